@@ -0,0 +1,142 @@
+// Compares LightCycle look-ahead cost against trail lifetime: the occupancy
+// grid should stay flat while a scan over the trail grows with it.
+//
+//   ./light_cycle_occupancy_bench
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+#include "animations/trail_occupancy.h"
+
+namespace {
+
+constexpr float kFps = 60.0f;
+constexpr int kCycles = 4;
+constexpr float kSpeed = 0.45f;
+constexpr float kSampleSpacing = 1.5f / 160.0f;
+constexpr float kLookAhead = 0.08f;
+constexpr int kFrames = 6000;
+
+struct Sample {
+    float from_x;
+    float from_y;
+    float x;
+    float y;
+    float time;
+};
+
+struct Cycle {
+    float x;
+    float y;
+    float dx;
+    float dy;
+    float last_x;
+    float last_y;
+    float travelled;
+};
+
+// Distance along the ray to the first trail sample within half a cell of it.
+float scan_clearance(const std::deque<Sample>& trail, const Cycle& cycle, float cell) {
+    float best = kLookAhead;
+    for (const Sample& sample : trail) {
+        const float px = sample.x - cycle.x;
+        const float py = sample.y - cycle.y;
+        const float along = px * cycle.dx + py * cycle.dy;
+        if (along <= cell || along >= best) {
+            continue;
+        }
+        const float across = std::abs(px * cycle.dy - py * cycle.dx);
+        if (across < cell * 0.5f) {
+            best = along;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    std::printf("%10s %10s %16s %16s\n", "tail_s", "samples", "grid_ns/frame", "scan_ns/frame");
+
+    for (const float tail_duration_s : {1.0f, 5.0f, 20.0f, 60.0f, 180.0f}) {
+        std::mt19937 rng(1234u);
+        std::uniform_real_distribution<float> position(0.05f, 0.95f);
+        std::uniform_int_distribution<int> turn(0, 59);
+
+        when::animations::TrailOccupancyGrid grid;
+        grid.resize(128, 128);
+        std::deque<Sample> trail;
+        Cycle cycles[kCycles];
+        for (Cycle& cycle : cycles) {
+            cycle = Cycle{position(rng), position(rng), 1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+            cycle.last_x = cycle.x;
+            cycle.last_y = cycle.y;
+        }
+
+        const float cell = grid.cell_size();
+        double grid_ns = 0.0;
+        double scan_ns = 0.0;
+        volatile float sink = 0.0f;
+        const float delta = 1.0f / kFps;
+        // Warm up until the trail reaches its steady-state length.
+        const int warmup_frames = static_cast<int>(tail_duration_s * kFps);
+        for (int frame = 0; frame < warmup_frames + kFrames; ++frame) {
+            const float now = static_cast<float>(frame) * delta;
+            const bool measure = frame >= warmup_frames;
+
+            auto grid_start = Clock::now();
+            for (Cycle& cycle : cycles) {
+                cycle.x += cycle.dx * kSpeed * delta;
+                cycle.y += cycle.dy * kSpeed * delta;
+                if (cycle.x < 0.0f || cycle.x > 1.0f || cycle.y < 0.0f || cycle.y > 1.0f || turn(rng) == 0) {
+                    cycle.x = std::fmod(cycle.x + 1.0f, 1.0f);
+                    cycle.y = std::fmod(cycle.y + 1.0f, 1.0f);
+                    cycle.last_x = cycle.x;
+                    cycle.last_y = cycle.y;
+                    const float swap = cycle.dx;
+                    cycle.dx = cycle.dy;
+                    cycle.dy = swap;
+                }
+                cycle.travelled += kSpeed * delta;
+                if (cycle.travelled >= kSampleSpacing) {
+                    trail.push_back(Sample{cycle.last_x, cycle.last_y, cycle.x, cycle.y, now});
+                    grid.add_segment(cycle.last_x, cycle.last_y, cycle.x, cycle.y);
+                    cycle.last_x = cycle.x;
+                    cycle.last_y = cycle.y;
+                    cycle.travelled = 0.0f;
+                }
+            }
+            while (!trail.empty() && now - trail.front().time > tail_duration_s) {
+                const Sample& expired = trail.front();
+                grid.remove_segment(expired.from_x, expired.from_y, expired.x, expired.y);
+                trail.pop_front();
+            }
+
+            for (const Cycle& cycle : cycles) {
+                sink = sink + grid.clearance(cycle.x, cycle.y, cycle.dx, cycle.dy, cell * 1.5f, kLookAhead);
+            }
+            auto scan_start = Clock::now();
+            for (const Cycle& cycle : cycles) {
+                sink = sink + scan_clearance(trail, cycle, cell);
+            }
+            auto scan_end = Clock::now();
+
+            if (measure) {
+                // Grid cost includes its incremental maintenance as samples are appended and expire.
+                grid_ns += std::chrono::duration<double, std::nano>(scan_start - grid_start).count();
+                scan_ns += std::chrono::duration<double, std::nano>(scan_end - scan_start).count();
+            }
+        }
+
+        std::printf("%10.0f %10zu %16.0f %16.0f\n",
+                    tail_duration_s,
+                    trail.size(),
+                    grid_ns / kFrames,
+                    scan_ns / kFrames);
+    }
+    return 0;
+}
@@ -0,0 +1,326 @@
+// End-to-end output cost: runs `when` inside a pseudo-terminal with a fixed
+// geometry, plays a deterministic audio file, and parses everything it writes.
+// Frames are delimited by the marker `when --frame-marker` emits after each
+// render, giving bytes and escape sequences per frame, frame intervals, and
+// feature-to-output latency (marker arrival minus the DSP hop that fed it).
+//
+//   ./pty_frame_bench --when ./when --config ../when.toml --seconds 10
+//   ./pty_frame_bench --when ./when --config ../when.toml --output ansi
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <poll.h>
+#include <pty.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include "frame_marker.h"
+
+namespace {
+
+struct FrameSample {
+    std::uint64_t sequence = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t escapes = 0;
+    std::int64_t arrival_ns = 0;
+    std::int64_t features_ns = 0;
+};
+
+void write_le(std::ofstream& out, std::uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.put(static_cast<char>((value >> (8 * i)) & 0xffu));
+    }
+}
+
+// 120 BPM kicks over a slow chord sweep: steady onsets and broadband content
+// so beat-driven and spectral animations both have work every frame.
+void write_test_audio(const std::string& path, double seconds) {
+    constexpr std::uint32_t kRate = 48000;
+    constexpr double kPi = 3.14159265358979323846;
+    const auto frames = static_cast<std::uint32_t>(seconds * kRate);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write("RIFF", 4);
+    write_le(out, 36 + frames * 2, 4);
+    out.write("WAVEfmt ", 8);
+    write_le(out, 16, 4);
+    write_le(out, 1, 2);
+    write_le(out, 1, 2);
+    write_le(out, kRate, 4);
+    write_le(out, kRate * 2, 4);
+    write_le(out, 2, 2);
+    write_le(out, 16, 2);
+    out.write("data", 4);
+    write_le(out, frames * 2, 4);
+    std::uint32_t noise = 0x12345678u;
+    for (std::uint32_t i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(i) / kRate;
+        const double beat_t = std::fmod(t, 0.5);
+        const double kick = std::exp(-beat_t * 18.0) * std::sin(2.0 * kPi * (50.0 + 90.0 * std::exp(-beat_t * 30.0)) * beat_t);
+        const double sweep = 0.5 + 0.5 * std::sin(2.0 * kPi * 0.1 * t);
+        double chord = 0.0;
+        for (const double ratio : {1.0, 1.25, 1.5}) {
+            chord += std::sin(2.0 * kPi * (220.0 + 440.0 * sweep) * ratio * t);
+        }
+        noise = noise * 1664525u + 1013904223u;
+        const double hat = (beat_t > 0.25 && beat_t < 0.27) ? (static_cast<double>(noise >> 8) / 8388608.0 - 1.0) : 0.0;
+        const double sample = std::clamp(0.5 * kick + 0.1 * chord + 0.15 * hat, -1.0, 1.0);
+        write_le(out, static_cast<std::uint16_t>(static_cast<std::int16_t>(sample * 32000.0)), 2);
+    }
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const double rank = p * static_cast<double>(values.size() - 1);
+    const auto lower = static_cast<std::size_t>(rank);
+    const std::size_t upper = std::min(lower + 1, values.size() - 1);
+    return values[lower] + (values[upper] - values[lower]) * (rank - static_cast<double>(lower));
+}
+
+void print_row(const char* name, const std::vector<double>& values, const char* unit) {
+    double sum = 0.0;
+    for (const double value : values) {
+        sum += value;
+    }
+    const double mean = values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+    const double max = values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+    std::printf("%-18s %10.2f %10.2f %10.2f %10.2f %10.2f  %s\n",
+                name,
+                mean,
+                percentile(values, 0.50),
+                percentile(values, 0.95),
+                percentile(values, 0.99),
+                max,
+                unit);
+}
+
+bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("pty_frame_bench", "Per-frame terminal output cost of when, measured through a PTY");
+    options.add_options()
+        ("when", "Path to the when binary", cxxopts::value<std::string>()->default_value("./when"))
+        ("c,config", "Configuration passed to when", cxxopts::value<std::string>()->default_value("when.toml"))
+        ("audio", "Audio file to play (default: generated test signal)", cxxopts::value<std::string>())
+        ("rows", "Terminal rows", cxxopts::value<unsigned short>()->default_value("50"))
+        ("cols", "Terminal columns", cxxopts::value<unsigned short>()->default_value("160"))
+        ("output", "Output backend passed to when (notcurses or ansi; default: config)",
+         cxxopts::value<std::string>())
+        ("term", "TERM for the child", cxxopts::value<std::string>()->default_value("xterm-256color"))
+        ("seconds", "Measurement length", cxxopts::value<double>()->default_value("10"))
+        ("warmup", "Frames ignored at startup", cxxopts::value<std::size_t>()->default_value("30"))
+        ("csv", "Write per-frame samples to this file", cxxopts::value<std::string>())
+        ("h,help", "Print usage");
+
+    std::string when_path;
+    std::string config_path;
+    std::string audio_path;
+    std::string csv_path;
+    std::string term;
+    std::string output_backend;
+    winsize size{};
+    double seconds = 10.0;
+    std::size_t warmup = 30;
+    try {
+        const auto result = options.parse(argc, argv);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        when_path = result["when"].as<std::string>();
+        config_path = result["config"].as<std::string>();
+        if (result.count("audio")) {
+            audio_path = result["audio"].as<std::string>();
+        }
+        if (result.count("csv")) {
+            csv_path = result["csv"].as<std::string>();
+        }
+        if (result.count("output")) {
+            output_backend = result["output"].as<std::string>();
+        }
+        term = result["term"].as<std::string>();
+        size.ws_row = result["rows"].as<unsigned short>();
+        size.ws_col = result["cols"].as<unsigned short>();
+        seconds = result["seconds"].as<double>();
+        warmup = result["warmup"].as<std::size_t>();
+    } catch (const cxxopts::exceptions::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (audio_path.empty()) {
+        audio_path = (std::filesystem::temp_directory_path() / "when_pty_frame_bench.wav").string();
+        write_test_audio(audio_path, 16.0);
+    }
+
+    int master = -1;
+    const pid_t child = forkpty(&master, nullptr, nullptr, &size);
+    if (child < 0) {
+        std::perror("forkpty");
+        return 1;
+    }
+    if (child == 0) {
+        setenv("TERM", term.c_str(), 1);
+        setenv("COLORTERM", "truecolor", 1);
+        std::vector<const char*> args{when_path.c_str(),
+                                      "--config",
+                                      config_path.c_str(),
+                                      "--file",
+                                      audio_path.c_str(),
+                                      "--frame-marker"};
+        if (!output_backend.empty()) {
+            args.push_back("--output");
+            args.push_back(output_backend.c_str());
+        }
+        args.push_back(nullptr);
+        execv(when_path.c_str(), const_cast<char* const*>(args.data()));
+        std::perror("exec");
+        _exit(127);
+    }
+
+    when::TerminalStreamScanner scanner;
+    std::vector<FrameSample> frames;
+    std::int64_t arrival_ns = 0;
+    when::TerminalStreamScanner::Handler handler;
+    handler.on_marker = [&](const when::FrameMarker& marker, const when::TerminalStreamScanner::Counts& counts) {
+        frames.push_back(FrameSample{marker.sequence, counts.bytes, counts.escapes, arrival_ns, marker.features_ns});
+    };
+    // notcurses blocks on its startup queries; answer as a VT220-class terminal.
+    handler.on_query = [&](when::TerminalStreamScanner::Query query) {
+        if (query == when::TerminalStreamScanner::Query::PrimaryDeviceAttributes) {
+            write_all(master, "\x1b[?62;22c");
+        } else {
+            write_all(master, "\x1b[1;1R");
+        }
+    };
+
+    const std::int64_t start_ns = when::steady_now_ns();
+    const auto measure_ns = static_cast<std::int64_t>(seconds * 1e9);
+    std::int64_t quit_sent_ns = 0;
+    bool eof = false;
+    std::vector<char> buffer(1 << 16);
+    while (!eof) {
+        pollfd fd{master, POLLIN, 0};
+        const int ready = ::poll(&fd, 1, 20);
+        arrival_ns = when::steady_now_ns();
+        if (ready > 0) {
+            const ssize_t got = ::read(master, buffer.data(), buffer.size());
+            if (got > 0) {
+                scanner.feed(std::string_view(buffer.data(), static_cast<std::size_t>(got)), handler);
+            } else if (got == 0 || errno != EINTR) {
+                eof = true; // EIO once the child has closed the slave side
+            }
+        }
+        if (quit_sent_ns == 0 && arrival_ns - start_ns >= measure_ns) {
+            write_all(master, "q");
+            quit_sent_ns = arrival_ns;
+        } else if (quit_sent_ns != 0 && arrival_ns - quit_sent_ns > 2'000'000'000) {
+            ::kill(child, SIGTERM);
+            break;
+        }
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    ::close(master);
+
+    // Frames after the quit request include shutdown output; drop them too.
+    std::vector<double> bytes;
+    std::vector<double> escapes;
+    std::vector<double> intervals_ms;
+    std::vector<double> latency_ms;
+    std::uint64_t missing = 0;
+    std::uint64_t measured_bytes = 0;
+    std::int64_t first_ns = 0;
+    std::int64_t last_ns = 0;
+    std::FILE* csv = csv_path.empty() ? nullptr : std::fopen(csv_path.c_str(), "w");
+    if (csv) {
+        std::fprintf(csv, "sequence,bytes,escapes,interval_ms,latency_ms\n");
+    }
+    for (std::size_t i = warmup; i < frames.size(); ++i) {
+        const FrameSample& frame = frames[i];
+        if (quit_sent_ns != 0 && frame.arrival_ns >= quit_sent_ns) {
+            break;
+        }
+        const double interval = (i > 0) ? static_cast<double>(frame.arrival_ns - frames[i - 1].arrival_ns) / 1e6 : 0.0;
+        const double latency = static_cast<double>(frame.arrival_ns - frame.features_ns) / 1e6;
+        bytes.push_back(static_cast<double>(frame.bytes));
+        escapes.push_back(static_cast<double>(frame.escapes));
+        if (i > warmup) {
+            intervals_ms.push_back(interval);
+            missing += frame.sequence - frames[i - 1].sequence - 1;
+        } else {
+            first_ns = frame.arrival_ns;
+        }
+        latency_ms.push_back(latency);
+        measured_bytes += frame.bytes;
+        last_ns = frame.arrival_ns;
+        if (csv) {
+            std::fprintf(csv,
+                         "%llu,%llu,%llu,%.3f,%.3f\n",
+                         static_cast<unsigned long long>(frame.sequence),
+                         static_cast<unsigned long long>(frame.bytes),
+                         static_cast<unsigned long long>(frame.escapes),
+                         interval,
+                         latency);
+        }
+    }
+    if (csv) {
+        std::fclose(csv);
+    }
+
+    std::printf("%ux%u TERM=%s output=%s, %zu frames measured (%zu warm-up, %llu markers missing), exit status %d\n",
+                size.ws_col,
+                size.ws_row,
+                term.c_str(),
+                output_backend.empty() ? "config" : output_backend.c_str(),
+                bytes.size(),
+                std::min(warmup, frames.size()),
+                static_cast<unsigned long long>(missing),
+                WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    if (bytes.empty()) {
+        std::fprintf(stderr, "no frames seen; is '%s' built with --frame-marker support?\n", when_path.c_str());
+        return 1;
+    }
+    std::printf("%-18s %10s %10s %10s %10s %10s\n", "", "mean", "p50", "p95", "p99", "max");
+    print_row("bytes/frame", bytes, "B");
+    print_row("escapes/frame", escapes, "");
+    print_row("frame interval", intervals_ms, "ms");
+    print_row("feature latency", latency_ms, "ms");
+    const double span_s = static_cast<double>(last_ns - first_ns) / 1e9;
+    if (span_s > 0.0) {
+        std::printf("output rate %.1f KiB/s, %.1f fps\n",
+                    static_cast<double>(measured_bytes) / 1024.0 / span_s,
+                    static_cast<double>(intervals_ms.size()) / span_s);
+    }
+    return 0;
+}
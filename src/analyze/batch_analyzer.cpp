@@ -0,0 +1,492 @@
+#include "analyze/batch_analyzer.h"
+
+#include <miniaudio.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "dsp.h"
+#include "dsp_setup.h"
+#include "events/event_bus.h"
+#include "events/frame_events.h"
+
+namespace when {
+namespace analyze {
+
+namespace {
+namespace fs = std::filesystem;
+
+constexpr std::uint64_t kFnvPrime = 0x100000001b3ull;
+constexpr std::size_t kHashChunkBytes = 1 << 20;
+constexpr ma_uint64 kDecodeChunkFrames = 4096;
+constexpr std::size_t kManifestSaveInterval = 16; // Completed tracks between manifest checkpoints
+constexpr const char* kManifestName = "manifest.tsv";
+constexpr const char* kManifestHeader = "# when-analyze manifest v1: path\tsize\tmtime_ns\tcontent_hash\tconfig_hash\toutput";
+constexpr const char* kCsvHeader =
+    "time_s,bass,mid,treble,total,beat,beat_strength,bpm,tempo_confidence,beat_phase,"
+    "spectral_centroid,spectral_flatness,novelty,section_index\n";
+
+std::string to_lower_copy(std::string_view value) {
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return lower;
+}
+
+bool is_audio_file(const fs::path& path) {
+    static const std::array<std::string_view, 4> kExtensions{".wav", ".mp3", ".flac", ".ogg"};
+    const std::string extension = to_lower_copy(path.extension().string());
+    return std::find(kExtensions.begin(), kExtensions.end(), extension) != kExtensions.end();
+}
+
+bool is_playlist(const fs::path& path) {
+    const std::string extension = to_lower_copy(path.extension().string());
+    return extension == ".m3u" || extension == ".m3u8" || extension == ".txt";
+}
+
+std::string to_hex(std::uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+bool parse_hex(const std::string& text, std::uint64_t& out) {
+    try {
+        std::size_t used = 0;
+        out = std::stoull(text, &used, 16);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::int64_t mtime_ns_of(const fs::path& path, std::error_code& ec) {
+    const auto time = fs::last_write_time(path, ec);
+    if (ec) {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+} // namespace
+
+std::uint64_t hash_bytes(std::string_view data, std::uint64_t seed) {
+    std::uint64_t hash = seed;
+    for (const char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+bool hash_file(const std::string& path, std::uint64_t& hash) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::vector<char> buffer(kHashChunkBytes);
+    hash = hash_bytes({});
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const std::streamsize got = in.gcount();
+        if (got <= 0) {
+            break;
+        }
+        hash = hash_bytes(std::string_view(buffer.data(), static_cast<std::size_t>(got)), hash);
+    }
+    return !in.bad();
+}
+
+std::vector<std::string> collect_tracks(const std::string& input, std::string& error) {
+    std::vector<std::string> tracks;
+    std::error_code ec;
+    const fs::path root = fs::absolute(input, ec);
+    if (ec || !fs::exists(root, ec)) {
+        error = "'" + input + "' does not exist";
+        return tracks;
+    }
+
+    if (fs::is_directory(root, ec)) {
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+             !ec && it != end;
+             it.increment(ec)) {
+            if (it->is_regular_file(ec) && is_audio_file(it->path())) {
+                tracks.push_back(it->path().lexically_normal().string());
+            }
+        }
+    } else if (is_playlist(root)) {
+        std::ifstream playlist(root);
+        if (!playlist) {
+            error = "Unable to read playlist '" + input + "'";
+            return tracks;
+        }
+        std::string line;
+        while (std::getline(playlist, line)) {
+            while (!line.empty() && (line.back() == '\r' || std::isspace(static_cast<unsigned char>(line.back())))) {
+                line.pop_back();
+            }
+            const std::size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+            fs::path entry(line.substr(start));
+            if (entry.is_relative()) {
+                entry = root.parent_path() / entry;
+            }
+            tracks.push_back(entry.lexically_normal().string());
+        }
+    } else {
+        tracks.push_back(root.lexically_normal().string());
+    }
+
+    std::sort(tracks.begin(), tracks.end());
+    tracks.erase(std::unique(tracks.begin(), tracks.end()), tracks.end());
+    if (ec) {
+        error = "Error while scanning '" + input + "': " + ec.message();
+    }
+    return tracks;
+}
+
+bool AnalysisManifest::load(const std::string& path) {
+    records_.clear();
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 6) {
+            continue;
+        }
+        TrackRecord record;
+        record.path = fields[0];
+        record.output = fields[5];
+        try {
+            record.size = std::stoull(fields[1]);
+            record.mtime_ns = std::stoll(fields[2]);
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (!parse_hex(fields[3], record.content_hash) || !parse_hex(fields[4], record.config_hash)) {
+            continue;
+        }
+        records_[record.path] = std::move(record);
+    }
+    return true;
+}
+
+bool AnalysisManifest::save(const std::string& path) const {
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << kManifestHeader << '\n';
+        for (const auto& [key, record] : records_) {
+            out << record.path << '\t' << record.size << '\t' << record.mtime_ns << '\t'
+                << to_hex(record.content_hash) << '\t' << to_hex(record.config_hash) << '\t' << record.output << '\n';
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp_path, path, ec);
+    return !ec;
+}
+
+const TrackRecord* AnalysisManifest::find(const std::string& track_path) const {
+    const auto it = records_.find(track_path);
+    return (it != records_.end()) ? &it->second : nullptr;
+}
+
+void AnalysisManifest::update(const TrackRecord& record) {
+    records_[record.path] = record;
+}
+
+TrackResult analyze_track(const std::string& track_path,
+                          const std::string& output_path,
+                          const DspConfig& config,
+                          std::uint32_t sample_rate) {
+    TrackResult result;
+
+    ma_decoder decoder;
+    const ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, 1, sample_rate);
+    if (ma_decoder_init_file(track_path.c_str(), &decoder_config, &decoder) != MA_SUCCESS) {
+        result.error = "unable to decode";
+        return result;
+    }
+
+    const std::string temp_path = output_path + ".tmp";
+    std::ofstream out(temp_path, std::ios::trunc);
+    if (!out) {
+        ma_decoder_uninit(&decoder);
+        result.error = "unable to write '" + temp_path + "'";
+        return result;
+    }
+    out << kCsvHeader;
+
+    try {
+        events::EventBus bus;
+        DspEngine dsp(bus,
+                      sample_rate,
+                      1,
+                      config.fft_size,
+                      config.hop_size,
+                      config.bands,
+                      make_feature_extractor_config(config));
+        std::vector<std::string> warnings;
+        configure_dsp_engine(dsp, config, warnings);
+
+        // The analysis clock is the end of each hop, which is what the live
+        // visualiser sees when that hop's features arrive.
+        const double seconds_per_hop = static_cast<double>(config.hop_size) / static_cast<double>(sample_rate);
+        std::array<char, 512> row{};
+        auto handle = bus.subscribe<events::AudioFeaturesUpdatedEvent>(
+            [&](const events::AudioFeaturesUpdatedEvent& event) {
+                const AudioFeatures& f = event.features;
+                ++result.frames;
+                const int length = std::snprintf(row.data(),
+                                                 row.size(),
+                                                 "%.4f,%.6g,%.6g,%.6g,%.6g,%d,%.4f,%.2f,%.4f,%.4f,%.2f,%.4f,%.4f,%zu\n",
+                                                 static_cast<double>(result.frames) * seconds_per_hop,
+                                                 f.bass_energy,
+                                                 f.mid_energy,
+                                                 f.treble_energy,
+                                                 f.total_energy,
+                                                 f.beat_detected ? 1 : 0,
+                                                 f.beat_strength,
+                                                 f.bpm,
+                                                 f.tempo_confidence,
+                                                 f.beat_phase,
+                                                 f.spectral_centroid,
+                                                 f.spectral_flatness,
+                                                 f.novelty,
+                                                 f.section_index);
+                if (length > 0) {
+                    out.write(row.data(), std::min<std::streamsize>(length, static_cast<std::streamsize>(row.size() - 1)));
+                }
+            });
+
+        std::vector<float> samples(static_cast<std::size_t>(kDecodeChunkFrames));
+        std::uint64_t total_frames = 0;
+        for (;;) {
+            ma_uint64 frames_read = 0;
+            const ma_result read = ma_decoder_read_pcm_frames(&decoder, samples.data(), kDecodeChunkFrames, &frames_read);
+            if (frames_read > 0) {
+                dsp.push_samples(samples.data(), static_cast<std::size_t>(frames_read));
+                total_frames += frames_read;
+            }
+            if (read != MA_SUCCESS || frames_read < kDecodeChunkFrames) {
+                break;
+            }
+        }
+        result.audio_seconds = static_cast<double>(total_frames) / static_cast<double>(sample_rate);
+    } catch (const std::exception& ex) {
+        ma_decoder_uninit(&decoder);
+        result.error = ex.what();
+        return result;
+    }
+    ma_decoder_uninit(&decoder);
+
+    out.close();
+    if (!out) {
+        result.error = "failed writing '" + temp_path + "'";
+        return result;
+    }
+    std::error_code ec;
+    fs::rename(temp_path, output_path, ec);
+    if (ec) {
+        result.error = "unable to move output into place: " + ec.message();
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
+
+BatchAnalyzer::BatchAnalyzer(const DspConfig& config, Options options)
+    : config_(config),
+      options_(std::move(options)) {
+    const std::string description =
+        describe_analysis_config(config_) + ";sample_rate=" + std::to_string(options_.sample_rate);
+    config_hash_ = hash_bytes(description);
+}
+
+std::string BatchAnalyzer::output_name_for(const std::string& track_path) const {
+    // The path hash keeps same-named tracks from different folders apart.
+    std::string stem = fs::path(track_path).stem().string();
+    for (char& c : stem) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') {
+            c = '_';
+        }
+    }
+    const std::string tag = to_hex(hash_bytes(track_path)).substr(0, 8);
+    return stem + "-" + tag + ".csv";
+}
+
+bool BatchAnalyzer::run(const std::vector<std::string>& tracks,
+                        const ProgressCallback& on_progress,
+                        double progress_interval_s) {
+    std::error_code ec;
+    fs::create_directories(options_.output_dir, ec);
+    if (ec) {
+        last_error_ = "Unable to create '" + options_.output_dir + "': " + ec.message();
+        return false;
+    }
+    manifest_path_ = (fs::path(options_.output_dir) / kManifestName).string();
+    manifest_.load(manifest_path_);
+    errors_.clear();
+    progress_ = Progress{};
+    progress_.total = tracks.size();
+    unsaved_updates_ = 0;
+
+    // Longest tracks first so one long mix does not finish alone at the end.
+    std::vector<Job> jobs;
+    jobs.reserve(tracks.size());
+    for (const std::string& track : tracks) {
+        Job job;
+        job.path = track;
+        job.size = fs::file_size(track, ec);
+        if (ec) {
+            job.size = 0;
+        }
+        job.mtime_ns = mtime_ns_of(track, ec);
+        jobs.push_back(std::move(job));
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.size > b.size; });
+
+    std::size_t worker_count = options_.jobs;
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    worker_count = std::min(worker_count, std::max<std::size_t>(jobs.size(), 1));
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next_job{0};
+    std::atomic<std::size_t> running{worker_count};
+    std::condition_variable finished;
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (std::size_t w = 0; w < worker_count; ++w) {
+        workers.emplace_back([&]() {
+            for (;;) {
+                const std::size_t index = next_job.fetch_add(1);
+                if (index >= jobs.size()) {
+                    break;
+                }
+                process(jobs[index]);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (running.fetch_sub(1) == 1) {
+                finished.notify_all();
+            }
+        });
+    }
+
+    const auto interval = std::chrono::duration<double>(std::max(progress_interval_s, 0.01));
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running.load() > 0) {
+            finished.wait_for(lock, interval);
+            progress_.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (on_progress) {
+                on_progress(progress_);
+            }
+        }
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    progress_.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!manifest_.save(manifest_path_)) {
+        last_error_ = "Unable to write manifest '" + manifest_path_ + "'";
+        return false;
+    }
+    return true;
+}
+
+void BatchAnalyzer::process(const Job& job) {
+    const std::string output_name = output_name_for(job.path);
+    const std::string output_path = (fs::path(options_.output_dir) / output_name).string();
+
+    TrackRecord previous;
+    bool have_previous = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (const TrackRecord* record = manifest_.find(job.path)) {
+            previous = *record;
+            have_previous = true;
+        }
+    }
+
+    // Unchanged size and mtime mean unchanged content; otherwise hash it, so a
+    // touched or copied file with the same bytes is still skipped.
+    TrackRecord record;
+    record.path = job.path;
+    record.size = job.size;
+    record.mtime_ns = job.mtime_ns;
+    record.config_hash = config_hash_;
+    record.output = output_name;
+    const bool stat_matches = have_previous && previous.size == job.size && previous.mtime_ns == job.mtime_ns;
+    if (stat_matches) {
+        record.content_hash = previous.content_hash;
+    } else if (!hash_file(job.path, record.content_hash)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++progress_.failed;
+        errors_.push_back(job.path + ": unable to read");
+        return;
+    }
+
+    std::error_code ec;
+    const bool current = !options_.force && have_previous && previous.content_hash == record.content_hash &&
+                         previous.config_hash == config_hash_ && previous.output == output_name &&
+                         fs::exists(output_path, ec);
+    if (current) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++progress_.skipped;
+        if (!stat_matches) {
+            manifest_.update(record);
+        }
+        return;
+    }
+
+    const TrackResult result = analyze_track(job.path, output_path, config_, options_.sample_rate);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!result.ok) {
+        ++progress_.failed;
+        errors_.push_back(job.path + ": " + result.error);
+        return;
+    }
+    ++progress_.analysed;
+    progress_.audio_seconds += result.audio_seconds;
+    manifest_.update(record);
+    // Checkpoint now and then so an interrupted run keeps most of its work.
+    if (++unsaved_updates_ >= kManifestSaveInterval) {
+        unsaved_updates_ = 0;
+        manifest_.save(manifest_path_);
+    }
+}
+
+} // namespace analyze
+} // namespace when
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.h"
+
+namespace when {
+namespace analyze {
+
+// 64-bit FNV-1a; stable across runs and platforms.
+std::uint64_t hash_bytes(std::string_view data, std::uint64_t seed = 0xcbf29ce484222325ull);
+// Hashes a file's contents in fixed-size chunks. Returns false if it cannot be read.
+bool hash_file(const std::string& path, std::uint64_t& hash);
+
+// Expands a directory (recursively, audio extensions only) or an .m3u/.m3u8/
+// .txt playlist (one path per line, relative to the playlist, '#' comments)
+// into absolute track paths. A single audio file is returned as is.
+std::vector<std::string> collect_tracks(const std::string& input, std::string& error);
+
+// What a previous run knew about a track. A track is skipped when its content
+// hash and the analysis config hash both match and its output still exists;
+// size and mtime only decide whether the content needs re-hashing.
+struct TrackRecord {
+    std::string path;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+    std::uint64_t content_hash = 0;
+    std::uint64_t config_hash = 0;
+    std::string output; // Feature file name inside the output directory
+};
+
+// Tab-separated manifest kept in the output directory.
+class AnalysisManifest {
+public:
+    bool load(const std::string& path);
+    // Writes to a temporary file and renames it over the old manifest.
+    bool save(const std::string& path) const;
+
+    const TrackRecord* find(const std::string& track_path) const;
+    void update(const TrackRecord& record);
+    std::size_t size() const { return records_.size(); }
+
+private:
+    std::map<std::string, TrackRecord> records_;
+};
+
+struct TrackResult {
+    bool ok = false;
+    double audio_seconds = 0.0;
+    std::size_t frames = 0; // Feature rows written
+    std::string error;
+};
+
+// Decodes one track to mono at sample_rate, runs it through a DspEngine set up
+// from config, and writes one CSV row per analysis hop to output_path.
+TrackResult analyze_track(const std::string& track_path,
+                          const std::string& output_path,
+                          const DspConfig& config,
+                          std::uint32_t sample_rate);
+
+// Runs analyze_track for a list of tracks on a pool of worker threads.
+class BatchAnalyzer {
+public:
+    struct Options {
+        std::string output_dir = "analysis";
+        std::size_t jobs = 0; // 0 = hardware concurrency
+        bool force = false;   // Re-analyse even when the manifest says a track is current
+        std::uint32_t sample_rate = 48000;
+    };
+
+    struct Progress {
+        std::size_t total = 0;
+        std::size_t analysed = 0;
+        std::size_t skipped = 0;
+        std::size_t failed = 0;
+        double audio_seconds = 0.0; // Audio analysed so far (skipped tracks excluded)
+        double wall_seconds = 0.0;
+        double realtime_factor() const { return wall_seconds > 0.0 ? audio_seconds / wall_seconds : 0.0; }
+    };
+
+    using ProgressCallback = std::function<void(const Progress&)>;
+
+    BatchAnalyzer(const DspConfig& config, Options options);
+
+    // Returns false when the output directory or manifest cannot be written;
+    // per-track failures are collected in errors() instead.
+    bool run(const std::vector<std::string>& tracks,
+             const ProgressCallback& on_progress = {},
+             double progress_interval_s = 0.5);
+
+    const Progress& progress() const { return progress_; }
+    const std::vector<std::string>& errors() const { return errors_; }
+    const std::string& last_error() const { return last_error_; }
+    std::uint64_t config_hash() const { return config_hash_; }
+
+private:
+    struct Job {
+        std::string path;
+        std::uint64_t size = 0;
+        std::int64_t mtime_ns = 0;
+    };
+
+    void process(const Job& job);
+    // File name within output_dir, so the manifest survives moving the directory.
+    std::string output_name_for(const std::string& track_path) const;
+
+    DspConfig config_;
+    Options options_;
+    std::uint64_t config_hash_ = 0;
+    std::string manifest_path_;
+    AnalysisManifest manifest_;
+    std::mutex mutex_; // Guards manifest_, errors_ and the progress counters below
+    std::size_t unsaved_updates_ = 0;
+    Progress progress_{};
+    std::vector<std::string> errors_;
+    std::string last_error_;
+};
+
+} // namespace analyze
+} // namespace when
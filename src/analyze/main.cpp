@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include "analyze/batch_analyzer.h"
+#include "config.h"
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("when-analyze", "Batch feature analysis for a directory or playlist of tracks");
+    options.add_options()
+        ("c,config", "Path to configuration file", cxxopts::value<std::string>()->default_value("when.toml"))
+        ("o,output", "Directory for per-track feature CSVs and the manifest",
+         cxxopts::value<std::string>()->default_value("analysis"))
+        ("j,jobs", "Worker threads (0 = all cores)", cxxopts::value<std::size_t>()->default_value("0"))
+        ("force", "Re-analyse tracks even when they are current")
+        ("input", "Directory, playlist (.m3u/.m3u8/.txt) or audio file", cxxopts::value<std::string>())
+        ("h,help", "Print usage");
+    options.parse_positional({"input"});
+    options.positional_help("<directory|playlist|file>");
+
+    std::string config_path;
+    std::string input;
+    when::analyze::BatchAnalyzer::Options analyzer_options;
+    try {
+        const auto result = options.parse(argc, argv);
+        if (result.count("help") || !result.count("input")) {
+            std::cout << options.help() << std::endl;
+            return result.count("help") ? 0 : 1;
+        }
+        config_path = result["config"].as<std::string>();
+        input = result["input"].as<std::string>();
+        analyzer_options.output_dir = result["output"].as<std::string>();
+        analyzer_options.jobs = result["jobs"].as<std::size_t>();
+        analyzer_options.force = result.count("force") > 0;
+    } catch (const cxxopts::exceptions::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+
+    const when::ConfigLoadResult config_result = when::load_app_config(config_path);
+    if (!config_result.loaded_file) {
+        std::clog << "[config] using built-in defaults (missing '" << config_path << "')" << std::endl;
+    }
+    for (const std::string& warning : config_result.warnings) {
+        std::cerr << "[config] " << warning << std::endl;
+    }
+    analyzer_options.sample_rate = config_result.config.audio.capture.sample_rate;
+
+    std::string scan_error;
+    const std::vector<std::string> tracks = when::analyze::collect_tracks(input, scan_error);
+    if (!scan_error.empty()) {
+        std::cerr << "[analyze] " << scan_error << std::endl;
+    }
+    if (tracks.empty()) {
+        std::cerr << "[analyze] no tracks found" << std::endl;
+        return 1;
+    }
+
+    when::analyze::BatchAnalyzer analyzer(config_result.config.dsp, analyzer_options);
+    std::clog << "[analyze] " << tracks.size() << " tracks -> '" << analyzer_options.output_dir << "'" << std::endl;
+
+    const bool ok = analyzer.run(tracks, [](const when::analyze::BatchAnalyzer::Progress& progress) {
+        const std::size_t done = progress.analysed + progress.skipped + progress.failed;
+        std::fprintf(stderr,
+                     "\r[analyze] %zu/%zu (analysed %zu, skipped %zu, failed %zu) %.0f audio-s in %.1f s, %.1fx realtime",
+                     done,
+                     progress.total,
+                     progress.analysed,
+                     progress.skipped,
+                     progress.failed,
+                     progress.audio_seconds,
+                     progress.wall_seconds,
+                     progress.realtime_factor());
+        std::fflush(stderr);
+    });
+    std::fprintf(stderr, "\n");
+
+    for (const std::string& error : analyzer.errors()) {
+        std::cerr << "[analyze] " << error << std::endl;
+    }
+    if (!ok) {
+        std::cerr << "[analyze] " << analyzer.last_error() << std::endl;
+        return 1;
+    }
+    return analyzer.errors().empty() ? 0 : 2;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -13,6 +14,8 @@
 namespace when {
 namespace animations {
 
+class CueScheduler;
+
 template<typename AnimationT>
 void bind_standard_frame_updates(AnimationT* animation,
                                  const AnimationConfig& config,
@@ -41,6 +44,18 @@ public:
         (void)bus;
     }
 
+    // Spawns any beat-sequenced cues; the scheduler outlives them and is
+    // cleared before the animation is destroyed.
+    virtual void bind_cues(CueScheduler& cues) { (void)cues; }
+
+    // Runs update() only on every Nth frame, offset by phase, passing the
+    // delta time accumulated since the previous scheduled update.
+    void set_update_schedule(unsigned int divisor, unsigned int phase) {
+        update_divisor_ = (divisor == 0u) ? 1u : divisor;
+        update_phase_ = phase % update_divisor_;
+        pending_delta_time_ = 0.0f;
+    }
+
     void clear_event_subscriptions() {
         for (auto& handle : event_subscriptions_) {
             handle.reset();
@@ -54,7 +69,20 @@ protected:
     }
 
 private:
+    bool take_update_slot(std::uint64_t frame_index, float delta_time, float& scheduled_delta_time) {
+        pending_delta_time_ += delta_time;
+        if (update_divisor_ > 1u && (frame_index + update_phase_) % update_divisor_ != 0u) {
+            return false;
+        }
+        scheduled_delta_time = pending_delta_time_;
+        pending_delta_time_ = 0.0f;
+        return true;
+    }
+
     std::vector<events::EventBus::SubscriptionHandle> event_subscriptions_;
+    unsigned int update_divisor_ = 1u;
+    unsigned int update_phase_ = 0u;
+    float pending_delta_time_ = 0.0f;
 
     template<typename AnimationT>
     friend void bind_standard_frame_updates(AnimationT* animation,
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "../config.h"
 #include "../events/event_bus.h"
 #include "../events/frame_events.h"
@@ -55,6 +57,48 @@ inline bool evaluate_beat_condition(const AnimationConfig& config, const AudioFe
            features.beat_strength <= config.trigger_beat_max;
 }
 
+// Creates a child of the standard plane sized and placed by the animation's
+// plane_rows/plane_cols/plane_y/plane_x (full screen when unset or config is
+// null). Returns nullptr and zero dimensions when there is nothing to create.
+inline ncplane* create_configured_plane(notcurses* nc,
+                                        const AnimationConfig* config,
+                                        unsigned int& rows,
+                                        unsigned int& cols) {
+    rows = 0;
+    cols = 0;
+    if (!nc) {
+        return nullptr;
+    }
+
+    ncplane* stdplane = notcurses_stdplane(nc);
+    unsigned int std_rows = 0;
+    unsigned int std_cols = 0;
+    ncplane_dim_yx(stdplane, &std_rows, &std_cols);
+
+    ncplane_options opts{};
+    opts.rows = std_rows;
+    opts.cols = std_cols;
+    if (config) {
+        if (config->plane_rows) {
+            opts.rows = static_cast<unsigned int>(std::clamp(*config->plane_rows, 1, static_cast<int>(std::max(std_rows, 1u))));
+        }
+        if (config->plane_cols) {
+            opts.cols = static_cast<unsigned int>(std::clamp(*config->plane_cols, 1, static_cast<int>(std::max(std_cols, 1u))));
+        }
+        opts.y = config->plane_y.value_or(0);
+        opts.x = config->plane_x.value_or(0);
+    }
+    if (opts.rows == 0u || opts.cols == 0u) {
+        return nullptr;
+    }
+
+    ncplane* plane = ncplane_create(stdplane, &opts);
+    if (plane) {
+        ncplane_dim_yx(plane, &rows, &cols);
+    }
+    return plane;
+}
+
 template<typename AnimationT>
 void bind_standard_frame_updates(AnimationT* animation,
                                  const AnimationConfig& config,
@@ -70,12 +114,15 @@ void bind_standard_frame_updates(AnimationT* animation,
 
             if (should_be_active && !animation->is_active()) {
                 animation->activate();
+                animation->pending_delta_time_ = 0.0f;
             } else if (!should_be_active && animation->is_active()) {
                 animation->deactivate();
             }
 
-            if (animation->is_active()) {
-                animation->update(event.delta_time,
+            float scheduled_delta_time = 0.0f;
+            if (animation->is_active() &&
+                animation->take_update_slot(event.frame_index, event.delta_time, scheduled_delta_time)) {
+                animation->update(scheduled_delta_time,
                                   event.metrics,
                                   event.features);
             }
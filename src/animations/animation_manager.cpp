@@ -1,10 +1,16 @@
 #include "animation_manager.h"
 
 #include "ascii_matrix_animation.h"
+#include "breathe_animation.h"
 #include "pleasure_animation.h"
 #include "space_rock_animation.h"
 #include "light_brush_animation.h"
 #include "light_cycle_animation.h"
+#include "log_animation.h"
+#include "plasma_animation.h"
+#include "random_text_animation.h"
+
+#include <map>
 
 #include "../config/raw_config.h"
 
@@ -13,6 +19,7 @@ namespace animations {
 
 void AnimationManager::load_animations(notcurses* nc, const AppConfig& app_config) {
     event_bus_.reset();
+    cues_.clear();
     animations_.clear();
     animations_.reserve(app_config.animations.size());
 
@@ -30,6 +37,14 @@ void AnimationManager::load_animations(notcurses* nc, const AppConfig& app_confi
             new_animation = std::make_unique<LightBrushAnimation>();
         } else if (cleaned_type == "LightCycle") {
             new_animation = std::make_unique<LightCycleAnimation>();
+        } else if (cleaned_type == "Plasma") {
+            new_animation = std::make_unique<PlasmaAnimation>();
+        } else if (cleaned_type == "RandomText") {
+            new_animation = std::make_unique<RandomTextAnimation>();
+        } else if (cleaned_type == "Breathe") {
+            new_animation = std::make_unique<BreatheAnimation>();
+        } else if (cleaned_type == "Log") {
+            new_animation = std::make_unique<LogAnimation>();
         }
 
         if (new_animation) {
@@ -41,11 +56,31 @@ void AnimationManager::load_animations(notcurses* nc, const AppConfig& app_confi
             managed->animation = std::move(new_animation);
 
             managed->animation->bind_events(managed->config, event_bus_);
+            managed->animation->bind_cues(cues_);
             animations_.push_back(std::move(managed));
         } else {
             // std::cerr << "[AnimationManager::load_animations] Unknown animation type: " << anim_config.type << std::endl;
         }
     }
+
+    assign_schedule_phases();
+}
+
+// Animations sharing a divisor are spread across its phases so their reduced-rate
+// frames do not all land together and the per-frame cost stays flat.
+void AnimationManager::assign_schedule_phases() {
+    update_frame_index_ = 0;
+    render_frame_index_ = 0;
+
+    std::map<unsigned int, unsigned int> update_groups;
+    std::map<unsigned int, unsigned int> render_groups;
+    for (const auto& managed : animations_) {
+        const unsigned int update_divisor = static_cast<unsigned int>(std::max(1, managed->config.update_divisor));
+        managed->animation->set_update_schedule(update_divisor, update_groups[update_divisor]++);
+
+        managed->render_divisor = static_cast<unsigned int>(std::max(1, managed->config.render_divisor));
+        managed->render_phase = render_groups[managed->render_divisor]++ % managed->render_divisor;
+    }
 }
 
 void AnimationManager::update_all(float delta_time,
@@ -55,8 +90,15 @@ void AnimationManager::update_all(float delta_time,
         events::BeatDetectedEvent beat_event{features.beat_strength};
         event_bus_.publish(beat_event);
     }
+    if (features.section_change) {
+        events::SectionChangeEvent section_event{features.section_peak, features.section_index};
+        event_bus_.publish(section_event);
+    }
 
-    events::FrameUpdateEvent frame_event{delta_time, metrics, features};
+    // Cues resume before the frame update so state they set is seen this frame.
+    cues_.advance(delta_time, features);
+
+    events::FrameUpdateEvent frame_event{delta_time, metrics, features, update_frame_index_++};
     event_bus_.publish(frame_event);
 }
 
@@ -67,14 +109,22 @@ void AnimationManager::render_all(notcurses* nc) {
 
     for (const auto& managed_anim : animations_) {
         if (auto* plane = managed_anim->animation->get_plane()) {
-            ncplane_move_bottom(plane);
+            // Family moves keep child planes (e.g. the log text area) with their layer.
+            ncplane_move_family_bottom(plane);
         }
     }
 
+    // Off-slot layers are simply not redrawn; their planes keep the last content.
+    const std::uint64_t frame_index = render_frame_index_++;
     for (const auto& managed_anim : animations_) {
-        if (managed_anim->animation->is_active()) {
-            managed_anim->animation->render(nc);
+        if (!managed_anim->animation->is_active()) {
+            continue;
+        }
+        if (managed_anim->render_divisor > 1u &&
+            (frame_index + managed_anim->render_phase) % managed_anim->render_divisor != 0u) {
+            continue;
         }
+        managed_anim->animation->render(nc);
     }
 }
 
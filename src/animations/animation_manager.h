@@ -1,12 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 #include <notcurses/notcurses.h>
 
 #include "animation.h"
+#include "cue_timeline.h"
 #include "../config.h"
 #include "../events/event_bus.h"
 #include "../events/frame_events.h"
@@ -27,15 +29,25 @@ public:
 
     events::EventBus& event_bus() { return event_bus_; }
     const events::EventBus& event_bus() const { return event_bus_; }
+    CueScheduler& cues() { return cues_; }
 
 private:
     struct ManagedAnimation {
         std::unique_ptr<Animation> animation;
         AnimationConfig config;
+        unsigned int render_divisor = 1;
+        unsigned int render_phase = 0;
     };
 
+    void assign_schedule_phases();
+
     std::vector<std::unique_ptr<ManagedAnimation>> animations_;
+    // Declared after animations_ so parked cues are destroyed before the
+    // animations they reference.
+    CueScheduler cues_;
     events::EventBus event_bus_;
+    std::uint64_t update_frame_index_ = 0;
+    std::uint64_t render_frame_index_ = 0;
 };
 
 } // namespace animations
@@ -0,0 +1,229 @@
+#include "breathe_animation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "animation_event_utils.h"
+
+namespace when {
+namespace animations {
+
+namespace {
+constexpr int kBrailleRowsPerCell = 4;
+constexpr int kBrailleColsPerCell = 2;
+constexpr float kTwoPi = 6.28318530718f;
+constexpr float kDotsPerSegment = 2.0f;   // Outline vertex spacing at the largest radius
+constexpr std::size_t kMaxVertices = 1024;
+constexpr float kLineRadiusDots = 0.8f;
+constexpr float kNoiseDriftPerSecond = 0.07f; // Noise table periods per second
+constexpr std::uint32_t kNoiseSeed = 0x6272u;
+constexpr float kBaseBrightness = 0.55f;
+constexpr std::array<float, 3> kRingColor{110.0f, 185.0f, 255.0f};
+} // namespace
+
+BreatheAnimation::BreatheAnimation() = default;
+
+BreatheAnimation::~BreatheAnimation() {
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+}
+
+void BreatheAnimation::init(notcurses* nc, const AppConfig& config) {
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+
+    z_index_ = 0;
+    is_active_ = true;
+    params_ = Parameters{};
+    energy_ = 0.0f;
+    pulse_phase_ = 0.0f;
+    rotation_ = 0.0f;
+    noise_phase_ = 0.0f;
+    outline_rows_ = 0;
+    outline_cols_ = 0;
+
+    const AnimationConfig* own_config = nullptr;
+    for (const auto& anim_config : config.animations) {
+        if (anim_config.type == "Breathe") {
+            own_config = &anim_config;
+            break;
+        }
+    }
+    if (own_config) {
+        z_index_ = own_config->z_index;
+        is_active_ = own_config->initially_active;
+        load_parameters_from_config(*own_config);
+    }
+    radius_ = params_.min_radius;
+
+    plane_ = create_configured_plane(nc, own_config, plane_rows_, plane_cols_);
+}
+
+void BreatheAnimation::load_parameters_from_config(const AnimationConfig& config) {
+    params_.points = std::clamp(config.breathe_points, 3, static_cast<int>(kMaxVertices));
+    params_.min_radius = std::max(config.breathe_min_radius, 0.5f);
+    params_.max_radius = std::max(config.breathe_max_radius, params_.min_radius);
+    params_.audio_radius_influence = std::max(config.breathe_audio_radius_influence, 0.0f);
+    params_.smoothing_s = std::max(config.breathe_smoothing_s, 0.0f);
+    params_.noise_amount = std::clamp(config.breathe_noise_amount, 0.0f, 0.9f);
+    params_.rotation_speed = config.breathe_rotation_speed;
+    params_.vertical_scale = std::max(config.breathe_vertical_scale, 0.05f);
+    params_.base_pulse_hz = std::max(config.breathe_base_pulse_hz, 0.0f);
+    params_.audio_pulse_weight = std::max(config.breathe_audio_pulse_weight, 0.0f);
+    params_.band_index = config.breathe_band_index;
+    params_.rms_weight = std::max(config.breathe_rms_weight, 0.0f);
+    params_.beat_weight = std::max(config.breathe_beat_weight, 0.0f);
+    params_.band_weight = std::max(config.breathe_band_weight, 0.0f);
+}
+
+
+// Sizes the vertex tables so neighbouring vertices sit about kDotsPerSegment
+// dots apart at the largest radius the plane can show; breathe_points is the floor.
+void BreatheAnimation::configure_outline() {
+    outline_rows_ = plane_rows_;
+    outline_cols_ = plane_cols_;
+
+    const float fit_radius = std::min(static_cast<float>(plane_cols_) * 0.5f,
+                                      static_cast<float>(plane_rows_) * 0.5f / params_.vertical_scale);
+    const float largest = std::min(params_.max_radius + params_.audio_radius_influence, fit_radius);
+    const float largest_dots = largest * std::max(static_cast<float>(kBrailleColsPerCell),
+                                                  params_.vertical_scale * static_cast<float>(kBrailleRowsPerCell));
+    const auto matched = static_cast<std::size_t>(std::ceil(kTwoPi * largest_dots / kDotsPerSegment));
+    const std::size_t count = std::clamp<std::size_t>(matched, static_cast<std::size_t>(params_.points), kMaxVertices);
+    if (count != outline_.vertex_count()) {
+        outline_.configure(count, kNoiseSeed);
+    }
+}
+
+void BreatheAnimation::update(float delta_time,
+                              const AudioMetrics& metrics,
+                              const AudioFeatures& features) {
+    if (!plane_) {
+        return;
+    }
+
+    const float dt = std::max(delta_time, 0.0f);
+    float target = params_.rms_weight * metrics.rms + params_.beat_weight * features.beat_strength;
+    if (params_.band_index >= 0) {
+        target += params_.band_weight * resolve_feature_value(features, params_.band_index);
+    }
+    target = std::clamp(target, 0.0f, 1.5f);
+    const float smoothing = (params_.smoothing_s > 0.0f) ? 1.0f - std::exp(-dt / params_.smoothing_s) : 1.0f;
+    energy_ += (target - energy_) * smoothing;
+
+    const float pulse_hz = params_.base_pulse_hz * (1.0f + params_.audio_pulse_weight * energy_);
+    pulse_phase_ = std::fmod(pulse_phase_ + dt * pulse_hz * kTwoPi, kTwoPi);
+    rotation_ = std::fmod(rotation_ + dt * params_.rotation_speed, kTwoPi);
+    noise_phase_ = std::fmod(noise_phase_ + dt * kNoiseDriftPerSecond * (1.0f + energy_), 1.0f);
+
+    const float breath = 0.5f + 0.5f * std::sin(pulse_phase_);
+    radius_ = params_.min_radius + (params_.max_radius - params_.min_radius) * breath +
+              params_.audio_radius_influence * energy_;
+}
+
+void BreatheAnimation::render(notcurses* /*nc*/) {
+    if (!plane_ || !is_active_) {
+        return;
+    }
+
+    ncplane_dim_yx(plane_, &plane_rows_, &plane_cols_);
+    ncplane_erase(plane_);
+    if (plane_rows_ == 0u || plane_cols_ == 0u) {
+        return;
+    }
+    if (plane_rows_ != outline_rows_ || plane_cols_ != outline_cols_) {
+        configure_outline();
+    }
+
+    const int dot_cols = static_cast<int>(plane_cols_) * kBrailleColsPerCell;
+    const int dot_rows = static_cast<int>(plane_rows_) * kBrailleRowsPerCell;
+    rasterizer_.resize(dot_cols, dot_rows);
+    const std::size_t cell_count = static_cast<std::size_t>(plane_rows_) * static_cast<std::size_t>(plane_cols_);
+    braille_masks_.assign(cell_count, 0u);
+    cell_intensity_.assign(cell_count, 0.0f);
+
+    // Radius is in terminal columns; rows are taller, hence vertical_scale.
+    const float fit_radius = std::min(static_cast<float>(plane_cols_) * 0.5f,
+                                      static_cast<float>(plane_rows_) * 0.5f / params_.vertical_scale);
+    const float radius = std::min(radius_, fit_radius * (1.0f - params_.noise_amount * 0.5f));
+    const float radius_x = radius * static_cast<float>(kBrailleColsPerCell);
+    const float radius_y = radius * params_.vertical_scale * static_cast<float>(kBrailleRowsPerCell);
+    outline_.build(static_cast<float>(dot_cols - 1) * 0.5f,
+                   static_cast<float>(dot_rows - 1) * 0.5f,
+                   radius_x,
+                   radius_y,
+                   rotation_,
+                   params_.noise_amount,
+                   noise_phase_,
+                   vertices_);
+    if (vertices_.size() < 2u) {
+        return;
+    }
+
+    const float brightness = std::clamp(kBaseBrightness + energy_, 0.0f, 1.0f);
+    auto make_vertex = [&](const std::array<float, 2>& point) {
+        TrailVertex vertex;
+        vertex.x = point[0];
+        vertex.y = point[1];
+        vertex.brightness = brightness;
+        vertex.radius = kLineRadiusDots;
+        return vertex;
+    };
+
+    TrailVertex previous = make_vertex(vertices_.back());
+    for (const auto& point : vertices_) {
+        const TrailVertex current = make_vertex(point);
+        rasterizer_.draw_segment(previous, current);
+        previous = current;
+    }
+    rasterizer_.flush(braille_masks_,
+                      static_cast<int>(plane_cols_),
+                      [&](std::size_t index, float intensity, const std::array<float, 3>& /*color*/) {
+                          cell_intensity_[index] = std::max(cell_intensity_[index], intensity);
+                      });
+
+    for (unsigned int row = 0; row < plane_rows_; ++row) {
+        for (unsigned int col = 0; col < plane_cols_; ++col) {
+            const std::size_t index = static_cast<std::size_t>(row) * plane_cols_ + col;
+            const std::uint8_t mask = braille_masks_[index];
+            if (mask == 0u) {
+                continue;
+            }
+
+            nccell cell = NCCELL_TRIVIAL_INITIALIZER;
+            if (nccell_load_ucs32(plane_, &cell, 0x2800u + static_cast<std::uint32_t>(mask)) <= 0) {
+                continue;
+            }
+            // Partially covered cells are dimmed so the ring edge stays soft.
+            const float level = std::clamp(0.35f + 0.65f * cell_intensity_[index], 0.0f, 1.0f);
+            nccell_set_fg_rgb8(&cell,
+                               static_cast<int>(std::lround(kRingColor[0] * level)),
+                               static_cast<int>(std::lround(kRingColor[1] * level)),
+                               static_cast<int>(std::lround(kRingColor[2] * level)));
+            ncplane_putc_yx(plane_, static_cast<int>(row), static_cast<int>(col), &cell);
+            nccell_release(plane_, &cell);
+        }
+    }
+}
+
+void BreatheAnimation::activate() {
+    is_active_ = true;
+}
+
+void BreatheAnimation::deactivate() {
+    is_active_ = false;
+    if (plane_) {
+        ncplane_erase(plane_);
+    }
+}
+
+void BreatheAnimation::bind_events(const AnimationConfig& config, events::EventBus& bus) {
+    bind_standard_frame_updates(this, config, bus);
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <notcurses/notcurses.h>
+
+#include "animation.h"
+#include "breathe_outline.h"
+#include "trail_raster.h"
+
+namespace when {
+namespace animations {
+
+// A slowly breathing, jittered ring drawn with Braille dots. The outline comes
+// from BreatheOutline's tables and is rasterised as thin segments, so it is
+// cheap enough to leave running beneath heavier layers.
+class BreatheAnimation : public Animation {
+public:
+    BreatheAnimation();
+    ~BreatheAnimation() override;
+
+    void init(notcurses* nc, const AppConfig& config) override;
+    void update(float delta_time,
+                const AudioMetrics& metrics,
+                const AudioFeatures& features) override;
+    void render(notcurses* nc) override;
+
+    void activate() override;
+    void deactivate() override;
+
+    bool is_active() const override { return is_active_; }
+    int get_z_index() const override { return z_index_; }
+    ncplane* get_plane() const override { return plane_; }
+
+    void bind_events(const AnimationConfig& config, events::EventBus& bus) override;
+
+private:
+    struct Parameters {
+        int points = 64;
+        float min_radius = 6.0f; // Terminal columns
+        float max_radius = 14.0f;
+        float audio_radius_influence = 10.0f;
+        float smoothing_s = 0.18f;
+        float noise_amount = 0.3f;
+        float rotation_speed = 0.35f;
+        float vertical_scale = 0.55f;
+        float base_pulse_hz = 0.35f;
+        float audio_pulse_weight = 0.65f;
+        int band_index = -1;
+        float rms_weight = 1.0f;
+        float beat_weight = 0.6f;
+        float band_weight = 0.5f;
+    };
+
+    void load_parameters_from_config(const AnimationConfig& config);
+    void configure_outline();
+
+    ncplane* plane_ = nullptr;
+    int z_index_ = 0;
+    bool is_active_ = true;
+    unsigned int plane_rows_ = 0;
+    unsigned int plane_cols_ = 0;
+    unsigned int outline_rows_ = 0; // Plane size the vertex tables were built for
+    unsigned int outline_cols_ = 0;
+
+    Parameters params_{};
+    BreatheOutline outline_;
+    std::vector<std::array<float, 2>> vertices_;
+    TrailRasterizer rasterizer_;
+    std::vector<std::uint8_t> braille_masks_;
+    std::vector<float> cell_intensity_;
+
+    float energy_ = 0.0f;
+    float pulse_phase_ = 0.0f;
+    float rotation_ = 0.0f;
+    float noise_phase_ = 0.0f;
+    float radius_ = 0.0f;
+};
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,89 @@
+#include "breathe_outline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace when {
+namespace animations {
+namespace {
+constexpr float kTwoPi = 6.28318530718f;
+constexpr std::size_t kMinVertices = 3;
+} // namespace
+
+void BreatheOutline::configure(std::size_t vertex_count, std::uint32_t seed) {
+    const std::size_t count = std::max(vertex_count, kMinVertices);
+    cos_table_.resize(count);
+    sin_table_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float angle = kTwoPi * static_cast<float>(i) / static_cast<float>(count);
+        cos_table_[i] = std::cos(angle);
+        sin_table_[i] = std::sin(angle);
+    }
+
+    // A few low harmonics with random phases: smooth, and periodic in the
+    // table length so the outline closes without a seam.
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> phase_dist(0.0f, kTwoPi);
+    std::array<float, kNoiseHarmonics> phases{};
+    for (float& phase : phases) {
+        phase = phase_dist(rng);
+    }
+    float peak = 0.0f;
+    for (std::size_t i = 0; i < kNoiseTableSize; ++i) {
+        const float t = kTwoPi * static_cast<float>(i) / static_cast<float>(kNoiseTableSize);
+        float value = 0.0f;
+        for (std::size_t h = 0; h < kNoiseHarmonics; ++h) {
+            const float harmonic = static_cast<float>(h + 2);
+            value += std::sin(harmonic * t + phases[h]) / harmonic;
+        }
+        noise_table_[i] = value;
+        peak = std::max(peak, std::abs(value));
+    }
+    if (peak > 0.0f) {
+        for (float& value : noise_table_) {
+            value /= peak;
+        }
+    }
+}
+
+float BreatheOutline::noise(float t) const {
+    const float wrapped = t - std::floor(t);
+    const float position = wrapped * static_cast<float>(kNoiseTableSize);
+    const std::size_t index = static_cast<std::size_t>(position) % kNoiseTableSize;
+    const std::size_t next = (index + 1) % kNoiseTableSize;
+    const float frac = position - std::floor(position);
+    return noise_table_[index] + (noise_table_[next] - noise_table_[index]) * frac;
+}
+
+void BreatheOutline::build(float center_x,
+                           float center_y,
+                           float radius_x,
+                           float radius_y,
+                           float rotation,
+                           float noise_amount,
+                           float noise_phase,
+                           std::vector<std::array<float, 2>>& out) const {
+    const std::size_t count = cos_table_.size();
+    out.resize(count);
+    if (count == 0) {
+        return;
+    }
+
+    const float cos_r = std::cos(rotation);
+    const float sin_r = std::sin(rotation);
+    const float step = 1.0f / static_cast<float>(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float c = cos_table_[i] * cos_r - sin_table_[i] * sin_r;
+        const float s = sin_table_[i] * cos_r + cos_table_[i] * sin_r;
+        // Two copies drifting in opposite directions at different scales make
+        // the outline morph rather than just spin.
+        const float t = static_cast<float>(i) * step;
+        const float jitter = 0.6f * noise(t + noise_phase) + 0.4f * noise(2.0f * t - 1.3f * noise_phase);
+        const float scale = 1.0f + noise_amount * jitter;
+        out[i] = {center_x + c * radius_x * scale, center_y + s * radius_y * scale};
+    }
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace when {
+namespace animations {
+
+// Closed, jittered ellipse outline built from lookup tables. The unit circle
+// is tabulated once per vertex count, rotation is applied as a single 2x2
+// rotation of the table, and jitter comes from a smooth periodic noise table
+// sampled with a drifting phase, so building a frame's outline costs two trig
+// calls regardless of how many vertices it has.
+class BreatheOutline {
+public:
+    static constexpr std::size_t kNoiseTableSize = 256;
+    static constexpr std::size_t kNoiseHarmonics = 4;
+
+    void configure(std::size_t vertex_count, std::uint32_t seed);
+
+    // Writes vertex_count() points to out. noise_amount scales the radial
+    // jitter as a fraction of the radius; advancing noise_phase (in table
+    // periods) morphs the jitter pattern.
+    void build(float center_x,
+               float center_y,
+               float radius_x,
+               float radius_y,
+               float rotation,
+               float noise_amount,
+               float noise_phase,
+               std::vector<std::array<float, 2>>& out) const;
+
+    std::size_t vertex_count() const { return cos_table_.size(); }
+    // Periodic noise in [-1, 1] at position t, in table periods.
+    float noise(float t) const;
+
+private:
+    std::vector<float> cos_table_;
+    std::vector<float> sin_table_;
+    std::array<float, kNoiseTableSize> noise_table_{};
+};
+
+} // namespace animations
+} // namespace when
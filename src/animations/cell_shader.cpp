@@ -0,0 +1,288 @@
+#include "cell_shader.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace when {
+namespace animations {
+namespace {
+// 8 x 64 float samples (2 KiB) per tile keeps a tile's field and cells in L1.
+// Both are multiples of the Braille 4x2 dot grid so tiles resolve whole cells.
+constexpr unsigned int kTileSampleRows = 8u;
+constexpr unsigned int kTileSampleCols = 64u;
+constexpr unsigned int kBrailleRowsPerCell = 4u;
+constexpr unsigned int kBrailleColsPerCell = 2u;
+constexpr std::size_t kMaxPoolWorkers = 7u;
+// Physical width / height of a terminal cell.
+constexpr float kCellAspectRatio = 0.5f;
+
+constexpr std::array<std::uint8_t, 8> kBrailleDotBits{
+    0x01u, 0x08u, // row 0: left, right
+    0x02u, 0x10u, // row 1
+    0x04u, 0x20u, // row 2
+    0x40u, 0x80u, // row 3
+};
+
+constexpr std::array<char, 10> kDensityRamp{' ', '.', ':', '-', '=', '+', '*', '#', '%', '@'};
+
+std::array<std::uint8_t, 3> blend_color(const ShaderStyle& style, float t) {
+    const float clamped = std::clamp(t, 0.0f, 1.0f);
+    std::array<std::uint8_t, 3> color{};
+    for (std::size_t i = 0; i < color.size(); ++i) {
+        const float low = static_cast<float>(style.low_color[i]);
+        const float high = static_cast<float>(style.high_color[i]);
+        color[i] = static_cast<std::uint8_t>(std::lround(low + (high - low) * clamped));
+    }
+    return color;
+}
+} // namespace
+
+ShaderThreadPool::ShaderThreadPool(std::size_t worker_count) {
+    workers_.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ShaderThreadPool::~ShaderThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+ShaderThreadPool& ShaderThreadPool::shared() {
+    static ShaderThreadPool pool([]() {
+        const unsigned int hardware = std::thread::hardware_concurrency();
+        return std::min<std::size_t>(hardware > 1u ? hardware - 1u : 0u, kMaxPoolWorkers);
+    }());
+    return pool;
+}
+
+void ShaderThreadPool::parallel_for(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (workers_.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> dispatch_lock(dispatch_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        task_count_ = count;
+        next_index_.store(0, std::memory_order_relaxed);
+        remaining_ = count;
+        ++generation_;
+    }
+    work_cv_.notify_all();
+
+    run_tasks(&task, count);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Workers that picked up this job must drop it before task_ can change.
+    done_cv_.wait(lock, [this]() { return remaining_ == 0 && active_workers_ == 0; });
+    task_ = nullptr;
+    task_count_ = 0;
+}
+
+void ShaderThreadPool::worker_loop() {
+    std::uint64_t seen_generation = 0;
+    while (true) {
+        const std::function<void(std::size_t)>* task = nullptr;
+        std::size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&]() { return stop_ || generation_ != seen_generation; });
+            if (stop_) {
+                return;
+            }
+            seen_generation = generation_;
+            if (!task_ || remaining_ == 0) {
+                continue;
+            }
+            task = task_;
+            count = task_count_;
+            ++active_workers_;
+        }
+
+        run_tasks(task, count);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --active_workers_;
+        if (remaining_ == 0 && active_workers_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+void ShaderThreadPool::run_tasks(const std::function<void(std::size_t)>* task, std::size_t count) {
+    std::size_t completed = 0;
+    while (true) {
+        const std::size_t index = next_index_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= count) {
+            break;
+        }
+        (*task)(index);
+        ++completed;
+    }
+
+    if (completed > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        remaining_ -= completed;
+        if (remaining_ == 0 && active_workers_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+CellShader::CellShader(ShaderThreadPool& pool) : pool_(pool) {}
+
+void CellShader::resize(unsigned int rows, unsigned int cols, ShaderResolution resolution) {
+    if (rows == rows_ && cols == cols_ && resolution == resolution_) {
+        return;
+    }
+
+    rows_ = rows;
+    cols_ = cols;
+    resolution_ = resolution;
+    const bool braille = resolution_ == ShaderResolution::Braille;
+    sample_rows_ = rows_ * (braille ? kBrailleRowsPerCell : 1u);
+    sample_cols_ = cols_ * (braille ? kBrailleColsPerCell : 1u);
+    tile_rows_ = (sample_rows_ + kTileSampleRows - 1u) / kTileSampleRows;
+    tile_cols_ = (sample_cols_ + kTileSampleCols - 1u) / kTileSampleCols;
+
+    x_coords_.resize(sample_cols_);
+    for (unsigned int col = 0; col < sample_cols_; ++col) {
+        x_coords_[col] = (static_cast<float>(col) + 0.5f) / static_cast<float>(sample_cols_);
+    }
+    field_.assign(static_cast<std::size_t>(sample_rows_) * sample_cols_, 0.0f);
+    cells_.assign(static_cast<std::size_t>(rows_) * cols_, ShadedCell{});
+}
+
+void CellShader::dispatch(const ShaderKernel& kernel, const ShaderUniforms& uniforms) {
+    if (!kernel || field_.empty()) {
+        return;
+    }
+
+    const std::function<void(std::size_t)> task = [&](std::size_t tile) { shade_tile(tile, kernel, uniforms); };
+    pool_.parallel_for(tile_count(), task);
+}
+
+void CellShader::shade_tile(std::size_t tile, const ShaderKernel& kernel, const ShaderUniforms& uniforms) {
+    const unsigned int row_begin = static_cast<unsigned int>(tile / tile_cols_) * kTileSampleRows;
+    const unsigned int col_begin = static_cast<unsigned int>(tile % tile_cols_) * kTileSampleCols;
+    const unsigned int row_end = std::min(row_begin + kTileSampleRows, sample_rows_);
+    const unsigned int col_end = std::min(col_begin + kTileSampleCols, sample_cols_);
+
+    const bool braille = resolution_ == ShaderResolution::Braille;
+    const float sample_aspect = braille ? kCellAspectRatio * static_cast<float>(kBrailleRowsPerCell) /
+                                              static_cast<float>(kBrailleColsPerCell)
+                                        : kCellAspectRatio;
+
+    ShaderSpan span;
+    span.aspect = (sample_rows_ > 0u)
+                      ? sample_aspect * static_cast<float>(sample_cols_) / static_cast<float>(sample_rows_)
+                      : 1.0f;
+    span.col = col_begin;
+    span.count = col_end - col_begin;
+    span.x = x_coords_.data() + col_begin;
+    for (unsigned int row = row_begin; row < row_end; ++row) {
+        span.row = row;
+        span.y = (static_cast<float>(row) + 0.5f) / static_cast<float>(sample_rows_);
+        kernel(span, uniforms, field_.data() + static_cast<std::size_t>(row) * sample_cols_ + col_begin);
+    }
+
+    if (braille) {
+        resolve_cells(row_begin / kBrailleRowsPerCell,
+                      (row_end + kBrailleRowsPerCell - 1u) / kBrailleRowsPerCell,
+                      col_begin / kBrailleColsPerCell,
+                      (col_end + kBrailleColsPerCell - 1u) / kBrailleColsPerCell);
+    } else {
+        resolve_cells(row_begin, row_end, col_begin, col_end);
+    }
+}
+
+void CellShader::resolve_cells(unsigned int row_begin,
+                               unsigned int row_end,
+                               unsigned int col_begin,
+                               unsigned int col_end) {
+    const float threshold = style_.threshold;
+    if (resolution_ == ShaderResolution::Cell) {
+        for (unsigned int row = row_begin; row < row_end; ++row) {
+            for (unsigned int col = col_begin; col < col_end; ++col) {
+                const float value = std::clamp(field_[static_cast<std::size_t>(row) * sample_cols_ + col], 0.0f, 1.0f);
+                ShadedCell& cell = cells_[static_cast<std::size_t>(row) * cols_ + col];
+                if (value < threshold) {
+                    cell.codepoint = 0;
+                    continue;
+                }
+                const float t = (threshold < 1.0f) ? (value - threshold) / (1.0f - threshold) : 1.0f;
+                const auto ramp_index = static_cast<std::size_t>(
+                    std::lround(t * static_cast<float>(kDensityRamp.size() - 1u)));
+                cell.codepoint = static_cast<std::uint32_t>(kDensityRamp[std::max<std::size_t>(ramp_index, 1u)]);
+                cell.color = blend_color(style_, value);
+            }
+        }
+        return;
+    }
+
+    for (unsigned int row = row_begin; row < row_end; ++row) {
+        for (unsigned int col = col_begin; col < col_end; ++col) {
+            std::uint8_t mask = 0u;
+            float sum = 0.0f;
+            for (unsigned int dy = 0; dy < kBrailleRowsPerCell; ++dy) {
+                const std::size_t sample_row = static_cast<std::size_t>(row) * kBrailleRowsPerCell + dy;
+                for (unsigned int dx = 0; dx < kBrailleColsPerCell; ++dx) {
+                    const std::size_t sample_col = static_cast<std::size_t>(col) * kBrailleColsPerCell + dx;
+                    const float value = field_[sample_row * sample_cols_ + sample_col];
+                    sum += value;
+                    if (value >= threshold) {
+                        mask |= kBrailleDotBits[dy * kBrailleColsPerCell + dx];
+                    }
+                }
+            }
+
+            ShadedCell& cell = cells_[static_cast<std::size_t>(row) * cols_ + col];
+            cell.codepoint = (mask != 0u) ? 0x2800u + mask : 0u;
+            cell.color = blend_color(style_, sum / static_cast<float>(kBrailleRowsPerCell * kBrailleColsPerCell));
+        }
+    }
+}
+
+void CellShader::blit(ncplane* plane, int origin_y, int origin_x) const {
+    if (!plane || cells_.empty()) {
+        return;
+    }
+
+    for (unsigned int row = 0; row < rows_; ++row) {
+        for (unsigned int col = 0; col < cols_; ++col) {
+            const ShadedCell& shaded = cells_[static_cast<std::size_t>(row) * cols_ + col];
+            if (shaded.codepoint == 0u) {
+                continue;
+            }
+
+            nccell cell = NCCELL_TRIVIAL_INITIALIZER;
+            if (nccell_load_ucs32(plane, &cell, shaded.codepoint) <= 0) {
+                nccell_release(plane, &cell);
+                continue;
+            }
+            nccell_set_fg_rgb8(&cell, shaded.color[0], shaded.color[1], shaded.color[2]);
+            ncplane_putc_yx(plane, origin_y + static_cast<int>(row), origin_x + static_cast<int>(col), &cell);
+            nccell_release(plane, &cell);
+        }
+    }
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <notcurses/notcurses.h>
+
+namespace when {
+namespace animations {
+
+// Per-dispatch values shared by every sample of a shader kernel.
+struct ShaderUniforms {
+    float time = 0.0f;
+    float bass = 0.0f;
+    float mid = 0.0f;
+    float treble = 0.0f;
+    float beat = 0.0f;
+    float beat_phase = 0.0f;
+    std::array<float, 8> params{}; // Animation-defined extras
+};
+
+// A contiguous run of samples on one row of the sample grid. Kernels write
+// `count` intensities (nominally 0-1) to `out`; looping over the run rather
+// than being called per sample keeps kernels vectorisable.
+struct ShaderSpan {
+    const float* x = nullptr; // Normalised x of each sample in [0, 1)
+    float y = 0.0f;           // Normalised y of the row in [0, 1)
+    float aspect = 1.0f;      // Physical width / height of the whole sample grid
+    unsigned int row = 0;     // Sample row index
+    unsigned int col = 0;     // Sample column of x[0]
+    std::size_t count = 0;
+};
+
+using ShaderKernel = std::function<void(const ShaderSpan& span, const ShaderUniforms& uniforms, float* out)>;
+
+enum class ShaderResolution {
+    Cell,    // One sample per terminal cell, shaded with a density ramp
+    Braille, // 2x4 samples per cell, thresholded into Braille dots
+};
+
+struct ShaderStyle {
+    float threshold = 0.5f; // Braille dot threshold; Cell mode leaves cells below it empty
+    std::array<std::uint8_t, 3> low_color{40u, 40u, 90u};
+    std::array<std::uint8_t, 3> high_color{255u, 255u, 255u};
+};
+
+struct ShadedCell {
+    std::uint32_t codepoint = 0; // 0 = leave the cell untouched
+    std::array<std::uint8_t, 3> color{};
+};
+
+// Small persistent pool shared by every shader so stacked field effects do
+// not each spawn their own threads. The calling thread also runs tasks.
+class ShaderThreadPool {
+public:
+    explicit ShaderThreadPool(std::size_t worker_count);
+    ~ShaderThreadPool();
+
+    ShaderThreadPool(const ShaderThreadPool&) = delete;
+    ShaderThreadPool& operator=(const ShaderThreadPool&) = delete;
+
+    static ShaderThreadPool& shared();
+
+    // Runs task(i) for every i in [0, count) and returns once all have finished.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& task);
+    std::size_t worker_count() const { return workers_.size(); }
+
+private:
+    void worker_loop();
+    void run_tasks(const std::function<void(std::size_t)>* task, std::size_t count);
+
+    std::vector<std::thread> workers_;
+    std::mutex dispatch_mutex_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(std::size_t)>* task_ = nullptr;
+    std::size_t task_count_ = 0;
+    std::atomic<std::size_t> next_index_{0};
+    std::size_t remaining_ = 0;
+    std::size_t active_workers_ = 0;
+    std::uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+// Evaluates a kernel over a plane-sized sample grid in cache-sized tiles on
+// the shared pool, then resolves each tile into glyphs and colours. Only
+// blit() touches notcurses and must run on the render thread.
+class CellShader {
+public:
+    explicit CellShader(ShaderThreadPool& pool = ShaderThreadPool::shared());
+
+    void resize(unsigned int rows, unsigned int cols, ShaderResolution resolution);
+    void set_style(const ShaderStyle& style) { style_ = style; }
+
+    void dispatch(const ShaderKernel& kernel, const ShaderUniforms& uniforms);
+    void blit(ncplane* plane, int origin_y = 0, int origin_x = 0) const;
+
+    unsigned int rows() const { return rows_; }
+    unsigned int cols() const { return cols_; }
+    unsigned int sample_rows() const { return sample_rows_; }
+    unsigned int sample_cols() const { return sample_cols_; }
+    std::size_t tile_count() const { return tile_rows_ * tile_cols_; }
+    std::span<const float> field() const { return field_; }
+    std::span<const ShadedCell> cells() const { return cells_; }
+
+private:
+    void shade_tile(std::size_t tile, const ShaderKernel& kernel, const ShaderUniforms& uniforms);
+    void resolve_cells(unsigned int row_begin, unsigned int row_end, unsigned int col_begin, unsigned int col_end);
+
+    ShaderThreadPool& pool_;
+    ShaderStyle style_{};
+    ShaderResolution resolution_ = ShaderResolution::Braille;
+    unsigned int rows_ = 0;
+    unsigned int cols_ = 0;
+    unsigned int sample_rows_ = 0;
+    unsigned int sample_cols_ = 0;
+    std::size_t tile_rows_ = 0;
+    std::size_t tile_cols_ = 0;
+    std::vector<float> x_coords_;
+    std::vector<float> field_;
+    std::vector<ShadedCell> cells_;
+};
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,187 @@
+#include "cue_timeline.h"
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+namespace when {
+namespace animations {
+
+CueFramePool& CueFramePool::local() {
+    // Pools are never destroyed: schedulers owned by statics (the renderer's
+    // AnimationManager) free their parked frames after thread_locals are gone,
+    // and a cue may outlive the thread that spawned it. A frame freed on
+    // another thread simply joins that thread's free list. The registry keeps
+    // every pool reachable.
+    static auto* registry_mutex = new std::mutex();
+    static auto* registry = new std::vector<CueFramePool*>();
+    thread_local CueFramePool* pool = [] {
+        auto* created = new CueFramePool();
+        std::lock_guard<std::mutex> lock(*registry_mutex);
+        registry->push_back(created);
+        return created;
+    }();
+    return *pool;
+}
+
+CueFramePool::~CueFramePool() {
+    for (void* chunk : chunks_) {
+        ::operator delete(chunk);
+    }
+}
+
+void* CueFramePool::allocate(std::size_t size) {
+    const std::size_t size_class = (size + kClassGranularity - 1) / kClassGranularity;
+    if (size_class == 0 || size_class > kClassCount) {
+        return ::operator new(size);
+    }
+
+    FreeBlock*& head = free_lists_[size_class - 1];
+    if (!head) {
+        const std::size_t block_size = size_class * kClassGranularity;
+        auto* chunk = static_cast<unsigned char*>(::operator new(block_size * kBlocksPerChunk));
+        chunks_.push_back(chunk);
+        for (std::size_t i = kBlocksPerChunk; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk + i * block_size);
+            block->next = head;
+            head = block;
+        }
+    }
+
+    FreeBlock* block = head;
+    head = block->next;
+    ++blocks_in_use_;
+    return block;
+}
+
+void CueFramePool::deallocate(void* pointer, std::size_t size) noexcept {
+    const std::size_t size_class = (size + kClassGranularity - 1) / kClassGranularity;
+    if (size_class == 0 || size_class > kClassCount) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    auto* block = static_cast<FreeBlock*>(pointer);
+    block->next = free_lists_[size_class - 1];
+    free_lists_[size_class - 1] = block;
+    --blocks_in_use_;
+}
+
+void Cue::promise_type::unhandled_exception() noexcept {
+    std::clog << "[cue] Cue ended with an unhandled exception" << std::endl;
+}
+
+Cue& Cue::operator=(Cue&& other) noexcept {
+    if (this != &other) {
+        if (handle_) {
+            handle_.destroy();
+        }
+        handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+}
+
+Cue::~Cue() {
+    if (handle_) {
+        handle_.destroy();
+    }
+}
+
+CueScheduler::~CueScheduler() {
+    clear();
+}
+
+void CueScheduler::spawn(Cue cue) {
+    if (!cue.handle_) {
+        return;
+    }
+    resume(std::exchange(cue.handle_, {}));
+}
+
+void CueScheduler::clear() {
+    // Take the queues first: destroying a frame runs destructors that must not
+    // observe half-cleared state.
+    for (auto& waiters : tick_waiters_) {
+        auto parked = std::move(waiters);
+        waiters.clear();
+        for (auto& waiter : parked) {
+            waiter.handle.destroy();
+        }
+    }
+    auto parked = std::move(time_waiters_);
+    time_waiters_.clear();
+    for (auto& waiter : parked) {
+        waiter.handle.destroy();
+    }
+}
+
+void CueScheduler::advance(float delta_time, const AudioFeatures& features) {
+    time_s_ += static_cast<double>(std::max(delta_time, 0.0f));
+    ++ticks_[static_cast<std::size_t>(Clock::Frame)];
+    if (features.beat_detected) {
+        ++ticks_[static_cast<std::size_t>(Clock::Beat)];
+    }
+    if (features.downbeat) {
+        ++ticks_[static_cast<std::size_t>(Clock::Downbeat)];
+    }
+    if (features.section_change) {
+        ++ticks_[static_cast<std::size_t>(Clock::Section)];
+    }
+
+    // Cues resumed here can only park on strictly later ticks or times, so
+    // each loop terminates within the frame.
+    for (std::size_t clock = 0; clock < kClockCount; ++clock) {
+        auto& waiters = tick_waiters_[clock];
+        while (!waiters.empty() && waiters.front().target <= ticks_[clock]) {
+            std::pop_heap(waiters.begin(), waiters.end(), WaiterLater<std::uint64_t>{});
+            const std::coroutine_handle<> handle = waiters.back().handle;
+            waiters.pop_back();
+            resume(handle);
+        }
+    }
+
+    while (!time_waiters_.empty() && time_waiters_.front().target <= time_s_) {
+        std::pop_heap(time_waiters_.begin(), time_waiters_.end(), WaiterLater<double>{});
+        const std::coroutine_handle<> handle = time_waiters_.back().handle;
+        time_waiters_.pop_back();
+        resume(handle);
+    }
+}
+
+CueScheduler::TimeAwaiter CueScheduler::seconds(double duration) {
+    return TimeAwaiter{this, time_s_ + duration, duration <= 0.0};
+}
+
+std::size_t CueScheduler::parked_cues() const {
+    std::size_t count = time_waiters_.size();
+    for (const auto& waiters : tick_waiters_) {
+        count += waiters.size();
+    }
+    return count;
+}
+
+CueScheduler::TickAwaiter CueScheduler::wait_ticks(Clock clock, std::uint64_t count) {
+    return TickAwaiter{this, clock, ticks_[static_cast<std::size_t>(clock)] + count, count == 0};
+}
+
+void CueScheduler::park(Clock clock, std::uint64_t target, std::coroutine_handle<> handle) {
+    auto& waiters = tick_waiters_[static_cast<std::size_t>(clock)];
+    waiters.push_back(Waiter<std::uint64_t>{target, next_sequence_++, handle});
+    std::push_heap(waiters.begin(), waiters.end(), WaiterLater<std::uint64_t>{});
+}
+
+void CueScheduler::park_until(double target, std::coroutine_handle<> handle) {
+    time_waiters_.push_back(Waiter<double>{target, next_sequence_++, handle});
+    std::push_heap(time_waiters_.begin(), time_waiters_.end(), WaiterLater<double>{});
+}
+
+void CueScheduler::resume(std::coroutine_handle<> handle) {
+    handle.resume();
+    if (handle.done()) {
+        handle.destroy();
+    }
+}
+
+} // namespace animations
+} // namespace when
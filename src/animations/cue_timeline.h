@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "audio/audio_features.h"
+
+namespace when {
+namespace animations {
+
+class CueScheduler;
+
+// Size-classed free lists for coroutine frames. Frames are recycled instead of
+// going back to the heap, so spawning cues every beat does not allocate once
+// the pool has warmed up. One pool per thread; cues run on the update thread.
+class CueFramePool {
+public:
+    // This thread's pool. It is never destroyed, so frames stay valid however
+    // late their scheduler is torn down.
+    static CueFramePool& local();
+
+    CueFramePool() = default;
+    ~CueFramePool();
+    CueFramePool(const CueFramePool&) = delete;
+    CueFramePool& operator=(const CueFramePool&) = delete;
+
+    void* allocate(std::size_t size);
+    void deallocate(void* pointer, std::size_t size) noexcept;
+
+    std::size_t chunk_count() const { return chunks_.size(); }
+    // Net allocations from this pool; frames freed on another thread count there.
+    std::size_t blocks_in_use() const { return blocks_in_use_; }
+
+private:
+    static constexpr std::size_t kClassGranularity = 64;
+    static constexpr std::size_t kClassCount = 16; // Frames up to 1 KiB are pooled
+    static constexpr std::size_t kBlocksPerChunk = 64;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::array<FreeBlock*, kClassCount> free_lists_{};
+    std::vector<void*> chunks_;
+    std::size_t blocks_in_use_ = 0;
+};
+
+// Fire-and-forget coroutine driven by a CueScheduler. Write a member function
+// returning Cue and hand the result to CueScheduler::spawn().
+class Cue {
+public:
+    struct promise_type {
+        Cue get_return_object() noexcept {
+            return Cue{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+
+        static void* operator new(std::size_t size) { return CueFramePool::local().allocate(size); }
+        static void operator delete(void* pointer, std::size_t size) noexcept {
+            CueFramePool::local().deallocate(pointer, size);
+        }
+    };
+
+    Cue() = default;
+    Cue(Cue&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Cue& operator=(Cue&& other) noexcept;
+    Cue(const Cue&) = delete;
+    Cue& operator=(const Cue&) = delete;
+    ~Cue();
+
+private:
+    explicit Cue(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_{};
+
+    friend class CueScheduler;
+};
+
+// Musical clocks that cues can wait on. Suspended cues sit in one min-heap per
+// clock keyed by the tick they wait for, so a frame with nothing due costs one
+// comparison per clock however many cues are parked.
+class CueScheduler {
+public:
+    enum class Clock : std::uint8_t {
+        Frame,
+        Beat,
+        Downbeat,
+        Section,
+        Count,
+    };
+
+    class TickAwaiter {
+    public:
+        bool await_ready() const noexcept { return ready_; }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler_->park(clock_, target_, handle); }
+        void await_resume() const noexcept {}
+
+    private:
+        TickAwaiter(CueScheduler* scheduler, Clock clock, std::uint64_t target, bool ready)
+            : scheduler_(scheduler), clock_(clock), target_(target), ready_(ready) {}
+
+        CueScheduler* scheduler_;
+        Clock clock_;
+        std::uint64_t target_;
+        bool ready_;
+
+        friend class CueScheduler;
+    };
+
+    class TimeAwaiter {
+    public:
+        bool await_ready() const noexcept { return ready_; }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler_->park_until(target_, handle); }
+        void await_resume() const noexcept {}
+
+    private:
+        TimeAwaiter(CueScheduler* scheduler, double target, bool ready)
+            : scheduler_(scheduler), target_(target), ready_(ready) {}
+
+        CueScheduler* scheduler_;
+        double target_;
+        bool ready_;
+
+        friend class CueScheduler;
+    };
+
+    CueScheduler() = default;
+    ~CueScheduler();
+    CueScheduler(const CueScheduler&) = delete;
+    CueScheduler& operator=(const CueScheduler&) = delete;
+
+    // Runs the cue up to its first suspension; it is destroyed when it finishes.
+    void spawn(Cue cue);
+    // Destroys every parked cue; call before the objects they reference go away.
+    void clear();
+
+    // Ticks the clocks from this frame's features and resumes whatever is due.
+    void advance(float delta_time, const AudioFeatures& features);
+
+    TickAwaiter frames(std::uint64_t count) { return wait_ticks(Clock::Frame, count); }
+    TickAwaiter beats(std::uint64_t count) { return wait_ticks(Clock::Beat, count); }
+    TickAwaiter bars(std::uint64_t count) { return wait_ticks(Clock::Downbeat, count); }
+    TickAwaiter next_beat() { return wait_ticks(Clock::Beat, 1); }
+    TickAwaiter next_downbeat() { return wait_ticks(Clock::Downbeat, 1); }
+    TickAwaiter next_section() { return wait_ticks(Clock::Section, 1); }
+    TimeAwaiter seconds(double duration);
+
+    std::uint64_t ticks(Clock clock) const { return ticks_[static_cast<std::size_t>(clock)]; }
+    double time() const { return time_s_; }
+    std::size_t parked_cues() const;
+
+private:
+    template<typename Key>
+    struct Waiter {
+        Key target;
+        std::uint64_t sequence; // Keeps resumption FIFO among equal targets
+        std::coroutine_handle<> handle;
+    };
+
+    template<typename Key>
+    struct WaiterLater {
+        bool operator()(const Waiter<Key>& lhs, const Waiter<Key>& rhs) const {
+            return lhs.target != rhs.target ? lhs.target > rhs.target : lhs.sequence > rhs.sequence;
+        }
+    };
+
+    static constexpr std::size_t kClockCount = static_cast<std::size_t>(Clock::Count);
+
+    TickAwaiter wait_ticks(Clock clock, std::uint64_t count);
+    void park(Clock clock, std::uint64_t target, std::coroutine_handle<> handle);
+    void park_until(double target, std::coroutine_handle<> handle);
+    void resume(std::coroutine_handle<> handle);
+
+    std::array<std::uint64_t, kClockCount> ticks_{};
+    std::array<std::vector<Waiter<std::uint64_t>>, kClockCount> tick_waiters_;
+    std::vector<Waiter<double>> time_waiters_;
+    std::uint64_t next_sequence_ = 0;
+    double time_s_ = 0.0;
+};
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,155 @@
+#include "flow_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace when {
+namespace animations {
+namespace {
+constexpr float kTwoPi = 6.28318530718f;
+constexpr std::size_t kMinResolution = 4;
+constexpr float kAttractorEpsilon = 1.0e-3f;
+constexpr float kMinAttractorWeight = 0.1f;
+} // namespace
+
+void FlowField::configure(std::size_t resolution, std::uint32_t seed) {
+    resolution_ = std::max(resolution, kMinResolution);
+    node_coords_.resize(resolution_);
+    for (std::size_t i = 0; i < resolution_; ++i) {
+        node_coords_[i] = static_cast<float>(i) / static_cast<float>(resolution_ - 1);
+    }
+    field_x_.assign(resolution_ * resolution_, 0.0f);
+    field_y_.assign(resolution_ * resolution_, 0.0f);
+
+    // Rotated products of sines give a smooth, slowly drifting stream
+    // function whose curl has an analytic form.
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> angle_dist(0.0f, kTwoPi);
+    std::uniform_real_distribution<float> drift_dist(-0.6f, 0.6f);
+    float amplitude_total = 0.0f;
+    for (std::size_t i = 0; i < kNoiseTerms; ++i) {
+        NoiseTerm& term = terms_[i];
+        const float angle = angle_dist(rng);
+        term.cos_angle = std::cos(angle);
+        term.sin_angle = std::sin(angle);
+        term.frequency = kTwoPi * (1.0f + static_cast<float>(i) * 0.75f);
+        term.amplitude = 1.0f / term.frequency;
+        term.drift_u = drift_dist(rng);
+        term.drift_v = drift_dist(rng);
+        term.phase_u = angle_dist(rng);
+        term.phase_v = angle_dist(rng);
+        amplitude_total += term.amplitude * term.frequency;
+    }
+    // Normalise so the curl magnitude stays around one before scaling.
+    for (NoiseTerm& term : terms_) {
+        term.amplitude /= amplitude_total;
+    }
+}
+
+void FlowField::rebuild(float time_s,
+                        float curl_strength,
+                        std::span<const Attractor> attractors,
+                        float seeking_strength) {
+    if (resolution_ == 0) {
+        configure(kMinResolution, 0u);
+    }
+
+    const std::size_t n = resolution_;
+    std::fill(field_x_.begin(), field_x_.end(), 0.0f);
+    std::fill(field_y_.begin(), field_y_.end(), 0.0f);
+
+    // Curl of psi = a * sin(f u + pu) * sin(f v + pv) with (u, v) the rotated
+    // coordinates: (d psi/dy, -d psi/dx). Rows are contiguous, branch-free
+    // loops so they vectorise.
+    if (curl_strength > 0.0f) {
+        for (const NoiseTerm& term : terms_) {
+            const float scale = curl_strength * term.amplitude * term.frequency;
+            const float phase_u = term.phase_u + term.drift_u * time_s;
+            const float phase_v = term.phase_v + term.drift_v * time_s;
+            for (std::size_t row = 0; row < n; ++row) {
+                const float y = node_coords_[row];
+                float* out_x = field_x_.data() + row * n;
+                float* out_y = field_y_.data() + row * n;
+                for (std::size_t col = 0; col < n; ++col) {
+                    const float x = node_coords_[col];
+                    const float u = term.frequency * (term.cos_angle * x + term.sin_angle * y) + phase_u;
+                    const float v = term.frequency * (-term.sin_angle * x + term.cos_angle * y) + phase_v;
+                    const float su = std::sin(u);
+                    const float cu = std::cos(u);
+                    const float sv = std::sin(v);
+                    const float cv = std::cos(v);
+                    const float dpsi_du = cu * sv;
+                    const float dpsi_dv = su * cv;
+                    const float dpsi_dx = dpsi_du * term.cos_angle - dpsi_dv * term.sin_angle;
+                    const float dpsi_dy = dpsi_du * term.sin_angle + dpsi_dv * term.cos_angle;
+                    out_x[col] += scale * dpsi_dy;
+                    out_y[col] -= scale * dpsi_dx;
+                }
+            }
+        }
+    }
+
+    if (attractors.empty() || seeking_strength <= 0.0f) {
+        return;
+    }
+
+    for (std::size_t row = 0; row < n; ++row) {
+        const float y = node_coords_[row];
+        for (std::size_t col = 0; col < n; ++col) {
+            const float x = node_coords_[col];
+            float nearest_distance_sq = std::numeric_limits<float>::max();
+            const Attractor* nearest = nullptr;
+            for (const Attractor& attractor : attractors) {
+                const float dx = attractor.x - x;
+                const float dy = attractor.y - y;
+                const float distance_sq = dx * dx + dy * dy;
+                if (distance_sq < nearest_distance_sq) {
+                    nearest_distance_sq = distance_sq;
+                    nearest = &attractor;
+                }
+            }
+            if (!nearest || nearest_distance_sq <= 0.0f) {
+                continue;
+            }
+
+            const float distance = std::sqrt(std::max(nearest_distance_sq, kAttractorEpsilon));
+            const float scale = seeking_strength * std::max(nearest->weight, kMinAttractorWeight) /
+                                (distance + kAttractorEpsilon);
+            field_x_[row * n + col] += (nearest->x - x) * scale;
+            field_y_[row * n + col] += (nearest->y - y) * scale;
+        }
+    }
+}
+
+std::array<float, 2> FlowField::sample(float x, float y) const {
+    if (resolution_ == 0) {
+        return {0.0f, 0.0f};
+    }
+
+    const float max_index = static_cast<float>(resolution_ - 1);
+    const float gx = std::clamp(x, 0.0f, 1.0f) * max_index;
+    const float gy = std::clamp(y, 0.0f, 1.0f) * max_index;
+    const std::size_t x0 = std::min(static_cast<std::size_t>(gx), resolution_ - 2);
+    const std::size_t y0 = std::min(static_cast<std::size_t>(gy), resolution_ - 2);
+    const float tx = gx - static_cast<float>(x0);
+    const float ty = gy - static_cast<float>(y0);
+
+    const std::size_t i00 = y0 * resolution_ + x0;
+    const std::size_t i10 = i00 + 1;
+    const std::size_t i01 = i00 + resolution_;
+    const std::size_t i11 = i01 + 1;
+
+    auto lerp2 = [tx, ty](float v00, float v10, float v01, float v11) {
+        const float top = v00 + (v10 - v00) * tx;
+        const float bottom = v01 + (v11 - v01) * tx;
+        return top + (bottom - top) * ty;
+    };
+
+    return {lerp2(field_x_[i00], field_x_[i10], field_x_[i01], field_x_[i11]),
+            lerp2(field_y_[i00], field_y_[i10], field_y_[i01], field_y_[i11])};
+}
+
+} // namespace animations
+} // namespace when
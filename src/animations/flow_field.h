@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace when {
+namespace animations {
+
+// Low-resolution acceleration field over the unit square combining
+// divergence-free curl noise with attractor pulls. It is rebuilt a few times
+// per second; particles then pay one bilinear fetch per update instead of
+// drawing random numbers and scanning every attractor.
+class FlowField {
+public:
+    struct Attractor {
+        float x = 0.5f;
+        float y = 0.5f;
+        float weight = 1.0f;
+    };
+
+    static constexpr std::size_t kNoiseTerms = 4;
+
+    void configure(std::size_t resolution, std::uint32_t seed);
+
+    // curl_strength scales the noise (acceleration units per second); the
+    // attractor term matches the nearest-attractor seeking force.
+    void rebuild(float time_s,
+                 float curl_strength,
+                 std::span<const Attractor> attractors,
+                 float seeking_strength);
+
+    std::array<float, 2> sample(float x, float y) const;
+
+    std::size_t resolution() const { return resolution_; }
+    std::span<const float> field_x() const { return field_x_; }
+    std::span<const float> field_y() const { return field_y_; }
+
+private:
+    struct NoiseTerm {
+        float cos_angle = 1.0f;
+        float sin_angle = 0.0f;
+        float frequency = 1.0f;
+        float amplitude = 1.0f;
+        float drift_u = 0.0f; // Phase velocity along the rotated u axis (rad/s)
+        float drift_v = 0.0f;
+        float phase_u = 0.0f;
+        float phase_v = 0.0f;
+    };
+
+    std::size_t resolution_ = 0;
+    std::array<NoiseTerm, kNoiseTerms> terms_{};
+    std::vector<float> node_coords_; // Normalised coordinate of each grid line
+    std::vector<float> field_x_;     // resolution x resolution, row-major (y, x)
+    std::vector<float> field_y_;
+};
+
+} // namespace animations
+} // namespace when
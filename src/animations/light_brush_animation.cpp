@@ -5,8 +5,8 @@
 #include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <limits>
 #include <random>
+#include <span>
 #include <utility>
 
 #include "animation_event_utils.h"
@@ -15,8 +15,6 @@ namespace when {
 namespace animations {
 namespace {
 constexpr float kTwoPi = 6.28318530718f;
-constexpr std::size_t kMaxAttractors = 3;
-constexpr float kAttractorEpsilon = 1.0e-3f;
 constexpr int kBrailleRowsPerCell = 4;
 constexpr int kBrailleColsPerCell = 2;
 
@@ -49,6 +47,10 @@ void LightBrushAnimation::init(notcurses* nc, const AppConfig& config) {
     strokes_.clear();
     elapsed_time_ = 0.0f;
     parameters_ = LightBrushParameters{};
+    flow_field_age_ = 0.0f;
+    flow_field_valid_ = false;
+    flow_field_notes_.fill(-1);
+    trail_spacing_ = kDefaultTrailSpacing;
 
     for (const auto& anim_config : config.animations) {
         if (anim_config.type == "LightBrush") {
@@ -59,6 +61,7 @@ void LightBrushAnimation::init(notcurses* nc, const AppConfig& config) {
         }
     }
 
+    flow_field_.configure(static_cast<std::size_t>(parameters_.flow_field_resolution), rng_());
     create_or_resize_plane(nc);
 }
 
@@ -82,14 +85,12 @@ void LightBrushAnimation::update(float delta_time,
     const float clamped_flatness = std::clamp(features.spectral_flatness, 0.0f, 1.0f);
     // Higher spectral flatness values (noisier textures) yield more turbulence,
     // keeping tonal passages comparatively smooth.
-    const float turbulence_strength =
-        clamped_flatness * parameters_.turbulence_base_strength * delta_time;
+    const float turbulence_strength = clamped_flatness * parameters_.turbulence_base_strength;
     const float clamped_beat_strength = std::clamp(features.beat_strength, 0.0f, 1.0f);
     const float tonal_weight = parameters_.tonal_weight_base +
                                (1.0f - clamped_flatness) * parameters_.tonal_weight_scale;
     const float beat_weight =
         parameters_.beat_weight_base + clamped_beat_strength * parameters_.beat_weight_scale;
-    std::uniform_real_distribution<float> turbulence_dist(-1.0f, 1.0f);
 
     for (auto& stroke : strokes_) {
         stroke.head.age += delta_time;
@@ -104,8 +105,9 @@ void LightBrushAnimation::update(float delta_time,
                                   }),
                    strokes_.end());
 
-    std::array<std::pair<float, float>, kMaxAttractors> attractor_positions{};
-    std::array<float, kMaxAttractors> attractor_weights{};
+    std::array<FlowField::Attractor, kMaxAttractors> attractors{};
+    std::array<int, kMaxAttractors> attractor_notes{};
+    attractor_notes.fill(-1);
     std::size_t attractor_count = 0;
 
     if (features.chroma_available) {
@@ -134,9 +136,9 @@ void LightBrushAnimation::update(float delta_time,
                 const float x = 0.5f + std::cos(angle) * parameters_.attractor_radius;
                 const float y = 0.5f + std::sin(angle) * parameters_.attractor_radius;
 
-                attractor_positions[attractor_count] =
-                    {std::clamp(x, 0.0f, 1.0f), std::clamp(y, 0.0f, 1.0f)};
-                attractor_weights[attractor_count] = strength_scale;
+                attractors[attractor_count] = FlowField::Attractor{
+                    std::clamp(x, 0.0f, 1.0f), std::clamp(y, 0.0f, 1.0f), strength_scale};
+                attractor_notes[attractor_count] = note_index;
                 ++attractor_count;
 
                 if (attractor_count >= kMaxAttractors) {
@@ -146,6 +148,21 @@ void LightBrushAnimation::update(float delta_time,
         }
     }
 
+    // The field is sampled once per particle; it only needs rebuilding a few
+    // times per second, or immediately when a different set of notes attracts.
+    flow_field_age_ += delta_time;
+    const float flow_field_period = 1.0f / parameters_.flow_field_update_hz;
+    if (!flow_field_valid_ || flow_field_age_ >= flow_field_period ||
+        attractor_notes != flow_field_notes_) {
+        flow_field_.rebuild(elapsed_time_,
+                            turbulence_strength,
+                            std::span<const FlowField::Attractor>(attractors.data(), attractor_count),
+                            parameters_.seeking_strength);
+        flow_field_notes_ = attractor_notes;
+        flow_field_age_ = 0.0f;
+        flow_field_valid_ = true;
+    }
+
     for (auto& stroke : strokes_) {
         auto& particle = stroke.head;
         const float thickness_target = std::clamp(stroke.base_thickness * beat_weight * tonal_weight,
@@ -156,39 +173,13 @@ void LightBrushAnimation::update(float delta_time,
         stroke.thickness =
             std::clamp(stroke.thickness, parameters_.thickness_min, parameters_.thickness_max);
         particle.thickness = stroke.thickness;
-        if (attractor_count > 0) {
-            float nearest_distance_sq = std::numeric_limits<float>::max();
-            std::pair<float, float> nearest_attractor{particle.x, particle.y};
-            float nearest_weight = 1.0f;
-
-            for (std::size_t i = 0; i < attractor_count; ++i) {
-                const float dx = attractor_positions[i].first - particle.x;
-                const float dy = attractor_positions[i].second - particle.y;
-                const float distance_sq = dx * dx + dy * dy;
-
-                if (distance_sq < nearest_distance_sq) {
-                    nearest_distance_sq = distance_sq;
-                    nearest_attractor = attractor_positions[i];
-                    nearest_weight = std::max(attractor_weights[i], 0.1f);
-                }
-            }
 
-            if (nearest_distance_sq > 0.0f) {
-                const float dx = nearest_attractor.first - particle.x;
-                const float dy = nearest_attractor.second - particle.y;
-                const float distance =
-                    std::sqrt(std::max(nearest_distance_sq, kAttractorEpsilon));
-                const float scale = (parameters_.seeking_strength * nearest_weight * delta_time) /
-                                    (distance + kAttractorEpsilon);
-                particle.vx += dx * scale;
-                particle.vy += dy * scale;
-            }
-        }
+        const auto [accel_x, accel_y] = flow_field_.sample(particle.x, particle.y);
+        particle.vx += accel_x * delta_time;
+        particle.vy += accel_y * delta_time;
 
-        if (clamped_flatness > 0.0f) {
-            particle.vx += turbulence_dist(rng_) * turbulence_strength;
-            particle.vy += turbulence_dist(rng_) * turbulence_strength;
-        }
+        const float previous_x = particle.x;
+        const float previous_y = particle.y;
 
         particle.x += particle.vx * delta_time * speed_scale;
         particle.y += particle.vy * delta_time * speed_scale;
@@ -212,7 +203,12 @@ void LightBrushAnimation::update(float delta_time,
         particle.x = std::clamp(particle.x, 0.0f, 1.0f);
         particle.y = std::clamp(particle.y, 0.0f, 1.0f);
 
-        stroke.trail.push_front(TrailPoint{particle.x, particle.y, elapsed_time_, stroke.thickness});
+        const float anchor_x = stroke.trail.empty() ? particle.x : stroke.trail.front().x;
+        const float anchor_y = stroke.trail.empty() ? particle.y : stroke.trail.front().y;
+        const float step_length = std::hypot(particle.x - previous_x, particle.y - previous_y);
+        if (stroke.sampler.advance(step_length, anchor_x, anchor_y, particle.x, particle.y)) {
+            stroke.trail.push_front(TrailPoint{particle.x, particle.y, elapsed_time_, stroke.thickness});
+        }
 
         const float trail_lifespan = std::max(particle.lifespan, 0.0f);
         while (!stroke.trail.empty()) {
@@ -294,6 +290,29 @@ void LightBrushAnimation::render(notcurses* /*nc*/) {
     braille_masks_.assign(cell_count, 0u);
     accumulation_buffer_.assign(cell_count, Color{});
 
+    const int dot_cols = interior_width * kBrailleColsPerCell;
+    const int dot_rows = interior_height * kBrailleRowsPerCell;
+    rasterizer_.resize(dot_cols, dot_rows);
+    const float dot_scale_x = static_cast<float>(dot_cols) - 1.0f;
+    const float dot_scale_y = static_cast<float>(dot_rows) - 1.0f;
+
+    const float trail_spacing = trail_spacing_for(dot_scale_x, dot_scale_y);
+    if (trail_spacing != trail_spacing_) {
+        trail_spacing_ = trail_spacing;
+        for (auto& stroke : strokes_) {
+            stroke.sampler.configure(trail_spacing_, kTrailMaxTurnRadians);
+        }
+    }
+
+    auto make_vertex = [&](float x, float y, float brightness, float thickness) {
+        TrailVertex vertex;
+        vertex.x = std::clamp(x, 0.0f, 1.0f) * dot_scale_x;
+        vertex.y = std::clamp(y, 0.0f, 1.0f) * dot_scale_y;
+        vertex.brightness = brightness;
+        vertex.radius = std::max(thickness * parameters_.thickness_radius_scale, 0.1f);
+        return vertex;
+    };
+
     bool any_braille_samples = false;
     struct FallbackSample {
         float x = 0.5f;
@@ -309,27 +328,23 @@ void LightBrushAnimation::render(notcurses* /*nc*/) {
             continue;
         }
 
+        // Consecutive samples are joined by thick segments, oldest first,
+        // finishing at the live head so fast strokes leave no gaps.
+        TrailVertex previous;
+        bool has_previous = false;
         for (auto it = stroke.trail.rbegin(); it != stroke.trail.rend(); ++it) {
             const float age = std::max(0.0f, elapsed_time_ - it->spawn_time);
             const float point_fade = compute_brightness(age, fade_duration);
             const float brightness = stroke_brightness * point_fade;
-            if (brightness <= 0.0f) {
-                continue;
-            }
-
             const float point_thickness = std::max(it->thickness * brightness, 0.0f);
-            if (point_thickness <= 0.0f) {
-                continue;
+            const TrailVertex vertex = make_vertex(it->x, it->y, brightness, point_thickness);
+            if (has_previous) {
+                rasterizer_.draw_segment(previous, vertex);
+            } else if (brightness > 0.0f) {
+                rasterizer_.draw_dot(vertex);
             }
-
-            any_braille_samples |= render_point(it->x,
-                                                it->y,
-                                                brightness,
-                                                point_thickness,
-                                                frame_y,
-                                                frame_x,
-                                                interior_height,
-                                                interior_width);
+            previous = vertex;
+            has_previous = true;
 
             if (brightness > strongest_sample.intensity) {
                 strongest_sample = {it->x, it->y, brightness};
@@ -337,22 +352,24 @@ void LightBrushAnimation::render(notcurses* /*nc*/) {
         }
 
         const float head_thickness = std::max(stroke.thickness * stroke_brightness, 0.0f);
-        if (head_thickness <= 0.0f) {
-            continue;
+        const TrailVertex head = make_vertex(stroke.head.x, stroke.head.y, stroke_brightness, head_thickness);
+        if (has_previous) {
+            rasterizer_.draw_segment(previous, head);
+        } else {
+            rasterizer_.draw_dot(head);
         }
 
-        any_braille_samples |= render_point(stroke.head.x,
-                                            stroke.head.y,
-                                            stroke_brightness,
-                                            head_thickness,
-                                            frame_y,
-                                            frame_x,
-                                            interior_height,
-                                            interior_width);
-
         if (stroke_brightness > strongest_sample.intensity) {
             strongest_sample = {stroke.head.x, stroke.head.y, stroke_brightness};
         }
+
+        any_braille_samples |= rasterizer_.flush(
+            braille_masks_, interior_width, [&](std::size_t index, float intensity, const std::array<float, 3>&) {
+                Color& color = accumulation_buffer_[index];
+                color.r += intensity;
+                color.g += intensity;
+                color.b += intensity;
+            });
     }
 
     if (!any_braille_samples && strongest_sample.intensity > 0.0f) {
@@ -534,6 +551,12 @@ void LightBrushAnimation::apply_animation_config(const AnimationConfig& config)
     parameters_.base_thickness_tonal_base = config.light_brush_base_thickness_tonal_base;
     parameters_.base_thickness_tonal_scale =
         std::max(0.0f, config.light_brush_base_thickness_tonal_scale);
+
+    parameters_.flow_field_resolution = std::clamp(config.light_brush_flow_field_resolution, 4, 256);
+    parameters_.flow_field_update_hz = config.light_brush_flow_field_update_hz;
+    if (!std::isfinite(parameters_.flow_field_update_hz) || parameters_.flow_field_update_hz <= 0.0f) {
+        parameters_.flow_field_update_hz = defaults.flow_field_update_hz;
+    }
 }
 
 void LightBrushAnimation::create_or_resize_plane(notcurses* nc) {
@@ -616,87 +639,6 @@ void LightBrushAnimation::draw_frame(int frame_y, int frame_x, int frame_height,
     cleanup_cells();
 }
 
-bool LightBrushAnimation::render_point(float normalized_x,
-                                       float normalized_y,
-                                       float brightness,
-                                       float thickness,
-                                       int frame_y,
-                                       int frame_x,
-                                       int interior_height,
-                                       int interior_width) {
-    (void)frame_y;
-    (void)frame_x;
-    if (!plane_ || interior_height <= 0 || interior_width <= 0 || brightness <= 0.0f || thickness <= 0.0f) {
-        return false;
-    }
-
-    const float clamped_x = std::clamp(normalized_x, 0.0f, 1.0f);
-    const float clamped_y = std::clamp(normalized_y, 0.0f, 1.0f);
-
-    const int subcols = interior_width * kBrailleColsPerCell;
-    const int subrows = interior_height * kBrailleRowsPerCell;
-    if (subcols <= 0 || subrows <= 0) {
-        return false;
-    }
-
-    const float center_subx = clamped_x * (static_cast<float>(subcols) - 1.0f);
-    const float center_suby = clamped_y * (static_cast<float>(subrows) - 1.0f);
-    const float radius = std::max(thickness * parameters_.thickness_radius_scale, 0.1f);
-
-    const int min_subx = std::max(0, static_cast<int>(std::floor(center_subx - radius)));
-    const int max_subx = std::min(subcols - 1, static_cast<int>(std::ceil(center_subx + radius)));
-    const int min_suby = std::max(0, static_cast<int>(std::floor(center_suby - radius)));
-    const int max_suby = std::min(subrows - 1, static_cast<int>(std::ceil(center_suby + radius)));
-
-    if (braille_masks_.empty() || accumulation_buffer_.empty()) {
-        return false;
-    }
-
-    static constexpr std::uint8_t kBrailleMask[kBrailleRowsPerCell][kBrailleColsPerCell] = {
-        {0x01u, 0x08u},
-        {0x02u, 0x10u},
-        {0x04u, 0x20u},
-        {0x40u, 0x80u},
-    };
-
-    bool wrote_sample = false;
-    for (int suby = min_suby; suby <= max_suby; ++suby) {
-        const float dy = static_cast<float>(suby) - center_suby;
-        for (int subx = min_subx; subx <= max_subx; ++subx) {
-            const float dx = static_cast<float>(subx) - center_subx;
-            const float distance = std::sqrt(dx * dx + dy * dy);
-            if (distance > radius) {
-                continue;
-            }
-
-            const float normalized = 1.0f - std::clamp(distance / radius, 0.0f, 1.0f);
-            const float sample_intensity = brightness * normalized * normalized;
-            if (sample_intensity <= 0.0f) {
-                continue;
-            }
-
-            const int cell_row = std::clamp(suby / kBrailleRowsPerCell, 0, interior_height - 1);
-            const int cell_col = std::clamp(subx / kBrailleColsPerCell, 0, interior_width - 1);
-            const int dot_row = suby % kBrailleRowsPerCell;
-            const int dot_col = subx % kBrailleColsPerCell;
-            const std::size_t index =
-                static_cast<std::size_t>(cell_row) * static_cast<std::size_t>(interior_width) +
-                static_cast<std::size_t>(cell_col);
-            if (index >= braille_masks_.size() || index >= accumulation_buffer_.size()) {
-                continue;
-            }
-
-            braille_masks_[index] |= kBrailleMask[dot_row][dot_col];
-            Color& color = accumulation_buffer_[index];
-            color.r += sample_intensity;
-            color.g += sample_intensity;
-            color.b += sample_intensity;
-            wrote_sample = true;
-        }
-    }
-    return wrote_sample;
-}
-
 float LightBrushAnimation::compute_brightness(float age, float lifespan) const {
     if (lifespan <= 1.0e-6f) {
         return 0.0f;
@@ -760,6 +702,8 @@ void LightBrushAnimation::spawn_particles(int count,
         stroke.head.thickness = base_thickness;
 
         stroke.trail.push_front(TrailPoint{stroke.head.x, stroke.head.y, elapsed_time_, base_thickness});
+        stroke.sampler.configure(trail_spacing_, kTrailMaxTurnRadians);
+        stroke.sampler.mark_sample(stroke.head.x, stroke.head.y, stroke.head.x, stroke.head.y);
 
         const float trail_lifespan = std::max(stroke.head.lifespan, 0.0f);
         while (!stroke.trail.empty()) {
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <random>
 #include <vector>
 
 #include "animation.h"
+#include "flow_field.h"
+#include "trail_raster.h"
 
 namespace when {
 namespace animations {
@@ -37,6 +41,7 @@ class BrushStroke {
 public:
     StrokeParticle head;
     std::deque<TrailPoint> trail;
+    TrailSampleGate sampler;
     float base_thickness = 1.0f;
     float thickness = 1.0f;
 };
@@ -75,6 +80,8 @@ struct LightBrushParameters {
     float base_thickness_beat_scale = 1.6f;
     float base_thickness_tonal_base = 0.6f;
     float base_thickness_tonal_scale = 0.8f;
+    int flow_field_resolution = 32;
+    float flow_field_update_hz = 8.0f;
 };
 
 class LightBrushAnimation : public Animation {
@@ -95,17 +102,11 @@ public:
     void bind_events(const AnimationConfig& config, events::EventBus& bus) override;
 
 private:
+    static constexpr std::size_t kMaxAttractors = 3;
+
     void apply_animation_config(const AnimationConfig& config);
     void create_or_resize_plane(notcurses* nc);
     void draw_frame(int frame_y, int frame_x, int frame_height, int frame_width);
-    bool render_point(float normalized_x,
-                      float normalized_y,
-                      float brightness,
-                      float thickness,
-                      int frame_y,
-                      int frame_x,
-                      int interior_height,
-                      int interior_width);
     void spawn_particles(int count,
                          bool heavy,
                          float treble_envelope,
@@ -123,7 +124,15 @@ private:
     std::mt19937 rng_;
     std::vector<std::uint8_t> braille_masks_;
     std::vector<Color> accumulation_buffer_;
+    TrailRasterizer rasterizer_;
+    float trail_spacing_ = 0.0f; // Normalised arc length between trail samples
     LightBrushParameters parameters_;
+    // Turbulence and attractor pull, rebuilt at flow_field_update_hz or when
+    // the set of attracting notes changes.
+    FlowField flow_field_;
+    float flow_field_age_ = 0.0f;
+    bool flow_field_valid_ = false;
+    std::array<int, kMaxAttractors> flow_field_notes_{}; // Chroma index per attractor, -1 = unused
 };
 
 } // namespace animations
@@ -1,6 +1,7 @@
 #include "light_cycle_animation.h"
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
@@ -25,6 +26,17 @@ constexpr std::size_t kMaxTrailSamples = 2048;
 constexpr float kHaloIntensityScale = 0.45f;
 constexpr float kHaloThicknessScale = 2.1f;
 constexpr float kBaseSpeedBoost = 1.35f;
+// Occupancy grid per side without a plane (it is one cell per Braille dot
+// otherwise), and how far ahead (normalised) cycles look for trails.
+constexpr int kFallbackOccupancyResolution = 128;
+constexpr float kLookAheadDistance = 0.08f;
+constexpr float kLookAheadSkipCells = 1.5f;
+
+LightCycleColor mix_trail_color(const LightCycleColor& trail_color, const LightCycleColor& cycle_color) {
+    return {std::clamp((trail_color.r + cycle_color.r) * 0.5f, 0.0f, 1.0f),
+            std::clamp((trail_color.g + cycle_color.g) * 0.5f, 0.0f, 1.0f),
+            std::clamp((trail_color.b + cycle_color.b) * 0.5f, 0.0f, 1.0f)};
+}
 }
 
 LightCycleAnimation::LightCycleAnimation()
@@ -52,6 +64,8 @@ void LightCycleAnimation::init(notcurses* nc, const AppConfig& config) {
     time_since_last_spawn_ = 0.0f;
     trail_.clear();
     cycles_.clear();
+    trail_spacing_ = kDefaultTrailSpacing;
+    next_cycle_id_ = 0;
 
     for (const auto& anim_config : config.animations) {
         if (anim_config.type == "LightCycle") {
@@ -123,38 +137,11 @@ void LightCycleAnimation::render(notcurses* /*nc*/) {
 
     ncplane_erase(plane_);
 
-    const float plane_physical_height = static_cast<float>(plane_rows_);
-    const float plane_physical_width = static_cast<float>(plane_cols_) * kCellWidthToHeightRatio;
-    const float max_physical_extent = std::min(plane_physical_height, plane_physical_width);
-    const float target_physical_extent = std::max(1.0f, max_physical_extent * kFrameFillRatio);
-
-    const int max_width_for_height =
-        std::max(2, static_cast<int>(std::floor(static_cast<float>(plane_rows_) / kCellWidthToHeightRatio)));
-
-    int frame_width = static_cast<int>(std::round(target_physical_extent / kCellWidthToHeightRatio));
-    frame_width = std::clamp(frame_width, 2, std::min(static_cast<int>(plane_cols_), max_width_for_height));
-
-    int frame_height = static_cast<int>(std::round(frame_width * kCellWidthToHeightRatio));
-    frame_height = std::clamp(frame_height, 2, static_cast<int>(plane_rows_));
+    const FrameRect frame = frame_rect();
+    draw_frame(frame.y, frame.x, frame.height, frame.width);
 
-    frame_width =
-        std::clamp(static_cast<int>(std::round(static_cast<float>(frame_height) / kCellWidthToHeightRatio)),
-                   2,
-                   static_cast<int>(plane_cols_));
-    frame_height =
-        std::clamp(static_cast<int>(std::round(static_cast<float>(frame_width) * kCellWidthToHeightRatio)),
-                   2,
-                   static_cast<int>(plane_rows_));
-
-    const int max_frame_y = static_cast<int>(plane_rows_) - frame_height;
-    const int max_frame_x = static_cast<int>(plane_cols_) - frame_width;
-    const int frame_y = std::max(0, max_frame_y / 2);
-    const int frame_x = std::max(0, max_frame_x / 2);
-
-    draw_frame(frame_y, frame_x, frame_height, frame_width);
-
-    const int interior_height = std::max(0, frame_height - 2);
-    const int interior_width = std::max(0, frame_width - 2);
+    const int interior_height = std::max(0, frame.height - 2);
+    const int interior_width = std::max(0, frame.width - 2);
     if (interior_height <= 0 || interior_width <= 0) {
         return;
     }
@@ -164,61 +151,89 @@ void LightCycleAnimation::render(notcurses* /*nc*/) {
     braille_masks_.assign(cell_count, 0u);
     accumulation_buffer_.assign(cell_count, LightCycleColor{});
 
-    bool any_samples = false;
-    for (const auto& point : trail_) {
-        const float age = std::max(0.0f, elapsed_time_ - point.spawn_time);
-        if (age > tail_duration_s_) {
-            continue;
+    const int dot_cols = interior_width * kBrailleColsPerCell;
+    const int dot_rows = interior_height * kBrailleRowsPerCell;
+    rasterizer_.resize(dot_cols, dot_rows);
+    if (occupancy_.cols() != dot_cols || occupancy_.rows() != dot_rows) {
+        resize_occupancy(); // The plane was resized behind our back
+    }
+    const float dot_scale_x = static_cast<float>(dot_cols) - 1.0f;
+    const float dot_scale_y = static_cast<float>(dot_rows) - 1.0f;
+
+    const float trail_spacing = trail_spacing_for(dot_scale_x, dot_scale_y);
+    if (trail_spacing != trail_spacing_) {
+        trail_spacing_ = trail_spacing;
+        for (auto& cycle : cycles_) {
+            cycle.sampler.configure(trail_spacing_, kTrailMaxTurnRadians);
         }
+    }
+
+    auto make_vertex = [&](float x, float y, float brightness, float thickness, const LightCycleColor& color) {
+        TrailVertex vertex;
+        vertex.x = std::clamp(x, 0.0f, 1.0f) * dot_scale_x;
+        vertex.y = std::clamp(y, 0.0f, 1.0f) * dot_scale_y;
+        vertex.brightness = brightness;
+        vertex.radius = std::max(thickness * kThicknessRadiusScale, 0.1f);
+        vertex.color = {color.r, color.g, color.b};
+        return vertex;
+    };
 
-        const float brightness = compute_trail_brightness(age) * point.intensity;
-        if (brightness <= std::numeric_limits<float>::epsilon()) {
-            continue;
+    // The core and halo are separate layers so the halo still adds on top of
+    // the core. Samples from different cycles interleave in trail_, so each
+    // sample is joined to the previous one carrying the same cycle id.
+    bool any_samples = false;
+    for (const bool halo : {false, true}) {
+        const float brightness_scale = halo ? kHaloIntensityScale : 1.0f;
+        const float thickness_scale = halo ? kHaloThicknessScale : 1.0f;
+        trail_tails_.clear();
+
+        for (const auto& point : trail_) {
+            const float age = std::max(0.0f, elapsed_time_ - point.spawn_time);
+            const float brightness =
+                (age > tail_duration_s_) ? 0.0f : compute_trail_brightness(age) * point.intensity * brightness_scale;
+            const TrailVertex vertex =
+                make_vertex(point.x, point.y, brightness, point.thickness * thickness_scale, point.color);
+
+            auto tail = std::find_if(trail_tails_.begin(), trail_tails_.end(), [&](const auto& entry) {
+                return entry.first == point.cycle_id;
+            });
+            if (tail != trail_tails_.end()) {
+                rasterizer_.draw_segment(tail->second, vertex);
+                tail->second = vertex;
+            } else {
+                rasterizer_.draw_dot(vertex);
+                trail_tails_.emplace_back(point.cycle_id, vertex);
+            }
         }
 
-        any_samples |= render_point(point.x,
-                                    point.y,
-                                    brightness,
-                                    point.thickness,
-                                    point.color,
-                                    frame_y,
-                                    frame_x,
-                                    interior_height,
-                                    interior_width);
-
-        any_samples |= render_point(point.x,
-                                    point.y,
-                                    brightness * kHaloIntensityScale,
-                                    point.thickness * kHaloThicknessScale,
-                                    point.color,
-                                    frame_y,
-                                    frame_x,
-                                    interior_height,
-                                    interior_width);
-    }
-
-    for (const auto& cycle : cycles_) {
-        const float head_brightness = std::clamp(cycle.glow, 0.0f, 1.2f);
-        const float thickness = std::max(thickness_min_, cycle.thickness);
-        any_samples |= render_point(cycle.head_x,
-                                    cycle.head_y,
-                                    head_brightness,
-                                    thickness,
-                                    cycle.color,
-                                    frame_y,
-                                    frame_x,
-                                    interior_height,
-                                    interior_width);
-
-        any_samples |= render_point(cycle.head_x,
-                                    cycle.head_y,
-                                    head_brightness * (kHaloIntensityScale + 0.15f),
-                                    thickness * (kHaloThicknessScale + 0.35f),
-                                    cycle.color,
-                                    frame_y,
-                                    frame_x,
-                                    interior_height,
-                                    interior_width);
+        for (const auto& cycle : cycles_) {
+            auto tail = std::find_if(trail_tails_.begin(), trail_tails_.end(), [&](const auto& entry) {
+                return entry.first == cycle.id;
+            });
+            if (tail == trail_tails_.end()) {
+                continue;
+            }
+            rasterizer_.draw_segment(tail->second,
+                                     make_vertex(cycle.head_x,
+                                                 cycle.head_y,
+                                                 compute_trail_brightness(0.0f) * cycle.glow * brightness_scale,
+                                                 cycle.thickness * thickness_scale,
+                                                 mix_trail_color(trail_color_, cycle.color)));
+        }
+        any_samples |= flush_layer();
+    }
+
+    for (const bool halo : {false, true}) {
+        for (const auto& cycle : cycles_) {
+            const float head_brightness = std::clamp(cycle.glow, 0.0f, 1.2f);
+            const float thickness = std::max(thickness_min_, cycle.thickness);
+            rasterizer_.draw_dot(make_vertex(cycle.head_x,
+                                             cycle.head_y,
+                                             halo ? head_brightness * (kHaloIntensityScale + 0.15f) : head_brightness,
+                                             halo ? thickness * (kHaloThicknessScale + 0.35f) : thickness,
+                                             cycle.color));
+        }
+        any_samples |= flush_layer();
     }
 
     if (!any_samples) {
@@ -226,9 +241,9 @@ void LightCycleAnimation::render(notcurses* /*nc*/) {
         const float fallback_y = !cycles_.empty() ? cycles_.front().head_y : 0.5f;
         const float clamped_x = std::clamp(fallback_x, 0.0f, 1.0f);
         const float clamped_y = std::clamp(fallback_y, 0.0f, 1.0f);
-        const int y = frame_y + 1 +
+        const int y = frame.y + 1 +
                       static_cast<int>(std::round(clamped_y * std::max(0, interior_height - 1)));
-        const int x = frame_x + 1 +
+        const int x = frame.x + 1 +
                       static_cast<int>(std::round(clamped_x * std::max(0, interior_width - 1)));
 
         nccell cell = NCCELL_TRIVIAL_INITIALIZER;
@@ -287,7 +302,7 @@ void LightCycleAnimation::render(notcurses* /*nc*/) {
                                static_cast<int>(kCycleBackgroundColor),
                                static_cast<int>(kCycleBackgroundColor));
 
-            ncplane_putc_yx(plane_, frame_y + 1 + row, frame_x + 1 + col, &cell);
+            ncplane_putc_yx(plane_, frame.y + 1 + row, frame.x + 1 + col, &cell);
             nccell_release(plane_, &cell);
         }
     }
@@ -346,6 +361,59 @@ void LightCycleAnimation::create_or_resize_plane(notcurses* nc) {
         plane_rows_ = 0;
         plane_cols_ = 0;
     }
+    resize_occupancy();
+}
+
+LightCycleAnimation::FrameRect LightCycleAnimation::frame_rect() const {
+    FrameRect frame;
+    if (plane_rows_ == 0 || plane_cols_ == 0) {
+        return frame;
+    }
+
+    const float plane_physical_height = static_cast<float>(plane_rows_);
+    const float plane_physical_width = static_cast<float>(plane_cols_) * kCellWidthToHeightRatio;
+    const float max_physical_extent = std::min(plane_physical_height, plane_physical_width);
+    const float target_physical_extent = std::max(1.0f, max_physical_extent * kFrameFillRatio);
+
+    const int max_width_for_height =
+        std::max(2, static_cast<int>(std::floor(static_cast<float>(plane_rows_) / kCellWidthToHeightRatio)));
+
+    int frame_width = static_cast<int>(std::round(target_physical_extent / kCellWidthToHeightRatio));
+    frame_width = std::clamp(frame_width, 2, std::min(static_cast<int>(plane_cols_), max_width_for_height));
+
+    int frame_height = static_cast<int>(std::round(frame_width * kCellWidthToHeightRatio));
+    frame_height = std::clamp(frame_height, 2, static_cast<int>(plane_rows_));
+
+    frame_width =
+        std::clamp(static_cast<int>(std::round(static_cast<float>(frame_height) / kCellWidthToHeightRatio)),
+                   2,
+                   static_cast<int>(plane_cols_));
+    frame_height =
+        std::clamp(static_cast<int>(std::round(static_cast<float>(frame_width) * kCellWidthToHeightRatio)),
+                   2,
+                   static_cast<int>(plane_rows_));
+
+    frame.height = frame_height;
+    frame.width = frame_width;
+    frame.y = std::max(0, (static_cast<int>(plane_rows_) - frame_height) / 2);
+    frame.x = std::max(0, (static_cast<int>(plane_cols_) - frame_width) / 2);
+    return frame;
+}
+
+void LightCycleAnimation::resize_occupancy() {
+    // One cell per Braille dot of the frame interior the trails are drawn
+    // into, so grid cells line up with the rasterised dots.
+    const FrameRect frame = frame_rect();
+    const int interior_cols = frame.width - 2;
+    const int interior_rows = frame.height - 2;
+    if (interior_cols > 0 && interior_rows > 0) {
+        occupancy_.resize(interior_cols * kBrailleColsPerCell, interior_rows * kBrailleRowsPerCell);
+    } else {
+        occupancy_.resize(kFallbackOccupancyResolution, kFallbackOccupancyResolution);
+    }
+    for (const auto& sample : trail_) {
+        occupancy_.add_segment(sample.from_x, sample.from_y, sample.x, sample.y);
+    }
 }
 
 void LightCycleAnimation::draw_frame(int frame_y, int frame_x, int frame_height, int frame_width) {
@@ -401,86 +469,19 @@ void LightCycleAnimation::draw_frame(int frame_y, int frame_x, int frame_height,
     cleanup_cells();
 }
 
-bool LightCycleAnimation::render_point(float normalized_x,
-                                       float normalized_y,
-                                       float brightness,
-                                       float thickness,
-                                       const LightCycleColor& color_scale,
-                                       int frame_y,
-                                       int frame_x,
-                                       int interior_height,
-                                       int interior_width) {
-    (void)frame_y;
-    (void)frame_x;
-    if (!plane_ || interior_height <= 0 || interior_width <= 0 || brightness <= 0.0f || thickness <= 0.0f) {
-        return false;
-    }
-
-    const float clamped_x = std::clamp(normalized_x, 0.0f, 1.0f);
-    const float clamped_y = std::clamp(normalized_y, 0.0f, 1.0f);
-
-    const int subcols = interior_width * kBrailleColsPerCell;
-    const int subrows = interior_height * kBrailleRowsPerCell;
-    if (subcols <= 0 || subrows <= 0) {
-        return false;
-    }
-
-    const float center_subx = clamped_x * (static_cast<float>(subcols) - 1.0f);
-    const float center_suby = clamped_y * (static_cast<float>(subrows) - 1.0f);
-    const float radius = std::max(thickness * kThicknessRadiusScale, 0.1f);
-
-    const int min_subx = std::max(0, static_cast<int>(std::floor(center_subx - radius)));
-    const int max_subx = std::min(subcols - 1, static_cast<int>(std::ceil(center_subx + radius)));
-    const int min_suby = std::max(0, static_cast<int>(std::floor(center_suby - radius)));
-    const int max_suby = std::min(subrows - 1, static_cast<int>(std::ceil(center_suby + radius)));
-
-    if (braille_masks_.empty() || accumulation_buffer_.empty()) {
-        return false;
-    }
-
-    static constexpr std::uint8_t kBrailleMask[kBrailleRowsPerCell][kBrailleColsPerCell] = {
-        {0x01u, 0x08u},
-        {0x02u, 0x10u},
-        {0x04u, 0x20u},
-        {0x40u, 0x80u},
-    };
-
-    bool wrote_sample = false;
-    for (int suby = min_suby; suby <= max_suby; ++suby) {
-        const float dy = static_cast<float>(suby) - center_suby;
-        for (int subx = min_subx; subx <= max_subx; ++subx) {
-            const float dx = static_cast<float>(subx) - center_subx;
-            const float distance = std::sqrt(dx * dx + dy * dy);
-            if (distance > radius) {
-                continue;
-            }
-
-            const float normalized = 1.0f - std::clamp(distance / radius, 0.0f, 1.0f);
-            const float sample_intensity = brightness * normalized * normalized;
-            if (sample_intensity <= 0.0f) {
-                continue;
+bool LightCycleAnimation::flush_layer() {
+    return rasterizer_.flush(
+        braille_masks_,
+        static_cast<int>(rasterizer_.dot_cols() / kBrailleColsPerCell),
+        [&](std::size_t index, float intensity, const std::array<float, 3>& color_scale) {
+            if (index >= accumulation_buffer_.size()) {
+                return;
             }
-
-            const int cell_row = std::clamp(suby / kBrailleRowsPerCell, 0, interior_height - 1);
-            const int cell_col = std::clamp(subx / kBrailleColsPerCell, 0, interior_width - 1);
-            const int dot_row = suby % kBrailleRowsPerCell;
-            const int dot_col = subx % kBrailleColsPerCell;
-            const std::size_t index =
-                static_cast<std::size_t>(cell_row) * static_cast<std::size_t>(interior_width) +
-                static_cast<std::size_t>(cell_col);
-            if (index >= braille_masks_.size() || index >= accumulation_buffer_.size()) {
-                continue;
-            }
-
-            braille_masks_[index] |= kBrailleMask[dot_row][dot_col];
             LightCycleColor& color = accumulation_buffer_[index];
-            color.r += sample_intensity * color_scale.r;
-            color.g += sample_intensity * color_scale.g;
-            color.b += sample_intensity * color_scale.b;
-            wrote_sample = true;
-        }
-    }
-    return wrote_sample;
+            color.r += intensity * color_scale[0];
+            color.g += intensity * color_scale[1];
+            color.b += intensity * color_scale[2];
+        });
 }
 
 float LightCycleAnimation::compute_trail_brightness(float age) const {
@@ -522,6 +523,10 @@ void LightCycleAnimation::spawn_cycle() {
                    std::clamp(head_color_.b * mix + trail_color_.b * (1.0f - mix), 0.0f, 1.0f)};
     cycle.thickness = (thickness_min_ + thickness_max_) * 0.5f;
     cycle.glow = 0.45f;
+    cycle.id = next_cycle_id_++;
+    cycle.last_sample_x = cycle.head_x;
+    cycle.last_sample_y = cycle.head_y;
+    cycle.sampler.configure(trail_spacing_, kTrailMaxTurnRadians);
 
     cycles_.push_back(cycle);
 }
@@ -555,16 +560,26 @@ void LightCycleAnimation::update_cycle(LightCycleCycle& cycle,
         cycle.head_x = cycle.anchor_coordinate;
     }
 
-    append_trail_sample(cycle);
+    advance_trail(cycle, delta);
 
     const float required_turn_time = std::max(kMinTurnDelay + cycle.min_turn_delay, turn_cooldown_s_);
-    if (!cycle.has_turned && turn_trigger && cycle.time_since_spawn >= required_turn_time &&
-        cycle_inside_bounds(cycle)) {
+    // A trail dead ahead also forces the turn, Tron style.
+    const bool inside = cycle_inside_bounds(cycle);
+    const bool avoid_trigger = !cycle.has_turned && inside &&
+                               path_blocked(cycle.head_x, cycle.head_y, cycle.orientation, cycle.direction_sign);
+    if (!cycle.has_turned && (turn_trigger || avoid_trigger) && cycle.time_since_spawn >= required_turn_time &&
+        inside) {
         turn_cycle(cycle, features);
     }
 }
 
 void LightCycleAnimation::turn_cycle(LightCycleCycle& cycle, const AudioFeatures& features) {
+    // Pin the corner so the trail does not cut across it.
+    if (cycle.head_x != cycle.last_sample_x || cycle.head_y != cycle.last_sample_y) {
+        cycle.sampler.mark_sample(cycle.last_sample_x, cycle.last_sample_y, cycle.head_x, cycle.head_y);
+        append_trail_sample(cycle);
+    }
+
     cycle.has_turned = true;
     cycle.time_since_turn = 0.0f;
     cycle.orientation = cycle.orientation == Orientation::Horizontal ? Orientation::Vertical : Orientation::Horizontal;
@@ -611,9 +626,23 @@ int LightCycleAnimation::choose_direction(Orientation orientation,
         direction = coin_flip(rng_) == 0 ? -1 : 1;
     }
 
+    const float position = orientation == Orientation::Horizontal ? cycle.head_x : cycle.head_y;
+    const bool edge_forced = position <= 0.05f || position >= 0.95f;
+    if (!edge_forced && path_blocked(cycle.head_x, cycle.head_y, orientation, direction) &&
+        !path_blocked(cycle.head_x, cycle.head_y, orientation, -direction)) {
+        direction = -direction;
+    }
+
     return direction;
 }
 
+bool LightCycleAnimation::path_blocked(float x, float y, Orientation orientation, int direction_sign) const {
+    const float dx = orientation == Orientation::Horizontal ? static_cast<float>(direction_sign) : 0.0f;
+    const float dy = orientation == Orientation::Vertical ? static_cast<float>(direction_sign) : 0.0f;
+    const float skip = occupancy_.cell_size() * kLookAheadSkipCells;
+    return occupancy_.clearance(x, y, dx, dy, skip, kLookAheadDistance) < kLookAheadDistance;
+}
+
 bool LightCycleAnimation::cycle_inside_bounds(const LightCycleCycle& cycle) const {
     const float min_pos = 0.0f;
     const float max_pos = 1.0f;
@@ -643,17 +672,29 @@ bool LightCycleAnimation::cycle_past_bounds(const LightCycleCycle& cycle) const
     return cycle.head_y <= min_pos;
 }
 
-void LightCycleAnimation::append_trail_sample(const LightCycleCycle& cycle) {
-    if (trail_.size() >= kMaxTrailSamples) {
-        trail_.pop_front();
+void LightCycleAnimation::advance_trail(LightCycleCycle& cycle, float step_length) {
+    if (cycle.sampler.advance(step_length, cycle.last_sample_x, cycle.last_sample_y, cycle.head_x, cycle.head_y)) {
+        append_trail_sample(cycle);
     }
+}
 
-    LightCycleColor mixed_color = {std::clamp((trail_color_.r + cycle.color.r) * 0.5f, 0.0f, 1.0f),
-                                   std::clamp((trail_color_.g + cycle.color.g) * 0.5f, 0.0f, 1.0f),
-                                   std::clamp((trail_color_.b + cycle.color.b) * 0.5f, 0.0f, 1.0f)};
-
-    trail_.push_back(
-        LightCycleTrailPoint{cycle.head_x, cycle.head_y, elapsed_time_, cycle.thickness, cycle.glow, mixed_color});
+void LightCycleAnimation::append_trail_sample(LightCycleCycle& cycle) {
+    if (trail_.size() >= kMaxTrailSamples) {
+        pop_trail_front();
+    }
+
+    trail_.push_back(LightCycleTrailPoint{cycle.head_x,
+                                          cycle.head_y,
+                                          elapsed_time_,
+                                          cycle.thickness,
+                                          cycle.glow,
+                                          mix_trail_color(trail_color_, cycle.color),
+                                          cycle.id,
+                                          cycle.last_sample_x,
+                                          cycle.last_sample_y});
+    occupancy_.add_segment(cycle.last_sample_x, cycle.last_sample_y, cycle.head_x, cycle.head_y);
+    cycle.last_sample_x = cycle.head_x;
+    cycle.last_sample_y = cycle.head_y;
 }
 
 void LightCycleAnimation::trim_trail() {
@@ -662,10 +703,16 @@ void LightCycleAnimation::trim_trail() {
         if (age <= tail_duration_s_) {
             break;
         }
-        trail_.pop_front();
+        pop_trail_front();
     }
 }
 
+void LightCycleAnimation::pop_trail_front() {
+    const LightCycleTrailPoint& expired = trail_.front();
+    occupancy_.remove_segment(expired.from_x, expired.from_y, expired.x, expired.y);
+    trail_.pop_front();
+}
+
 } // namespace animations
 } // namespace when
 
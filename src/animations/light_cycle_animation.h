@@ -3,9 +3,12 @@
 #include <cstdint>
 #include <deque>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "animation.h"
+#include "trail_occupancy.h"
+#include "trail_raster.h"
 
 namespace when {
 namespace animations {
@@ -23,6 +26,9 @@ struct LightCycleTrailPoint {
     float thickness = 1.0f;
     float intensity = 1.0f;
     LightCycleColor color;
+    std::uint32_t cycle_id = 0;
+    float from_x = 0.5f; // Previous sample of the same cycle; the segment is tracked in the occupancy grid
+    float from_y = 0.5f;
 };
 
 class LightCycleAnimation : public Animation {
@@ -46,6 +52,7 @@ private:
     enum class Orientation { Horizontal, Vertical };
 
     struct LightCycleCycle {
+        std::uint32_t id = 0;
         Orientation orientation = Orientation::Horizontal;
         int direction_sign = 1;
         float head_x = 0.0f;
@@ -59,19 +66,24 @@ private:
         float speed_multiplier = 1.0f;
         float min_turn_delay = 0.0f;
         LightCycleColor color;
+        TrailSampleGate sampler;
+        float last_sample_x = 0.0f;
+        float last_sample_y = 0.0f;
+    };
+
+    // Square-looking frame centred in the plane; trails live inside it.
+    struct FrameRect {
+        int y = 0;
+        int x = 0;
+        int height = 0;
+        int width = 0;
     };
 
     void create_or_resize_plane(notcurses* nc);
+    FrameRect frame_rect() const;
+    void resize_occupancy();
     void draw_frame(int frame_y, int frame_x, int frame_height, int frame_width);
-    bool render_point(float normalized_x,
-                      float normalized_y,
-                      float brightness,
-                      float thickness,
-                      const LightCycleColor& color_scale,
-                      int frame_y,
-                      int frame_x,
-                      int interior_height,
-                      int interior_width);
+    bool flush_layer();
     float compute_trail_brightness(float age) const;
     void spawn_cycle();
     void update_cycle(LightCycleCycle& cycle,
@@ -82,10 +94,13 @@ private:
     int choose_direction(Orientation orientation,
                          const AudioFeatures& features,
                          const LightCycleCycle& cycle);
+    bool path_blocked(float x, float y, Orientation orientation, int direction_sign) const;
     bool cycle_inside_bounds(const LightCycleCycle& cycle) const;
     bool cycle_past_bounds(const LightCycleCycle& cycle) const;
-    void append_trail_sample(const LightCycleCycle& cycle);
+    void advance_trail(LightCycleCycle& cycle, float step_length);
+    void append_trail_sample(LightCycleCycle& cycle);
     void trim_trail();
+    void pop_trail_front();
 
     ncplane* plane_ = nullptr;
     bool is_active_ = false;
@@ -94,9 +109,14 @@ private:
     unsigned int plane_cols_ = 0;
 
     std::deque<LightCycleTrailPoint> trail_;
+    TrailOccupancyGrid occupancy_;
     std::vector<LightCycleCycle> cycles_;
     std::vector<std::uint8_t> braille_masks_;
     std::vector<LightCycleColor> accumulation_buffer_;
+    TrailRasterizer rasterizer_;
+    std::vector<std::pair<std::uint32_t, TrailVertex>> trail_tails_; // Render scratch: last vertex per cycle
+    float trail_spacing_ = 0.0f; // Normalised arc length between trail samples
+    std::uint32_t next_cycle_id_ = 0;
 
     std::mt19937 rng_;
 
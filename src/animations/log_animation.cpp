@@ -0,0 +1,313 @@
+#include "log_animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+#include "animation_event_utils.h"
+
+namespace when {
+namespace animations {
+
+namespace {
+constexpr std::size_t kMinRingLines = 512;
+constexpr std::size_t kMaxLineBytes = 1024;
+constexpr float kMinLineInterval = 0.01f;
+constexpr unsigned int kFrameR = 120u;
+constexpr unsigned int kFrameG = 130u;
+constexpr unsigned int kFrameB = 150u;
+constexpr unsigned int kTextR = 200u;
+constexpr unsigned int kTextG = 210u;
+constexpr unsigned int kTextB = 200u;
+
+// Bytes of text that fit in columns, counting one column per code point.
+std::size_t prefix_for_columns(std::string_view text, int columns, int& used) {
+    used = 0;
+    std::size_t end = 0;
+    while (end < text.size()) {
+        std::size_t next = end + 1;
+        while (next < text.size() && (static_cast<unsigned char>(text[next]) & 0xC0u) == 0x80u) {
+            ++next;
+        }
+        if (used == columns) {
+            break;
+        }
+        ++used;
+        end = next;
+    }
+    return end;
+}
+} // namespace
+
+LogAnimation::LogAnimation() = default;
+
+LogAnimation::~LogAnimation() {
+    if (text_plane_) {
+        ncplane_destroy(text_plane_);
+        text_plane_ = nullptr;
+    }
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+}
+
+void LogAnimation::init(notcurses* nc, const AppConfig& config) {
+    if (text_plane_) {
+        ncplane_destroy(text_plane_);
+        text_plane_ = nullptr;
+    }
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+
+    z_index_ = 0;
+    is_active_ = true;
+    params_ = Parameters{};
+    line_timer_ = 0.0f;
+    drawn_total_lines_ = 0;
+    shown_lines_ = 0;
+    needs_redraw_ = true;
+    follower_.close();
+
+    const AnimationConfig* own_config = nullptr;
+    for (const auto& anim_config : config.animations) {
+        if (anim_config.type == "Log") {
+            own_config = &anim_config;
+            break;
+        }
+    }
+    if (own_config) {
+        z_index_ = own_config->z_index;
+        is_active_ = own_config->initially_active;
+        load_parameters_from_config(*own_config);
+    }
+
+    plane_ = create_configured_plane(nc, own_config, plane_rows_, plane_cols_);
+
+    // A missing file leaves an empty window rather than failing startup.
+    if (own_config && !own_config->text_file_path.empty()) {
+        LogFollower::Options options;
+        options.max_lines = std::max<std::size_t>(kMinRingLines, plane_rows_);
+        options.max_line_bytes = kMaxLineBytes;
+        if (params_.follow) {
+            follower_.open_follow(own_config->text_file_path, options);
+        } else if (follower_.open_step(own_config->text_file_path, options)) {
+            follower_.advance_line(params_.loop);
+        }
+    }
+}
+
+void LogAnimation::load_parameters_from_config(const AnimationConfig& config) {
+    params_.line_interval_s = std::max(config.log_line_interval_s, kMinLineInterval);
+    params_.loop = config.log_loop_messages;
+    params_.show_border = config.log_show_border;
+    params_.padding_y = std::max(config.log_padding_y, 0);
+    params_.padding_x = std::max(config.log_padding_x, 0);
+    params_.title = config.log_title;
+    params_.follow = config.log_follow;
+}
+
+void LogAnimation::update(float delta_time,
+                          const AudioMetrics& /*metrics*/,
+                          const AudioFeatures& /*features*/) {
+    if (!plane_ || !is_active_) {
+        return;
+    }
+
+    // Follow mode polls on the same cadence; with inotify an idle poll is a
+    // single non-blocking read, and appended bytes are read exactly once.
+    line_timer_ += std::max(delta_time, 0.0f);
+    if (line_timer_ < params_.line_interval_s) {
+        return;
+    }
+    line_timer_ = std::fmod(line_timer_, params_.line_interval_s);
+    if (params_.follow) {
+        follower_.poll();
+    } else {
+        follower_.advance_line(params_.loop);
+    }
+}
+
+void LogAnimation::render(notcurses* /*nc*/) {
+    if (!plane_ || !is_active_) {
+        return;
+    }
+
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    ncplane_dim_yx(plane_, &rows, &cols);
+    if (rows != plane_rows_ || cols != plane_cols_) {
+        plane_rows_ = rows;
+        plane_cols_ = cols;
+        needs_redraw_ = true;
+    }
+
+    // The plane keeps its cells between frames, so frames without new lines
+    // cost nothing.
+    if (needs_redraw_) {
+        ncplane_erase(plane_);
+        draw_frame();
+        layout_text_plane();
+        draw_lines();
+        needs_redraw_ = false;
+    } else if (follower_.total_lines() != drawn_total_lines_) {
+        scroll_in_lines();
+    }
+}
+
+void LogAnimation::draw_frame() {
+    if (!params_.show_border || plane_rows_ < 2u || plane_cols_ < 2u) {
+        return;
+    }
+
+    nccell ul = NCCELL_TRIVIAL_INITIALIZER;
+    nccell ur = NCCELL_TRIVIAL_INITIALIZER;
+    nccell ll = NCCELL_TRIVIAL_INITIALIZER;
+    nccell lr = NCCELL_TRIVIAL_INITIALIZER;
+    nccell hl = NCCELL_TRIVIAL_INITIALIZER;
+    nccell vl = NCCELL_TRIVIAL_INITIALIZER;
+
+    auto cleanup_cells = [&]() {
+        nccell_release(plane_, &ul);
+        nccell_release(plane_, &ur);
+        nccell_release(plane_, &ll);
+        nccell_release(plane_, &lr);
+        nccell_release(plane_, &hl);
+        nccell_release(plane_, &vl);
+    };
+
+    auto load_cell = [&](nccell* cell, uint32_t glyph) -> bool {
+        if (nccell_load_ucs32(plane_, cell, glyph) <= 0) {
+            return false;
+        }
+        nccell_set_fg_rgb8(cell, kFrameR, kFrameG, kFrameB);
+        return true;
+    };
+
+    const bool loaded = load_cell(&ul, 0x256Du) &&  // ╭
+                        load_cell(&ur, 0x256Eu) &&  // ╮
+                        load_cell(&ll, 0x2570u) &&  // ╰
+                        load_cell(&lr, 0x256Fu) &&  // ╯
+                        load_cell(&hl, 0x2500u) &&  // ─
+                        load_cell(&vl, 0x2502u);    // │
+    if (loaded) {
+        ncplane_cursor_move_yx(plane_, 0, 0);
+        ncplane_box_sized(plane_, &ul, &ur, &ll, &lr, &hl, &vl, plane_rows_, plane_cols_, 0);
+    }
+    cleanup_cells();
+
+    if (!params_.title.empty() && plane_cols_ > 6u) {
+        const std::string label = " " + params_.title + " ";
+        int used = 0;
+        const std::size_t bytes = prefix_for_columns(label, static_cast<int>(plane_cols_) - 4, used);
+        ncplane_set_fg_rgb8(plane_, kTextR, kTextG, kTextB);
+        ncplane_putnstr_yx(plane_, 0, 2, bytes, label.data());
+    }
+}
+
+void LogAnimation::layout_text_plane() {
+    if (text_plane_) {
+        ncplane_destroy(text_plane_);
+        text_plane_ = nullptr;
+    }
+    text_rows_ = 0;
+    text_cols_ = 0;
+
+    const int inset_y = (params_.show_border ? 1 : 0) + params_.padding_y;
+    const int inset_x = (params_.show_border ? 1 : 0) + params_.padding_x;
+    const int text_rows = static_cast<int>(plane_rows_) - 2 * inset_y;
+    const int text_cols = static_cast<int>(plane_cols_) - 2 * inset_x;
+    if (text_rows <= 0 || text_cols <= 0) {
+        return;
+    }
+
+    ncplane_options opts{};
+    opts.y = inset_y;
+    opts.x = inset_x;
+    opts.rows = static_cast<unsigned int>(text_rows);
+    opts.cols = static_cast<unsigned int>(text_cols);
+    text_plane_ = ncplane_create(plane_, &opts);
+    if (!text_plane_) {
+        return;
+    }
+    ncplane_set_scrolling(text_plane_, true);
+    text_rows_ = opts.rows;
+    text_cols_ = opts.cols;
+    blank_row_.assign(text_cols_, ' ');
+}
+
+void LogAnimation::draw_lines() {
+    drawn_total_lines_ = follower_.total_lines();
+    shown_lines_ = 0;
+    if (!text_plane_) {
+        return;
+    }
+
+    // Oldest visible line at the top, newest at the bottom once the window fills.
+    const std::size_t visible = std::min<std::size_t>(follower_.size(), text_rows_);
+    ncplane_set_fg_rgb8(text_plane_, kTextR, kTextG, kTextB);
+    for (unsigned int row = 0; row < text_rows_; ++row) {
+        draw_row(row, row < visible ? follower_.line_from_end(visible - 1u - row) : std::string_view{});
+    }
+    shown_lines_ = visible;
+}
+
+void LogAnimation::scroll_in_lines() {
+    const std::uint64_t added = follower_.total_lines() - drawn_total_lines_;
+    const std::size_t visible = std::min<std::size_t>(follower_.size(), text_rows_);
+    // A reopened file or a burst that fills the window gains nothing from scrolling.
+    if (!text_plane_ || added >= text_rows_ ||
+        visible != std::min<std::size_t>(shown_lines_ + static_cast<std::size_t>(added), text_rows_)) {
+        draw_lines();
+        return;
+    }
+    drawn_total_lines_ = follower_.total_lines();
+
+    const auto new_rows = static_cast<std::size_t>(added);
+    const std::size_t overflow = shown_lines_ + new_rows - visible;
+    if (overflow > 0) {
+        ncplane_scrollup(text_plane_, static_cast<int>(overflow));
+    }
+    ncplane_set_fg_rgb8(text_plane_, kTextR, kTextG, kTextB);
+    for (std::size_t row = visible - new_rows; row < visible; ++row) {
+        draw_row(static_cast<unsigned int>(row), follower_.line_from_end(visible - 1u - row));
+    }
+    shown_lines_ = visible;
+}
+
+void LogAnimation::draw_row(unsigned int row, std::string_view line) {
+    const int y = static_cast<int>(row);
+    int used = 0;
+    const std::size_t bytes = prefix_for_columns(line, static_cast<int>(text_cols_), used);
+    if (bytes > 0) {
+        ncplane_putnstr_yx(text_plane_, y, 0, bytes, line.data());
+    }
+    // Pad with spaces so the text area stays opaque over the layers below.
+    if (used < static_cast<int>(text_cols_)) {
+        ncplane_putnstr_yx(text_plane_, y, used, text_cols_ - static_cast<unsigned int>(used), blank_row_.data());
+    }
+}
+
+void LogAnimation::activate() {
+    is_active_ = true;
+    needs_redraw_ = true;
+}
+
+void LogAnimation::deactivate() {
+    is_active_ = false;
+    if (plane_) {
+        ncplane_erase(plane_);
+    }
+    if (text_plane_) {
+        ncplane_erase(text_plane_);
+    }
+}
+
+void LogAnimation::bind_events(const AnimationConfig& config, events::EventBus& bus) {
+    bind_standard_frame_updates(this, config, bus);
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <notcurses/notcurses.h>
+
+#include "animation.h"
+#include "log_follower.h"
+
+namespace when {
+namespace animations {
+
+// A framed window of log lines read from text_file_path. With log_follow the
+// file is tailed as it grows; otherwise one line is revealed every
+// log_line_interval_s and the file optionally loops. Text lives in a scrolling
+// child plane inside the frame: new lines scroll it and only the rows they land
+// on are written; everything is redrawn only when the size changes.
+class LogAnimation : public Animation {
+public:
+    LogAnimation();
+    ~LogAnimation() override;
+
+    void init(notcurses* nc, const AppConfig& config) override;
+    void update(float delta_time,
+                const AudioMetrics& metrics,
+                const AudioFeatures& features) override;
+    void render(notcurses* nc) override;
+
+    void activate() override;
+    void deactivate() override;
+
+    bool is_active() const override { return is_active_; }
+    int get_z_index() const override { return z_index_; }
+    ncplane* get_plane() const override { return plane_; }
+
+    void bind_events(const AnimationConfig& config, events::EventBus& bus) override;
+
+private:
+    struct Parameters {
+        float line_interval_s = 0.4f;
+        bool loop = true;
+        bool show_border = true;
+        int padding_y = 1;
+        int padding_x = 2;
+        std::string title;
+        bool follow = false;
+    };
+
+    void load_parameters_from_config(const AnimationConfig& config);
+    void draw_frame();
+    void layout_text_plane();
+    void draw_lines();
+    void scroll_in_lines();
+    void draw_row(unsigned int row, std::string_view line);
+
+    ncplane* plane_ = nullptr;
+    ncplane* text_plane_ = nullptr; // Child of plane_ covering the text area
+    int z_index_ = 0;
+    bool is_active_ = true;
+    unsigned int plane_rows_ = 0;
+    unsigned int plane_cols_ = 0;
+    unsigned int text_rows_ = 0;
+    unsigned int text_cols_ = 0;
+
+    Parameters params_{};
+    LogFollower follower_;
+    float line_timer_ = 0.0f;
+    std::uint64_t drawn_total_lines_ = 0; // follower_.total_lines() at the last draw
+    std::size_t shown_lines_ = 0;         // Rows of text_plane_ holding lines
+    bool needs_redraw_ = true;
+    std::string blank_row_;
+};
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,369 @@
+#include "log_follower.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace when {
+namespace animations {
+
+namespace {
+constexpr std::size_t kMinLineBytes = 16;
+
+// Drops a trailing UTF-8 sequence that truncation cut short.
+std::size_t utf8_safe_length(const char* data, std::size_t length) {
+    std::size_t end = length;
+    std::size_t continuation = 0;
+    while (end > 0 && (static_cast<unsigned char>(data[end - 1]) & 0xC0u) == 0x80u && continuation < 3) {
+        --end;
+        ++continuation;
+    }
+    if (end == 0) {
+        return length;
+    }
+    const auto lead = static_cast<unsigned char>(data[end - 1]);
+    std::size_t expected = 1;
+    if ((lead & 0xE0u) == 0xC0u) {
+        expected = 2;
+    } else if ((lead & 0xF0u) == 0xE0u) {
+        expected = 3;
+    } else if ((lead & 0xF8u) == 0xF0u) {
+        expected = 4;
+    }
+    if (expected > 1 && continuation + 1 < expected) {
+        return end - 1;
+    }
+    return length;
+}
+} // namespace
+
+LogFollower::~LogFollower() {
+    close();
+}
+
+bool LogFollower::open_follow(const std::string& path, const Options& options) {
+    return open_file(path, options, Mode::Follow);
+}
+
+bool LogFollower::open_step(const std::string& path, const Options& options) {
+    return open_file(path, options, Mode::Step);
+}
+
+bool LogFollower::open_file(const std::string& path, const Options& options, Mode mode) {
+    close();
+    mode_ = mode;
+    options_ = options;
+    options_.max_lines = std::max<std::size_t>(options_.max_lines, 1);
+    options_.max_line_bytes = std::max(options_.max_line_bytes, kMinLineBytes);
+    options_.read_chunk_bytes = std::max<std::size_t>(options_.read_chunk_bytes, 1024);
+    path_ = path;
+
+    slots_.assign(options_.max_lines * options_.max_line_bytes, '\0');
+    lengths_.assign(options_.max_lines, 0u);
+    chunk_.assign(options_.read_chunk_bytes, '\0');
+    partial_.clear();
+    partial_.reserve(options_.max_line_bytes);
+    head_ = 0;
+    count_ = 0;
+    total_lines_ = 0;
+    bytes_read_ = 0;
+
+    if (!reopen()) {
+        // Follow mode tolerates a log that does not exist yet; poll() retries.
+        return mode_ == Mode::Follow && errno == ENOENT;
+    }
+    if (mode_ == Mode::Follow) {
+        read_appended();
+    }
+    return true;
+}
+
+bool LogFollower::reopen() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    unwatch();
+    offset_ = 0;
+    chunk_pos_ = 0;
+    chunk_len_ = 0;
+    partial_.clear();
+    partial_truncated_ = false;
+    partial_pending_ = false;
+    skip_to_newline_ = false;
+
+    const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        const int error = errno;
+        last_error_ = "Unable to open '" + path_ + "': " + std::strerror(error);
+        errno = error;
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        last_error_ = "'" + path_ + "' is not a regular file";
+        ::close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    fd_ = fd;
+    last_error_.clear();
+
+    if (mode_ == Mode::Follow) {
+        const auto size = static_cast<std::uint64_t>(st.st_size);
+        if (size > options_.initial_tail_bytes) {
+            offset_ = size - options_.initial_tail_bytes;
+            skip_to_newline_ = true;
+        }
+        watch();
+    }
+    return true;
+}
+
+void LogFollower::close() {
+    unwatch();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void LogFollower::watch() {
+#ifdef __linux__
+    watch_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd_ < 0) {
+        return;
+    }
+    const std::uint32_t mask = IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+    if (::inotify_add_watch(watch_fd_, path_.c_str(), mask) < 0) {
+        ::close(watch_fd_);
+        watch_fd_ = -1;
+    }
+#endif
+}
+
+void LogFollower::unwatch() {
+    if (watch_fd_ >= 0) {
+        ::close(watch_fd_);
+        watch_fd_ = -1;
+    }
+}
+
+bool LogFollower::drain_watch_events(bool& rotated) {
+    rotated = false;
+#ifdef __linux__
+    bool changed = false;
+    alignas(struct inotify_event) std::array<char, 4096> buffer{};
+    for (;;) {
+        const ssize_t n = ::read(watch_fd_, buffer.data(), buffer.size());
+        if (n <= 0) {
+            break;
+        }
+        std::size_t pos = 0;
+        while (pos + sizeof(struct inotify_event) <= static_cast<std::size_t>(n)) {
+            struct inotify_event event {};
+            std::memcpy(&event, buffer.data() + pos, sizeof(event));
+            changed = true;
+            if (event.mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) {
+                rotated = true;
+            }
+            pos += sizeof(struct inotify_event) + event.len;
+        }
+    }
+    return changed;
+#else
+    return true;
+#endif
+}
+
+std::size_t LogFollower::poll() {
+    if (mode_ != Mode::Follow) {
+        return 0;
+    }
+    const std::uint64_t before = total_lines_;
+    if (fd_ < 0) {
+        if (path_.empty() || !reopen()) {
+            return 0;
+        }
+        read_appended();
+        return static_cast<std::size_t>(total_lines_ - before);
+    }
+
+    bool rotated = false;
+    if (watch_fd_ >= 0 && !drain_watch_events(rotated)) {
+        return 0;
+    }
+    // Unlinking only shows up as an attribute change, and without inotify
+    // there are no events at all, so compare the path's inode with the open file.
+    struct stat path_st {};
+    struct stat fd_st {};
+    if (::stat(path_.c_str(), &path_st) != 0 ||
+        (::fstat(fd_, &fd_st) == 0 && (path_st.st_ino != fd_st.st_ino || path_st.st_dev != fd_st.st_dev))) {
+        rotated = true;
+    }
+
+    read_appended();
+    if (rotated) {
+        // Start the replacement file from its beginning; if it is not there
+        // yet, the next poll retries.
+        if (reopen()) {
+            offset_ = 0;
+            skip_to_newline_ = false;
+            read_appended();
+        }
+    }
+    return static_cast<std::size_t>(total_lines_ - before);
+}
+
+std::size_t LogFollower::read_appended() {
+    if (fd_ < 0) {
+        return 0;
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+        return 0;
+    }
+    const auto size = static_cast<std::uint64_t>(st.st_size);
+    if (size < offset_) {
+        // Truncated in place (copytruncate rotation).
+        offset_ = 0;
+        partial_.clear();
+        partial_truncated_ = false;
+        partial_pending_ = false;
+        skip_to_newline_ = false;
+    }
+    // A burst larger than the tail window would scroll past unseen anyway, so
+    // jump to the tail instead of reading it all.
+    if (size - offset_ > options_.initial_tail_bytes) {
+        offset_ = size - options_.initial_tail_bytes;
+        partial_.clear();
+        partial_truncated_ = false;
+        partial_pending_ = false;
+        skip_to_newline_ = true;
+    }
+
+    std::size_t total = 0;
+    while (offset_ < size) {
+        const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(chunk_.size(), size - offset_));
+        const ssize_t n = ::pread(fd_, chunk_.data(), want, static_cast<off_t>(offset_));
+        if (n <= 0) {
+            break;
+        }
+        offset_ += static_cast<std::uint64_t>(n);
+        bytes_read_ += static_cast<std::uint64_t>(n);
+        total += static_cast<std::size_t>(n);
+        consume(chunk_.data(), static_cast<std::size_t>(n), static_cast<std::size_t>(-1));
+    }
+    return total;
+}
+
+bool LogFollower::advance_line(bool loop) {
+    if (mode_ != Mode::Step || fd_ < 0) {
+        return false;
+    }
+    bool wrapped = false;
+    for (;;) {
+        if (chunk_pos_ < chunk_len_) {
+            const std::uint64_t before = total_lines_;
+            chunk_pos_ += consume(chunk_.data() + chunk_pos_, chunk_len_ - chunk_pos_, 1);
+            if (total_lines_ != before) {
+                return true;
+            }
+            continue;
+        }
+
+        const ssize_t n = ::pread(fd_, chunk_.data(), chunk_.size(), static_cast<off_t>(offset_));
+        if (n > 0) {
+            offset_ += static_cast<std::uint64_t>(n);
+            bytes_read_ += static_cast<std::uint64_t>(n);
+            chunk_pos_ = 0;
+            chunk_len_ = static_cast<std::size_t>(n);
+            continue;
+        }
+
+        // End of file: a last line without a newline still counts.
+        if (partial_pending_) {
+            push_partial();
+            return true;
+        }
+        if (!loop || wrapped || offset_ == 0) {
+            return false;
+        }
+        wrapped = true;
+        offset_ = 0;
+        chunk_pos_ = 0;
+        chunk_len_ = 0;
+    }
+}
+
+std::size_t LogFollower::consume(const char* data, std::size_t length, std::size_t line_limit) {
+    std::size_t pos = 0;
+    std::size_t lines = 0;
+    while (pos < length && lines < line_limit) {
+        const void* found = std::memchr(data + pos, '\n', length - pos);
+        const std::size_t end = found ? static_cast<std::size_t>(static_cast<const char*>(found) - data) : length;
+
+        if (skip_to_newline_) {
+            if (found) {
+                skip_to_newline_ = false;
+            }
+        } else {
+            partial_pending_ = partial_pending_ || end > pos;
+            for (std::size_t i = pos; i < end && !partial_truncated_; ++i) {
+                char c = data[i];
+                if (c == '\t') {
+                    c = ' ';
+                } else if (static_cast<unsigned char>(c) < 0x20u || c == 0x7f) {
+                    continue; // Control bytes would move the cursor
+                }
+                if (partial_.size() == options_.max_line_bytes) {
+                    partial_truncated_ = true;
+                    break;
+                }
+                partial_.push_back(c);
+            }
+            if (found) {
+                push_partial();
+                ++lines;
+            }
+        }
+        pos = found ? end + 1 : length;
+    }
+    return pos;
+}
+
+void LogFollower::push_partial() {
+    const std::size_t length = partial_truncated_ ? utf8_safe_length(partial_.data(), partial_.size())
+                                                  : partial_.size();
+    char* slot = slots_.data() + head_ * options_.max_line_bytes;
+    if (length > 0) {
+        std::memcpy(slot, partial_.data(), length);
+    }
+    lengths_[head_] = static_cast<std::uint32_t>(length);
+    head_ = (head_ + 1) % options_.max_lines;
+    count_ = std::min(count_ + 1, options_.max_lines);
+    ++total_lines_;
+    partial_.clear();
+    partial_truncated_ = false;
+    partial_pending_ = false;
+}
+
+std::string_view LogFollower::line_from_end(std::size_t index) const {
+    if (index >= count_) {
+        return {};
+    }
+    const std::size_t slot = (head_ + options_.max_lines - 1 - index) % options_.max_lines;
+    return std::string_view(slots_.data() + slot * options_.max_line_bytes, lengths_[slot]);
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace when {
+namespace animations {
+
+// Streams lines from a file into a fixed ring of line slots. Memory is bounded
+// by max_lines * max_line_bytes plus one read chunk, however large the file.
+//
+// Follow mode keeps a read offset and, on poll(), reads only bytes appended
+// since the previous poll (woken by inotify on Linux, a size check elsewhere).
+// Truncation restarts from the beginning and rotation reopens the path. Step
+// mode instead hands out one line per advance_line() call and can loop.
+class LogFollower {
+public:
+    struct Options {
+        std::size_t max_lines = 512;
+        std::size_t max_line_bytes = 512;      // Longer lines are truncated
+        std::size_t initial_tail_bytes = 65536; // Follow mode starts this far from the end
+        std::size_t read_chunk_bytes = 65536;
+    };
+
+    LogFollower() = default;
+    ~LogFollower();
+
+    LogFollower(const LogFollower&) = delete;
+    LogFollower& operator=(const LogFollower&) = delete;
+
+    bool open_follow(const std::string& path, const Options& options);
+    bool open_step(const std::string& path, const Options& options);
+    void close();
+
+    // Follow mode: ingests appended bytes. Returns the number of complete lines added.
+    std::size_t poll();
+    // Step mode: appends the next line. At end of file, wraps when loop is set
+    // and otherwise returns false.
+    bool advance_line(bool loop);
+
+    bool is_open() const { return fd_ >= 0; }
+    const std::string& last_error() const { return last_error_; }
+
+    std::size_t size() const { return count_; }
+    // 0 is the newest line.
+    std::string_view line_from_end(std::size_t index) const;
+    // Lines ever appended; a change means new lines scrolled in.
+    std::uint64_t total_lines() const { return total_lines_; }
+    std::uint64_t bytes_read() const { return bytes_read_; }
+
+private:
+    enum class Mode { Follow, Step };
+
+    bool open_file(const std::string& path, const Options& options, Mode mode);
+    bool reopen();
+    void watch();
+    void unwatch();
+    // Returns true when the file may have changed; sets rotated when it was moved or deleted.
+    bool drain_watch_events(bool& rotated);
+    std::size_t read_appended();
+    // Splits data into lines, stopping after line_limit complete lines.
+    // Returns the number of bytes consumed.
+    std::size_t consume(const char* data, std::size_t length, std::size_t line_limit);
+    void push_partial();
+
+    Mode mode_ = Mode::Follow;
+    Options options_{};
+    std::string path_;
+    std::string last_error_;
+    int fd_ = -1;
+    int watch_fd_ = -1;
+    std::uint64_t offset_ = 0;
+    std::uint64_t bytes_read_ = 0;
+    bool skip_to_newline_ = false; // Drop the partial first line after seeking into a file
+
+    std::vector<char> chunk_;
+    std::size_t chunk_pos_ = 0; // Step mode: unread bytes are chunk_[chunk_pos_, chunk_len_)
+    std::size_t chunk_len_ = 0;
+
+    std::vector<char> slots_;          // max_lines slots of max_line_bytes each
+    std::vector<std::uint32_t> lengths_;
+    std::size_t head_ = 0;             // Slot the next line is written to
+    std::size_t count_ = 0;
+    std::uint64_t total_lines_ = 0;
+    std::vector<char> partial_;        // Bytes of the line being assembled (bounded)
+    bool partial_truncated_ = false;
+    bool partial_pending_ = false;     // Bytes seen since the last newline
+};
+
+} // namespace animations
+} // namespace when
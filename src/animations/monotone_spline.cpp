@@ -0,0 +1,72 @@
+#include "monotone_spline.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace when {
+namespace animations {
+
+void MonotoneSpline::fit(std::span<const float> values) {
+    values_.assign(values.begin(), values.end());
+    tangents_.assign(values_.size(), 0.0f);
+    const std::size_t count = values_.size();
+    if (count < 2) {
+        return;
+    }
+
+    tangents_.front() = values_[1] - values_[0];
+    tangents_.back() = values_[count - 1] - values_[count - 2];
+    for (std::size_t i = 1; i + 1 < count; ++i) {
+        const float before = values_[i] - values_[i - 1];
+        const float after = values_[i + 1] - values_[i];
+        // A local extremum gets a flat tangent; otherwise the harmonic mean
+        // keeps the slope within twice the smaller secant, which is enough
+        // for monotonicity on uniform spacing.
+        tangents_[i] = (before * after > 0.0f) ? 2.0f * before * after / (before + after) : 0.0f;
+    }
+}
+
+float MonotoneSpline::segment(std::size_t index, float u) const {
+    const float u2 = u * u;
+    const float u3 = u2 * u;
+    const float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+    const float h10 = u3 - 2.0f * u2 + u;
+    const float h01 = -2.0f * u3 + 3.0f * u2;
+    const float h11 = u3 - u2;
+    return h00 * values_[index] + h10 * tangents_[index] + h01 * values_[index + 1] +
+           h11 * tangents_[index + 1];
+}
+
+float MonotoneSpline::evaluate(float t) const {
+    if (values_.empty()) {
+        return 0.0f;
+    }
+    if (values_.size() == 1) {
+        return values_.front();
+    }
+
+    const float position = std::clamp(t, 0.0f, 1.0f) * static_cast<float>(values_.size() - 1);
+    const std::size_t index = std::min(static_cast<std::size_t>(position), values_.size() - 2);
+    return segment(index, position - static_cast<float>(index));
+}
+
+void MonotoneSpline::resample(std::span<float> out) const {
+    if (out.empty()) {
+        return;
+    }
+    if (values_.size() < 2 || out.size() == 1) {
+        std::fill(out.begin(), out.end(), values_.empty() ? 0.0f : values_.front());
+        return;
+    }
+
+    const float step = static_cast<float>(values_.size() - 1) / static_cast<float>(out.size() - 1);
+    const std::size_t last_segment = values_.size() - 2;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        const float position = static_cast<float>(i) * step;
+        const std::size_t index = std::min(static_cast<std::size_t>(position), last_segment);
+        out[i] = segment(index, position - static_cast<float>(index));
+    }
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace when {
+namespace animations {
+
+// Piecewise cubic Hermite curve through evenly spaced samples over [0, 1].
+// Tangents use the Fritsch-Butland harmonic mean, so the curve never
+// overshoots its neighbouring samples: flat runs stay flat and a ridge's peak
+// is not exaggerated when a coarse profile is stretched to pixel width.
+class MonotoneSpline {
+public:
+    void fit(std::span<const float> values);
+
+    std::size_t size() const { return values_.size(); }
+    float evaluate(float t) const;
+    // Fills out with out.size() evenly spaced samples from t = 0 to t = 1.
+    void resample(std::span<float> out) const;
+
+private:
+    float segment(std::size_t index, float u) const;
+
+    std::vector<float> values_;
+    std::vector<float> tangents_; // Per-sample slope in value units per sample step
+};
+
+} // namespace animations
+} // namespace when
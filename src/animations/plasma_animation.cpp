@@ -0,0 +1,131 @@
+#include "plasma_animation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "animation_event_utils.h"
+
+namespace when {
+namespace animations {
+namespace {
+constexpr float kEnergySpeedBoost = 1.5f;
+constexpr float kBeatSmoothing = 0.25f;
+
+// Classic four-term plasma with a bass-driven radial ripple. Written as a
+// flat loop over the span so the compiler can vectorise the body.
+void plasma_kernel(const ShaderSpan& span, const ShaderUniforms& uniforms, float* out) {
+    const float scale = uniforms.params[0];
+    const float warp = uniforms.params[1] * uniforms.bass;
+    const float t = uniforms.time;
+    const float y = (span.y - 0.5f) * scale;
+    const float row_term = std::sin(y * 0.7f + t * 0.9f);
+    const float brightness = 0.75f + 0.25f * uniforms.mid + 0.35f * uniforms.beat;
+
+    for (std::size_t i = 0; i < span.count; ++i) {
+        const float x = (span.x[i] - 0.5f) * scale * span.aspect;
+        const float radius = std::sqrt(x * x + y * y);
+        float value = std::sin(x + t);
+        value += row_term;
+        value += std::sin((x + y) * 0.5f + t * 1.3f);
+        value += std::sin(radius * 1.5f - t * 2.0f + warp * std::sin(radius * 4.0f - t * 6.0f));
+        out[i] = (value * 0.125f + 0.5f) * brightness;
+    }
+}
+} // namespace
+
+PlasmaAnimation::PlasmaAnimation() : kernel_(plasma_kernel) {}
+
+PlasmaAnimation::~PlasmaAnimation() {
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+}
+
+void PlasmaAnimation::init(notcurses* nc, const AppConfig& config) {
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+
+    z_index_ = 0;
+    is_active_ = true;
+    params_ = Parameters{};
+    uniforms_ = ShaderUniforms{};
+
+    const AnimationConfig* own_config = nullptr;
+    for (const auto& anim_config : config.animations) {
+        if (anim_config.type == "Plasma") {
+            own_config = &anim_config;
+            break;
+        }
+    }
+    if (own_config) {
+        z_index_ = own_config->z_index;
+        is_active_ = own_config->initially_active;
+        load_parameters_from_config(*own_config);
+    }
+
+    plane_ = create_configured_plane(nc, own_config, plane_rows_, plane_cols_);
+
+    ShaderStyle style;
+    style.threshold = params_.threshold;
+    shader_.set_style(style);
+}
+
+void PlasmaAnimation::update(float delta_time,
+                             const AudioMetrics& /*metrics*/,
+                             const AudioFeatures& features) {
+    const float dt = std::max(delta_time, 0.0f);
+    const float energy = std::clamp(features.total_energy, 0.0f, 1.0f);
+    uniforms_.time += dt * params_.speed * (1.0f + kEnergySpeedBoost * energy);
+    uniforms_.bass = std::clamp(features.bass_envelope, 0.0f, 1.0f);
+    uniforms_.mid = std::clamp(features.mid_envelope, 0.0f, 1.0f);
+    uniforms_.treble = std::clamp(features.treble_envelope, 0.0f, 1.0f);
+    uniforms_.beat += (std::clamp(features.beat_strength, 0.0f, 1.0f) - uniforms_.beat) * kBeatSmoothing;
+    uniforms_.beat_phase = features.beat_phase;
+    uniforms_.params[0] = params_.scale;
+    uniforms_.params[1] = params_.bass_warp;
+}
+
+void PlasmaAnimation::render(notcurses* /*nc*/) {
+    if (!plane_ || !is_active_) {
+        return;
+    }
+
+    ncplane_dim_yx(plane_, &plane_rows_, &plane_cols_);
+    ncplane_erase(plane_);
+    if (plane_rows_ == 0u || plane_cols_ == 0u) {
+        return;
+    }
+
+    shader_.resize(plane_rows_, plane_cols_, params_.resolution);
+    shader_.dispatch(kernel_, uniforms_);
+    shader_.blit(plane_);
+}
+
+void PlasmaAnimation::activate() {
+    is_active_ = true;
+}
+
+void PlasmaAnimation::deactivate() {
+    is_active_ = false;
+    if (plane_) {
+        ncplane_erase(plane_);
+    }
+}
+
+void PlasmaAnimation::bind_events(const AnimationConfig& config, events::EventBus& bus) {
+    bind_standard_frame_updates(this, config, bus);
+}
+
+void PlasmaAnimation::load_parameters_from_config(const AnimationConfig& config) {
+    params_.resolution = (config.plasma_resolution == "cell") ? ShaderResolution::Cell : ShaderResolution::Braille;
+    params_.speed = std::max(0.0f, config.plasma_speed);
+    params_.scale = std::max(0.1f, config.plasma_scale);
+    params_.bass_warp = std::max(0.0f, config.plasma_bass_warp);
+    params_.threshold = std::clamp(config.plasma_threshold, 0.0f, 1.0f);
+}
+
+} // namespace animations
+} // namespace when
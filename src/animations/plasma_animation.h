@@ -0,0 +1,57 @@
+#pragma once
+
+#include <notcurses/notcurses.h>
+
+#include "animation.h"
+#include "cell_shader.h"
+#include "../config.h"
+
+namespace when {
+namespace animations {
+
+// Audio-reactive plasma field rendered through the tile-parallel CellShader.
+class PlasmaAnimation : public Animation {
+public:
+    PlasmaAnimation();
+    ~PlasmaAnimation() override;
+
+    void init(notcurses* nc, const AppConfig& config) override;
+    void update(float delta_time,
+                const AudioMetrics& metrics,
+                const AudioFeatures& features) override;
+    void render(notcurses* nc) override;
+
+    void activate() override;
+    void deactivate() override;
+
+    bool is_active() const override { return is_active_; }
+    int get_z_index() const override { return z_index_; }
+    ncplane* get_plane() const override { return plane_; }
+
+    void bind_events(const AnimationConfig& config, events::EventBus& bus) override;
+
+private:
+    struct Parameters {
+        ShaderResolution resolution = ShaderResolution::Braille;
+        float speed = 0.6f;
+        float scale = 3.0f;
+        float bass_warp = 0.35f;
+        float threshold = 0.55f;
+    };
+
+    void load_parameters_from_config(const AnimationConfig& config);
+
+    ncplane* plane_ = nullptr;
+    int z_index_ = 0;
+    bool is_active_ = true;
+    unsigned int plane_rows_ = 0;
+    unsigned int plane_cols_ = 0;
+
+    Parameters params_{};
+    CellShader shader_;
+    ShaderKernel kernel_;
+    ShaderUniforms uniforms_{};
+};
+
+} // namespace animations
+} // namespace when
@@ -19,6 +19,10 @@ constexpr unsigned int kDefaultPlaneCols = 48;
 constexpr int kBrailleRowsPerCell = 4;
 constexpr int kBrailleColsPerCell = 2;
 constexpr float kTwoPi = 6.28318530717958647692f;
+// Adaptive profile resolution: control points per ridge sigma across the unit
+// width. Three keeps the spline reconstruction of a ridge within a dot.
+constexpr float kProfilePointsPerSigma = 3.0f;
+constexpr std::size_t kMinProfilePoints = 8u;
 } // namespace
 
 // Constructs the animation and seeds the internal RNG so ridge behavior is varied
@@ -108,7 +112,7 @@ void PleasureAnimation::init(notcurses* nc, const AppConfig& config) {
 
     create_or_resize_plane(nc);
 
-    configure_history_capacity();
+    configure_profile_resolution();
     last_magnitude_ = 0.0f;
     global_magnitude_ = 0.0f;
     beat_pulse_ = 0.0f;
@@ -120,7 +124,7 @@ void PleasureAnimation::init(notcurses* nc, const AppConfig& config) {
 void PleasureAnimation::update(float delta_time,
                                const AudioMetrics& /*metrics*/,
                                const AudioFeatures& features) {
-    if (history_capacity_ < 2u || lines_.empty()) {
+    if (profile_points_ < 2u || lines_.empty()) {
         return;
     }
 
@@ -167,9 +171,6 @@ void PleasureAnimation::update(float delta_time,
     beat_pulse_ += (target_pulse - beat_pulse_) * pulse_smoothing;
     beat_pulse_ = std::clamp(beat_pulse_, 0.0f, 1.5f);
 
-    if (features.downbeat) {
-        downbeat_flash_ = params_.downbeat_flash_strength;
-    }
     const float downbeat_decay = std::exp(-params_.downbeat_flash_decay * delta_time);
     downbeat_flash_ = std::max(0.0f, downbeat_flash_ * downbeat_decay);
 
@@ -257,8 +258,8 @@ void PleasureAnimation::update(float delta_time,
             initialize_line(line);
         }
 
-        if (line.line_profile.size() != history_capacity_) {
-            line.line_profile.assign(history_capacity_, 0.5f);
+        if (line.line_profile.size() != profile_points_) {
+            line.line_profile.assign(profile_points_, 0.5f);
             line.highlight_pos = 0.5f;
             line.highlight_strength = 0.0f;
         }
@@ -333,9 +334,9 @@ void PleasureAnimation::update(float delta_time,
         const float base_level =
             global_magnitude_ * 0.08f * (0.6f + 0.4f * depth_scale) + downbeat_flash_ * 0.12f * depth_scale;
 
-        for (std::size_t i = 0; i < history_capacity_; ++i) {
-            const float x_norm = (history_capacity_ > 1u)
-                                     ? static_cast<float>(i) / static_cast<float>(history_capacity_ - 1u)
+        for (std::size_t i = 0; i < profile_points_; ++i) {
+            const float x_norm = (profile_points_ > 1u)
+                                     ? static_cast<float>(i) / static_cast<float>(profile_points_ - 1u)
                                      : 0.0f;
 
             float ridge_sum = 0.0f;
@@ -392,16 +393,14 @@ void PleasureAnimation::render(notcurses* /*nc*/) {
     std::vector<uint8_t> braille_cells(rows * cols, 0);
     std::vector<int> skyline_buffer(static_cast<std::size_t>(pixel_cols), pixel_rows);
 
-    const float max_x = static_cast<float>(pixel_cols - 1);
+    raster_profile_.resize(static_cast<std::size_t>(pixel_cols));
 
     for (std::size_t line_index = 0; line_index < lines_.size(); ++line_index) {
         const auto& line = lines_[line_index];
-        const std::size_t profile_size = line.line_profile.size();
-        if (profile_size < 2u) {
+        if (line.line_profile.size() < 2u) {
             continue;
         }
 
-        const float max_index = static_cast<float>(profile_size - 1u);
         const int base_y = pixel_rows - 1 - static_cast<int>(line_index) * params_.line_spacing -
                            params_.baseline_margin;
         if (base_y < 0) {
@@ -412,35 +411,26 @@ void PleasureAnimation::render(notcurses* /*nc*/) {
         const int downward_range =
             std::min(params_.max_downward_excursion, std::max(0, pixel_rows - 1 - base_y));
 
-        for (std::size_t j = 0; j + 1 < profile_size; ++j) {
-            const float sample_a = std::clamp(line.line_profile[j], 0.0f, 1.0f);
-            const float sample_b = std::clamp(line.line_profile[j + 1], 0.0f, 1.0f);
-
-            const float centered_a = sample_a * 2.0f - 1.0f;
-            const float centered_b = sample_b * 2.0f - 1.0f;
-
-            const auto map_to_y = [&](float centered_value) {
-                if (centered_value >= 0.0f) {
-                    const int offset = static_cast<int>(std::lround(centered_value * upward_range));
-                    return base_y - offset;
-                }
-                const int offset = static_cast<int>(std::lround(-centered_value * downward_range));
-                return base_y + offset;
-            };
-
-            int y1 = std::clamp(map_to_y(centered_a), 0, pixel_rows - 1);
-            int y2 = std::clamp(map_to_y(centered_b), 0, pixel_rows - 1);
-
-            const float x_norm_a = static_cast<float>(j) / std::max(1.0f, max_index);
-            const float x_norm_b = static_cast<float>(j + 1u) / std::max(1.0f, max_index);
-
-            int x1 = static_cast<int>(std::lround(x_norm_a * max_x));
-            int x2 = static_cast<int>(std::lround(x_norm_b * max_x));
-
-            x1 = std::clamp(x1, 0, pixel_cols - 1);
-            x2 = std::clamp(x2, 0, pixel_cols - 1);
-
-            draw_occluded_line(braille_cells, rows, cols, y1, x1, y2, x2, skyline_buffer);
+        const auto map_to_y = [&](float sample) {
+            const float centered_value = std::clamp(sample, 0.0f, 1.0f) * 2.0f - 1.0f;
+            if (centered_value >= 0.0f) {
+                const int offset = static_cast<int>(std::lround(centered_value * upward_range));
+                return std::clamp(base_y - offset, 0, pixel_rows - 1);
+            }
+            const int offset = static_cast<int>(std::lround(-centered_value * downward_range));
+            return std::clamp(base_y + offset, 0, pixel_rows - 1);
+        };
+
+        // The profile is held at control-point resolution; reconstruct one
+        // sample per Braille column here so update cost is independent of width.
+        profile_spline_.fit(line.line_profile);
+        profile_spline_.resample(raster_profile_);
+
+        int previous_y = map_to_y(raster_profile_[0]);
+        for (int x = 0; x + 1 < pixel_cols; ++x) {
+            const int next_y = map_to_y(raster_profile_[static_cast<std::size_t>(x + 1)]);
+            draw_occluded_line(braille_cells, rows, cols, previous_y, x, next_y, x + 1, skyline_buffer);
+            previous_y = next_y;
         }
     }
 
@@ -465,12 +455,27 @@ void PleasureAnimation::bind_events(const AnimationConfig& config, events::Event
     bind_standard_frame_updates(this, config, bus);
 }
 
+void PleasureAnimation::bind_cues(CueScheduler& cues) {
+    cues.spawn(downbeat_flash_cue(cues));
+}
+
+// Re-arms the flash on every downbeat, including ones that fall on frames a
+// reduced update rate skips; update() decays it.
+Cue PleasureAnimation::downbeat_flash_cue(CueScheduler& cues) {
+    while (true) {
+        co_await cues.next_downbeat();
+        if (is_active_) {
+            downbeat_flash_ = params_.downbeat_flash_strength;
+        }
+    }
+}
+
 // Builds the per-line data structures based on the current plane size and history
 // capacity.
 void PleasureAnimation::initialize_line_states() {
     lines_.clear();
 
-    if (!plane_ || history_capacity_ < 2u) {
+    if (!plane_ || profile_points_ < 2u) {
         return;
     }
 
@@ -489,7 +494,7 @@ void PleasureAnimation::initialize_line_states() {
 
     lines_.resize(static_cast<std::size_t>(desired_lines));
     for (auto& line : lines_) {
-        line.line_profile.assign(history_capacity_, 0.5f);
+        line.line_profile.assign(profile_points_, 0.5f);
         line.ridges.clear();
         line.highlight_pos = 0.5f;
         line.highlight_strength = 0.0f;
@@ -501,7 +506,7 @@ void PleasureAnimation::initialize_line_states() {
 void PleasureAnimation::initialize_line(LineState& line_state) {
     line_state.ridges.clear();
 
-    if (history_capacity_ < 2u) {
+    if (profile_points_ < 2u) {
         return;
     }
 
@@ -602,6 +607,7 @@ void PleasureAnimation::load_parameters_from_config(const AnimationConfig& confi
     params_.baseline_margin = std::max(0, config_entry.pleasure_baseline_margin);
     params_.max_upward_excursion = std::max(1, config_entry.pleasure_max_upward_excursion);
     params_.max_downward_excursion = std::max(0, config_entry.pleasure_max_downward_excursion);
+    params_.profile_control_points = std::max(0, config_entry.pleasure_profile_control_points);
 }
 
 // Draws a line segment into the Braille buffer using Bresenham's algorithm while keeping
@@ -770,15 +776,22 @@ void PleasureAnimation::create_or_resize_plane(notcurses* nc) {
     }
 }
 
-// Calculates the number of samples needed to span the plane width in Braille pixels and
-// reinitializes all dependent line state.
-void PleasureAnimation::configure_history_capacity() {
-    history_capacity_ = 0u;
+// Chooses how many control points each line profile is evaluated at: the configured
+// count, or enough to resolve the narrowest ridge Gaussian, never more than the plane
+// has Braille columns. Reinitializes all dependent line state.
+void PleasureAnimation::configure_profile_resolution() {
+    profile_points_ = 0u;
 
     if (plane_) {
-        const std::size_t pixel_cols = static_cast<std::size_t>(plane_cols_) *
-                                       static_cast<std::size_t>(kBrailleColsPerCell);
-        history_capacity_ = std::max<std::size_t>(2u, pixel_cols);
+        const std::size_t pixel_cols = std::max<std::size_t>(
+            2u, static_cast<std::size_t>(plane_cols_) * static_cast<std::size_t>(kBrailleColsPerCell));
+        std::size_t points = static_cast<std::size_t>(std::max(0, params_.profile_control_points));
+        if (points == 0u) {
+            const float sigma = std::max(std::min(params_.ridge_sigma, params_.highlight_width), 1e-4f);
+            points = static_cast<std::size_t>(std::ceil(kProfilePointsPerSigma / sigma)) + 1u;
+            points = std::max(points, kMinProfilePoints);
+        }
+        profile_points_ = std::clamp<std::size_t>(points, 2u, pixel_cols);
     }
 
     initialize_line_states();
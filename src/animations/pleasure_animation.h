@@ -6,6 +6,8 @@
 #include <notcurses/notcurses.h>
 
 #include "animation.h"
+#include "cue_timeline.h"
+#include "monotone_spline.h"
 #include "../config.h"
 
 namespace when {
@@ -30,6 +32,7 @@ public:
     ncplane* get_plane() const override { return plane_; }
 
     void bind_events(const AnimationConfig& config, events::EventBus& bus) override;
+    void bind_cues(CueScheduler& cues) override;
 
 private:
     void create_or_resize_plane(notcurses* nc);
@@ -55,7 +58,8 @@ private:
                             const std::vector<uint8_t>& cells,
                             unsigned int cell_rows,
                             unsigned int cell_cols) const;
-    void configure_history_capacity();
+    void configure_profile_resolution();
+    Cue downbeat_flash_cue(CueScheduler& cues);
 
     ncplane* plane_ = nullptr;
     int z_index_ = 0;
@@ -82,7 +86,7 @@ private:
 
     struct LineState {
         std::vector<RidgeState> ridges;
-        std::vector<float> line_profile;
+        std::vector<float> line_profile; // profile_points_ control points across the plane width
         float highlight_pos = 0.5f;
         float highlight_strength = 0.0f;
     };
@@ -134,11 +138,14 @@ private:
         int baseline_margin = 4;
         int max_upward_excursion = 28;
         int max_downward_excursion = 6;
+        int profile_control_points = 0; // 0 = derive from ridge_sigma
     };
 
     std::vector<LineState> lines_;
     std::mt19937 rng_;
-    std::size_t history_capacity_ = 0u;
+    std::size_t profile_points_ = 0u;
+    MonotoneSpline profile_spline_;
+    std::vector<float> raster_profile_; // Spline resampled to one value per Braille column
     float last_magnitude_ = 0.0f;
     float global_magnitude_ = 0.0f;
     float beat_pulse_ = 0.0f;
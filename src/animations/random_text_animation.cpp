@@ -0,0 +1,222 @@
+#include "random_text_animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include "animation_event_utils.h"
+
+namespace when {
+namespace animations {
+
+namespace {
+constexpr int kSpawnAttempts = 8;
+constexpr float kBeatGlowDecay = 4.0f;
+constexpr float kBaseLevel = 0.82f;
+constexpr float kBeatGlowLevel = 0.18f;
+constexpr std::uint8_t kTextR = 235u;
+constexpr std::uint8_t kTextG = 228u;
+constexpr std::uint8_t kTextB = 210u;
+
+// Terminal columns taken by UTF-8 text, counting one per code point.
+int display_columns(std::string_view text) {
+    int columns = 0;
+    for (const char c : text) {
+        if ((static_cast<unsigned char>(c) & 0xC0u) != 0x80u) {
+            ++columns;
+        }
+    }
+    return columns;
+}
+} // namespace
+
+RandomTextAnimation::RandomTextAnimation()
+    : rng_(std::random_device{}()) {}
+
+RandomTextAnimation::~RandomTextAnimation() {
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+}
+
+void RandomTextAnimation::init(notcurses* nc, const AppConfig& config) {
+    if (plane_) {
+        ncplane_destroy(plane_);
+        plane_ = nullptr;
+    }
+
+    z_index_ = 0;
+    is_active_ = true;
+    params_ = Parameters{};
+    active_lines_.clear();
+    cooldown_remaining_ = 0.0f;
+    beat_glow_ = 0.0f;
+    corpus_.close();
+
+    const AnimationConfig* own_config = nullptr;
+    for (const auto& anim_config : config.animations) {
+        if (anim_config.type == "RandomText") {
+            own_config = &anim_config;
+            break;
+        }
+    }
+
+    if (own_config) {
+        z_index_ = own_config->z_index;
+        is_active_ = own_config->initially_active;
+        load_parameters_from_config(*own_config);
+        // A missing corpus leaves the layer blank rather than failing startup.
+        if (!own_config->text_file_path.empty() && !corpus_.open(own_config->text_file_path)) {
+            std::clog << "[RandomText] " << corpus_.last_error() << std::endl;
+        }
+    }
+
+    plane_ = create_configured_plane(nc, own_config, plane_rows_, plane_cols_);
+}
+
+void RandomTextAnimation::load_parameters_from_config(const AnimationConfig& config) {
+    params_.type_speed_words_per_s = std::max(config.type_speed_words_per_s, 0.1f);
+    params_.display_duration_s = std::max(config.display_duration_s, 0.0f);
+    params_.fade_duration_s = std::max(config.fade_duration_s, 0.0f);
+    params_.trigger_cooldown_s = std::max(config.trigger_cooldown_s, 0.0f);
+    params_.max_active_lines = std::max(config.max_active_lines, 1);
+    params_.min_y_ratio = std::clamp(config.random_text_min_y_ratio, 0.0f, 1.0f);
+    params_.max_y_ratio = std::clamp(config.random_text_max_y_ratio, 0.0f, 1.0f);
+    if (params_.min_y_ratio > params_.max_y_ratio) {
+        std::swap(params_.min_y_ratio, params_.max_y_ratio);
+    }
+}
+
+void RandomTextAnimation::update(float delta_time,
+                                 const AudioMetrics& /*metrics*/,
+                                 const AudioFeatures& features) {
+    if (!plane_ || !corpus_.is_open()) {
+        return;
+    }
+
+    ncplane_dim_yx(plane_, &plane_rows_, &plane_cols_);
+    const float dt = std::max(delta_time, 0.0f);
+
+    beat_glow_ = std::max(0.0f, beat_glow_ - dt * kBeatGlowDecay);
+    if (features.beat_detected) {
+        beat_glow_ = 1.0f;
+    }
+
+    const float lifetime_tail = params_.display_duration_s + params_.fade_duration_s;
+    for (auto& line : active_lines_) {
+        line.age += dt;
+        const auto typed = static_cast<std::size_t>(line.age * params_.type_speed_words_per_s) + 1u;
+        line.revealed_words = std::min(line.word_count, typed);
+    }
+    active_lines_.erase(std::remove_if(active_lines_.begin(),
+                                       active_lines_.end(),
+                                       [lifetime_tail](const ActiveLine& line) {
+                                           return line.age >= line.reveal_duration + lifetime_tail;
+                                       }),
+                        active_lines_.end());
+
+    // Beats start new lines; an empty screen starts one without waiting.
+    cooldown_remaining_ = std::max(0.0f, cooldown_remaining_ - dt);
+    const bool wants_line = features.beat_detected || active_lines_.empty();
+    if (wants_line && cooldown_remaining_ <= 0.0f &&
+        active_lines_.size() < static_cast<std::size_t>(params_.max_active_lines)) {
+        if (spawn_line()) {
+            cooldown_remaining_ = params_.trigger_cooldown_s;
+        }
+    }
+}
+
+bool RandomTextAnimation::spawn_line() {
+    if (plane_rows_ == 0u || plane_cols_ == 0u || corpus_.line_count() == 0u) {
+        return false;
+    }
+
+    const int last_row = static_cast<int>(plane_rows_) - 1;
+    const int min_row = static_cast<int>(std::floor(params_.min_y_ratio * static_cast<float>(last_row)));
+    const int max_row = std::max(min_row, static_cast<int>(std::ceil(params_.max_y_ratio * static_cast<float>(last_row))));
+    std::uniform_int_distribution<int> row_dist(min_row, max_row);
+    std::uniform_int_distribution<std::size_t> line_dist(0u, corpus_.line_count() - 1u);
+
+    for (int attempt = 0; attempt < kSpawnAttempts; ++attempt) {
+        const int row = row_dist(rng_);
+        const bool taken = std::any_of(active_lines_.begin(), active_lines_.end(), [row](const ActiveLine& line) {
+            return line.row == row;
+        });
+        if (taken) {
+            continue;
+        }
+
+        ActiveLine line;
+        line.line_index = line_dist(rng_);
+        line.word_count = corpus_.words_in_line(line.line_index);
+        line.revealed_words = 1u;
+        line.row = row;
+        const int width = display_columns(corpus_.line(line.line_index));
+        const int slack = std::max(0, static_cast<int>(plane_cols_) - width);
+        line.col = std::uniform_int_distribution<int>(0, slack)(rng_);
+        line.reveal_duration =
+            static_cast<float>(line.word_count > 0u ? line.word_count - 1u : 0u) / params_.type_speed_words_per_s;
+        active_lines_.push_back(line);
+        return true;
+    }
+    return false;
+}
+
+float RandomTextAnimation::line_brightness(const ActiveLine& line) const {
+    const float fade_start = line.reveal_duration + params_.display_duration_s;
+    if (line.age <= fade_start) {
+        return 1.0f;
+    }
+    if (params_.fade_duration_s <= 0.0f) {
+        return 0.0f;
+    }
+    return std::clamp(1.0f - (line.age - fade_start) / params_.fade_duration_s, 0.0f, 1.0f);
+}
+
+void RandomTextAnimation::render(notcurses* /*nc*/) {
+    if (!plane_ || !is_active_) {
+        return;
+    }
+
+    ncplane_erase(plane_);
+    if (!corpus_.is_open()) {
+        return;
+    }
+
+    const float level = kBaseLevel + kBeatGlowLevel * beat_glow_;
+    for (const auto& line : active_lines_) {
+        const std::string_view text = corpus_.line_prefix(line.line_index, line.revealed_words);
+        if (text.empty() || line.row >= static_cast<int>(plane_rows_)) {
+            continue;
+        }
+
+        const float brightness = std::clamp(line_brightness(line) * level, 0.0f, 1.0f);
+        ncplane_set_fg_rgb8(plane_,
+                            static_cast<unsigned int>(std::lround(kTextR * brightness)),
+                            static_cast<unsigned int>(std::lround(kTextG * brightness)),
+                            static_cast<unsigned int>(std::lround(kTextB * brightness)));
+        // Text past the plane edge is clipped by notcurses.
+        ncplane_putnstr_yx(plane_, line.row, line.col, text.size(), text.data());
+    }
+}
+
+void RandomTextAnimation::activate() {
+    is_active_ = true;
+}
+
+void RandomTextAnimation::deactivate() {
+    is_active_ = false;
+    active_lines_.clear();
+    if (plane_) {
+        ncplane_erase(plane_);
+    }
+}
+
+void RandomTextAnimation::bind_events(const AnimationConfig& config, events::EventBus& bus) {
+    bind_standard_frame_updates(this, config, bus);
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <notcurses/notcurses.h>
+
+#include "animation.h"
+#include "text_corpus.h"
+
+namespace when {
+namespace animations {
+
+// Types random lines from a text corpus word by word on beats, holds them, then
+// fades them out. Lines are string_views into the mapped corpus, so nothing is
+// copied per frame.
+class RandomTextAnimation : public Animation {
+public:
+    RandomTextAnimation();
+    ~RandomTextAnimation() override;
+
+    void init(notcurses* nc, const AppConfig& config) override;
+    void update(float delta_time,
+                const AudioMetrics& metrics,
+                const AudioFeatures& features) override;
+    void render(notcurses* nc) override;
+
+    void activate() override;
+    void deactivate() override;
+
+    bool is_active() const override { return is_active_; }
+    int get_z_index() const override { return z_index_; }
+    ncplane* get_plane() const override { return plane_; }
+
+    void bind_events(const AnimationConfig& config, events::EventBus& bus) override;
+
+private:
+    struct ActiveLine {
+        std::size_t line_index = 0;
+        std::size_t word_count = 0;
+        std::size_t revealed_words = 0;
+        int row = 0;
+        int col = 0;
+        float age = 0.0f;
+        float reveal_duration = 0.0f; // Time until the last word appears
+    };
+
+    struct Parameters {
+        float type_speed_words_per_s = 4.0f;
+        float display_duration_s = 3.0f;
+        float fade_duration_s = 1.0f;
+        float trigger_cooldown_s = 0.75f;
+        int max_active_lines = 4;
+        float min_y_ratio = 0.0f;
+        float max_y_ratio = 1.0f;
+    };
+
+    void load_parameters_from_config(const AnimationConfig& config);
+    bool spawn_line();
+    float line_brightness(const ActiveLine& line) const;
+
+    ncplane* plane_ = nullptr;
+    int z_index_ = 0;
+    bool is_active_ = true;
+    unsigned int plane_rows_ = 0;
+    unsigned int plane_cols_ = 0;
+
+    Parameters params_{};
+    TextCorpus corpus_;
+    std::vector<ActiveLine> active_lines_;
+    float cooldown_remaining_ = 0.0f;
+    float beat_glow_ = 0.0f;
+    std::mt19937 rng_;
+};
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,250 @@
+#include "text_corpus.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace when {
+namespace animations {
+namespace {
+constexpr std::array<char, 8> kIndexMagic{'W', 'H', 'E', 'N', 'T', 'X', 'T', '1'};
+
+struct IndexHeader {
+    std::array<char, 8> magic{};
+    std::uint64_t file_size = 0;
+    std::int64_t mtime = 0;
+    std::uint64_t line_count = 0;
+    std::uint64_t word_count = 0;
+};
+
+bool is_word_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+} // namespace
+
+TextCorpus::~TextCorpus() {
+    close();
+}
+
+void TextCorpus::close() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    lines_.clear();
+    words_.clear();
+    loaded_from_cache_ = false;
+}
+
+bool TextCorpus::open(const std::string& path, bool use_cache) {
+    close();
+    last_error_.clear();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        last_error_ = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        last_error_ = "cannot stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    const auto file_size = static_cast<std::uint64_t>(info.st_size);
+    if (file_size == 0) {
+        last_error_ = path + " is empty";
+        ::close(fd);
+        return false;
+    }
+    if (file_size > std::numeric_limits<std::uint32_t>::max()) {
+        last_error_ = path + " exceeds the 4 GiB index limit";
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = ::mmap(nullptr, static_cast<std::size_t>(file_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        last_error_ = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    data_ = static_cast<const char*>(mapping);
+    size_ = static_cast<std::size_t>(file_size);
+#ifdef MADV_RANDOM
+    // Lines are picked at random; readahead would mostly fetch unused pages.
+    ::madvise(mapping, size_, MADV_RANDOM);
+#endif
+
+    std::error_code ec;
+    const auto write_time = std::filesystem::last_write_time(path, ec);
+    const std::int64_t mtime = ec ? 0 : static_cast<std::int64_t>(write_time.time_since_epoch().count());
+    const std::string index_path = path + kIndexSuffix;
+
+    if (use_cache && load_index(index_path, file_size, mtime)) {
+        loaded_from_cache_ = true;
+    } else {
+        build_index();
+        if (use_cache && !lines_.empty()) {
+            save_index(index_path, file_size, mtime);
+        }
+    }
+
+    if (lines_.empty()) {
+        last_error_ = path + " contains no words";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TextCorpus::build_index() {
+    lines_.clear();
+    words_.clear();
+
+    LineEntry current{};
+    std::size_t i = 0;
+    while (i < size_) {
+        const char c = data_[i];
+        if (c == '\n') {
+            if (current.word_count > 0) {
+                lines_.push_back(current);
+            }
+            current = LineEntry{};
+            ++i;
+            continue;
+        }
+        if (is_word_space(c)) {
+            ++i;
+            continue;
+        }
+
+        const std::size_t start = i;
+        while (i < size_ && data_[i] != '\n' && !is_word_space(data_[i])) {
+            ++i;
+        }
+        if (current.word_count == 0) {
+            current.first_word = static_cast<std::uint32_t>(words_.size());
+        }
+        words_.push_back({static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(i - start)});
+        ++current.word_count;
+    }
+    if (current.word_count > 0) {
+        lines_.push_back(current);
+    }
+}
+
+bool TextCorpus::load_index(const std::string& index_path, std::uint64_t file_size, std::int64_t mtime) {
+    std::ifstream in(index_path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    IndexHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != kIndexMagic ||
+        header.file_size != file_size || header.mtime != mtime || header.line_count > header.word_count ||
+        header.word_count > file_size) {
+        return false;
+    }
+
+    std::vector<LineEntry> lines(static_cast<std::size_t>(header.line_count));
+    std::vector<WordEntry> words(static_cast<std::size_t>(header.word_count));
+    if (!in.read(reinterpret_cast<char*>(lines.data()), static_cast<std::streamsize>(lines.size() * sizeof(LineEntry))) ||
+        !in.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(WordEntry)))) {
+        return false;
+    }
+
+    // A stale or damaged cache must never produce views outside the mapping.
+    for (const LineEntry& entry : lines) {
+        if (entry.word_count == 0 ||
+            static_cast<std::uint64_t>(entry.first_word) + entry.word_count > words.size()) {
+            return false;
+        }
+    }
+    // Words must also ascend without overlap, or line_prefix would underflow.
+    std::uint64_t previous_end = 0;
+    for (const WordEntry& entry : words) {
+        const std::uint64_t end = static_cast<std::uint64_t>(entry.offset) + entry.length;
+        if (entry.offset < previous_end || end > size_) {
+            return false;
+        }
+        previous_end = end;
+    }
+
+    lines_ = std::move(lines);
+    words_ = std::move(words);
+    return true;
+}
+
+void TextCorpus::save_index(const std::string& index_path, std::uint64_t file_size, std::int64_t mtime) const {
+    IndexHeader header;
+    header.magic = kIndexMagic;
+    header.file_size = file_size;
+    header.mtime = mtime;
+    header.line_count = lines_.size();
+    header.word_count = words_.size();
+
+    // Best effort: a read-only corpus directory just means no cache.
+    const std::string temp_path = index_path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(lines_.data()),
+                  static_cast<std::streamsize>(lines_.size() * sizeof(LineEntry)));
+        out.write(reinterpret_cast<const char*>(words_.data()),
+                  static_cast<std::streamsize>(words_.size() * sizeof(WordEntry)));
+        if (!out) {
+            out.close();
+            std::remove(temp_path.c_str());
+            return;
+        }
+    }
+    if (std::rename(temp_path.c_str(), index_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+    }
+}
+
+std::size_t TextCorpus::words_in_line(std::size_t line) const {
+    return line < lines_.size() ? lines_[line].word_count : 0u;
+}
+
+std::string_view TextCorpus::line(std::size_t line) const {
+    return line_prefix(line, words_in_line(line));
+}
+
+std::string_view TextCorpus::word(std::size_t line, std::size_t word) const {
+    if (line >= lines_.size() || word >= lines_[line].word_count) {
+        return {};
+    }
+    const WordEntry& entry = words_[lines_[line].first_word + word];
+    return {data_ + entry.offset, entry.length};
+}
+
+std::string_view TextCorpus::line_prefix(std::size_t line, std::size_t words) const {
+    if (line >= lines_.size() || words == 0) {
+        return {};
+    }
+    const LineEntry& entry = lines_[line];
+    const WordEntry& first = words_[entry.first_word];
+    const WordEntry& last = words_[entry.first_word + std::min<std::size_t>(words, entry.word_count) - 1];
+    return {data_ + first.offset, static_cast<std::size_t>(last.offset + last.length - first.offset)};
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace when {
+namespace animations {
+
+// Read-only view of a large text file: the file is memory-mapped and indexed
+// once into line and word offset tables, so picking a line or revealing its
+// first N words is an O(1) string_view into the mapping. Blank lines are not
+// indexed; line text excludes leading and trailing whitespace.
+class TextCorpus {
+public:
+    // Appended to the corpus path for the on-disk index cache.
+    static constexpr const char* kIndexSuffix = ".idx";
+
+    TextCorpus() = default;
+    ~TextCorpus();
+
+    TextCorpus(const TextCorpus&) = delete;
+    TextCorpus& operator=(const TextCorpus&) = delete;
+
+    // Maps path and loads its index from the cache when the cached size and
+    // modification time still match, otherwise rebuilds it (and, with
+    // use_cache, tries to rewrite the cache). Returns false if the file cannot
+    // be mapped or holds no words.
+    bool open(const std::string& path, bool use_cache = true);
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+    bool loaded_from_cache() const { return loaded_from_cache_; }
+    const std::string& last_error() const { return last_error_; }
+
+    std::size_t line_count() const { return lines_.size(); }
+    std::size_t total_words() const { return words_.size(); }
+    std::size_t words_in_line(std::size_t line) const;
+    std::string_view line(std::size_t line) const;
+    std::string_view word(std::size_t line, std::size_t word) const;
+    // The line from its first word through the end of word `words - 1`,
+    // including the original spacing between them.
+    std::string_view line_prefix(std::size_t line, std::size_t words) const;
+
+private:
+    struct LineEntry {
+        std::uint32_t first_word = 0;
+        std::uint32_t word_count = 0;
+    };
+
+    struct WordEntry {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    void build_index();
+    bool load_index(const std::string& index_path, std::uint64_t file_size, std::int64_t mtime);
+    void save_index(const std::string& index_path, std::uint64_t file_size, std::int64_t mtime) const;
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::vector<LineEntry> lines_;
+    std::vector<WordEntry> words_;
+    bool loaded_from_cache_ = false;
+    std::string last_error_;
+};
+
+} // namespace animations
+} // namespace when
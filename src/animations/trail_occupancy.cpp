@@ -0,0 +1,102 @@
+#include "trail_occupancy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace when {
+namespace animations {
+namespace {
+// Half-cell steps visit every cell a segment crosses at this resolution.
+constexpr float kWalkStepCells = 0.5f;
+} // namespace
+
+void TrailOccupancyGrid::resize(int cols, int rows) {
+    cols_ = std::max(cols, 1);
+    rows_ = std::max(rows, 1);
+    counts_.assign(static_cast<std::size_t>(cols_) * static_cast<std::size_t>(rows_), 0u);
+    occupied_cells_ = 0;
+}
+
+void TrailOccupancyGrid::clear() {
+    std::fill(counts_.begin(), counts_.end(), 0u);
+    occupied_cells_ = 0;
+}
+
+float TrailOccupancyGrid::cell_size() const {
+    return cols_ > 0 && rows_ > 0 ? 1.0f / static_cast<float>(std::max(cols_, rows_)) : 1.0f;
+}
+
+int TrailOccupancyGrid::cell_index(float x, float y) const {
+    if (counts_.empty() || !(x >= 0.0f && x <= 1.0f && y >= 0.0f && y <= 1.0f)) {
+        return -1;
+    }
+    const int col = std::min(static_cast<int>(x * static_cast<float>(cols_)), cols_ - 1);
+    const int row = std::min(static_cast<int>(y * static_cast<float>(rows_)), rows_ - 1);
+    return row * cols_ + col;
+}
+
+template<typename Visit>
+void TrailOccupancyGrid::walk_segment(float x0, float y0, float x1, float y1, Visit&& visit) const {
+    const float dx = x1 - x0;
+    const float dy = y1 - y0;
+    const float span_cells = std::max(std::abs(dx) * static_cast<float>(cols_), std::abs(dy) * static_cast<float>(rows_));
+    const int steps = std::max(1, static_cast<int>(std::ceil(span_cells / kWalkStepCells)));
+    int previous = -1;
+    for (int step = 0; step <= steps; ++step) {
+        const float t = static_cast<float>(step) / static_cast<float>(steps);
+        const int index = cell_index(x0 + dx * t, y0 + dy * t);
+        if (index >= 0 && index != previous) {
+            visit(static_cast<std::size_t>(index));
+            previous = index;
+        }
+    }
+}
+
+void TrailOccupancyGrid::add_segment(float x0, float y0, float x1, float y1) {
+    walk_segment(x0, y0, x1, y1, [this](std::size_t index) {
+        std::uint32_t& count = counts_[index];
+        if (count == std::numeric_limits<std::uint32_t>::max()) {
+            return;
+        }
+        if (count++ == 0u) {
+            ++occupied_cells_;
+        }
+    });
+}
+
+void TrailOccupancyGrid::remove_segment(float x0, float y0, float x1, float y1) {
+    walk_segment(x0, y0, x1, y1, [this](std::size_t index) {
+        std::uint32_t& count = counts_[index];
+        // Once saturated the true count is unknown, so the cell stays covered.
+        if (count == 0u || count == std::numeric_limits<std::uint32_t>::max()) {
+            return;
+        }
+        if (--count == 0u) {
+            --occupied_cells_;
+        }
+    });
+}
+
+bool TrailOccupancyGrid::occupied(float x, float y) const {
+    const int index = cell_index(x, y);
+    return index >= 0 && counts_[static_cast<std::size_t>(index)] > 0u;
+}
+
+float TrailOccupancyGrid::clearance(float x,
+                                    float y,
+                                    float dx,
+                                    float dy,
+                                    float skip_distance,
+                                    float max_distance) const {
+    const float step = cell_size() * kWalkStepCells;
+    for (float distance = std::max(skip_distance, 0.0f); distance <= max_distance; distance += step) {
+        if (occupied(x + dx * distance, y + dy * distance)) {
+            return distance;
+        }
+    }
+    return max_distance;
+}
+
+} // namespace animations
+} // namespace when
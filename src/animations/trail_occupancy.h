@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace when {
+namespace animations {
+
+// Coverage counts for trail segments over the unit square. Segments are added
+// as samples are appended and removed as they expire, so queries never walk
+// the trail itself: a point test is one lookup and a look-ahead probe touches
+// a fixed number of cells regardless of how long trails live.
+class TrailOccupancyGrid {
+public:
+    void resize(int cols, int rows);
+    void clear();
+
+    void add_segment(float x0, float y0, float x1, float y1);
+    void remove_segment(float x0, float y0, float x1, float y1);
+
+    bool occupied(float x, float y) const;
+    // Probes from (x, y) along the unit direction (dx, dy), skipping the first
+    // skip_distance so a head does not see its own latest sample. Returns the
+    // distance to the first occupied cell, or max_distance when clear.
+    float clearance(float x, float y, float dx, float dy, float skip_distance, float max_distance) const;
+
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+    float cell_size() const;
+    std::size_t occupied_cells() const { return occupied_cells_; }
+
+private:
+    template<typename Visit>
+    void walk_segment(float x0, float y0, float x1, float y1, Visit&& visit) const;
+    int cell_index(float x, float y) const;
+
+    int cols_ = 0;
+    int rows_ = 0;
+    std::vector<std::uint32_t> counts_; // A saturated count sticks until clear()
+    std::size_t occupied_cells_ = 0;
+};
+
+} // namespace animations
+} // namespace when
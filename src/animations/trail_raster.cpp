@@ -0,0 +1,148 @@
+#include "trail_raster.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace when {
+namespace animations {
+namespace {
+// Fraction of the spacing that must be covered before a turn forces a sample.
+constexpr float kTurnSampleFraction = 0.25f;
+constexpr float kMinRadius = 0.1f;
+constexpr float kDirectionEpsilon = 1.0e-6f;
+} // namespace
+
+void TrailSampleGate::configure(float spacing, float max_turn_radians) {
+    spacing_ = std::max(spacing, 1.0e-5f);
+    cos_max_turn_ = std::cos(std::clamp(max_turn_radians, 0.0f, 3.14159265f));
+}
+
+void TrailSampleGate::reset() {
+    travelled_ = 0.0f;
+    heading_x_ = 0.0f;
+    heading_y_ = 0.0f;
+    has_sample_ = false;
+    has_heading_ = false;
+}
+
+bool TrailSampleGate::advance(float step_length, float anchor_x, float anchor_y, float x, float y) {
+    travelled_ += std::max(step_length, 0.0f);
+    if (!has_sample_) {
+        mark_sample(anchor_x, anchor_y, x, y);
+        return true;
+    }
+
+    bool emit = travelled_ >= spacing_;
+    if (!emit && has_heading_ && travelled_ >= spacing_ * kTurnSampleFraction) {
+        const float dx = x - anchor_x;
+        const float dy = y - anchor_y;
+        const float length = std::sqrt(dx * dx + dy * dy);
+        if (length > kDirectionEpsilon) {
+            emit = (dx * heading_x_ + dy * heading_y_) / length < cos_max_turn_;
+        }
+    }
+
+    if (emit) {
+        mark_sample(anchor_x, anchor_y, x, y);
+    }
+    return emit;
+}
+
+void TrailSampleGate::mark_sample(float anchor_x, float anchor_y, float x, float y) {
+    if (has_sample_) {
+        const float dx = x - anchor_x;
+        const float dy = y - anchor_y;
+        const float length = std::sqrt(dx * dx + dy * dy);
+        if (length > kDirectionEpsilon) {
+            heading_x_ = dx / length;
+            heading_y_ = dy / length;
+            has_heading_ = true;
+        }
+    }
+    has_sample_ = true;
+    travelled_ = 0.0f;
+}
+
+void TrailRasterizer::resize(int dot_cols, int dot_rows) {
+    dot_cols = std::max(dot_cols, 0);
+    dot_rows = std::max(dot_rows, 0);
+    if (dot_cols == dot_cols_ && dot_rows == dot_rows_) {
+        return;
+    }
+
+    dot_cols_ = dot_cols;
+    dot_rows_ = dot_rows;
+    const std::size_t dot_count = static_cast<std::size_t>(dot_cols_) * static_cast<std::size_t>(dot_rows_);
+    intensity_.assign(dot_count, 0.0f);
+    color_.assign(dot_count, std::array<float, 3>{});
+    touched_.clear();
+}
+
+void TrailRasterizer::draw_segment(const TrailVertex& a, const TrailVertex& b) {
+    if (dot_cols_ <= 0 || dot_rows_ <= 0 || (a.brightness <= 0.0f && b.brightness <= 0.0f)) {
+        return;
+    }
+
+    const float radius_a = std::max(a.radius, kMinRadius);
+    const float radius_b = std::max(b.radius, kMinRadius);
+    const float reach = std::max(radius_a, radius_b);
+    const int min_x = std::max(0, static_cast<int>(std::floor(std::min(a.x, b.x) - reach)));
+    const int max_x = std::min(dot_cols_ - 1, static_cast<int>(std::ceil(std::max(a.x, b.x) + reach)));
+    const int min_y = std::max(0, static_cast<int>(std::floor(std::min(a.y, b.y) - reach)));
+    const int max_y = std::min(dot_rows_ - 1, static_cast<int>(std::ceil(std::max(a.y, b.y) + reach)));
+    if (min_x > max_x || min_y > max_y) {
+        return;
+    }
+
+    const float seg_x = b.x - a.x;
+    const float seg_y = b.y - a.y;
+    const float seg_length_sq = seg_x * seg_x + seg_y * seg_y;
+    const float inv_length_sq = seg_length_sq > kDirectionEpsilon ? 1.0f / seg_length_sq : 0.0f;
+
+    for (int dot_y = min_y; dot_y <= max_y; ++dot_y) {
+        const float py = static_cast<float>(dot_y) - a.y;
+        for (int dot_x = min_x; dot_x <= max_x; ++dot_x) {
+            const float px = static_cast<float>(dot_x) - a.x;
+            const float t = std::clamp((px * seg_x + py * seg_y) * inv_length_sq, 0.0f, 1.0f);
+            const float dx = px - seg_x * t;
+            const float dy = py - seg_y * t;
+            const float radius = radius_a + (radius_b - radius_a) * t;
+            const float distance_sq = dx * dx + dy * dy;
+            if (distance_sq > radius * radius) {
+                continue;
+            }
+
+            const float falloff = 1.0f - std::sqrt(distance_sq) / radius;
+            const float brightness = a.brightness + (b.brightness - a.brightness) * t;
+            const float intensity = brightness * falloff * falloff;
+            if (intensity <= 0.0f) {
+                continue;
+            }
+
+            const std::size_t index =
+                static_cast<std::size_t>(dot_y) * static_cast<std::size_t>(dot_cols_) + static_cast<std::size_t>(dot_x);
+            float& stored = intensity_[index];
+            if (intensity <= stored) {
+                continue;
+            }
+            if (stored <= 0.0f) {
+                touched_.push_back(static_cast<std::uint32_t>(index));
+            }
+            stored = intensity;
+            for (std::size_t channel = 0; channel < 3; ++channel) {
+                color_[index][channel] = a.color[channel] + (b.color[channel] - a.color[channel]) * t;
+            }
+        }
+    }
+}
+
+float TrailRasterizer::intensity_at(int dot_col, int dot_row) const {
+    if (dot_col < 0 || dot_row < 0 || dot_col >= dot_cols_ || dot_row >= dot_rows_) {
+        return 0.0f;
+    }
+    return intensity_[static_cast<std::size_t>(dot_row) * static_cast<std::size_t>(dot_cols_) +
+                      static_cast<std::size_t>(dot_col)];
+}
+
+} // namespace animations
+} // namespace when
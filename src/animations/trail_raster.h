@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace when {
+namespace animations {
+
+// Trail samples are laid down every kTrailSpacingDots Braille dots of travel,
+// or sooner when the heading turns by more than kTrailMaxTurnRadians.
+constexpr float kTrailSpacingDots = 1.5f;
+constexpr float kTrailMaxTurnRadians = 0.35f;
+// Dot span assumed until the first frame knows the plane size: an 80-column
+// terminal is 160 Braille dots wide.
+constexpr float kDefaultTrailDotSpan = 80.0f * 2.0f;
+
+// Normalised sample spacing that keeps samples kTrailSpacingDots apart when
+// the unit square spans dot_scale_x by dot_scale_y dots.
+constexpr float trail_spacing_for(float dot_scale_x, float dot_scale_y) {
+    return kTrailSpacingDots / std::max(1.0f, std::max(dot_scale_x, dot_scale_y));
+}
+
+constexpr float kDefaultTrailSpacing = trail_spacing_for(kDefaultTrailDotSpan, kDefaultTrailDotSpan);
+
+// Decides when a moving head should lay down a new trail sample. Samples are
+// spaced by arc length travelled, with an early sample when the heading
+// turns sharply, so trail density follows the path rather than the frame rate.
+class TrailSampleGate {
+public:
+    // spacing is in the same units as the positions; max_turn_radians is the
+    // heading change that forces a sample once a quarter of spacing is covered.
+    void configure(float spacing, float max_turn_radians);
+    void reset();
+
+    // Advances by the distance moved since the previous call and returns true
+    // when (x, y) should be stored. anchor is the most recent stored sample.
+    bool advance(float step_length, float anchor_x, float anchor_y, float x, float y);
+    // Records that a sample was stored at (x, y) regardless of advance().
+    void mark_sample(float anchor_x, float anchor_y, float x, float y);
+
+    float spacing() const { return spacing_; }
+    bool has_sample() const { return has_sample_; }
+
+private:
+    float spacing_ = 0.01f;
+    float cos_max_turn_ = 0.9f;
+    float travelled_ = 0.0f;
+    float heading_x_ = 0.0f;
+    float heading_y_ = 0.0f;
+    bool has_sample_ = false;
+    bool has_heading_ = false;
+};
+
+// One end of a trail segment in Braille dot coordinates.
+struct TrailVertex {
+    float x = 0.0f;
+    float y = 0.0f;
+    float brightness = 0.0f;
+    float radius = 1.0f; // Dots
+    std::array<float, 3> color{1.0f, 1.0f, 1.0f};
+};
+
+// Rasterises thick trail segments onto a Braille dot grid. Within a layer each
+// dot keeps the brightest coverage, so joints between consecutive segments do
+// not double up; flush() then adds the layer into the caller's cell buffers.
+class TrailRasterizer {
+public:
+    void resize(int dot_cols, int dot_rows);
+
+    // Capsule from a to b with brightness, radius and colour interpolated
+    // along the segment and a (1 - d/r)^2 falloff across it.
+    void draw_segment(const TrailVertex& a, const TrailVertex& b);
+    void draw_dot(const TrailVertex& vertex) { draw_segment(vertex, vertex); }
+
+    // Sets Braille bits in masks (cell_cols cells per row) and calls
+    // sink(cell_index, intensity, color) for every covered dot, then clears
+    // the layer. Returns whether any dot was covered.
+    template<typename Sink>
+    bool flush(std::vector<std::uint8_t>& masks, int cell_cols, Sink&& sink);
+
+    int dot_cols() const { return dot_cols_; }
+    int dot_rows() const { return dot_rows_; }
+    std::size_t covered_dots() const { return touched_.size(); }
+    float intensity_at(int dot_col, int dot_row) const;
+
+private:
+    static constexpr int kDotRowsPerCell = 4;
+    static constexpr int kDotColsPerCell = 2;
+    static constexpr std::uint8_t kDotBits[kDotRowsPerCell][kDotColsPerCell] = {
+        {0x01u, 0x08u},
+        {0x02u, 0x10u},
+        {0x04u, 0x20u},
+        {0x40u, 0x80u},
+    };
+
+    int dot_cols_ = 0;
+    int dot_rows_ = 0;
+    std::vector<float> intensity_;
+    std::vector<std::array<float, 3>> color_;
+    std::vector<std::uint32_t> touched_;
+};
+
+template<typename Sink>
+bool TrailRasterizer::flush(std::vector<std::uint8_t>& masks, int cell_cols, Sink&& sink) {
+    const bool wrote = !touched_.empty();
+    for (const std::uint32_t dot : touched_) {
+        const int dot_row = static_cast<int>(dot) / dot_cols_;
+        const int dot_col = static_cast<int>(dot) % dot_cols_;
+        const std::size_t cell_index =
+            static_cast<std::size_t>(dot_row / kDotRowsPerCell) * static_cast<std::size_t>(cell_cols) +
+            static_cast<std::size_t>(dot_col / kDotColsPerCell);
+        if (cell_index < masks.size()) {
+            masks[cell_index] |= kDotBits[dot_row % kDotRowsPerCell][dot_col % kDotColsPerCell];
+            sink(cell_index, intensity_[dot], color_[dot]);
+        }
+        intensity_[dot] = 0.0f;
+    }
+    touched_.clear();
+    return wrote;
+}
+
+} // namespace animations
+} // namespace when
@@ -0,0 +1,86 @@
+#include "audio/analysis_stage.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace when {
+
+void AnalysisStageHost::add_stage(std::unique_ptr<AnalysisStage> stage,
+                                  float sample_rate,
+                                  std::size_t fft_size,
+                                  std::size_t band_count) {
+    if (!stage) {
+        return;
+    }
+
+    stage->prepare(sample_rate, fft_size, band_count);
+    const std::vector<std::string> names = stage->channel_names();
+
+    Slot slot;
+    slot.id = stage->id();
+    slot.first_channel = channel_values_.size();
+    slot.channel_count = names.size();
+    slot.stage = std::move(stage);
+    channel_values_.resize(channel_values_.size() + names.size(), 0.0f);
+    channel_names_.insert(channel_names_.end(), names.begin(), names.end());
+    stages_.push_back(std::move(slot));
+    status_changes_.clear(); // Ids may have moved with stages_
+    status_changes_.reserve(stages_.size());
+}
+
+void AnalysisStageHost::process(const FeatureInputFrame& frame) {
+    status_changes_.clear();
+    for (Slot& slot : stages_) {
+        if (slot.bypassed) {
+            slot.probe_in_seconds -= frame.frame_period;
+            if (slot.probe_in_seconds > 0.0f) {
+                continue;
+            }
+        }
+
+        const std::span<float> out(channel_values_.data() + slot.first_channel, slot.channel_count);
+        const double start = now_seconds_();
+        slot.stage->process(frame, out);
+        const double elapsed = now_seconds_() - start;
+
+        if (budget_seconds_ <= 0.0f || elapsed <= budget_seconds_) {
+            slot.consecutive_overruns = 0;
+            if (slot.bypassed) {
+                slot.bypassed = false;
+                slot.cooldown_seconds = kBypassCooldownSeconds;
+                status_changes_.push_back({slot.id, false});
+            }
+            continue;
+        }
+        if (slot.bypassed) {
+            // Failed re-probe: stay bypassed and wait longer before the next one.
+            slot.cooldown_seconds = std::min(slot.cooldown_seconds * 2.0f, kMaxBypassCooldownSeconds);
+            bypass(slot, out);
+            continue;
+        }
+        if (++slot.consecutive_overruns < kMaxConsecutiveOverruns) {
+            continue;
+        }
+
+        slot.bypassed = true;
+        bypass(slot, out);
+        status_changes_.push_back({slot.id, true});
+    }
+}
+
+double AnalysisStageHost::steady_seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void AnalysisStageHost::bypass(Slot& slot, std::span<float> out) {
+    slot.consecutive_overruns = 0;
+    slot.probe_in_seconds = slot.cooldown_seconds;
+    std::fill(out.begin(), out.end(), 0.0f);
+}
+
+std::size_t AnalysisStageHost::bypassed_stages() const {
+    return static_cast<std::size_t>(
+        std::count_if(stages_.begin(), stages_.end(), [](const Slot& slot) { return slot.bypassed; }));
+}
+
+} // namespace when
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "audio/feature_input_frame.h"
+
+namespace when {
+
+// Custom analysis step run by the DSP for every hop, on the analysis thread.
+// A stage owns a fixed set of named float channels; their slots are reserved
+// when the stage is added so per-hop processing never allocates.
+class AnalysisStage {
+public:
+    virtual ~AnalysisStage() = default;
+
+    virtual std::string id() const = 0;
+    virtual std::vector<std::string> channel_names() const = 0;
+    virtual void prepare(float sample_rate, std::size_t fft_size, std::size_t band_count) {
+        (void)sample_rate;
+        (void)fft_size;
+        (void)band_count;
+    }
+    // `out` has one slot per channel_names() entry and keeps its previous values.
+    virtual void process(const FeatureInputFrame& frame, std::span<float> out) = 0;
+};
+
+// Runs registered stages against each FeatureInputFrame within a per-stage
+// time budget. Stages that keep overrunning are bypassed and their channels
+// drop to zero so a slow plug-in cannot stall the analysis. A bypassed stage
+// is re-probed with a single hop once a cool-down of analysed audio has
+// passed; a probe within budget restores it, an overrun doubles the
+// cool-down up to kMaxBypassCooldownSeconds.
+class AnalysisStageHost {
+public:
+    static constexpr std::size_t kMaxConsecutiveOverruns = 8;
+    static constexpr float kBypassCooldownSeconds = 5.0f;
+    static constexpr float kMaxBypassCooldownSeconds = 80.0f;
+
+    // A stage entering or leaving bypass during the last process() call.
+    struct StatusChange {
+        std::string_view stage_id;
+        bool bypassed = false;
+    };
+
+    void add_stage(std::unique_ptr<AnalysisStage> stage,
+                   float sample_rate,
+                   std::size_t fft_size,
+                   std::size_t band_count);
+    void set_budget_ms(float budget_ms) { budget_seconds_ = (budget_ms > 0.0f) ? budget_ms / 1000.0f : 0.0f; }
+    // Replaces the steady clock stages are timed with, so tests can give a
+    // stage an exact cost. Returns seconds; nullptr restores the steady clock.
+    void set_time_source(double (*now_seconds)()) { now_seconds_ = now_seconds ? now_seconds : steady_seconds; }
+
+    void process(const FeatureInputFrame& frame);
+
+    bool empty() const { return stages_.empty(); }
+    std::size_t bypassed_stages() const;
+    // Transitions from the most recent process() call; valid until the next one.
+    std::span<const StatusChange> status_changes() const { return status_changes_; }
+    float budget_ms() const { return budget_seconds_ * 1000.0f; }
+    std::span<const float> channel_values() const { return channel_values_; }
+    std::span<const std::string> channel_names() const { return channel_names_; }
+
+private:
+    struct Slot {
+        std::unique_ptr<AnalysisStage> stage;
+        std::string id; // Cached so reporting a transition does not allocate
+        std::size_t first_channel = 0;
+        std::size_t channel_count = 0;
+        std::size_t consecutive_overruns = 0;
+        bool bypassed = false;
+        float cooldown_seconds = kBypassCooldownSeconds;
+        float probe_in_seconds = 0.0f; // Analysed audio left before the next re-probe
+    };
+
+    static double steady_seconds();
+    void bypass(Slot& slot, std::span<float> out);
+
+    std::vector<Slot> stages_;
+    std::vector<StatusChange> status_changes_; // Reserved per stage in add_stage
+    std::vector<float> channel_values_;
+    std::vector<std::string> channel_names_;
+    float budget_seconds_ = 0.0f; // 0 = unlimited
+    double (*now_seconds_)() = steady_seconds;
+};
+
+} // namespace when
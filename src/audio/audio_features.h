@@ -1,7 +1,10 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <span>
+#include <string>
+#include <string_view>
 
 namespace when {
 
@@ -28,10 +31,17 @@ struct AudioFeatures {
     bool mid_beat = false;      // True when a mid-band onset is detected
     bool treble_beat = false;   // True when a treble-band onset is detected
     float bpm = 0.0f;           // Estimated tempo in beats per minute
+    float tempo_confidence = 0.0f; // Autocorrelation score backing the tempo estimate
     float beat_phase = 0.0f;    // Normalized phase of the current beat (0-1)
     float bar_phase = 0.0f;     // Normalized phase within the current bar (0-1)
     bool downbeat = false;      // True on frames aligned with the bar downbeat
 
+    // Structural Features
+    float novelty = 0.0f;            // Checkerboard novelty of the recent chroma/band history (0-1)
+    bool section_change = false;     // True from the hop that detects a section boundary until the frame consumes it
+    float section_peak = 0.0f;       // Novelty peak that confirmed the latest section change (0-1)
+    std::size_t section_index = 0;   // Number of section changes detected so far
+
     // Spectral Features
     float spectral_centroid = 0.0f; // Represents the "brightness" of the sound
     float spectral_flatness = 0.0f; // Ratio describing tonal vs. noisy content
@@ -40,6 +50,21 @@ struct AudioFeatures {
 
     // Raw analysis context
     std::span<const float> band_flux; // Per-band spectral flux deltas from the DSP stage
+    std::span<const float> tone_envelopes; // Sliding-DFT amplitude per tracked tone (dsp.tone_frequencies order)
+    std::span<const float> tone_peaks;     // Highest tone amplitude seen since the previous frame
+    std::span<const float> custom_channels;            // Values published by analysis-stage plug-ins
+    std::span<const std::string> custom_channel_names; // Channel names, parallel to custom_channels
 };
 
+// Resolves a custom channel name to its index (-1 when absent). Indices stay
+// stable for the lifetime of the DSP engine, so look them up once.
+inline int find_custom_channel(const AudioFeatures& features, std::string_view name) {
+    for (std::size_t i = 0; i < features.custom_channel_names.size(); ++i) {
+        if (features.custom_channel_names[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
 } // namespace when
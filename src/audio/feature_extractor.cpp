@@ -9,6 +9,10 @@
 
 namespace when {
 
+namespace {
+constexpr float kRefinedFrequencyTolerance = 1e-3f; // Hz; smaller offsets are treated as the bin centre
+} // namespace
+
 FeatureExtractor::FeatureExtractor() { reset(); }
 
 FeatureExtractor::FeatureExtractor(Config config) : config_(config) { reset(); }
@@ -96,6 +100,9 @@ AudioFeatures FeatureExtractor::process(const FeatureInputFrame& input_frame) {
             weighted_band_buffer_.assign(band_count_, 0.0f);
         }
 
+        const std::span<const int> refined_bands =
+            (input_frame.refined_bin_bands.size() == fft_bin_count) ? input_frame.refined_bin_bands
+                                                                    : std::span<const int>();
         const std::size_t resolved_count = std::min(band_count_, band_ranges.size());
         for (std::size_t band = 0; band < resolved_count; ++band) {
             const auto [raw_start, raw_end] = band_ranges[band];
@@ -107,9 +114,26 @@ AudioFeatures FeatureExtractor::process(const FeatureInputFrame& input_frame) {
             }
 
             double sum_sq = 0.0;
-            for (std::size_t bin = start; bin < end; ++bin) {
-                const double magnitude = weighted_bins_[bin];
-                sum_sq += magnitude * magnitude;
+            if (refined_bands.empty()) {
+                for (std::size_t bin = start; bin < end; ++bin) {
+                    const double magnitude = weighted_bins_[bin];
+                    sum_sq += magnitude * magnitude;
+                }
+            } else {
+                // Peak bins follow their phase-refined frequency, which may sit
+                // in a neighbouring band; all other bins keep the static ranges.
+                const std::size_t scan_start = (start > kRefinedBinReach) ? start - kRefinedBinReach : 0;
+                const std::size_t scan_end = std::min(end + kRefinedBinReach, fft_bin_count);
+                for (std::size_t bin = scan_start; bin < scan_end; ++bin) {
+                    const int refined_band = refined_bands[bin];
+                    const bool in_band = (refined_band < 0) ? (bin >= start && bin < end)
+                                                            : (refined_band == static_cast<int>(band));
+                    if (!in_band) {
+                        continue;
+                    }
+                    const double magnitude = weighted_bins_[bin];
+                    sum_sq += magnitude * magnitude;
+                }
             }
 
             const std::size_t span = end - start;
@@ -232,9 +256,20 @@ AudioFeatures FeatureExtractor::process(const FeatureInputFrame& input_frame) {
         double total_energy = 0.0;
         constexpr double kEnergyFloor = 1e-12;
 
+        const std::span<const float> bin_frequencies =
+            (input_frame.bin_frequencies.size() == weighted_bins_.size()) ? input_frame.bin_frequencies
+                                                                          : std::span<const float>();
+        const float bin_width = (chroma_fft_size_ > 0)
+                                    ? input_frame.sample_rate / static_cast<float>(chroma_fft_size_)
+                                    : 0.0f;
+
         const std::size_t usable_bins = std::min(weighted_bins_.size(), chroma_bin_map_.size());
         for (std::size_t bin = 0; bin < usable_bins; ++bin) {
-            const std::uint8_t pitch_class = chroma_bin_map_[bin];
+            std::uint8_t pitch_class = chroma_bin_map_[bin];
+            if (!bin_frequencies.empty() &&
+                std::abs(bin_frequencies[bin] - bin_width * static_cast<float>(bin)) > kRefinedFrequencyTolerance) {
+                pitch_class = pitch_class_for_frequency(bin_frequencies[bin]);
+            }
             if (pitch_class >= 12) {
                 continue;
             }
@@ -435,15 +470,25 @@ void FeatureExtractor::update_chroma_mapping(std::size_t fft_bin_count,
             continue;
         }
 
-        const double midi_note = 69.0 + 12.0 * std::log2(frequency / 440.0);
-        const int rounded_note = static_cast<int>(std::lround(midi_note));
-        int pitch_class = rounded_note % 12;
-        if (pitch_class < 0) {
-            pitch_class += 12;
-        }
+        chroma_bin_map_[bin] = pitch_class_for_frequency(static_cast<float>(frequency));
+    }
+}
 
-        chroma_bin_map_[bin] = static_cast<std::uint8_t>(pitch_class);
+std::uint8_t FeatureExtractor::pitch_class_for_frequency(float frequency_hz) const {
+    const double frequency = static_cast<double>(frequency_hz);
+    const double min_frequency = static_cast<double>(std::max(std::min(config_.chroma_min_frequency, config_.chroma_max_frequency), 0.0f));
+    const double max_frequency = static_cast<double>(std::max({config_.chroma_min_frequency, config_.chroma_max_frequency, 0.0f}));
+    if (frequency <= 0.0 || frequency < min_frequency || frequency > max_frequency) {
+        return 0xFFu;
+    }
+
+    const double midi_note = 69.0 + 12.0 * std::log2(frequency / 440.0);
+    const int rounded_note = static_cast<int>(std::lround(midi_note));
+    int pitch_class = rounded_note % 12;
+    if (pitch_class < 0) {
+        pitch_class += 12;
     }
+    return static_cast<std::uint8_t>(pitch_class);
 }
 
 float FeatureExtractor::apply_envelope(float target, float& state) const {
@@ -465,7 +510,33 @@ void FeatureExtractor::resize_onset_history(std::size_t desired_length) {
         return;
     }
 
+    if (onset_history_.empty()) {
+        onset_history_.assign(desired_length, 0.0f);
+        onset_history_linear_.assign(desired_length, 0.0f);
+        onset_history_write_pos_ = 0;
+        return;
+    }
+
+    // The frame period changed (e.g. the DSP adjusted its hop). Resample the
+    // history so it still spans the same stretch of time instead of dropping
+    // the tempo context.
+    const std::size_t old_length = onset_history_.size();
+    std::vector<float> chronological(old_length);
+    for (std::size_t i = 0; i < old_length; ++i) {
+        chronological[i] = onset_history_[(onset_history_write_pos_ + i) % old_length];
+    }
+
     onset_history_.assign(desired_length, 0.0f);
+    const float scale = (desired_length > 1)
+                            ? static_cast<float>(old_length - 1) / static_cast<float>(desired_length - 1)
+                            : 0.0f;
+    for (std::size_t i = 0; i < desired_length; ++i) {
+        const float position = static_cast<float>(i) * scale;
+        const std::size_t index = std::min(static_cast<std::size_t>(position), old_length - 1);
+        const std::size_t next = std::min(index + 1, old_length - 1);
+        const float fraction = position - static_cast<float>(index);
+        onset_history_[i] = chronological[index] + (chronological[next] - chronological[index]) * fraction;
+    }
     onset_history_linear_.assign(desired_length, 0.0f);
     onset_history_write_pos_ = 0;
 }
@@ -483,6 +554,7 @@ bool FeatureExtractor::update_tempo_tracking(float onset_strength,
                                  static_cast<float>(beats_per_bar_int);
         tempo_state_.bar_phase = std::clamp(tempo_state_.bar_phase, 0.0f, 1.0f);
         features.bpm = tempo_state_.bpm;
+        features.tempo_confidence = tempo_state_.confidence;
         features.beat_phase = tempo_state_.beat_phase;
         features.bar_phase = tempo_state_.bar_phase;
         features.downbeat = false;
@@ -507,6 +579,7 @@ bool FeatureExtractor::update_tempo_tracking(float onset_strength,
 
     if (onset_history_.empty()) {
         features.bpm = tempo_state_.bpm;
+        features.tempo_confidence = tempo_state_.confidence;
         features.beat_phase = tempo_state_.beat_phase;
         features.bar_phase = tempo_state_.bar_phase;
         features.downbeat = false;
@@ -626,6 +699,7 @@ bool FeatureExtractor::update_tempo_tracking(float onset_strength,
     }
 
     features.bpm = tempo_state_.bpm;
+    features.tempo_confidence = tempo_state_.confidence;
     features.beat_phase = tempo_state_.beat_phase;
     features.bar_phase = tempo_state_.bar_phase;
     features.downbeat = downbeat;
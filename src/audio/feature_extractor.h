@@ -62,6 +62,7 @@ private:
     void ensure_band_capacity(std::size_t band_count);
     void update_weighting_curve(std::size_t fft_bin_count, float sample_rate, std::size_t fft_size);
     void update_chroma_mapping(std::size_t fft_bin_count, float sample_rate, std::size_t fft_size);
+    std::uint8_t pitch_class_for_frequency(float frequency_hz) const;
     float apply_envelope(float target, float& state) const;
     void resize_onset_history(std::size_t desired_length);
     bool update_tempo_tracking(float onset_strength,
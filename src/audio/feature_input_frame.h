@@ -1,13 +1,21 @@
 #pragma once
 
+#include <cstddef>
 #include <span>
 #include <utility>
 
 namespace when {
 
+// Bins a phase-refined peak may move across a band edge. The DSP assigns
+// refined_bin_bands within this reach and the extractor scans it, so both
+// sides must agree.
+inline constexpr std::size_t kRefinedBinReach = 2;
+
 struct FeatureInputFrame {
     std::span<const float> fft_magnitudes;            // Raw FFT magnitudes for each bin
     std::span<const float> fft_phases;                // Optional FFT phase information per bin
+    std::span<const float> bin_frequencies;           // Optional per-bin frequency in Hz, phase-refined around peaks
+    std::span<const int> refined_bin_bands;           // Optional band owning each bin by refined frequency (-1 = use ranges)
     std::span<const float> instantaneous_band_energies; // Unsmoothed log-band magnitudes
     std::span<const float> smoothed_band_energies;    // Optional pre-smoothed magnitudes (may be empty)
     std::span<const float> band_flux;                 // Per-band spectral flux deltas
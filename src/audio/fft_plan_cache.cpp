@@ -0,0 +1,190 @@
+#include "audio/fft_plan_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace when {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+
+std::size_t align_up(std::size_t bytes) {
+    return (bytes + FftPlan::kAlignment - 1) / FftPlan::kAlignment * FftPlan::kAlignment;
+}
+
+// Zeroth-order modified Bessel function of the first kind, by its power series.
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_sq = 0.25 * x * x;
+    for (int k = 1; k < 64 && term > sum * 1e-12; ++k) {
+        term *= half_sq / (static_cast<double>(k) * static_cast<double>(k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Symmetric windows (period size - 1), matching the Hann the engine always used.
+void fill_window(float* out, std::size_t size, FftWindowType type, float param) {
+    const double denominator = static_cast<double>(size - 1);
+    const double kaiser_norm = (type == FftWindowType::Kaiser) ? 1.0 / bessel_i0(param) : 1.0;
+    for (std::size_t i = 0; i < size; ++i) {
+        const double position = (denominator == 0.0) ? 0.0 : static_cast<double>(i) / denominator;
+        const double phase = 2.0 * kPi * position;
+        double value = 1.0;
+        switch (type) {
+        case FftWindowType::Hann:
+            value = 0.5 - 0.5 * std::cos(phase);
+            break;
+        case FftWindowType::BlackmanHarris:
+            value = 0.35875 - 0.48829 * std::cos(phase) + 0.14128 * std::cos(2.0 * phase) -
+                    0.01168 * std::cos(3.0 * phase);
+            break;
+        case FftWindowType::Kaiser: {
+            const double r = 2.0 * position - 1.0;
+            value = bessel_i0(param * std::sqrt(std::max(0.0, 1.0 - r * r))) * kaiser_norm;
+            break;
+        }
+        case FftWindowType::FlatTop:
+            // Normalised to a peak of 1; dips slightly negative near the edges.
+            value = 0.21557895 - 0.41663158 * std::cos(phase) + 0.277263158 * std::cos(2.0 * phase) -
+                    0.083578947 * std::cos(3.0 * phase) + 0.006947368 * std::cos(4.0 * phase);
+            break;
+        }
+        out[i] = static_cast<float>(value);
+    }
+}
+
+std::string normalise_window_name(std::string_view name) {
+    std::string out;
+    out.reserve(name.size());
+    for (const char c : name) {
+        if (c == '-' || c == '_' || c == ' ') {
+            continue;
+        }
+        out.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+    return out;
+}
+} // namespace
+
+bool parse_fft_window(std::string_view name, FftWindowType& out) {
+    const std::string key = normalise_window_name(name);
+    if (key == "hann" || key == "hanning") {
+        out = FftWindowType::Hann;
+    } else if (key == "blackmanharris") {
+        out = FftWindowType::BlackmanHarris;
+    } else if (key == "kaiser") {
+        out = FftWindowType::Kaiser;
+    } else if (key == "flattop") {
+        out = FftWindowType::FlatTop;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+FftPlan::FftPlan(std::size_t size, FftDirection direction, FftWindowType window_type, float window_param)
+    : size_(size),
+      direction_(direction),
+      window_type_(window_type),
+      window_param_(window_param) {
+    if (size_ < 2) {
+        throw std::invalid_argument("FFT size must be at least 2");
+    }
+    const int inverse = (direction_ == FftDirection::Inverse) ? 1 : 0;
+    std::size_t config_bytes = 0;
+    kiss_fft_alloc(static_cast<int>(size_), inverse, nullptr, &config_bytes);
+    if (config_bytes == 0) {
+        throw std::invalid_argument("Unsupported FFT size");
+    }
+
+    // One aligned block: twiddles first, then the window on its own cache line.
+    config_bytes_ = align_up(config_bytes);
+    window_bytes_ = align_up(size_ * sizeof(float));
+    void* block = ::operator new(config_bytes_ + window_bytes_, std::align_val_t{kAlignment});
+    std::size_t lenmem = config_bytes_;
+    config_ = kiss_fft_alloc(static_cast<int>(size_), inverse, block, &lenmem);
+    if (!config_) {
+        ::operator delete(block, std::align_val_t{kAlignment});
+        throw std::bad_alloc();
+    }
+    window_ = reinterpret_cast<float*>(static_cast<unsigned char*>(block) + config_bytes_);
+    fill_window(window_, size_, window_type_, window_param_);
+
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for (std::size_t i = 0; i < size_; ++i) {
+        sum += window_[i];
+        sum_sq += static_cast<double>(window_[i]) * window_[i];
+    }
+    coherent_gain_ = static_cast<float>(sum / static_cast<double>(size_));
+    power_gain_ = static_cast<float>(sum_sq / static_cast<double>(size_));
+}
+
+FftPlan::~FftPlan() {
+    ::operator delete(static_cast<void*>(config_), std::align_val_t{kAlignment});
+}
+
+FftPlanCache& FftPlanCache::instance() {
+    static FftPlanCache cache;
+    return cache;
+}
+
+std::shared_ptr<const FftPlan> FftPlanCache::acquire(std::size_t size,
+                                                     FftDirection direction,
+                                                     FftWindowType window_type,
+                                                     float window_param) {
+    // Only Kaiser is parameterised; keep other windows on one key.
+    if (window_type != FftWindowType::Kaiser) {
+        window_param = 0.0f;
+    }
+    const Key key{size, direction, window_type, window_param};
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = plans_.find(key);
+    if (it != plans_.end()) {
+        ++hits_;
+        return it->second;
+    }
+    ++misses_;
+    auto plan = std::make_shared<const FftPlan>(size, direction, window_type, window_param);
+    plans_.emplace(key, plan);
+    return plan;
+}
+
+std::size_t FftPlanCache::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t dropped = 0;
+    for (auto it = plans_.begin(); it != plans_.end();) {
+        if (it->second.use_count() == 1) {
+            it = plans_.erase(it);
+            ++dropped;
+        } else {
+            ++it;
+        }
+    }
+    evictions_ += dropped;
+    return dropped;
+}
+
+FftPlanCache::Stats FftPlanCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.cached_plans = plans_.size();
+    for (const auto& entry : plans_) {
+        if (entry.second.use_count() > 1) {
+            ++stats.shared_plans;
+        }
+        stats.bytes += entry.second->bytes();
+    }
+    return stats;
+}
+
+} // namespace when
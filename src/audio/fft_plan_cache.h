@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <tuple>
+
+extern "C" {
+#include <kiss_fft.h>
+}
+
+namespace when {
+
+enum class FftDirection { Forward, Inverse };
+enum class FftWindowType { Hann, BlackmanHarris, Kaiser, FlatTop };
+
+constexpr float kDefaultKaiserBeta = 8.6f;
+
+// Accepts "hann", "blackman-harris", "kaiser" and "flat-top" ('_' or no
+// separator also work). Returns false for anything else.
+bool parse_fft_window(std::string_view name, FftWindowType& out);
+
+// Immutable FFT setup shared by every analysis instance with the same key:
+// kiss_fft twiddles plus the analysis window, both in cache-line aligned
+// storage. kiss_fft only reads the config, so one plan may be used from
+// several threads at once.
+class FftPlan {
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    // window_param is the Kaiser beta; other windows ignore it.
+    FftPlan(std::size_t size, FftDirection direction, FftWindowType window_type, float window_param = 0.0f);
+    ~FftPlan();
+
+    FftPlan(const FftPlan&) = delete;
+    FftPlan& operator=(const FftPlan&) = delete;
+
+    std::size_t size() const { return size_; }
+    FftDirection direction() const { return direction_; }
+    FftWindowType window_type() const { return window_type_; }
+    float window_param() const { return window_param_; }
+
+    kiss_fft_cfg config() const { return config_; }
+    const float* window() const { return window_; }
+    std::size_t bytes() const { return config_bytes_ + window_bytes_; }
+
+    // Mean of the window: the factor a sinusoid's peak bin is scaled by.
+    float coherent_gain() const { return coherent_gain_; }
+    // Mean of the squared window: the factor noise power is scaled by.
+    float power_gain() const { return power_gain_; }
+    // Equivalent noise bandwidth in bins, power_gain / coherent_gain^2.
+    float noise_bandwidth_bins() const { return power_gain_ / (coherent_gain_ * coherent_gain_); }
+
+private:
+    std::size_t size_;
+    FftDirection direction_;
+    FftWindowType window_type_;
+    float window_param_;
+    float coherent_gain_ = 1.0f;
+    float power_gain_ = 1.0f;
+    std::size_t config_bytes_ = 0;
+    std::size_t window_bytes_ = 0;
+    kiss_fft_cfg config_ = nullptr; // Placed in our own aligned block
+    float* window_ = nullptr;
+};
+
+// Process-wide cache of FftPlans keyed by (size, direction, window). Plans
+// stay cached after their last user goes away, so reconfiguring with the same
+// parameters allocates nothing; trim() drops the unused ones.
+class FftPlanCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::size_t cached_plans = 0;
+        std::size_t shared_plans = 0; // Cached plans that some instance still holds
+        std::size_t bytes = 0;
+    };
+
+    static FftPlanCache& instance();
+
+    // Throws std::invalid_argument for sizes kiss_fft cannot plan and
+    // std::bad_alloc when allocation fails.
+    std::shared_ptr<const FftPlan> acquire(std::size_t size,
+                                           FftDirection direction = FftDirection::Forward,
+                                           FftWindowType window_type = FftWindowType::Hann,
+                                           float window_param = 0.0f);
+
+    // Releases plans no instance holds. Returns how many were dropped.
+    std::size_t trim();
+    Stats stats() const;
+
+private:
+    using Key = std::tuple<std::size_t, FftDirection, FftWindowType, float>;
+
+    mutable std::mutex mutex_;
+    std::map<Key, std::shared_ptr<const FftPlan>> plans_;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::uint64_t evictions_ = 0;
+};
+
+} // namespace when
@@ -0,0 +1,234 @@
+#include "audio/novelty_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace when {
+
+namespace {
+constexpr std::size_t kMinHalfWidth = 2;
+constexpr std::size_t kRebuildIntervalBlocks = 4096; // Bounds floating-point drift of the running sums
+constexpr float kMinBlockSeconds = 0.05f;
+constexpr float kVectorNormFloor = 1e-9f;
+constexpr float kHalfPartWeight = 0.70710678f; // 1/sqrt(2): two unit halves form one unit vector
+
+void normalise(std::span<float> values) {
+    double sum_sq = 0.0;
+    for (float value : values) {
+        sum_sq += static_cast<double>(value) * value;
+    }
+    const double norm = std::sqrt(sum_sq);
+    if (norm <= kVectorNormFloor) {
+        std::fill(values.begin(), values.end(), 0.0f);
+        return;
+    }
+    const float inverse = static_cast<float>(1.0 / norm);
+    for (float& value : values) {
+        value *= inverse;
+    }
+}
+} // namespace
+
+void NoveltyDetector::configure(const Config& config) {
+    config_ = config;
+    config_.block_seconds = std::max(config_.block_seconds, kMinBlockSeconds);
+    config_.kernel_seconds = std::max(config_.kernel_seconds, config_.block_seconds * 2.0f * kMinHalfWidth);
+    config_.min_interval_seconds = std::max(config_.min_interval_seconds, 0.0f);
+    half_width_ = std::max<std::size_t>(
+        kMinHalfWidth,
+        static_cast<std::size_t>(std::lround(config_.kernel_seconds / (2.0f * config_.block_seconds))));
+    window_ = half_width_ * 2;
+    dims_ = 0;
+    reset();
+}
+
+void NoveltyDetector::reset() {
+    block_sum_.assign(dims_, 0.0f);
+    block_vector_.assign(dims_, 0.0f);
+    block_frames_ = 0;
+    block_elapsed_ = 0.0f;
+    vectors_.assign(window_ * dims_, 0.0f);
+    similarity_.assign(window_ * window_, 0.0f);
+    start_ = 0;
+    count_ = 0;
+    blocks_since_rebuild_ = 0;
+    sum_past_ = 0.0;
+    sum_future_ = 0.0;
+    sum_cross_ = 0.0;
+    novelty_ = 0.0f;
+    previous_novelty_ = 0.0f;
+    previous_previous_novelty_ = 0.0f;
+    last_peak_ = 0.0f;
+    seconds_since_change_ = 0.0f;
+}
+
+bool NoveltyDetector::push(std::span<const float> chroma, std::span<const float> band_energies, float frame_period) {
+    if (window_ == 0) {
+        configure(config_);
+    }
+
+    const std::size_t dims = chroma.size() + band_energies.size();
+    if (dims == 0) {
+        return false;
+    }
+    if (dims != dims_ || chroma.size() != chroma_dims_) {
+        dims_ = dims;
+        chroma_dims_ = chroma.size();
+        reset();
+    }
+
+    for (std::size_t i = 0; i < chroma.size(); ++i) {
+        block_sum_[i] += chroma[i];
+    }
+    // Log compression keeps the loudest bands from dominating the cosine similarity.
+    for (std::size_t i = 0; i < band_energies.size(); ++i) {
+        block_sum_[chroma_dims_ + i] += std::log1p(std::max(band_energies[i], 0.0f));
+    }
+    ++block_frames_;
+    block_elapsed_ += std::max(frame_period, 0.0f);
+    seconds_since_change_ += std::max(frame_period, 0.0f);
+
+    if (block_elapsed_ < config_.block_seconds) {
+        return false;
+    }
+    return finish_block();
+}
+
+bool NoveltyDetector::finish_block() {
+    const float inverse_frames = 1.0f / static_cast<float>(std::max<std::size_t>(block_frames_, 1));
+    for (std::size_t i = 0; i < dims_; ++i) {
+        block_vector_[i] = block_sum_[i] * inverse_frames;
+    }
+    std::fill(block_sum_.begin(), block_sum_.end(), 0.0f);
+    block_frames_ = 0;
+    block_elapsed_ = 0.0f;
+
+    // Chroma and band shape get equal weight in the combined unit vector.
+    const std::span<float> all(block_vector_);
+    normalise(all.first(chroma_dims_));
+    normalise(all.subspan(chroma_dims_));
+    if (chroma_dims_ > 0 && chroma_dims_ < dims_) {
+        for (float& value : block_vector_) {
+            value *= kHalfPartWeight;
+        }
+    }
+
+    insert_vector(block_vector_);
+    if (count_ < window_) {
+        return false;
+    }
+
+    const double pairs = static_cast<double>(half_width_ * half_width_);
+    previous_previous_novelty_ = previous_novelty_;
+    previous_novelty_ = novelty_;
+    novelty_ = static_cast<float>(
+        std::clamp((sum_past_ + sum_future_ - 2.0 * sum_cross_) / (2.0 * pairs), 0.0, 1.0));
+
+    const bool is_peak = previous_novelty_ > previous_previous_novelty_ && previous_novelty_ >= novelty_;
+    if (is_peak && previous_novelty_ >= config_.threshold && seconds_since_change_ >= config_.min_interval_seconds) {
+        seconds_since_change_ = 0.0f;
+        last_peak_ = previous_novelty_;
+        ++section_index_;
+        return true;
+    }
+    return false;
+}
+
+float NoveltyDetector::dot_with_slot(const float* vector, std::size_t slot_index) const {
+    const float* other = vectors_.data() + slot_index * dims_;
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < dims_; ++i) {
+        sum += vector[i] * other[i];
+    }
+    return sum;
+}
+
+void NoveltyDetector::insert_vector(const std::vector<float>& vector) {
+    if (count_ < window_) {
+        const std::size_t target = slot(count_);
+        std::copy(vector.begin(), vector.end(), vectors_.begin() + static_cast<std::ptrdiff_t>(target * dims_));
+        for (std::size_t k = 0; k <= count_; ++k) {
+            const std::size_t other = slot(k);
+            const float value = dot_with_slot(vector.data(), other);
+            similarity(target, other) = value;
+            similarity(other, target) = value;
+        }
+        ++count_;
+        if (count_ == window_) {
+            rebuild_sums();
+        }
+        return;
+    }
+
+    // Logical layout: [0, L) is the past half, [L, 2L) the future half. The
+    // oldest block o leaves, m crosses from future to past and n arrives.
+    const std::size_t half = half_width_;
+    const std::size_t o = slot(0);
+    const std::size_t m = slot(half);
+
+    double o_past = 0.0;
+    double o_future = 0.0;
+    double m_past_without_o = 0.0;
+    double m_future = 0.0;
+    for (std::size_t k = 0; k < half; ++k) {
+        o_past += similarity(o, slot(k));
+        o_future += similarity(o, slot(half + k));
+        m_future += similarity(m, slot(half + k));
+        if (k > 0) {
+            m_past_without_o += similarity(m, slot(k));
+        }
+    }
+    const double o_self = similarity(o, o);
+    const double m_self = similarity(m, m);
+
+    // n reuses o's slot.
+    std::copy(vector.begin(), vector.end(), vectors_.begin() + static_cast<std::ptrdiff_t>(o * dims_));
+    double n_past_without_o = 0.0;
+    double n_future_without_m = 0.0;
+    for (std::size_t k = 1; k < window_; ++k) {
+        const std::size_t other = slot(k);
+        const float value = dot_with_slot(vector.data(), other);
+        similarity(o, other) = value;
+        similarity(other, o) = value;
+        if (k < half) {
+            n_past_without_o += value;
+        } else if (k > half) {
+            n_future_without_m += value;
+        }
+    }
+    const double n_self = dot_with_slot(vector.data(), o);
+    similarity(o, o) = static_cast<float>(n_self);
+    const double m_n = similarity(m, o);
+
+    sum_past_ += -2.0 * o_past + o_self + 2.0 * m_past_without_o + m_self;
+    sum_future_ += -2.0 * m_future + m_self + 2.0 * n_future_without_m + n_self;
+    sum_cross_ += -o_future - m_past_without_o + n_past_without_o + (m_future - m_self) + m_n;
+
+    start_ = (start_ + 1) % window_;
+    if (++blocks_since_rebuild_ >= kRebuildIntervalBlocks) {
+        rebuild_sums();
+    }
+}
+
+void NoveltyDetector::rebuild_sums() {
+    sum_past_ = 0.0;
+    sum_future_ = 0.0;
+    sum_cross_ = 0.0;
+    for (std::size_t i = 0; i < window_; ++i) {
+        for (std::size_t j = 0; j < window_; ++j) {
+            const double value = similarity(slot(i), slot(j));
+            const bool i_past = i < half_width_;
+            const bool j_past = j < half_width_;
+            if (i_past && j_past) {
+                sum_past_ += value;
+            } else if (!i_past && !j_past) {
+                sum_future_ += value;
+            } else if (i_past) {
+                sum_cross_ += value;
+            }
+        }
+    }
+    blocks_since_rebuild_ = 0;
+}
+
+} // namespace when
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace when {
+
+// Streaming Foote novelty over block-averaged chroma + band-energy vectors.
+// A checkerboard kernel of 2L blocks is slid along the self-similarity
+// matrix; the quadrant sums are updated incrementally so each new block costs
+// O(L) similarity evaluations instead of rebuilding the matrix.
+class NoveltyDetector {
+public:
+    struct Config {
+        float kernel_seconds = 16.0f;      // Full checkerboard width (past + future)
+        float block_seconds = 0.5f;        // Feature averaging block; one novelty value per block
+        float threshold = 0.3f;            // Normalised novelty (0-1) a peak must exceed
+        float min_interval_seconds = 8.0f; // Minimum spacing between reported section changes
+    };
+
+    NoveltyDetector() = default;
+    explicit NoveltyDetector(const Config& config) { configure(config); }
+
+    void configure(const Config& config);
+    void reset();
+
+    // Adds one analysis frame. Returns true when a section boundary was
+    // confirmed by this frame; the boundary lies half a kernel in the past.
+    bool push(std::span<const float> chroma, std::span<const float> band_energies, float frame_period);
+
+    float novelty() const { return novelty_; }
+    // Novelty of the peak that confirmed the latest section change.
+    float last_peak() const { return last_peak_; }
+    std::size_t section_index() const { return section_index_; }
+    std::size_t half_width() const { return half_width_; }
+
+private:
+    bool finish_block();
+    void insert_vector(const std::vector<float>& vector);
+    void rebuild_sums();
+    float& similarity(std::size_t slot_a, std::size_t slot_b) { return similarity_[slot_a * window_ + slot_b]; }
+    std::size_t slot(std::size_t logical_index) const { return (start_ + logical_index) % window_; }
+    float dot_with_slot(const float* vector, std::size_t slot_index) const;
+
+    Config config_{};
+    std::size_t half_width_ = 0;
+    std::size_t window_ = 0;
+    std::size_t dims_ = 0;
+    std::size_t chroma_dims_ = 0;
+
+    std::vector<float> block_sum_;
+    std::size_t block_frames_ = 0;
+    float block_elapsed_ = 0.0f;
+    std::vector<float> block_vector_;
+
+    std::vector<float> vectors_;    // window_ x dims_ ring of unit vectors
+    std::vector<float> similarity_; // window_ x window_ cosine similarities by slot
+    std::size_t start_ = 0;
+    std::size_t count_ = 0;
+    std::size_t blocks_since_rebuild_ = 0;
+    double sum_past_ = 0.0;
+    double sum_future_ = 0.0;
+    double sum_cross_ = 0.0;
+
+    float novelty_ = 0.0f;
+    float previous_novelty_ = 0.0f;
+    float previous_previous_novelty_ = 0.0f;
+    float seconds_since_change_ = 0.0f;
+    float last_peak_ = 0.0f;
+    std::size_t section_index_ = 0;
+};
+
+} // namespace when
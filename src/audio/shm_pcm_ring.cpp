@@ -0,0 +1,309 @@
+#include "audio/shm_pcm_ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace when {
+
+namespace {
+std::size_t ring_bytes(std::uint32_t channels, std::size_t capacity_frames) {
+    return sizeof(ShmPcmHeader) + capacity_frames * channels * sizeof(float);
+}
+
+std::int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+
+ShmPcmRing::~ShmPcmRing() { close(); }
+
+bool ShmPcmRing::create(const std::string& name,
+                        std::uint32_t sample_rate,
+                        std::uint32_t channels,
+                        std::size_t capacity_frames,
+                        bool force) {
+    close();
+    last_error_.clear();
+    if (name.empty() || sample_rate == 0 || channels == 0 || capacity_frames < 4) {
+        last_error_ = "invalid shared-memory ring geometry";
+        return false;
+    }
+    const std::size_t bytes = ring_bytes(channels, capacity_frames);
+
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        last_error_ = "shm_open '" + name + "' failed: " + std::strerror(errno);
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        last_error_ = "fstat '" + name + "' failed: " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    std::size_t existing = static_cast<std::size_t>(info.st_size);
+    bool same_geometry = false;
+    if (existing >= sizeof(ShmPcmHeader) && map(fd, existing, false)) {
+        // Two writers interleave their blocks and readers get garbage.
+        const bool live = !force && has_live_writer();
+        const std::int32_t pid = header_->writer_pid.load(std::memory_order_relaxed);
+        same_geometry = existing == bytes &&
+                        header_->magic.load(std::memory_order_acquire) == ShmPcmHeader::kMagic &&
+                        header_->version == ShmPcmHeader::kVersion && header_->sample_rate == sample_rate &&
+                        header_->channels == channels && header_->capacity_frames == capacity_frames;
+        close();
+        if (live) {
+            last_error_ = "shared memory '" + name + "' is still being written by pid " + std::to_string(pid);
+            ::close(fd);
+            return false;
+        }
+    }
+    if (existing != 0 && !same_geometry) {
+        // Attached readers hold the old geometry (even at the same byte size),
+        // so it cannot be changed under them: mark it retired so they
+        // re-attach, and build a new segment under the same name.
+        if (existing >= sizeof(ShmPcmHeader) && map(fd, existing, true)) {
+            header_->magic.store(0, std::memory_order_release);
+            close();
+        }
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            last_error_ = "shm_open '" + name + "' failed: " + std::strerror(errno);
+            return false;
+        }
+        existing = 0;
+    }
+    if (existing == 0 && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        last_error_ = "ftruncate '" + name + "' failed: " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    const bool mapped = map(fd, bytes, true);
+    ::close(fd);
+    if (!mapped) {
+        return false;
+    }
+
+    if (same_geometry) {
+        // Keep the sample clock running so readers need not notice.
+        header_->generation.fetch_add(1, std::memory_order_acq_rel);
+    } else {
+        new (mapping_) ShmPcmHeader{};
+        header_->version = ShmPcmHeader::kVersion;
+        header_->sample_rate = sample_rate;
+        header_->channels = channels;
+        header_->capacity_frames = capacity_frames;
+        std::memset(samples(), 0, capacity_frames * channels * sizeof(float));
+        header_->generation.fetch_add(1, std::memory_order_acq_rel);
+        header_->magic.store(ShmPcmHeader::kMagic, std::memory_order_release);
+    }
+    header_->writer_pid.store(static_cast<std::int32_t>(::getpid()), std::memory_order_relaxed);
+    writer_ = true;
+
+    sample_rate_ = sample_rate;
+    channels_ = channels;
+    capacity_frames_ = capacity_frames;
+    guard_frames_ = std::max<std::size_t>(1, capacity_frames / 4);
+    return true;
+}
+
+void ShmPcmRing::write(const float* interleaved, std::size_t frames) {
+    if (!header_ || frames == 0) {
+        return;
+    }
+    float* data = samples();
+    std::uint64_t position = header_->write_frames.load(std::memory_order_relaxed);
+    while (frames > 0) {
+        const std::size_t chunk = std::min(frames, guard_frames_);
+        const std::size_t offset = static_cast<std::size_t>(position % capacity_frames_);
+        const std::size_t first = std::min(chunk, capacity_frames_ - offset);
+        std::memcpy(data + offset * channels_, interleaved, first * channels_ * sizeof(float));
+        if (chunk > first) {
+            std::memcpy(data, interleaved + first * channels_, (chunk - first) * channels_ * sizeof(float));
+        }
+        position += chunk;
+        interleaved += chunk * channels_;
+        frames -= chunk;
+        header_->write_frames.store(position, std::memory_order_release);
+    }
+    header_->write_time_ns.store(steady_now_ns(), std::memory_order_relaxed);
+}
+
+bool ShmPcmRing::attach(const std::string& name) {
+    close();
+    last_error_.clear();
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        last_error_ = "shared memory '" + name + "' is not available: " + std::strerror(errno);
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(ShmPcmHeader)) {
+        last_error_ = "shared memory '" + name + "' is not initialised";
+        ::close(fd);
+        return false;
+    }
+    const bool mapped = map(fd, static_cast<std::size_t>(info.st_size), false);
+    ::close(fd);
+    if (!mapped) {
+        return false;
+    }
+
+    if (header_->magic.load(std::memory_order_acquire) != ShmPcmHeader::kMagic) {
+        last_error_ = "shared memory '" + name + "' is not initialised";
+        close();
+        return false;
+    }
+    if (header_->version != ShmPcmHeader::kVersion || header_->channels == 0 || header_->capacity_frames < 4 ||
+        ring_bytes(header_->channels, header_->capacity_frames) != mapping_bytes_) {
+        last_error_ = "shared memory '" + name + "' has an unsupported layout";
+        close();
+        return false;
+    }
+
+    sample_rate_ = header_->sample_rate;
+    channels_ = header_->channels;
+    capacity_frames_ = static_cast<std::size_t>(header_->capacity_frames);
+    guard_frames_ = std::max<std::size_t>(1, capacity_frames_ / 4);
+    seen_generation_ = header_->generation.load(std::memory_order_acquire);
+    read_frames_ = header_->write_frames.load(std::memory_order_acquire);
+    dropped_frames_ = 0;
+    return true;
+}
+
+std::size_t ShmPcmRing::read(float* dest, std::size_t max_samples) {
+    if (!header_ || max_samples < channels_ || header_->magic.load(std::memory_order_acquire) != ShmPcmHeader::kMagic) {
+        return 0;
+    }
+    const std::uint64_t generation = header_->generation.load(std::memory_order_acquire);
+    std::uint64_t write = header_->write_frames.load(std::memory_order_acquire);
+    if (generation != seen_generation_ || write < read_frames_) {
+        // A new writer took over: whatever was pending belongs to the old stream.
+        seen_generation_ = generation;
+        read_frames_ = write;
+        return 0;
+    }
+
+    const std::uint64_t limit = capacity_frames_ - guard_frames_;
+    const auto skip_to = [&](std::uint64_t position) {
+        dropped_frames_ += position - read_frames_;
+        read_frames_ = position;
+    };
+    if (write - read_frames_ > limit) {
+        skip_to(write - capacity_frames_ / 2);
+    }
+    const std::size_t frames =
+        static_cast<std::size_t>(std::min<std::uint64_t>(write - read_frames_, max_samples / channels_));
+    if (frames == 0) {
+        return 0;
+    }
+
+    const float* data = samples();
+    const std::size_t offset = static_cast<std::size_t>(read_frames_ % capacity_frames_);
+    const std::size_t first = std::min(frames, capacity_frames_ - offset);
+    std::memcpy(dest, data + offset * channels_, first * channels_ * sizeof(float));
+    if (frames > first) {
+        std::memcpy(dest + first * channels_, data, (frames - first) * channels_ * sizeof(float));
+    }
+
+    // If the writer got within a guard of what was copied, part of it may
+    // already hold newer audio.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    write = header_->write_frames.load(std::memory_order_relaxed);
+    if (write - read_frames_ > limit) {
+        skip_to(write - capacity_frames_ / 2);
+        return 0;
+    }
+    read_frames_ += frames;
+    return frames * channels_;
+}
+
+void ShmPcmRing::close() {
+    if (writer_ && header_) {
+        std::int32_t self = static_cast<std::int32_t>(::getpid());
+        header_->writer_pid.compare_exchange_strong(self, 0, std::memory_order_relaxed);
+    }
+    if (mapping_) {
+        ::munmap(mapping_, mapping_bytes_);
+    }
+    mapping_ = nullptr;
+    header_ = nullptr;
+    mapping_bytes_ = 0;
+    sample_rate_ = 0;
+    channels_ = 0;
+    capacity_frames_ = 0;
+    guard_frames_ = 0;
+    writer_ = false;
+}
+
+bool ShmPcmRing::unlink(const std::string& name) { return ::shm_unlink(name.c_str()) == 0; }
+
+bool ShmPcmRing::is_current() const {
+    return header_ && header_->magic.load(std::memory_order_acquire) == ShmPcmHeader::kMagic;
+}
+
+std::uint64_t ShmPcmRing::generation() const {
+    return header_ ? header_->generation.load(std::memory_order_acquire) : 0;
+}
+
+std::uint64_t ShmPcmRing::write_frames() const {
+    return header_ ? header_->write_frames.load(std::memory_order_acquire) : 0;
+}
+
+std::int64_t ShmPcmRing::last_write_ns() const {
+    return header_ ? header_->write_time_ns.load(std::memory_order_relaxed) : 0;
+}
+
+float ShmPcmRing::occupancy() const {
+    if (!header_ || capacity_frames_ == 0) {
+        return 0.0f;
+    }
+    const std::uint64_t pending = write_frames() - std::min(read_frames_, write_frames());
+    return std::min(1.0f, static_cast<float>(pending) / static_cast<float>(capacity_frames_));
+}
+
+bool ShmPcmRing::has_live_writer() const {
+    if (header_->magic.load(std::memory_order_acquire) != ShmPcmHeader::kMagic) {
+        return false;
+    }
+    const std::int32_t pid = header_->writer_pid.load(std::memory_order_relaxed);
+    if (pid <= 0 || pid == static_cast<std::int32_t>(::getpid())) {
+        return false;
+    }
+    if (::kill(static_cast<pid_t>(pid), 0) != 0 && errno != EPERM) {
+        return false;
+    }
+    const std::int64_t last_write = header_->write_time_ns.load(std::memory_order_relaxed);
+    return last_write != 0 && steady_now_ns() - last_write < kLiveWriterWindowNs;
+}
+
+bool ShmPcmRing::map(int fd, std::size_t bytes, bool writable) {
+    void* address = ::mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        last_error_ = std::string("mmap failed: ") + std::strerror(errno);
+        return false;
+    }
+    mapping_ = address;
+    mapping_bytes_ = bytes;
+    header_ = static_cast<ShmPcmHeader*>(address);
+    return true;
+}
+
+float* ShmPcmRing::samples() const {
+    return reinterpret_cast<float*>(static_cast<char*>(mapping_) + sizeof(ShmPcmHeader));
+}
+
+} // namespace when
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace when {
+
+// Header at the start of a POSIX shared-memory PCM ring. Interleaved float
+// frames follow it. The capture daemon is the only writer; every reader keeps
+// its own position, so readers never hold the writer up and several
+// visualisers may attach at once.
+struct ShmPcmHeader {
+    static constexpr std::uint32_t kMagic = 0x4d435057u; // "WPCM"
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::atomic<std::uint32_t> magic;   // Published last; zero while initialising or once retired
+    std::uint32_t version;
+    std::uint32_t sample_rate;
+    std::uint32_t channels;
+    std::uint64_t capacity_frames;
+    std::atomic<std::uint64_t> generation; // Bumped whenever a writer takes the ring over
+    std::atomic<std::int32_t> writer_pid;
+    alignas(64) std::atomic<std::uint64_t> write_frames; // Sample clock: frames written since the ring was created
+    std::atomic<std::int64_t> write_time_ns;              // steady_clock time of the last write
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared-memory ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<std::int64_t>::is_always_lock_free, "shared-memory ring needs lock-free 64-bit atomics");
+
+// One mapping of a shared PCM ring, opened either as the writer (create) or as
+// a reader (attach).
+//
+// The writer never waits: it overwrites the oldest frames and advances
+// write_frames after each block. A reader that falls more than
+// capacity - guard frames behind skips ahead to half a ring of backlog and
+// counts the skipped frames as dropped. The guard is the most the writer
+// publishes at once, so a reader re-checking write_frames after its copy can
+// tell whether any of it was overwritten mid-copy and discard it.
+class ShmPcmRing {
+public:
+    ShmPcmRing() = default;
+    ~ShmPcmRing();
+
+    ShmPcmRing(const ShmPcmRing&) = delete;
+    ShmPcmRing& operator=(const ShmPcmRing&) = delete;
+
+    // Opens or creates the segment named name ("/when-pcm"). A segment with
+    // the same geometry is taken over in place (generation bumped, sample
+    // clock kept) so attached readers carry on; otherwise the old one is
+    // retired and replaced. Fails while another live process is still
+    // writing the segment, unless force is set.
+    bool create(const std::string& name,
+                std::uint32_t sample_rate,
+                std::uint32_t channels,
+                std::size_t capacity_frames,
+                bool force = false);
+    // Safe to call from the audio callback: no allocation or locking.
+    void write(const float* interleaved, std::size_t frames);
+
+    // Maps an existing segment read-only and starts reading at the current
+    // write position. Fails while no writer has initialised it.
+    bool attach(const std::string& name);
+    // Copies up to max_samples interleaved samples (whole frames) in the ring's
+    // channel layout. Returns 0 once the writer has retired the segment.
+    std::size_t read(float* dest, std::size_t max_samples);
+
+    // A writer gives up its claim on the segment so another may take it over.
+    void close();
+    static bool unlink(const std::string& name);
+
+    bool is_open() const { return header_ != nullptr; }
+    // False once the writer replaced the segment with one of a new geometry.
+    bool is_current() const;
+    std::uint32_t sample_rate() const { return sample_rate_; }
+    std::uint32_t channels() const { return channels_; }
+    std::size_t capacity_frames() const { return capacity_frames_; }
+    std::uint64_t generation() const;
+    std::uint64_t write_frames() const;
+    // steady_clock nanoseconds of the writer's last block (0 before the first).
+    std::int64_t last_write_ns() const;
+    std::uint64_t dropped_frames() const { return dropped_frames_; }
+    // Fraction of the ring this reader has yet to consume.
+    float occupancy() const;
+    const std::string& last_error() const { return last_error_; }
+
+private:
+    // A writer counts as live while its process exists and it wrote recently.
+    static constexpr std::int64_t kLiveWriterWindowNs = 2'000'000'000;
+
+    bool map(int fd, std::size_t bytes, bool writable);
+    bool has_live_writer() const;
+    float* samples() const;
+
+    ShmPcmHeader* header_ = nullptr;
+    void* mapping_ = nullptr;
+    std::size_t mapping_bytes_ = 0;
+    std::uint32_t sample_rate_ = 0;
+    std::uint32_t channels_ = 0;
+    std::size_t capacity_frames_ = 0;
+    std::size_t guard_frames_ = 0;
+    bool writer_ = false;
+
+    std::uint64_t read_frames_ = 0;
+    std::uint64_t seen_generation_ = 0;
+    std::uint64_t dropped_frames_ = 0;
+    std::string last_error_;
+};
+
+} // namespace when
@@ -0,0 +1,68 @@
+#include "audio/tone_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace when {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr float kMinBandwidthHz = 0.5f;
+constexpr float kDenormalPowerFloor = 1e-30f; // Flush decayed state before it turns denormal
+} // namespace
+
+void ToneTracker::configure(const Config& config, float sample_rate) {
+    resonators_.clear();
+    if (sample_rate <= 0.0f) {
+        envelopes_.clear();
+        peaks_.clear();
+        return;
+    }
+
+    const double nyquist = 0.5 * static_cast<double>(sample_rate);
+    const double bandwidth = static_cast<double>(std::max(config.bandwidth_hz, kMinBandwidthHz));
+    const double decay = std::exp(-kPi * bandwidth / static_cast<double>(sample_rate));
+    // A sinusoid of amplitude A settles at |X| = A / (2 * (1 - decay)).
+    amplitude_scale_ = static_cast<float>(2.0 * (1.0 - decay));
+
+    for (float frequency : config.frequencies) {
+        if (frequency <= 0.0f || static_cast<double>(frequency) >= nyquist) {
+            continue;
+        }
+        const double omega = 2.0 * kPi * static_cast<double>(frequency) / static_cast<double>(sample_rate);
+        Resonator resonator;
+        resonator.rotate_real = static_cast<float>(decay * std::cos(omega));
+        resonator.rotate_imag = static_cast<float>(decay * std::sin(omega));
+        resonators_.push_back(resonator);
+    }
+
+    envelopes_.assign(resonators_.size(), 0.0f);
+    peaks_.assign(resonators_.size(), 0.0f);
+}
+
+void ToneTracker::reset() {
+    for (Resonator& resonator : resonators_) {
+        resonator.real = 0.0f;
+        resonator.imag = 0.0f;
+        resonator.peak_power = 0.0f;
+    }
+    std::fill(envelopes_.begin(), envelopes_.end(), 0.0f);
+    std::fill(peaks_.begin(), peaks_.end(), 0.0f);
+}
+
+void ToneTracker::snapshot() {
+    for (std::size_t i = 0; i < resonators_.size(); ++i) {
+        Resonator& resonator = resonators_[i];
+        float power = resonator.real * resonator.real + resonator.imag * resonator.imag;
+        if (power < kDenormalPowerFloor) {
+            resonator.real = 0.0f;
+            resonator.imag = 0.0f;
+            power = 0.0f;
+        }
+        envelopes_[i] = std::sqrt(power) * amplitude_scale_;
+        peaks_[i] = std::sqrt(std::max(resonator.peak_power, power)) * amplitude_scale_;
+        resonator.peak_power = power;
+    }
+}
+
+} // namespace when
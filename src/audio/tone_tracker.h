@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace when {
+
+// Bank of single-bin sliding DFTs with an exponential window. Each tracked
+// frequency costs one complex multiply-add per sample, so a handful of tones
+// can be followed at sample resolution for a fraction of one FFT.
+class ToneTracker {
+public:
+    struct Config {
+        std::vector<float> frequencies; // Target frequencies in Hz (empty = disabled)
+        float bandwidth_hz = 10.0f;     // Resolution bandwidth; the envelope time constant is 1 / (pi * bandwidth)
+    };
+
+    ToneTracker() = default;
+
+    void configure(const Config& config, float sample_rate);
+    void reset();
+
+    bool empty() const { return resonators_.empty(); }
+    std::size_t size() const { return resonators_.size(); }
+
+    void push(float sample) {
+        for (Resonator& resonator : resonators_) {
+            const float real = resonator.real * resonator.rotate_real - resonator.imag * resonator.rotate_imag + sample;
+            const float imag = resonator.real * resonator.rotate_imag + resonator.imag * resonator.rotate_real;
+            resonator.real = real;
+            resonator.imag = imag;
+            const float power = real * real + imag * imag;
+            if (power > resonator.peak_power) {
+                resonator.peak_power = power;
+            }
+        }
+    }
+
+    // Publishes the current envelopes and the per-interval peaks, then starts
+    // a new peak interval. The spans stay valid until the next snapshot.
+    void snapshot();
+    std::span<const float> envelopes() const { return envelopes_; }
+    std::span<const float> peaks() const { return peaks_; }
+
+private:
+    struct Resonator {
+        float rotate_real = 0.0f; // decay * cos(omega)
+        float rotate_imag = 0.0f; // decay * sin(omega)
+        float real = 0.0f;
+        float imag = 0.0f;
+        float peak_power = 0.0f;
+    };
+
+    std::vector<Resonator> resonators_;
+    std::vector<float> envelopes_;
+    std::vector<float> peaks_;
+    float amplitude_scale_ = 0.0f; // Converts |X| to the amplitude of a steady sinusoid
+};
+
+} // namespace when
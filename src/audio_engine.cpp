@@ -48,6 +48,11 @@ bool contains_ignore_case(std::string_view haystack, std::string_view needle) {
 
 namespace when {
 
+namespace {
+constexpr std::chrono::milliseconds kShmReattachInterval{250};
+constexpr std::chrono::milliseconds kShmSilenceTimeout{1000};
+} // namespace
+
 AudioEngine::FloatRingBuffer::FloatRingBuffer(std::size_t capacity)
     : buffer_(capacity), capacity_(capacity), head_(0), tail_(0) {}
 
@@ -75,6 +80,12 @@ std::size_t AudioEngine::FloatRingBuffer::write(const float* data, std::size_t c
     return to_write;
 }
 
+std::size_t AudioEngine::FloatRingBuffer::size() const {
+    const std::size_t tail = tail_.load(std::memory_order_acquire);
+    const std::size_t head = head_.load(std::memory_order_acquire);
+    return head >= tail ? head - tail : 0;
+}
+
 std::size_t AudioEngine::FloatRingBuffer::read(float* dest, std::size_t count) {
     if (capacity_ == 0 || count == 0) {
         return 0;
@@ -112,6 +123,11 @@ AudioEngine::AudioEngine(ma_uint32 sample_rate,
       file_path_(std::move(file_path)),
       device_name_(std::move(device_name)),
       system_audio_(system_audio),
+      requested_period_frames_(0),
+      requested_periods_(0),
+      low_latency_(false),
+      achieved_period_frames_(0),
+      achieved_periods_(0),
       device_initialized_(false),
       context_initialized_(false),
       have_device_id_(false),
@@ -120,12 +136,38 @@ AudioEngine::AudioEngine(ma_uint32 sample_rate,
       decoder_sample_rate_(0),
       file_stream_channels_(0),
       resampler_initialized_(false),
-      stop_stream_thread_(false) {}
+      stop_stream_thread_(false),
+      capture_sink_(nullptr),
+      realtime_priority_(false),
+      shm_dropped_seen_(0) {}
 
 AudioEngine::~AudioEngine() { stop(); }
 
+void AudioEngine::set_period_hint(ma_uint32 period_frames, ma_uint32 periods, bool low_latency) {
+    requested_period_frames_ = period_frames;
+    requested_periods_ = periods;
+    low_latency_ = low_latency;
+}
+
+void AudioEngine::set_shared_memory_source(std::string name) {
+    shm_name_ = std::move(name);
+    mode_ = Mode::SharedMemory;
+}
+
+void AudioEngine::set_capture_sink(ShmPcmRing* sink) { capture_sink_ = sink; }
+
+void AudioEngine::set_realtime_priority(bool realtime) { realtime_priority_ = realtime; }
+
 bool AudioEngine::start() {
     last_error_.clear();
+    if (mode_ == Mode::SharedMemory) {
+        // A missing daemon is not fatal: read_samples() keeps trying.
+        shm_next_attach_ = std::chrono::steady_clock::now() + kShmReattachInterval;
+        if (!shm_ring_.is_open()) {
+            attach_shared_memory();
+        }
+        return true;
+    }
     if (mode_ == Mode::Capture) {
         if (device_initialized_) {
             return true;
@@ -143,10 +185,18 @@ bool AudioEngine::start() {
         config.capture.channels = channels_;
         config.dataCallback = &AudioEngine::data_callback;
         config.pUserData = this;
+        config.periodSizeInFrames = requested_period_frames_;
+        config.periods = requested_periods_;
+        if (low_latency_) {
+            config.performanceProfile = ma_performance_profile_low_latency;
+        }
 
         ma_context* context = nullptr;
-        if (!device_name_.empty() || system_audio_) {
+        if (!device_name_.empty() || system_audio_ || realtime_priority_) {
             ma_context_config context_config = ma_context_config_init();
+            if (realtime_priority_) {
+                context_config.threadPriority = ma_thread_priority_realtime;
+            }
             if (ma_context_init(nullptr, 0, &context_config, &context_) != MA_SUCCESS) {
                 last_error_ = "failed to initialize audio context";
                 return false;
@@ -268,6 +318,8 @@ bool AudioEngine::start() {
         }
 
         device_initialized_ = true;
+        achieved_period_frames_ = device_.capture.internalPeriodSizeInFrames;
+        achieved_periods_ = device_.capture.internalPeriods;
         dropped_samples_.store(0, std::memory_order_relaxed);
         return true;
     }
@@ -320,6 +372,10 @@ bool AudioEngine::start() {
 }
 
 void AudioEngine::stop() {
+    if (mode_ == Mode::SharedMemory) {
+        shm_ring_.close();
+        return;
+    }
     if (mode_ == Mode::Capture) {
         if (!device_initialized_) {
             return;
@@ -332,6 +388,8 @@ void AudioEngine::stop() {
         }
         have_device_id_ = false;
         device_initialized_ = false;
+        achieved_period_frames_ = 0;
+        achieved_periods_ = 0;
         return;
     }
 
@@ -355,6 +413,9 @@ void AudioEngine::stop() {
 }
 
 std::size_t AudioEngine::read_samples(float* dest, std::size_t max_samples) {
+    if (mode_ == Mode::SharedMemory) {
+        return read_shared_memory(dest, max_samples);
+    }
     return ring_buffer_.read(dest, max_samples);
 }
 
@@ -362,6 +423,17 @@ std::size_t AudioEngine::dropped_samples() const {
     return dropped_samples_.load(std::memory_order_relaxed);
 }
 
+float AudioEngine::ring_occupancy() const {
+    if (mode_ == Mode::SharedMemory) {
+        return shm_ring_.occupancy();
+    }
+    const std::size_t capacity = ring_buffer_.capacity();
+    if (capacity == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(ring_buffer_.size()) / static_cast<float>(capacity);
+}
+
 void AudioEngine::data_callback(ma_device* device, void*, const void* input, ma_uint32 frame_count) {
     auto* engine = reinterpret_cast<AudioEngine*>(device->pUserData);
     if (!engine) {
@@ -369,6 +441,10 @@ void AudioEngine::data_callback(ma_device* device, void*, const void* input, ma_
     }
 
     const float* samples = static_cast<const float*>(input);
+    if (engine->capture_sink_) {
+        engine->capture_sink_->write(samples, frame_count);
+        return;
+    }
     const std::size_t sample_count = static_cast<std::size_t>(frame_count) * engine->channels_;
     const std::size_t written = engine->ring_buffer_.write(samples, sample_count);
     if (written < sample_count) {
@@ -376,6 +452,74 @@ void AudioEngine::data_callback(ma_device* device, void*, const void* input, ma_
     }
 }
 
+bool AudioEngine::attach_shared_memory() {
+    if (!shm_ring_.attach(shm_name_)) {
+        last_error_ = shm_ring_.last_error();
+        return false;
+    }
+    if (shm_ring_.sample_rate() != sample_rate_) {
+        last_error_ = "capture daemon on '" + shm_name_ + "' runs at " + std::to_string(shm_ring_.sample_rate()) +
+                      " Hz, expected " + std::to_string(sample_rate_) + " Hz";
+        shm_ring_.close();
+        return false;
+    }
+    last_error_.clear();
+    shm_dropped_seen_ = 0;
+    return true;
+}
+
+std::size_t AudioEngine::read_shared_memory(float* dest, std::size_t max_samples) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= shm_next_attach_) {
+        // Re-attach when the daemon retired the ring or has stopped writing;
+        // a restarted daemon with the same geometry needs neither.
+        const std::int64_t now_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        const bool silent = now_ns - shm_ring_.last_write_ns() >
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(kShmSilenceTimeout).count();
+        if (!shm_ring_.is_current() || silent) {
+            attach_shared_memory();
+        }
+        shm_next_attach_ = now + kShmReattachInterval;
+    }
+    if (!shm_ring_.is_current()) {
+        return 0;
+    }
+
+    const std::size_t source_channels = shm_ring_.channels();
+    std::size_t produced = 0;
+    if (source_channels == channels_) {
+        produced = shm_ring_.read(dest, max_samples);
+    } else {
+        const std::size_t frames = max_samples / channels_;
+        shm_scratch_.resize(frames * source_channels);
+        const std::size_t frames_read = shm_ring_.read(shm_scratch_.data(), shm_scratch_.size()) / source_channels;
+        for (std::size_t frame = 0; frame < frames_read; ++frame) {
+            const float* in = &shm_scratch_[frame * source_channels];
+            if (channels_ == 1) {
+                double sum = 0.0;
+                for (std::size_t ch = 0; ch < source_channels; ++ch) {
+                    sum += in[ch];
+                }
+                dest[frame] = static_cast<float>(sum / static_cast<double>(source_channels));
+            } else {
+                for (std::size_t ch = 0; ch < channels_; ++ch) {
+                    dest[frame * channels_ + ch] = in[std::min(ch, source_channels - 1)];
+                }
+            }
+        }
+        produced = frames_read * channels_;
+    }
+
+    const std::uint64_t dropped = shm_ring_.dropped_frames();
+    if (dropped > shm_dropped_seen_) {
+        dropped_samples_.fetch_add(static_cast<std::size_t>(dropped - shm_dropped_seen_) * channels_,
+                                   std::memory_order_relaxed);
+        shm_dropped_seen_ = dropped;
+    }
+    return produced;
+}
+
 void AudioEngine::file_stream_loop() {
     if (!decoder_initialized_) {
         return;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <string>
@@ -9,6 +10,8 @@
 
 #include <miniaudio.h>
 
+#include "audio/shm_pcm_ring.h"
+
 namespace when {
 
 struct AudioMetrics {
@@ -16,6 +19,10 @@ struct AudioMetrics {
     float rms = 0.0f;
     float peak = 0.0f;
     std::size_t dropped = 0;
+    std::size_t stale_skips = 0; // Times the DSP skipped a stale backlog to catch up
+    float analysis_rate_hz = 0.0f; // Current DSP hop rate
+    float analysis_load = 0.0f;    // Smoothed analysis cost as a fraction of real time
+    std::size_t bypassed_stages = 0; // Analysis stages bypassed for overrunning their budget
 };
 
 class AudioEngine {
@@ -28,15 +35,36 @@ public:
                 bool system_audio = false);
     ~AudioEngine();
 
+    // Requests a device period size/count for capture mode. Must be called
+    // before start(); zero leaves the choice to the backend.
+    void set_period_hint(ma_uint32 period_frames, ma_uint32 periods, bool low_latency);
+    // Reads from a when-capture shared-memory ring instead of a device or
+    // file. Must be called before start(). read_samples() re-attaches when the
+    // daemon goes quiet or replaces the ring, so it may restart at any time.
+    void set_shared_memory_source(std::string name);
+    // Capture mode: device blocks go straight to sink instead of the internal
+    // ring (the when-capture daemon). Must be called before start().
+    void set_capture_sink(ShmPcmRing* sink);
+    // Asks miniaudio for a real-time device thread; it quietly falls back to
+    // normal priority when the process may not use SCHED_FIFO.
+    void set_realtime_priority(bool realtime);
+
     bool start();
     void stop();
 
     std::size_t read_samples(float* dest, std::size_t max_samples);
     std::size_t dropped_samples() const;
+    // Fraction of the ring currently holding unread samples.
+    float ring_occupancy() const;
     const std::string& last_error() const { return last_error_; }
 
     ma_uint32 channels() const { return channels_; }
     bool using_file_stream() const { return mode_ == Mode::FileStream; }
+    bool using_shared_memory() const { return mode_ == Mode::SharedMemory; }
+    bool shared_memory_attached() const { return shm_ring_.is_current(); }
+    // Period size/count reported by the backend after ma_device_init (0 when unknown).
+    ma_uint32 period_frames() const { return achieved_period_frames_; }
+    ma_uint32 periods() const { return achieved_periods_; }
 
 private:
     class FloatRingBuffer {
@@ -45,6 +73,8 @@ private:
 
         std::size_t write(const float* data, std::size_t count);
         std::size_t read(float* dest, std::size_t count);
+        std::size_t size() const;
+        std::size_t capacity() const { return capacity_; }
 
     private:
         std::vector<float> buffer_;
@@ -53,10 +83,12 @@ private:
         std::atomic<std::size_t> tail_;
     };
 
-    enum class Mode { Capture, FileStream };
+    enum class Mode { Capture, FileStream, SharedMemory };
 
     static void data_callback(ma_device* device, void* output, const void* input, ma_uint32 frame_count);
     void file_stream_loop();
+    bool attach_shared_memory();
+    std::size_t read_shared_memory(float* dest, std::size_t max_samples);
 
     const ma_uint32 sample_rate_;
     const ma_uint32 channels_;
@@ -68,6 +100,12 @@ private:
     bool system_audio_;
     std::string last_error_;
 
+    ma_uint32 requested_period_frames_;
+    ma_uint32 requested_periods_;
+    bool low_latency_;
+    ma_uint32 achieved_period_frames_;
+    ma_uint32 achieved_periods_;
+
     ma_device device_{};
     bool device_initialized_;
 
@@ -87,6 +125,15 @@ private:
 
     std::thread stream_thread_;
     std::atomic<bool> stop_stream_thread_;
+
+    ShmPcmRing* capture_sink_;
+    bool realtime_priority_;
+
+    std::string shm_name_;
+    ShmPcmRing shm_ring_;
+    std::vector<float> shm_scratch_;
+    std::uint64_t shm_dropped_seen_;
+    std::chrono::steady_clock::time_point shm_next_attach_;
 };
 
 } // namespace when
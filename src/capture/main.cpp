@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include "audio/shm_pcm_ring.h"
+#include "audio_engine.h"
+#include "config.h"
+
+namespace {
+// miniaudio drops to normal priority without telling anyone, so say up front
+// whether SCHED_FIFO is likely to be granted.
+bool realtime_permitted() {
+    if (::geteuid() == 0) {
+        return true;
+    }
+    struct rlimit limit {};
+    return ::getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur > 0;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    cxxopts::Options options("when-capture",
+                             "Capture daemon: keeps the audio device open and shares PCM with when --attach");
+    options.add_options()
+        ("c,config", "Path to configuration file", cxxopts::value<std::string>()->default_value("when.toml"))
+        ("n,name", "Shared-memory name (default: audio.shared_memory.name)", cxxopts::value<std::string>())
+        ("d,device", "Audio input device override", cxxopts::value<std::string>())
+        ("system", "Force system audio capture")
+        ("mic", "Force microphone capture")
+        ("realtime", "Request a SCHED_FIFO capture thread and lock memory")
+        ("unlink", "Remove the shared memory on exit instead of leaving it for the next daemon")
+        ("force", "Take the shared memory over even while another daemon is still writing it")
+        ("h,help", "Print usage");
+
+    std::string config_path;
+    std::string name_override;
+    std::string device_name_override;
+    int system_override = -1; // -1 = use config, 0 = mic, 1 = system
+    bool realtime_override = false;
+    bool unlink_on_exit = false;
+    bool force = false;
+    try {
+        const auto result = options.parse(argc, argv);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+        config_path = result["config"].as<std::string>();
+        if (result.count("name")) {
+            name_override = result["name"].as<std::string>();
+        }
+        if (result.count("device")) {
+            device_name_override = result["device"].as<std::string>();
+        }
+        if (result.count("system") && result.count("mic")) {
+            std::cerr << "Cannot specify both --system and --mic" << std::endl;
+            return 1;
+        }
+        if (result.count("system")) {
+            system_override = 1;
+        } else if (result.count("mic")) {
+            system_override = 0;
+        }
+        realtime_override = result.count("realtime") > 0;
+        unlink_on_exit = result.count("unlink") > 0;
+        force = result.count("force") > 0;
+    } catch (const cxxopts::exceptions::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+
+    const when::ConfigLoadResult config_result = when::load_app_config(config_path);
+    const when::AppConfig& config = config_result.config;
+    if (!config_result.loaded_file) {
+        std::clog << "[config] using built-in defaults (missing '" << config_path << "')" << std::endl;
+    }
+    for (const std::string& warning : config_result.warnings) {
+        std::cerr << "[config] " << warning << std::endl;
+    }
+
+    const when::AudioCaptureConfig& capture = config.audio.capture;
+    const std::string name = name_override.empty() ? config.audio.shared_memory.name : name_override;
+    const std::string device = device_name_override.empty() ? capture.device : device_name_override;
+    const bool system_audio = system_override == -1 ? capture.system : system_override == 1;
+    const bool realtime = realtime_override || config.audio.shared_memory.realtime;
+    const std::uint32_t channels = std::max<std::uint32_t>(1, capture.channels);
+    const std::size_t capacity_frames = std::max<std::size_t>(
+        1024, static_cast<std::size_t>(capture.sample_rate) * config.audio.shared_memory.capacity_ms / 1000);
+
+    // Signals are taken synchronously below; block them before miniaudio
+    // starts its threads so they inherit the mask.
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    sigaddset(&stop_signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+    if (realtime) {
+        if (!realtime_permitted()) {
+            std::cerr << "[capture] realtime priority unavailable (RLIMIT_RTPRIO is 0); capture thread stays at normal "
+                         "priority"
+                      << std::endl;
+        }
+        if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::cerr << "[capture] could not lock memory; page faults may still stall the capture thread" << std::endl;
+        }
+    }
+
+    when::ShmPcmRing ring;
+    if (!ring.create(name, capture.sample_rate, channels, capacity_frames, force)) {
+        std::cerr << "[capture] " << ring.last_error() << std::endl;
+        return 1;
+    }
+
+    when::AudioEngine audio(capture.sample_rate, channels, capture.ring_frames, {}, device, system_audio);
+    audio.set_period_hint(capture.period_frames, capture.periods, capture.latency_profile == "low_latency");
+    audio.set_capture_sink(&ring);
+    audio.set_realtime_priority(realtime);
+    if (!audio.start()) {
+        std::cerr << "[capture] failed to start audio capture";
+        if (!audio.last_error().empty()) {
+            std::cerr << ": " << audio.last_error();
+        }
+        std::cerr << std::endl;
+        if (unlink_on_exit) {
+            when::ShmPcmRing::unlink(name);
+        }
+        return 1;
+    }
+    std::clog << "[capture] writing " << capture.sample_rate << " Hz x " << channels << " to '" << name << "' ("
+              << capacity_frames << " frames, generation " << ring.generation() << "), period "
+              << audio.period_frames() << " frames x " << audio.periods() << std::endl;
+
+    int signal_number = 0;
+    sigwait(&stop_signals, &signal_number);
+    std::clog << "[capture] stopping after " << ring.write_frames() << " frames" << std::endl;
+
+    audio.stop();
+    ring.close();
+    if (unlink_on_exit) {
+        when::ShmPcmRing::unlink(name);
+    }
+    return 0;
+}
@@ -86,6 +86,17 @@ void populate_audio_config(const RawConfig& raw,
                   audio.capture.system,
                   parse_bool,
                   warnings);
+    assign_string(raw, "audio.capture.latency_profile", audio.capture.latency_profile);
+    assign_scalar(raw,
+                  "audio.capture.period_frames",
+                  audio.capture.period_frames,
+                  parse_uint32,
+                  warnings);
+    assign_scalar(raw,
+                  "audio.capture.periods",
+                  audio.capture.periods,
+                  parse_uint32,
+                  warnings);
 
     assign_scalar(raw,
                   "audio.file.enabled",
@@ -104,6 +115,23 @@ void populate_audio_config(const RawConfig& raw,
                   parse_float32,
                   warnings);
 
+    assign_scalar(raw,
+                  "audio.shared_memory.enabled",
+                  audio.shared_memory.enabled,
+                  parse_bool,
+                  warnings);
+    assign_string(raw, "audio.shared_memory.name", audio.shared_memory.name);
+    assign_scalar(raw,
+                  "audio.shared_memory.capacity_ms",
+                  audio.shared_memory.capacity_ms,
+                  parse_uint32,
+                  warnings);
+    assign_scalar(raw,
+                  "audio.shared_memory.realtime",
+                  audio.shared_memory.realtime,
+                  parse_bool,
+                  warnings);
+
     assign_scalar(raw,
                   "audio.prefer_file",
                   audio.prefer_file,
@@ -122,6 +150,49 @@ void populate_dsp_config(const RawConfig& raw,
     assign_scalar(raw, "dsp.hop_size", dsp.hop_size, parse_size, warnings);
     assign_scalar(raw, "dsp.bands", dsp.bands, parse_size, warnings);
     assign_string(raw, "dsp.window", dsp.window);
+    assign_scalar(raw, "dsp.kaiser_beta", dsp.kaiser_beta, parse_float32, warnings);
+    assign_scalar(raw, "dsp.max_backlog_ms", dsp.max_backlog_ms, parse_float32, warnings);
+    assign_scalar(raw, "dsp.adaptive_hop", dsp.adaptive_hop, parse_bool, warnings);
+    assign_scalar(raw, "dsp.phase_refinement", dsp.phase_refinement, parse_bool, warnings);
+    const auto tones_it = raw.arrays.find("dsp.tone_frequencies");
+    if (tones_it != raw.arrays.end()) {
+        dsp.tone_frequencies.clear();
+        for (const std::string& value : tones_it->second.values) {
+            float frequency = 0.0f;
+            if (parse_float32(value, frequency) && frequency > 0.0f) {
+                dsp.tone_frequencies.push_back(frequency);
+            } else {
+                std::ostringstream oss;
+                oss << "Invalid value '" << value << "' in 'dsp.tone_frequencies' on line " << tones_it->second.line;
+                warnings.push_back(oss.str());
+            }
+        }
+    }
+    assign_scalar(raw, "dsp.tone_bandwidth_hz", dsp.tone_bandwidth_hz, parse_float32, warnings);
+    assign_scalar(raw, "dsp.section_detection", dsp.section_detection, parse_bool, warnings);
+    assign_scalar(raw, "dsp.novelty_kernel_s", dsp.novelty_kernel_s, parse_float32, warnings);
+    assign_scalar(raw, "dsp.novelty_block_s", dsp.novelty_block_s, parse_float32, warnings);
+    assign_scalar(raw, "dsp.novelty_threshold", dsp.novelty_threshold, parse_float32, warnings);
+    assign_scalar(raw, "dsp.section_min_interval_s", dsp.section_min_interval_s, parse_float32, warnings);
+    assign_scalar(raw,
+                  "dsp.analysis_stage_budget_ms",
+                  dsp.analysis_stage_budget_ms,
+                  parse_float32,
+                  warnings);
+    assign_scalar(raw, "dsp.min_hop_size", dsp.min_hop_size, parse_size, warnings);
+    assign_scalar(raw, "dsp.max_hop_size", dsp.max_hop_size, parse_size, warnings);
+    assign_scalar(raw,
+                  "dsp.analysis_cpu_budget",
+                  dsp.analysis_cpu_budget,
+                  parse_float32,
+                  warnings);
+    assign_scalar(raw, "dsp.autotune", dsp.autotune, parse_bool, warnings);
+    assign_scalar(raw,
+                  "dsp.autotune_max_latency_ms",
+                  dsp.autotune_max_latency_ms,
+                  parse_float32,
+                  warnings);
+    assign_string(raw, "dsp.wisdom_file", dsp.wisdom_file);
     assign_scalar(raw,
                   "dsp.smoothing_attack",
                   dsp.smoothing_attack,
@@ -197,6 +268,18 @@ void populate_runtime_config(const RawConfig& raw,
                   parse_double,
                   warnings);
     assign_string(raw, "runtime.band_feature_log_file", runtime.band_feature_log_file);
+    assign_string(raw, "runtime.output_backend", runtime.output_backend);
+}
+
+void populate_metrics_config(const RawConfig& raw,
+                             MetricsConfig& metrics,
+                             std::vector<std::string>& warnings) {
+    using config::detail::parse_bool;
+    using config::detail::parse_double;
+    assign_scalar(raw, "metrics.enabled", metrics.enabled, parse_bool, warnings);
+    assign_string(raw, "metrics.mode", metrics.mode);
+    assign_string(raw, "metrics.path", metrics.path);
+    assign_scalar(raw, "metrics.interval_s", metrics.interval_s, parse_double, warnings);
 }
 
 void populate_plugin_config(const RawConfig& raw,
@@ -239,17 +322,60 @@ void apply_sanity_defaults(AppConfig& config) {
     if (config.audio.file.gain <= 0.0f) {
         config.audio.file.gain = 1.0f;
     }
+    if (config.audio.shared_memory.name.empty()) {
+        config.audio.shared_memory.name = "/when-pcm";
+    } else if (config.audio.shared_memory.name.front() != '/') {
+        config.audio.shared_memory.name.insert(0, 1, '/');
+    }
+    config.audio.shared_memory.capacity_ms =
+        std::clamp<std::uint32_t>(config.audio.shared_memory.capacity_ms, 100, 60000);
     if (config.dsp.hop_size == 0) {
         config.dsp.hop_size = std::max<std::size_t>(1, config.dsp.fft_size / 4);
     }
+    if (config.dsp.max_backlog_ms < 0.0f) {
+        config.dsp.max_backlog_ms = 0.0f;
+    }
+    if (config.dsp.kaiser_beta < 0.0f) {
+        config.dsp.kaiser_beta = 0.0f;
+    }
+    if (config.dsp.autotune_max_latency_ms < 0.0f) {
+        config.dsp.autotune_max_latency_ms = 0.0f;
+    }
     if (config.visual.target_fps <= 0.0) {
         config.visual.target_fps = 60.0;
     }
+    if (config.metrics.interval_s <= 0.0) {
+        config.metrics.interval_s = 5.0;
+    }
     if (config.plugins.autoload.empty()) {
         config.plugins.autoload.push_back("beat-flash-debug");
     }
 }
 
+void resolve_capture_latency(AppConfig& config, std::vector<std::string>& warnings) {
+    AudioCaptureConfig& capture = config.audio.capture;
+    if (capture.latency_profile.empty() || capture.latency_profile == "default") {
+        capture.latency_profile = "default";
+        return;
+    }
+    if (capture.latency_profile != "low_latency") {
+        warnings.push_back("Unknown audio.capture.latency_profile '" + capture.latency_profile +
+                           "'; using backend defaults");
+        capture.latency_profile = "default";
+        return;
+    }
+
+    // One device period per analysis hop keeps the callback cadence aligned with
+    // the DSP so features are never a whole period stale. Explicit values win.
+    if (capture.period_frames == 0) {
+        capture.period_frames = static_cast<std::uint32_t>(config.dsp.hop_size);
+        capture.period_from_hop = true;
+    }
+    if (capture.periods == 0) {
+        capture.periods = 2;
+    }
+}
+
 } // namespace
 
 ConfigLoadResult load_app_config(const std::string& path) {
@@ -262,10 +388,12 @@ ConfigLoadResult load_app_config(const std::string& path) {
     populate_dsp_config(raw, result.config.dsp, result.warnings);
     populate_visual_config(raw, result.config.visual, result.warnings);
     populate_runtime_config(raw, result.config.runtime, result.warnings);
+    populate_metrics_config(raw, result.config.metrics, result.warnings);
     populate_plugin_config(raw, result.config.plugins, result.warnings);
     populate_animation_configs(raw, result.config.animations, result.warnings);
 
     apply_sanity_defaults(result.config);
+    resolve_capture_latency(result.config, result.warnings);
 
     return result;
 }
@@ -18,6 +18,10 @@ struct AudioCaptureConfig {
     std::string device;
     float input_gain = 1.0f;
     bool system = false;
+    std::string latency_profile = "default"; // "default" or "low_latency" (period derived from dsp.hop_size)
+    std::uint32_t period_frames = 0;         // Device period size in frames (0 = backend/profile default)
+    std::uint32_t periods = 0;               // Number of device periods (0 = backend/profile default)
+    bool period_from_hop = false;            // Set when low_latency derived period_frames from dsp.hop_size
 };
 
 struct AudioFileConfig {
@@ -27,9 +31,17 @@ struct AudioFileConfig {
     float gain = 1.0f;
 };
 
+struct AudioSharedMemoryConfig {
+    bool enabled = false;             // Read PCM from a running when-capture instead of opening a device
+    std::string name = "/when-pcm";   // POSIX shared-memory object the daemon writes
+    std::uint32_t capacity_ms = 2000; // Ring length when-capture allocates
+    bool realtime = false;            // when-capture: request a SCHED_FIFO capture thread
+};
+
 struct AudioConfig {
     AudioCaptureConfig capture;
     AudioFileConfig file;
+    AudioSharedMemoryConfig shared_memory;
     bool prefer_file = false;
 };
 
@@ -37,7 +49,25 @@ struct DspConfig {
     std::size_t fft_size = 1024;
     std::size_t hop_size = 256;
     std::size_t bands = 32;
-    std::string window = "hann";
+    std::string window = "hann";     // hann, blackman-harris, kaiser or flat-top
+    float kaiser_beta = 8.6f;        // Kaiser window shape; larger trades a wider main lobe for lower leakage
+    float max_backlog_ms = 250.0f; // Skip to the newest audio when more than this is queued (0 = never skip)
+    bool adaptive_hop = false;       // Let the DSP adjust hop_size to fit the CPU budget
+    std::size_t min_hop_size = 0;    // Lower hop bound for adaptive_hop (0 = hop_size / 2)
+    std::size_t max_hop_size = 0;    // Upper hop bound for adaptive_hop (0 = fft_size)
+    float analysis_cpu_budget = 0.25f; // Fraction of real time the analysis may use
+    bool autotune = false;             // Choose fft_size/hop_size by timing this machine (cached in wisdom_file)
+    float autotune_max_latency_ms = 0.0f; // Bound on FFT window + hop for autotune (0 = that of fft_size/hop_size)
+    std::string wisdom_file = "when.wisdom";
+    bool phase_refinement = true;    // Refine spectral peak frequencies from frame-to-frame phase
+    std::vector<float> tone_frequencies; // Frequencies (Hz) tracked per sample by the sliding-DFT bank
+    float tone_bandwidth_hz = 10.0f;     // Sliding-DFT resolution; narrower is more selective but slower
+    bool section_detection = true;       // Detect song-section changes from a streaming novelty curve
+    float novelty_kernel_s = 16.0f;      // Checkerboard kernel width (past + future) in seconds
+    float novelty_block_s = 0.5f;        // Feature averaging block for the novelty curve
+    float novelty_threshold = 0.3f;      // Normalised novelty required for a section change
+    float section_min_interval_s = 8.0f; // Minimum time between section changes
+    float analysis_stage_budget_ms = 0.5f; // Per-hop time allowed to each plug-in analysis stage (0 = unlimited)
     float smoothing_attack = 0.2f;
     float smoothing_release = 0.05f;
     float beat_sensitivity = 1.0f;
@@ -64,6 +94,14 @@ struct RuntimeConfig {
     bool band_feature_logging = false;
     double band_feature_logging_duration_s = 0.0;
     std::string band_feature_log_file;
+    std::string output_backend = "notcurses"; // "notcurses" or "ansi" (diffed direct escape output)
+};
+
+struct MetricsConfig {
+    bool enabled = false;
+    std::string mode = "textfile"; // "textfile" (node_exporter collector) or "socket" (Unix socket)
+    std::string path = "when.prom";
+    double interval_s = 5.0;       // Text file rewrite period
 };
 
 struct PluginConfig {
@@ -76,6 +114,8 @@ struct AnimationConfig {
     std::string type;
     int z_index = 0;
     bool initially_active = true; // New: whether the animation starts active
+    int update_divisor = 1;       // Update every Nth frame (accumulated delta time); staggered with peers
+    int render_divisor = 1;       // Redraw every Nth frame; skipped frames keep the previous plane content
     // Trigger conditions
     int trigger_band_index = -1; // -1 means no feature-specific trigger (0=bass,1=mid,2=treble,3=total,4=centroid)
     float trigger_threshold = 0.0f; // Threshold for the selected audio feature or beat strength
@@ -143,6 +183,8 @@ struct AnimationConfig {
     float light_brush_base_thickness_beat_scale = 1.6f; // Beat contribution to initial thickness
     float light_brush_base_thickness_tonal_base = 0.6f; // Tonal base contribution to thickness
     float light_brush_base_thickness_tonal_scale = 0.8f; // Tonal scale contribution to thickness
+    int light_brush_flow_field_resolution = 32;        // Grid nodes per side of the turbulence flow field
+    float light_brush_flow_field_update_hz = 8.0f;     // Flow field rebuilds per second
     int space_rock_spawn_base_count = 3; // Base number of squares to spawn per bass beat
     float space_rock_spawn_strength_scale = 4.0f; // Additional spawn scale driven by beat strength
     float space_rock_square_lifespan_ms = 1600.0f; // Lifespan of a square in milliseconds
@@ -194,6 +236,7 @@ struct AnimationConfig {
     int log_padding_y = 1;                // Vertical padding between border and log text
     int log_padding_x = 2;                // Horizontal padding between border and log text
     std::string log_title;                // Optional title displayed on the top border
+    bool log_follow = false;              // Tail text_file_path as it grows instead of stepping through it
     // Add more generic parameters as needed, e.g., std::map<std::string, std::string> params;
 
     // Pleasure animation parameters
@@ -243,6 +286,14 @@ struct AnimationConfig {
     int pleasure_baseline_margin = 4;
     int pleasure_max_upward_excursion = 28;
     int pleasure_max_downward_excursion = 6;
+    int pleasure_profile_control_points = 0; // Profile samples per line; 0 derives them from ridge sigma
+
+    // Plasma (cell shader) animation parameters
+    std::string plasma_resolution = "braille"; // "braille" (2x4 dots per cell) or "cell"
+    float plasma_speed = 0.6f;                 // Base animation speed
+    float plasma_scale = 3.0f;                 // Spatial frequency of the plasma field
+    float plasma_bass_warp = 0.35f;            // Radial ripple depth driven by the bass envelope
+    float plasma_threshold = 0.55f;            // Intensity required to light a dot or cell
 };
 
 struct AppConfig {
@@ -251,6 +302,7 @@ struct AppConfig {
     DspConfig dsp;
     VisualConfig visual;
     RuntimeConfig runtime;
+    MetricsConfig metrics;
     PluginConfig plugins;
     std::vector<AnimationConfig> animations;
 };
@@ -31,6 +31,16 @@ std::optional<AnimationConfig> parse_animation_config(
         parse_bool(initially_active_it->second.value, anim_config.initially_active);
     }
 
+    const auto update_divisor_it = raw_anim_config.find("update_divisor");
+    if (update_divisor_it != raw_anim_config.end()) {
+        parse_int32(update_divisor_it->second.value, anim_config.update_divisor);
+    }
+
+    const auto render_divisor_it = raw_anim_config.find("render_divisor");
+    if (render_divisor_it != raw_anim_config.end()) {
+        parse_int32(render_divisor_it->second.value, anim_config.render_divisor);
+    }
+
     const auto trigger_band_index_it = raw_anim_config.find("trigger_band_index");
     if (trigger_band_index_it != raw_anim_config.end()) {
         parse_int32(trigger_band_index_it->second.value, anim_config.trigger_band_index);
@@ -121,6 +131,11 @@ std::optional<AnimationConfig> parse_animation_config(
         anim_config.log_title = sanitize_string_value(log_title_it->second.value);
     }
 
+    const auto log_follow_it = raw_anim_config.find("log_follow");
+    if (log_follow_it != raw_anim_config.end()) {
+        parse_bool(log_follow_it->second.value, anim_config.log_follow);
+    }
+
     const auto plane_y_it = raw_anim_config.find("plane_y");
     if (plane_y_it != raw_anim_config.end()) {
         int value = 0;
@@ -485,6 +500,20 @@ std::optional<AnimationConfig> parse_animation_config(
                       anim_config.light_brush_base_thickness_tonal_scale);
     }
 
+    const auto light_brush_flow_field_resolution_it =
+        raw_anim_config.find("light_brush_flow_field_resolution");
+    if (light_brush_flow_field_resolution_it != raw_anim_config.end()) {
+        parse_int32(light_brush_flow_field_resolution_it->second.value,
+                    anim_config.light_brush_flow_field_resolution);
+    }
+
+    const auto light_brush_flow_field_update_hz_it =
+        raw_anim_config.find("light_brush_flow_field_update_hz");
+    if (light_brush_flow_field_update_hz_it != raw_anim_config.end()) {
+        parse_float32(light_brush_flow_field_update_hz_it->second.value,
+                      anim_config.light_brush_flow_field_update_hz);
+    }
+
     const auto space_rock_spawn_base_count_it =
         raw_anim_config.find("space_rock_spawn_base_count");
     if (space_rock_spawn_base_count_it != raw_anim_config.end()) {
@@ -984,6 +1013,38 @@ std::optional<AnimationConfig> parse_animation_config(
                     anim_config.pleasure_max_downward_excursion);
     }
 
+    const auto pleasure_profile_control_points_it =
+        raw_anim_config.find("pleasure_profile_control_points");
+    if (pleasure_profile_control_points_it != raw_anim_config.end()) {
+        parse_int32(pleasure_profile_control_points_it->second.value,
+                    anim_config.pleasure_profile_control_points);
+    }
+
+    const auto plasma_resolution_it = raw_anim_config.find("plasma_resolution");
+    if (plasma_resolution_it != raw_anim_config.end()) {
+        anim_config.plasma_resolution = sanitize_string_value(plasma_resolution_it->second.value);
+    }
+
+    const auto plasma_speed_it = raw_anim_config.find("plasma_speed");
+    if (plasma_speed_it != raw_anim_config.end()) {
+        parse_float32(plasma_speed_it->second.value, anim_config.plasma_speed);
+    }
+
+    const auto plasma_scale_it = raw_anim_config.find("plasma_scale");
+    if (plasma_scale_it != raw_anim_config.end()) {
+        parse_float32(plasma_scale_it->second.value, anim_config.plasma_scale);
+    }
+
+    const auto plasma_bass_warp_it = raw_anim_config.find("plasma_bass_warp");
+    if (plasma_bass_warp_it != raw_anim_config.end()) {
+        parse_float32(plasma_bass_warp_it->second.value, anim_config.plasma_bass_warp);
+    }
+
+    const auto plasma_threshold_it = raw_anim_config.find("plasma_threshold");
+    if (plasma_threshold_it != raw_anim_config.end()) {
+        parse_float32(plasma_threshold_it->second.value, anim_config.plasma_threshold);
+    }
+
     return anim_config;
 }
 
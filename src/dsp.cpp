@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <stdexcept>
@@ -20,6 +21,13 @@ namespace when {
 namespace {
 constexpr float kMinDisplayFrequency = 20.0f;
 constexpr float kPi = 3.14159265358979323846f;
+constexpr float kTwoPi = 2.0f * kPi;
+constexpr float kPeakMagnitudeFloor = 1e-6f;
+constexpr std::size_t kGovernorIntervalHops = 32;
+constexpr float kGovernorLoadSmoothing = 0.05f;
+constexpr float kGovernorGrowFactor = 1.25f;
+constexpr float kGovernorShrinkFactor = 0.8f;
+constexpr float kGovernorShrinkHeadroom = 0.5f;
 } // namespace
 
 DspEngine::DspEngine(events::EventBus& event_bus,
@@ -34,7 +42,6 @@ DspEngine::DspEngine(events::EventBus& event_bus,
       channels_(channels),
       fft_size_(fft_size),
       hop_size_(hop_size),
-      window_(fft_size_, 0.0f),
       frame_buffer_(fft_size_, 0.0f),
       band_bin_ranges_(bands),
       prev_magnitudes_(bands, 0.0f),
@@ -42,8 +49,10 @@ DspEngine::DspEngine(events::EventBus& event_bus,
       band_flux_(bands, 0.0f),
       fft_magnitudes_(fft_size_ / 2 + 1, 0.0f),
       fft_phases_(fft_size_ / 2 + 1, 0.0f),
+      prev_fft_phases_(fft_size_ / 2 + 1, 0.0f),
+      bin_frequencies_(fft_size_ / 2 + 1, 0.0f),
+      refined_bin_bands_(fft_size_ / 2 + 1, -1),
       feature_extractor_(std::move(feature_config)),
-      fft_cfg_(nullptr),
       fft_in_(fft_size_),
       fft_out_(fft_size_),
       flux_average_(0.0f),
@@ -58,28 +67,13 @@ DspEngine::DspEngine(events::EventBus& event_bus,
         throw std::invalid_argument("Channels must be non-zero");
     }
 
-    const float denominator = static_cast<float>(fft_size_ - 1);
-    for (std::size_t i = 0; i < fft_size_; ++i) {
-        const float phase = (denominator == 0.0f) ? 0.0f : (2.0f * kPi * static_cast<float>(i)) / denominator;
-        const float w = 0.5f - 0.5f * std::cos(phase);
-        window_[i] = w;
-    }
-
-    fft_cfg_ = kiss_fft_alloc(static_cast<int>(fft_size_), 0, nullptr, nullptr);
-    if (!fft_cfg_) {
-        throw std::runtime_error("Failed to allocate FFT config");
-    }
+    set_window(FftWindowType::Hann);
 
     compute_band_ranges();
     feature_extractor_.prepare(band_bin_ranges_.size());
 }
 
-DspEngine::~DspEngine() {
-    if (fft_cfg_) {
-        kiss_fft_free(fft_cfg_);
-        fft_cfg_ = nullptr;
-    }
-}
+DspEngine::~DspEngine() = default;
 
 void DspEngine::push_samples(const float* interleaved_samples, std::size_t count) {
     if (!interleaved_samples || count == 0) {
@@ -92,7 +86,14 @@ void DspEngine::push_samples(const float* interleaved_samples, std::size_t count
         for (std::size_t ch = 0; ch < channels_; ++ch) {
             sum += interleaved_samples[i * channels_ + ch];
         }
-        mono_fifo_.push_back(static_cast<float>(sum / static_cast<double>(channels_)));
+        const float mono = static_cast<float>(sum / static_cast<double>(channels_));
+        tone_tracker_.push(mono);
+        mono_fifo_.push_back(mono);
+    }
+
+    if (max_backlog_frames_ > 0 && mono_fifo_.size() > max_backlog_frames_) {
+        skip_to_latest();
+        return;
     }
 
     while (mono_fifo_.size() >= hop_size_) {
@@ -104,7 +105,137 @@ void DspEngine::push_samples(const float* interleaved_samples, std::size_t count
             mono_fifo_.pop_front();
         }
 
-        process_frame();
+        run_frame();
+    }
+}
+
+void DspEngine::set_max_backlog_ms(float max_backlog_ms) {
+    max_backlog_ms_ = max_backlog_ms;
+    update_backlog_bound();
+}
+
+void DspEngine::update_backlog_bound() {
+    if (max_backlog_ms_ <= 0.0f || sample_rate_ == 0) {
+        max_backlog_frames_ = 0;
+        return;
+    }
+    const auto frames = static_cast<std::size_t>(
+        std::ceil(static_cast<double>(max_backlog_ms_) * static_cast<double>(sample_rate_) / 1000.0));
+    // Never bound below one full analysis window plus a hop, otherwise every push would skip.
+    max_backlog_frames_ = std::max(frames, fft_size_ + hop_size_);
+}
+
+void DspEngine::skip_to_latest() {
+    // Replaying a stale backlog hop by hop would only make the visuals lag
+    // further behind. Analyse the newest window once and drop the rest.
+    const std::size_t discard = mono_fifo_.size() - std::min(mono_fifo_.size(), fft_size_);
+    mono_fifo_.erase(mono_fifo_.begin(), mono_fifo_.begin() + static_cast<std::ptrdiff_t>(discard));
+
+    const std::size_t offset = fft_size_ - mono_fifo_.size();
+    std::fill(frame_buffer_.begin(), frame_buffer_.begin() + static_cast<std::ptrdiff_t>(offset), 0.0f);
+    std::copy(mono_fifo_.begin(), mono_fifo_.end(), frame_buffer_.begin() + static_cast<std::ptrdiff_t>(offset));
+    mono_fifo_.clear();
+
+    ++stale_skips_;
+    resync_flux_ = true;
+    have_prev_phases_ = false;
+    run_frame();
+}
+
+void DspEngine::set_window(FftWindowType type, float kaiser_beta) {
+    FftPlanCache& cache = FftPlanCache::instance();
+    fft_plan_ = cache.acquire(fft_size_, FftDirection::Forward, type, std::max(kaiser_beta, 0.0f));
+    const auto reference = (type == FftWindowType::Hann) ? fft_plan_ : cache.acquire(fft_size_);
+    magnitude_correction_ = reference->coherent_gain() / fft_plan_->coherent_gain();
+    band_energy_correction_ = reference->noise_bandwidth_bins() / fft_plan_->noise_bandwidth_bins();
+    have_prev_phases_ = false;
+}
+
+void DspEngine::set_phase_refinement(bool enabled) {
+    phase_refinement_ = enabled;
+    have_prev_phases_ = false;
+}
+
+void DspEngine::configure_tone_tracker(const ToneTracker::Config& config) {
+    tone_tracker_.configure(config, static_cast<float>(sample_rate_));
+    tone_peaks_.assign(tone_tracker_.size(), 0.0f);
+    tone_peaks_consumed_ = true;
+}
+
+void DspEngine::configure_section_detection(bool enabled, const NoveltyDetector::Config& config) {
+    section_detection_ = enabled;
+    novelty_detector_.configure(config);
+}
+
+void DspEngine::mark_features_consumed() {
+    section_change_pending_ = false;
+    latest_features_.section_change = false;
+    tone_peaks_consumed_ = true; // The next hop starts a new peak interval
+}
+
+void DspEngine::add_analysis_stage(std::unique_ptr<AnalysisStage> stage) {
+    analysis_stages_.add_stage(std::move(stage),
+                               static_cast<float>(sample_rate_),
+                               fft_size_,
+                               band_bin_ranges_.size());
+}
+
+void DspEngine::configure_rate_governor(const RateGovernorConfig& config) {
+    governor_ = config;
+    governor_min_hop_ = (config.min_hop_size > 0) ? config.min_hop_size : std::max<std::size_t>(1, hop_size_ / 2);
+    governor_max_hop_ = (config.max_hop_size > 0) ? config.max_hop_size : fft_size_;
+    governor_min_hop_ = std::clamp<std::size_t>(governor_min_hop_, 1, fft_size_);
+    governor_max_hop_ = std::clamp(governor_max_hop_, governor_min_hop_, fft_size_);
+    governor_.cpu_budget = std::clamp(config.cpu_budget, 0.01f, 1.0f);
+    hops_since_adjust_ = 0;
+    if (governor_.enabled) {
+        hop_size_ = std::clamp(hop_size_, governor_min_hop_, governor_max_hop_);
+        update_backlog_bound();
+    }
+}
+
+float DspEngine::analysis_rate_hz() const {
+    return (hop_size_ > 0) ? static_cast<float>(sample_rate_) / static_cast<float>(hop_size_) : 0.0f;
+}
+
+void DspEngine::run_frame() {
+    const auto start = std::chrono::steady_clock::now();
+    process_frame();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    last_hop_seconds_ = elapsed.count();
+    ++hops_processed_;
+    update_rate_governor(elapsed.count());
+}
+
+void DspEngine::update_rate_governor(double frame_seconds) {
+    if (sample_rate_ == 0 || hop_size_ == 0) {
+        return;
+    }
+
+    const double hop_seconds = static_cast<double>(hop_size_) / static_cast<double>(sample_rate_);
+    const float load = static_cast<float>(frame_seconds / hop_seconds);
+    analysis_load_ += (load - analysis_load_) * kGovernorLoadSmoothing;
+
+    if (!governor_.enabled || ++hops_since_adjust_ < kGovernorIntervalHops) {
+        return;
+    }
+    hops_since_adjust_ = 0;
+
+    // Load scales with 1/hop, so small multiplicative steps converge without
+    // overshoot and keep consecutive frame periods close for the tempo tracker.
+    std::size_t target = hop_size_;
+    if (analysis_load_ > governor_.cpu_budget) {
+        target = static_cast<std::size_t>(std::ceil(static_cast<float>(hop_size_) * kGovernorGrowFactor));
+    } else if (analysis_load_ < governor_.cpu_budget * kGovernorShrinkHeadroom) {
+        target = static_cast<std::size_t>(std::floor(static_cast<float>(hop_size_) * kGovernorShrinkFactor));
+    }
+    target = std::clamp(target, governor_min_hop_, governor_max_hop_);
+    if (target != hop_size_) {
+        // The next frame's frame_period reflects the new hop; the previous
+        // load estimate is rescaled so the governor does not react twice.
+        analysis_load_ *= static_cast<float>(hop_size_) / static_cast<float>(target);
+        hop_size_ = target;
+        update_backlog_bound(); // Its floor is one window plus the hop
     }
 }
 
@@ -130,6 +261,7 @@ void DspEngine::compute_band_ranges() {
     const float log_min = std::log(min_freq);
     const float log_max = std::log(nyquist);
 
+    band_edges_hz_.assign(bands + 1, 0.0f);
     for (std::size_t i = 0; i < bands; ++i) {
         const float t0 = static_cast<float>(i) / static_cast<float>(bands);
         const float t1 = static_cast<float>(i + 1) / static_cast<float>(bands);
@@ -143,26 +275,80 @@ void DspEngine::compute_band_ranges() {
         bin1 = std::clamp(bin1, bin0 + 1, fft_size_ / 2 + 1);
 
         band_bin_ranges_[i] = {bin0, bin1};
+        band_edges_hz_[i] = f0;
+        band_edges_hz_[i + 1] = f1;
     }
+
+    const std::size_t bin_count = fft_size_ / 2 + 1;
+    bin_frequencies_.resize(bin_count);
+    for (std::size_t bin = 0; bin < bin_count; ++bin) {
+        bin_frequencies_[bin] = static_cast<float>(bin) * bin_width;
+    }
+    refined_bin_bands_.assign(bin_count, -1);
+}
+
+void DspEngine::refine_peak_frequencies() {
+    const std::size_t bin_count = fft_magnitudes_.size();
+    const float bin_width = static_cast<float>(sample_rate_) / static_cast<float>(fft_size_);
+    for (std::size_t bin = 0; bin < bin_count; ++bin) {
+        bin_frequencies_[bin] = static_cast<float>(bin) * bin_width;
+    }
+    std::fill(refined_bin_bands_.begin(), refined_bin_bands_.end(), -1);
+
+    const bool can_refine = phase_refinement_ && have_prev_phases_ && hop_size_ > 0 && bin_count >= 3;
+    if (can_refine) {
+        const float hop = static_cast<float>(hop_size_);
+        const float radians_per_bin = kTwoPi / static_cast<float>(fft_size_);
+        for (std::size_t bin = 1; bin + 1 < bin_count; ++bin) {
+            const float magnitude = fft_magnitudes_[bin];
+            if (magnitude < kPeakMagnitudeFloor || magnitude <= fft_magnitudes_[bin - 1] ||
+                magnitude < fft_magnitudes_[bin + 1]) {
+                continue;
+            }
+
+            // Phase advance beyond what the bin centre predicts over one hop
+            // gives the offset of the true frequency from the bin centre.
+            const float expected = radians_per_bin * static_cast<float>(bin) * hop;
+            float deviation = fft_phases_[bin] - prev_fft_phases_[bin] - expected;
+            deviation -= kTwoPi * std::round(deviation / kTwoPi);
+            const float offset_bins = std::clamp(deviation / (radians_per_bin * hop), -1.0f, 1.0f);
+            const float refined = (static_cast<float>(bin) + offset_bins) * bin_width;
+
+            const auto edge = std::upper_bound(band_edges_hz_.begin(), band_edges_hz_.end(), refined);
+            const int band = static_cast<int>(std::distance(band_edges_hz_.begin(), edge)) - 1;
+            const int clamped_band =
+                std::clamp(band, 0, static_cast<int>(band_bin_ranges_.size()) - 1);
+
+            // The main lobe neighbours belong to the same partial.
+            for (std::size_t lobe = bin - 1; lobe <= bin + 1; ++lobe) {
+                bin_frequencies_[lobe] = refined;
+                refined_bin_bands_[lobe] = clamped_band;
+            }
+        }
+    }
+
+    prev_fft_phases_ = fft_phases_;
+    have_prev_phases_ = phase_refinement_;
 }
 
 void DspEngine::process_frame() {
-    if (!fft_cfg_) {
+    if (!fft_plan_) {
         return;
     }
 
-    const float norm = 1.0f / static_cast<float>(fft_size_);
+    const float norm = magnitude_correction_ / static_cast<float>(fft_size_);
 
     assert(band_bin_ranges_.size() == instantaneous_band_energies_.size());
     assert(band_bin_ranges_.size() == band_flux_.size());
 
+    const float* window = fft_plan_->window();
     for (std::size_t i = 0; i < fft_size_; ++i) {
-        const float windowed = frame_buffer_[i] * window_[i];
+        const float windowed = frame_buffer_[i] * window[i];
         fft_in_[i].r = windowed;
         fft_in_[i].i = 0.0f;
     }
 
-    kiss_fft(fft_cfg_, fft_in_.data(), fft_out_.data());
+    kiss_fft(fft_plan_->config(), fft_in_.data(), fft_out_.data());
 
     const std::size_t nyquist_bin = fft_size_ / 2;
     for (std::size_t bin = 0; bin <= nyquist_bin; ++bin) {
@@ -173,19 +359,33 @@ void DspEngine::process_frame() {
         fft_phases_[bin] = std::atan2(imag, real);
     }
 
+    refine_peak_frequencies();
+
     float flux = 0.0f;
     for (std::size_t band = 0; band < band_bin_ranges_.size(); ++band) {
         const auto [start_bin, end_bin] = band_bin_ranges_[band];
         float energy = 0.0f;
-        const std::size_t clamped_end = std::min(end_bin, nyquist_bin + 1);
-        for (std::size_t bin = start_bin; bin < clamped_end; ++bin) {
+        const std::size_t scan_start = (start_bin > kRefinedBinReach) ? start_bin - kRefinedBinReach : 0;
+        const std::size_t scan_end = std::min(end_bin + kRefinedBinReach, nyquist_bin + 1);
+        for (std::size_t bin = scan_start; bin < scan_end; ++bin) {
+            const int refined_band = refined_bin_bands_[bin];
+            const bool in_band = (refined_band < 0) ? (bin >= start_bin && bin < end_bin)
+                                                    : (refined_band == static_cast<int>(band));
+            if (!in_band) {
+                continue;
+            }
             const float magnitude = fft_magnitudes_[bin];
             energy += magnitude * magnitude;
         }
         const std::size_t bin_count = (end_bin > start_bin) ? (end_bin - start_bin) : 1;
-        const float average_energy = energy / static_cast<float>(bin_count);
+        // Wider main lobes spread one tone over more bins; scale the summed
+        // power back to what the Hann window reports.
+        const float average_energy = energy * band_energy_correction_ / static_cast<float>(bin_count);
         const float magnitude = std::sqrt(std::max(average_energy, 0.0f));
-        const float previous = (band < prev_magnitudes_.size()) ? prev_magnitudes_[band] : 0.0f;
+        // After a skip the previous magnitudes describe audio that is long gone;
+        // reseed them so the jump does not register as a burst of onsets.
+        const float previous = resync_flux_ ? magnitude
+                                            : (band < prev_magnitudes_.size()) ? prev_magnitudes_[band] : 0.0f;
         if (band < prev_magnitudes_.size()) {
             prev_magnitudes_[band] = magnitude;
         }
@@ -194,6 +394,7 @@ void DspEngine::process_frame() {
         instantaneous_band_energies_[band] = magnitude;
         band_flux_[band] = delta;
     }
+    resync_flux_ = false;
 
     flux_average_ = flux_average_ * 0.92f + flux * 0.08f;
     const float baseline = std::max(flux_average_ * 1.35f, 1e-4f);
@@ -206,6 +407,8 @@ void DspEngine::process_frame() {
 
     feature_input_frame_.fft_magnitudes = std::span<const float>(fft_magnitudes_);
     feature_input_frame_.fft_phases = std::span<const float>(fft_phases_);
+    feature_input_frame_.bin_frequencies = std::span<const float>(bin_frequencies_);
+    feature_input_frame_.refined_bin_bands = std::span<const int>(refined_bin_bands_);
     feature_input_frame_.instantaneous_band_energies =
         std::span<const float>(instantaneous_band_energies_);
     feature_input_frame_.smoothed_band_energies = std::span<const float>();
@@ -217,8 +420,50 @@ void DspEngine::process_frame() {
         (sample_rate_ > 0) ? static_cast<float>(hop_size_) / static_cast<float>(sample_rate_) : 0.0f;
 
     latest_features_ = feature_extractor_.process(feature_input_frame_);
+    if (!tone_tracker_.empty()) {
+        tone_tracker_.snapshot();
+        latest_features_.tone_envelopes = tone_tracker_.envelopes();
+        const std::span<const float> peaks = tone_tracker_.peaks();
+        for (std::size_t i = 0; i < tone_peaks_.size(); ++i) {
+            tone_peaks_[i] = tone_peaks_consumed_ ? peaks[i] : std::max(tone_peaks_[i], peaks[i]);
+        }
+        tone_peaks_consumed_ = false;
+        latest_features_.tone_peaks = tone_peaks_;
+    }
+    if (!analysis_stages_.empty()) {
+        analysis_stages_.process(feature_input_frame_);
+        latest_features_.custom_channels = analysis_stages_.channel_values();
+        latest_features_.custom_channel_names = analysis_stages_.channel_names();
+        for (const AnalysisStageHost::StatusChange& change : analysis_stages_.status_changes()) {
+            events::AnalysisStageStatusEvent status_event{change.stage_id, change.bypassed,
+                                                          analysis_stages_.budget_ms()};
+            event_bus_.publish(status_event);
+        }
+    }
+    bool section_changed = false;
+    if (section_detection_) {
+        const std::span<const float> chroma = latest_features_.chroma_available
+                                                  ? std::span<const float>(latest_features_.chroma)
+                                                  : std::span<const float>();
+        section_changed = novelty_detector_.push(chroma,
+                                                 std::span<const float>(instantaneous_band_energies_),
+                                                 feature_input_frame_.frame_period);
+        latest_features_.novelty = novelty_detector_.novelty();
+        latest_features_.section_index = novelty_detector_.section_index();
+    }
+    if (section_changed) {
+        section_change_pending_ = true;
+        section_peak_ = novelty_detector_.last_peak();
+    }
+    latest_features_.section_change = section_change_pending_;
+    latest_features_.section_peak = section_peak_;
+
     events::AudioFeaturesUpdatedEvent features_event{latest_features_};
     event_bus_.publish(features_event);
+    if (section_changed) {
+        events::SectionChangeEvent section_event{section_peak_, latest_features_.section_index};
+        event_bus_.publish(section_event);
+    }
 }
 
 } // namespace when
@@ -3,16 +3,17 @@
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "audio/analysis_stage.h"
 #include "audio/audio_features.h"
 #include "audio/feature_extractor.h"
+#include "audio/fft_plan_cache.h"
 #include "audio/feature_input_frame.h"
-
-extern "C" {
-#include <kiss_fft.h>
-}
+#include "audio/novelty_detector.h"
+#include "audio/tone_tracker.h"
 
 namespace when {
 
@@ -26,6 +27,13 @@ public:
     static constexpr std::size_t kDefaultHopSize = kDefaultFftSize / 2;
     static constexpr std::size_t kDefaultBands = 16;
 
+    struct RateGovernorConfig {
+        bool enabled = false;
+        std::size_t min_hop_size = 0; // 0 = half the configured hop
+        std::size_t max_hop_size = 0; // 0 = fft size
+        float cpu_budget = 0.25f;     // Fraction of real time the analysis may consume
+    };
+
     DspEngine(events::EventBus& event_bus,
               std::uint32_t sample_rate,
               std::uint32_t channels,
@@ -37,11 +45,62 @@ public:
 
     void push_samples(const float* interleaved_samples, std::size_t count);
 
+    // Bounds how much queued audio may be analysed in one go. When more than
+    // max_backlog_ms is waiting, the backlog is dropped except for the newest
+    // fft_size samples. Zero disables the bound.
+    void set_max_backlog_ms(float max_backlog_ms);
+    std::size_t stale_skips() const { return stale_skips_; }
+
+    // Lets the engine grow or shrink the effective hop so that the measured
+    // per-hop cost stays within the CPU budget.
+    void configure_rate_governor(const RateGovernorConfig& config);
+    std::size_t hop_size() const { return hop_size_; }
+    float analysis_rate_hz() const;
+    float analysis_load() const { return analysis_load_; }
+    // Wall-clock cost of the most recent hop and the number of hops run so far.
+    double last_hop_seconds() const { return last_hop_seconds_; }
+    std::size_t hops_processed() const { return hops_processed_; }
+
+    // Selects the analysis window (tables come from FftPlanCache). Magnitudes
+    // are divided by the window's coherent gain and band energies by its noise
+    // bandwidth, both relative to Hann, so levels and tuned thresholds stay
+    // put when the window changes. kaiser_beta only affects Kaiser.
+    void set_window(FftWindowType type, float kaiser_beta = kDefaultKaiserBeta);
+    FftWindowType window_type() const { return fft_plan_->window_type(); }
+
+    // Enables phase-vocoder frequency refinement of spectral peaks. Refined
+    // frequencies drive chroma and band assignment for the peak bins.
+    void set_phase_refinement(bool enabled);
+
+    // Tracks a few target frequencies per sample during ingest; their
+    // envelopes are published as AudioFeatures::tone_envelopes/tone_peaks.
+    void configure_tone_tracker(const ToneTracker::Config& config);
+
+    // Registers a custom analysis stage whose channels are published as
+    // AudioFeatures::custom_channels. Register before audio starts flowing.
+    void add_analysis_stage(std::unique_ptr<AnalysisStage> stage);
+    // Streams chroma and band energies into a novelty detector and publishes
+    // a SectionChangeEvent when the music moves to a new section.
+    void configure_section_detection(bool enabled, const NoveltyDetector::Config& config);
+
+    void set_analysis_stage_budget_ms(float budget_ms) { analysis_stages_.set_budget_ms(budget_ms); }
+    void set_analysis_stage_time_source(double (*now_seconds)()) { analysis_stages_.set_time_source(now_seconds); }
+    std::size_t bypassed_analysis_stages() const { return analysis_stages_.bypassed_stages(); }
+
     const AudioFeatures& audio_features() const { return latest_features_; }
+    // Call once per render frame after the features have been read. Several
+    // hops may run between frames, so one-shot results are held in the
+    // features until then instead of being overwritten by the next hop.
+    void mark_features_consumed();
 
 private:
     void compute_band_ranges();
     void process_frame();
+    void skip_to_latest();
+    void update_backlog_bound();
+    void run_frame();
+    void refine_peak_frequencies();
+    void update_rate_governor(double frame_seconds);
 
     events::EventBus& event_bus_;
 
@@ -50,7 +109,6 @@ private:
     std::size_t fft_size_;
     std::size_t hop_size_;
 
-    std::vector<float> window_;
     std::vector<float> frame_buffer_;
     std::deque<float> mono_fifo_;
 
@@ -60,17 +118,46 @@ private:
     std::vector<float> band_flux_;
     std::vector<float> fft_magnitudes_;
     std::vector<float> fft_phases_;
+    std::vector<float> prev_fft_phases_;
+    std::vector<float> bin_frequencies_;
+    std::vector<int> refined_bin_bands_;
+    std::vector<float> band_edges_hz_;
 
     FeatureExtractor feature_extractor_;
+    ToneTracker tone_tracker_;
+    std::vector<float> tone_peaks_; // Max over the hops since the last consumed frame
+    bool tone_peaks_consumed_ = true;
+    AnalysisStageHost analysis_stages_;
+    NoveltyDetector novelty_detector_;
+    bool section_detection_ = true;
+    bool section_change_pending_ = false; // Latched until mark_features_consumed()
+    float section_peak_ = 0.0f;
     FeatureInputFrame feature_input_frame_{};
     AudioFeatures latest_features_{};
 
-    kiss_fft_cfg fft_cfg_;
+    std::shared_ptr<const FftPlan> fft_plan_; // Twiddles and window, shared through FftPlanCache
+    float magnitude_correction_ = 1.0f;        // Coherent gain of Hann over that of the window
+    float band_energy_correction_ = 1.0f;      // Noise bandwidth of Hann over that of the window
     std::vector<kiss_fft_cpx> fft_in_;
     std::vector<kiss_fft_cpx> fft_out_;
 
     float flux_average_;
     float beat_strength_;
+
+    float max_backlog_ms_ = 0.0f;
+    std::size_t max_backlog_frames_ = 0; // Derived from max_backlog_ms_ and the current hop
+    std::size_t stale_skips_ = 0;
+    bool resync_flux_ = false;
+    bool phase_refinement_ = true;
+    bool have_prev_phases_ = false;
+
+    RateGovernorConfig governor_{};
+    std::size_t governor_min_hop_ = 0;
+    std::size_t governor_max_hop_ = 0;
+    std::size_t hops_since_adjust_ = 0;
+    float analysis_load_ = 0.0f;
+    double last_hop_seconds_ = 0.0;
+    std::size_t hops_processed_ = 0;
 };
 
 } // namespace when
@@ -0,0 +1,299 @@
+#include "dsp_autotune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+#include "dsp.h"
+#include "dsp_setup.h"
+#include "events/event_bus.h"
+
+namespace when {
+
+namespace {
+constexpr std::size_t kWarmupHops = 8;
+constexpr std::size_t kTimedHops = 32;
+constexpr int kTimedRuns = 3;
+constexpr double kBudgetHeadroom = 0.8; // Leave room for plug-in stages and scheduling noise
+constexpr std::size_t kMinFftSize = 256;
+constexpr std::size_t kMaxFftSize = 16384;
+
+// Deterministic programme-like input: a few partials and some noise, so the
+// feature extractor takes its usual paths rather than the silence shortcuts.
+std::vector<float> make_test_signal(std::size_t samples, std::uint32_t sample_rate) {
+    std::vector<float> signal(samples);
+    std::uint32_t noise = 0x9e3779b9u;
+    const double rate = static_cast<double>(sample_rate);
+    for (std::size_t i = 0; i < samples; ++i) {
+        const double t = static_cast<double>(i) / rate;
+        noise = noise * 1664525u + 1013904223u;
+        const double white = static_cast<double>(noise >> 8) / 8388608.0 - 1.0;
+        signal[i] = static_cast<float>(0.3 * std::sin(2.0 * 3.14159265358979 * 110.0 * t) +
+                                       0.2 * std::sin(2.0 * 3.14159265358979 * 1760.0 * t) + 0.05 * white);
+    }
+    return signal;
+}
+
+double time_candidate(const DspConfig& config, std::uint32_t sample_rate, std::size_t fft_size, std::size_t hop_size) {
+    DspConfig candidate = config;
+    candidate.fft_size = fft_size;
+    candidate.hop_size = hop_size;
+    events::EventBus event_bus;
+    DspEngine dsp(event_bus, sample_rate, 1, fft_size, hop_size, config.bands,
+                  make_feature_extractor_config(candidate));
+    std::vector<std::string> ignored;
+    configure_dsp_engine(dsp, candidate, ignored);
+
+    const std::size_t warmup = fft_size + hop_size * kWarmupHops;
+    const std::size_t block = hop_size * kTimedHops;
+    const std::vector<float> signal = make_test_signal(warmup + block * kTimedRuns, sample_rate);
+    dsp.push_samples(signal.data(), warmup);
+
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < kTimedRuns; ++run) {
+        const std::uint64_t hops_before = dsp.hops_processed();
+        const auto start = std::chrono::steady_clock::now();
+        dsp.push_samples(signal.data() + warmup + block * static_cast<std::size_t>(run), block);
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const std::uint64_t hops = dsp.hops_processed() - hops_before;
+        if (hops > 0) {
+            best = std::min(best, elapsed / static_cast<double>(hops));
+        }
+    }
+    return best;
+}
+
+double latency_ms(std::size_t fft_size, std::size_t hop_size, std::uint32_t sample_rate) {
+    return 1000.0 * static_cast<double>(fft_size + hop_size) / static_cast<double>(sample_rate);
+}
+
+std::string sanitise_field(std::string text) {
+    std::replace(text.begin(), text.end(), '\t', ' ');
+    std::replace(text.begin(), text.end(), '\n', ' ');
+    return text;
+}
+} // namespace
+
+AutotuneResult autotune_dsp(const DspConfig& config, const AutotuneOptions& options) {
+    AutotuneResult result;
+    const std::uint32_t sample_rate = std::max<std::uint32_t>(1, options.sample_rate);
+    const std::size_t configured_fft = std::max<std::size_t>(2, config.fft_size);
+    const std::size_t configured_hop = std::clamp<std::size_t>(config.hop_size, 1, configured_fft);
+    const double max_latency = (options.max_latency_ms > 0.0f)
+                                   ? static_cast<double>(options.max_latency_ms)
+                                   : latency_ms(configured_fft, configured_hop, sample_rate) + 1e-6;
+
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (const std::size_t fft : {configured_fft / 2, configured_fft, configured_fft * 2}) {
+        if (fft != configured_fft && (fft < kMinFftSize || fft > kMaxFftSize)) {
+            continue;
+        }
+        for (const std::size_t divisor : {8u, 4u, 2u}) {
+            pairs.emplace_back(fft, std::max<std::size_t>(1, fft / divisor));
+        }
+        if (fft == configured_fft) {
+            pairs.emplace_back(fft, configured_hop);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    for (const auto& [fft, hop] : pairs) {
+        AutotuneCandidate candidate;
+        candidate.fft_size = fft;
+        candidate.hop_size = hop;
+        candidate.latency_ms = latency_ms(fft, hop, sample_rate);
+        if (candidate.latency_ms > max_latency) {
+            result.candidates.push_back(candidate); // Not worth timing
+            continue;
+        }
+        candidate.hop_cost_s = time_candidate(config, sample_rate, fft, hop);
+        candidate.load = candidate.hop_cost_s * static_cast<double>(sample_rate) / static_cast<double>(hop);
+        candidate.feasible = candidate.load <= static_cast<double>(options.cpu_budget) * kBudgetHeadroom;
+        result.candidates.push_back(candidate);
+    }
+
+    const auto resolution_distance = [&](const AutotuneCandidate& candidate) {
+        return std::abs(std::log2(static_cast<double>(candidate.fft_size) / static_cast<double>(configured_fft)));
+    };
+    const AutotuneCandidate* best = nullptr;
+    for (const AutotuneCandidate& candidate : result.candidates) {
+        if (!candidate.feasible) {
+            continue;
+        }
+        if (!best || resolution_distance(candidate) < resolution_distance(*best) ||
+            (resolution_distance(candidate) == resolution_distance(*best) && candidate.hop_size < best->hop_size)) {
+            best = &candidate;
+        }
+    }
+    if (!best) {
+        // Nothing fits: take the cheapest pair that was timed.
+        for (const AutotuneCandidate& candidate : result.candidates) {
+            if (candidate.hop_cost_s > 0.0 && (!best || candidate.load < best->load)) {
+                best = &candidate;
+            }
+        }
+    }
+    if (best) {
+        result.fft_size = best->fft_size;
+        result.hop_size = best->hop_size;
+        result.hop_cost_s = best->hop_cost_s;
+        result.load = best->load;
+        result.feasible = best->feasible;
+    } else {
+        result.fft_size = configured_fft;
+        result.hop_size = configured_hop;
+    }
+    return result;
+}
+
+std::string host_cpu_model() {
+    std::string model;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        const std::size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = line.substr(0, colon);
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (name == "model name" || name == "Hardware" || name == "cpu model" || name == "Model") {
+            model = line.substr(colon + 1);
+            model.erase(0, model.find_first_not_of(" \t"));
+            if (name == "model name") {
+                break;
+            }
+        }
+    }
+    if (model.empty()) {
+        model = "unknown";
+    }
+    return sanitise_field(model + " x" + std::to_string(std::thread::hardware_concurrency()));
+}
+
+std::string autotune_key(const DspConfig& config, const AutotuneOptions& options) {
+    std::ostringstream out;
+    out.precision(9);
+    out << describe_analysis_config(config) << ";sample_rate=" << options.sample_rate
+        << ";max_latency_ms=" << options.max_latency_ms << ";cpu_budget=" << options.cpu_budget;
+    return sanitise_field(out.str());
+}
+
+bool DspWisdom::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    entries_.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        Entry entry;
+        std::string fft;
+        std::string hop;
+        std::string cost;
+        if (!std::getline(fields, entry.cpu_model, '\t') || !std::getline(fields, entry.key, '\t') ||
+            !std::getline(fields, fft, '\t') || !std::getline(fields, hop, '\t') || !std::getline(fields, cost)) {
+            continue;
+        }
+        try {
+            entry.fft_size = std::stoul(fft);
+            entry.hop_size = std::stoul(hop);
+            entry.hop_cost_s = std::stod(cost);
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (entry.fft_size < 2 || entry.hop_size == 0) {
+            continue;
+        }
+        update(entry);
+    }
+    return true;
+}
+
+bool DspWisdom::save(const std::string& path) const {
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << "# cpu_model\tkey\tfft_size\thop_size\thop_cost_s\n";
+        out.precision(9);
+        for (const auto& [id, entry] : entries_) {
+            out << entry.cpu_model << '\t' << entry.key << '\t' << entry.fft_size << '\t' << entry.hop_size << '\t'
+                << entry.hop_cost_s << '\n';
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+const DspWisdom::Entry* DspWisdom::find(const std::string& cpu_model, const std::string& key) const {
+    const auto it = entries_.find({cpu_model, key});
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+void DspWisdom::update(const Entry& entry) {
+    entries_[{entry.cpu_model, entry.key}] = entry;
+}
+
+void apply_dsp_autotune(DspConfig& config,
+                        std::uint32_t sample_rate,
+                        bool force,
+                        std::vector<std::string>& messages) {
+    AutotuneOptions options;
+    options.sample_rate = sample_rate;
+    options.max_latency_ms = config.autotune_max_latency_ms;
+    options.cpu_budget = config.analysis_cpu_budget;
+    const std::string key = autotune_key(config, options);
+    const std::string cpu_model = host_cpu_model();
+
+    DspWisdom wisdom;
+    wisdom.load(config.wisdom_file);
+    if (!force) {
+        if (const DspWisdom::Entry* entry = wisdom.find(cpu_model, key)) {
+            config.fft_size = entry->fft_size;
+            config.hop_size = entry->hop_size;
+            messages.push_back("autotune: wisdom for '" + cpu_model + "': fft " + std::to_string(entry->fft_size) +
+                               ", hop " + std::to_string(entry->hop_size));
+            return;
+        }
+    }
+
+    const AutotuneResult result = autotune_dsp(config, options);
+    char summary[160];
+    std::snprintf(summary,
+                  sizeof(summary),
+                  "autotune: fft %zu, hop %zu (%.1f us/hop, %.1f%% load) after timing %zu candidates%s",
+                  result.fft_size,
+                  result.hop_size,
+                  result.hop_cost_s * 1e6,
+                  result.load * 100.0,
+                  result.candidates.size(),
+                  result.feasible ? "" : "; none met the limits, using the cheapest");
+    messages.emplace_back(summary);
+    config.fft_size = result.fft_size;
+    config.hop_size = result.hop_size;
+
+    wisdom.update(DspWisdom::Entry{cpu_model, key, result.fft_size, result.hop_size, result.hop_cost_s});
+    if (!wisdom.save(config.wisdom_file)) {
+        messages.push_back("autotune: could not write wisdom file '" + config.wisdom_file + "'");
+    }
+}
+
+} // namespace when
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "config.h"
+
+namespace when {
+
+struct AutotuneOptions {
+    std::uint32_t sample_rate = 48000;
+    float max_latency_ms = 0.0f; // FFT window plus hop; 0 = whatever the configured pair needs
+    float cpu_budget = 0.25f;    // Fraction of real time the analysis may use
+};
+
+struct AutotuneCandidate {
+    std::size_t fft_size = 0;
+    std::size_t hop_size = 0;
+    double hop_cost_s = 0.0; // Best of several timed runs
+    double load = 0.0;       // hop_cost_s / hop period
+    double latency_ms = 0.0;
+    bool feasible = false;
+};
+
+struct AutotuneResult {
+    std::size_t fft_size = 0;
+    std::size_t hop_size = 0;
+    double hop_cost_s = 0.0;
+    double load = 0.0;
+    bool feasible = false; // False when nothing met the constraints and the cheapest pair was taken
+    std::vector<AutotuneCandidate> candidates;
+};
+
+// Times a real DspEngine, set up from config, on this machine for FFT sizes
+// around the configured one and hops of 1/8 to 1/2 of each. A pair is
+// feasible when it fits the latency bound and stays under 80% of the CPU
+// budget. Among feasible pairs the configured FFT size (frequency resolution)
+// wins first, then the smallest hop (analysis rate).
+AutotuneResult autotune_dsp(const DspConfig& config, const AutotuneOptions& options);
+
+// "model name" from /proc/cpuinfo (or the closest equivalent) and core count.
+std::string host_cpu_model();
+// Everything a tuning result depends on apart from the CPU.
+std::string autotune_key(const DspConfig& config, const AutotuneOptions& options);
+
+// Tuning results kept between runs, one tab-separated line per CPU model and
+// key, so mixed hardware can share one file.
+class DspWisdom {
+public:
+    struct Entry {
+        std::string cpu_model;
+        std::string key;
+        std::size_t fft_size = 0;
+        std::size_t hop_size = 0;
+        double hop_cost_s = 0.0;
+    };
+
+    bool load(const std::string& path);
+    // Writes to a temporary file and renames it over the old one.
+    bool save(const std::string& path) const;
+
+    const Entry* find(const std::string& cpu_model, const std::string& key) const;
+    void update(const Entry& entry);
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    std::map<std::pair<std::string, std::string>, Entry> entries_;
+};
+
+// Applies cached wisdom for this CPU and config to config.fft_size/hop_size,
+// or tunes and records it when there is none (or force is set). Progress and
+// problems are appended to messages; a wisdom file that cannot be written
+// only costs a re-tune next time.
+void apply_dsp_autotune(DspConfig& config,
+                        std::uint32_t sample_rate,
+                        bool force,
+                        std::vector<std::string>& messages);
+
+} // namespace when
@@ -0,0 +1,64 @@
+#include "dsp_setup.h"
+
+#include <sstream>
+
+namespace when {
+
+FeatureExtractor::Config make_feature_extractor_config(const DspConfig& config) {
+    FeatureExtractor::Config feature_config{};
+    feature_config.smoothing_attack = config.smoothing_attack;
+    feature_config.smoothing_release = config.smoothing_release;
+    feature_config.apply_a_weighting = config.apply_a_weighting;
+    feature_config.enable_spectral_flatness = config.enable_spectral_flatness;
+    feature_config.enable_chroma = config.enable_chroma;
+    feature_config.bass_onset_sensitivity = config.bass_onset_sensitivity;
+    feature_config.mid_onset_sensitivity = config.mid_onset_sensitivity;
+    feature_config.treble_onset_sensitivity = config.treble_onset_sensitivity;
+    return feature_config;
+}
+
+void configure_dsp_engine(DspEngine& dsp, const DspConfig& config, std::vector<std::string>& warnings) {
+    FftWindowType window_type = FftWindowType::Hann;
+    if (!parse_fft_window(config.window, window_type)) {
+        warnings.push_back("unknown window '" + config.window + "', using hann");
+    }
+    dsp.set_window(window_type, config.kaiser_beta);
+    dsp.set_phase_refinement(config.phase_refinement);
+
+    ToneTracker::Config tone_config{};
+    tone_config.frequencies = config.tone_frequencies;
+    tone_config.bandwidth_hz = config.tone_bandwidth_hz;
+    dsp.configure_tone_tracker(tone_config);
+
+    NoveltyDetector::Config novelty_config{};
+    novelty_config.kernel_seconds = config.novelty_kernel_s;
+    novelty_config.block_seconds = config.novelty_block_s;
+    novelty_config.threshold = config.novelty_threshold;
+    novelty_config.min_interval_seconds = config.section_min_interval_s;
+    dsp.configure_section_detection(config.section_detection, novelty_config);
+}
+
+std::string describe_analysis_config(const DspConfig& config) {
+    std::ostringstream out;
+    out.precision(9);
+    out << "fft_size=" << config.fft_size << ";hop_size=" << config.hop_size << ";bands=" << config.bands
+        << ";window=" << config.window << ";kaiser_beta=" << config.kaiser_beta
+        << ";phase_refinement=" << config.phase_refinement << ";tones=";
+    for (const float frequency : config.tone_frequencies) {
+        out << frequency << ',';
+    }
+    out << ";tone_bandwidth_hz=" << config.tone_bandwidth_hz << ";section_detection=" << config.section_detection
+        << ";novelty_kernel_s=" << config.novelty_kernel_s << ";novelty_block_s=" << config.novelty_block_s
+        << ";novelty_threshold=" << config.novelty_threshold
+        << ";section_min_interval_s=" << config.section_min_interval_s
+        << ";smoothing_attack=" << config.smoothing_attack << ";smoothing_release=" << config.smoothing_release
+        << ";apply_a_weighting=" << config.apply_a_weighting
+        << ";enable_spectral_flatness=" << config.enable_spectral_flatness
+        << ";enable_chroma=" << config.enable_chroma
+        << ";bass_onset_sensitivity=" << config.bass_onset_sensitivity
+        << ";mid_onset_sensitivity=" << config.mid_onset_sensitivity
+        << ";treble_onset_sensitivity=" << config.treble_onset_sensitivity;
+    return out.str();
+}
+
+} // namespace when
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "audio/feature_extractor.h"
+#include "config.h"
+#include "dsp.h"
+
+namespace when {
+
+// Maps the [dsp] section onto the feature extractor and engine. Shared by the
+// live visualiser and when-analyze so both analyse audio identically.
+FeatureExtractor::Config make_feature_extractor_config(const DspConfig& config);
+
+// Applies every setting that changes analysis output (window, phase
+// refinement, tone tracker, section detection). Live-only pacing such as the
+// backlog bound and rate governor is left to the caller.
+void configure_dsp_engine(DspEngine& dsp, const DspConfig& config, std::vector<std::string>& warnings);
+
+// Canonical text of the settings that affect analysis output, for detecting
+// when cached results are stale. Extend it alongside configure_dsp_engine.
+std::string describe_analysis_config(const DspConfig& config);
+
+} // namespace when
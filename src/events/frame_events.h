@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
 #include "../audio_engine.h"
 #include "audio/audio_features.h"
 
@@ -14,12 +18,26 @@ struct FrameUpdateEvent {
     float delta_time;
     const AudioMetrics& metrics;
     const AudioFeatures& features;
+    std::uint64_t frame_index = 0; // Monotonic frame counter used for staggered scheduling
 };
 
 struct BeatDetectedEvent {
     float strength;
 };
 
+struct SectionChangeEvent {
+    float novelty;             // Normalised novelty peak that confirmed the change (0-1)
+    std::size_t section_index; // Number of section changes detected so far
+};
+
+// A custom analysis stage was bypassed for overrunning its budget, or was
+// restored after a re-probe came in within it.
+struct AnalysisStageStatusEvent {
+    std::string_view stage_id;
+    bool bypassed;
+    float budget_ms;
+};
+
 } // namespace events
 } // namespace when
 
@@ -0,0 +1,177 @@
+#include "frame_marker.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+
+namespace when {
+
+namespace {
+constexpr char kEsc = '\x1b';
+constexpr char kBel = '\x07';
+constexpr std::string_view kMarkerTag = "7770;when-frame;";
+constexpr std::size_t kMaxKeptSequence = 64; // Longer sequences are counted, not stored
+
+bool is_intermediate(char c) {
+    return c >= 0x20 && c <= 0x2f;
+}
+
+bool is_csi_final(char c) {
+    return c >= 0x40 && c <= 0x7e;
+}
+} // namespace
+
+std::int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::size_t format_frame_marker(const FrameMarker& marker, char* buffer, std::size_t size) {
+    const int written = std::snprintf(buffer,
+                                      size,
+                                      "\x1b]%d;when-frame;%llu;%lld\x07",
+                                      kFrameMarkerOsc,
+                                      static_cast<unsigned long long>(marker.sequence),
+                                      static_cast<long long>(marker.features_ns));
+    if (written <= 0 || static_cast<std::size_t>(written) >= size) {
+        return 0;
+    }
+    return static_cast<std::size_t>(written);
+}
+
+bool parse_frame_marker(std::string_view payload, FrameMarker& out) {
+    if (payload.substr(0, kMarkerTag.size()) != kMarkerTag) {
+        return false;
+    }
+    payload.remove_prefix(kMarkerTag.size());
+    const std::size_t split = payload.find(';');
+    if (split == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view sequence = payload.substr(0, split);
+    const std::string_view features = payload.substr(split + 1);
+    FrameMarker parsed;
+    const auto seq_result = std::from_chars(sequence.data(), sequence.data() + sequence.size(), parsed.sequence);
+    const auto ns_result = std::from_chars(features.data(), features.data() + features.size(), parsed.features_ns);
+    if (seq_result.ec != std::errc{} || seq_result.ptr != sequence.data() + sequence.size() ||
+        ns_result.ec != std::errc{} || ns_result.ptr != features.data() + features.size()) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+void TerminalStreamScanner::feed(std::string_view data, const Handler& handler) {
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        const char c = data[i];
+        switch (state_) {
+        case State::Ground:
+            if (c == kEsc) {
+                state_ = State::Escape;
+                sequence_.clear();
+                sequence_bytes_ = 0;
+                keep(c);
+            } else {
+                ++pending_.bytes;
+                ++pending_.text;
+                ++total_.bytes;
+                ++total_.text;
+            }
+            break;
+        case State::Escape:
+            keep(c);
+            if (c == '[') {
+                state_ = State::Csi;
+            } else if (c == ']') {
+                state_ = State::Osc;
+            } else if (c == 'P' || c == 'X' || c == '^' || c == '_') {
+                state_ = State::String;
+            } else if (is_intermediate(c)) {
+                state_ = State::EscapeIntermediate;
+            } else {
+                finish_sequence(handler);
+            }
+            break;
+        case State::EscapeIntermediate:
+            keep(c);
+            if (!is_intermediate(c)) {
+                finish_sequence(handler);
+            }
+            break;
+        case State::Csi:
+            keep(c);
+            if (is_csi_final(c)) {
+                finish_sequence(handler);
+            }
+            break;
+        case State::Osc:
+        case State::String:
+            if (c == kEsc) {
+                state_ = (state_ == State::Osc) ? State::OscEscape : State::StringEscape;
+            } else {
+                keep(c);
+                if (c == kBel) {
+                    finish_sequence(handler);
+                }
+            }
+            break;
+        case State::OscEscape:
+        case State::StringEscape:
+            if (c == '\\') {
+                keep(kEsc);
+                keep(c);
+                finish_sequence(handler);
+            } else {
+                // Unterminated string: close it and restart at the ESC that cut it short.
+                finish_sequence(handler);
+                state_ = State::Escape;
+                sequence_.assign(1, kEsc);
+                sequence_bytes_ = 1;
+                --i;
+            }
+            break;
+        }
+    }
+}
+
+void TerminalStreamScanner::keep(char c) {
+    ++sequence_bytes_;
+    if (sequence_.size() < kMaxKeptSequence) {
+        sequence_.push_back(c);
+    }
+}
+
+void TerminalStreamScanner::finish_sequence(const Handler& handler) {
+    state_ = State::Ground;
+    const std::string_view sequence = sequence_;
+    if (sequence.size() > 2 && sequence[1] == ']') {
+        std::string_view payload = sequence.substr(2);
+        if (!payload.empty() && payload.back() == kBel) {
+            payload.remove_suffix(1);
+        } else if (payload.size() >= 2 && payload.substr(payload.size() - 2) == "\x1b\\") {
+            payload.remove_suffix(2);
+        }
+        FrameMarker marker;
+        if (sequence_bytes_ == sequence.size() && parse_frame_marker(payload, marker)) {
+            if (handler.on_marker) {
+                handler.on_marker(marker, pending_);
+            }
+            pending_ = Counts{};
+            return;
+        }
+    }
+
+    pending_.bytes += sequence_bytes_;
+    total_.bytes += sequence_bytes_;
+    ++pending_.escapes;
+    ++total_.escapes;
+    if (handler.on_query) {
+        if (sequence == "\x1b[c" || sequence == "\x1b[0c") {
+            handler.on_query(Query::PrimaryDeviceAttributes);
+        } else if (sequence == "\x1b[6n") {
+            handler.on_query(Query::CursorPosition);
+        }
+    }
+}
+
+} // namespace when
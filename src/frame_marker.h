@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace when {
+
+// Per-frame marker written after each notcurses_render when --frame-marker is
+// set. It is a private OSC (ESC ] 7770 ; when-frame ; seq ; features_ns BEL),
+// which terminals ignore, so the rendered output is unchanged. Timestamps are
+// steady_clock nanoseconds (CLOCK_MONOTONIC on Linux), comparable across
+// processes on the same host.
+struct FrameMarker {
+    std::uint64_t sequence = 0;
+    std::int64_t features_ns = 0; // When the features drawn in this frame were produced
+};
+
+inline constexpr int kFrameMarkerOsc = 7770;
+
+std::int64_t steady_now_ns();
+
+// Returns the number of bytes written, or 0 if buffer is too small.
+std::size_t format_frame_marker(const FrameMarker& marker, char* buffer, std::size_t size);
+// Parses an OSC payload (the bytes between "ESC ]" and the terminator).
+bool parse_frame_marker(std::string_view payload, FrameMarker& out);
+
+// Incremental tokenizer for a terminal output stream. Counts bytes and escape
+// sequences between frame markers and reports the queries notcurses sends at
+// startup so a harness can answer them. Sequences may be split across feed()
+// calls.
+class TerminalStreamScanner {
+public:
+    enum class Query {
+        PrimaryDeviceAttributes, // CSI c
+        CursorPosition,          // CSI 6 n
+    };
+
+    struct Counts {
+        std::uint64_t bytes = 0;   // All output bytes, markers excluded
+        std::uint64_t escapes = 0; // Complete escape sequences (CSI, OSC, DCS, ESC x)
+        std::uint64_t text = 0;    // Bytes outside escape sequences
+    };
+
+    struct Handler {
+        // Counts cover the output since the previous marker.
+        std::function<void(const FrameMarker&, const Counts&)> on_marker;
+        std::function<void(Query)> on_query;
+    };
+
+    void feed(std::string_view data, const Handler& handler);
+
+    const Counts& pending() const { return pending_; }
+    const Counts& total() const { return total_; }
+
+private:
+    enum class State { Ground, Escape, EscapeIntermediate, Csi, Osc, OscEscape, String, StringEscape };
+
+    void keep(char c);
+    void finish_sequence(const Handler& handler);
+
+    State state_ = State::Ground;
+    std::string sequence_; // Leading bytes of the sequence in progress, for marker/query checks
+    std::uint64_t sequence_bytes_ = 0;
+    Counts pending_{};
+    Counts total_{};
+};
+
+} // namespace when
@@ -4,18 +4,28 @@
 #include <clocale>
 #include <cstdint>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include <unistd.h>
+
 #include <cxxopts.hpp>
 
 #include "audio_engine.h"
 #include "config.h"
 #include "dsp.h"
+#include "dsp_autotune.h"
+#include "dsp_setup.h"
+#include "frame_marker.h"
+#include "metrics_exporter.h"
+#include "output/ansi_output.h"
 #include "plugins.h"
 #include "renderer.h"
 #include "events/event_bus.h"
+#include "events/frame_events.h"
 int main(int argc, char** argv) {
     std::setlocale(LC_ALL, "");
 
@@ -26,12 +36,23 @@ int main(int argc, char** argv) {
         ("d,device", "Audio input device override", cxxopts::value<std::string>())
         ("system", "Force system audio capture")
         ("mic", "Force microphone capture")
+        ("attach", "Read audio from a running when-capture (optionally naming its shared memory)",
+         cxxopts::value<std::string>()->implicit_value(""))
+        ("autotune", "Re-time DSP settings on this machine and update the wisdom file")
+        ("output", "Output backend override: notcurses or ansi", cxxopts::value<std::string>())
+        ("frame-marker", "Write a timing marker after each frame (for bench/pty_frame_bench)")
         ("h,help", "Print usage");
 
     std::string config_path;
     std::string file_path;
+    bool file_from_cli = false;
+    bool attach_from_cli = false;
+    std::string attach_name;
     std::string device_name_override;
     int system_override = -1; // -1 = use config, 0 = mic, 1 = system
+    bool emit_frame_marker = false;
+    bool force_autotune = false;
+    std::string output_override;
 
     try {
         const auto result = options.parse(argc, argv);
@@ -45,12 +66,28 @@ int main(int argc, char** argv) {
 
         if (result.count("file")) {
             file_path = result["file"].as<std::string>();
+            file_from_cli = true;
+        }
+
+        if (result.count("attach")) {
+            if (file_from_cli) {
+                std::cerr << "Cannot specify both --file and --attach" << std::endl;
+                return 1;
+            }
+            attach_from_cli = true;
+            attach_name = result["attach"].as<std::string>();
         }
 
         if (result.count("device")) {
             device_name_override = result["device"].as<std::string>();
         }
 
+        emit_frame_marker = result.count("frame-marker") > 0;
+        force_autotune = result.count("autotune") > 0;
+        if (result.count("output")) {
+            output_override = result["output"].as<std::string>();
+        }
+
         if (result.count("system") && result.count("mic")) {
             std::cerr << "Cannot specify both --system and --mic" << std::endl;
             return 1;
@@ -92,7 +129,27 @@ int main(int argc, char** argv) {
         use_system_audio = false;
     }
 
-    const bool use_file_stream = config.audio.file.enabled && !file_path.empty();
+    // Tune before audio starts so the capture ring does not fill meanwhile.
+    when::DspConfig dsp_config = config.dsp;
+    std::uint32_t period_frames = config.audio.capture.period_frames;
+    if (config.dsp.autotune || force_autotune) {
+        std::vector<std::string> autotune_messages;
+        when::apply_dsp_autotune(dsp_config, config.audio.capture.sample_rate, force_autotune, autotune_messages);
+        for (const std::string& message : autotune_messages) {
+            std::clog << "[dsp] " << message << std::endl;
+        }
+        // Keep low_latency's one period per hop with the tuned hop.
+        if (config.audio.capture.period_from_hop) {
+            period_frames = static_cast<std::uint32_t>(dsp_config.hop_size);
+        }
+    }
+
+    // A running capture daemon replaces the device (and a configured file) unless --file is given.
+    const bool use_shared_memory = attach_from_cli || (config.audio.shared_memory.enabled && !file_from_cli);
+    const std::string shm_name = attach_name.empty() ? config.audio.shared_memory.name : attach_name;
+    // An explicit --file plays even when [audio.file] is disabled in the config.
+    const bool use_file_stream =
+        !use_shared_memory && !file_path.empty() && (config.audio.file.enabled || file_from_cli);
     const ma_uint32 sample_rate = config.audio.capture.sample_rate;
     ma_uint32 channels = use_file_stream ? config.audio.file.channels : config.audio.capture.channels;
     if (channels == 0) {
@@ -106,8 +163,14 @@ int main(int argc, char** argv) {
                            use_file_stream ? file_path : std::string{},
                            capture_device,
                            use_system_audio);
+    audio.set_period_hint(period_frames,
+                          config.audio.capture.periods,
+                          config.audio.capture.latency_profile == "low_latency");
+    if (use_shared_memory) {
+        audio.set_shared_memory_source(shm_name);
+    }
     bool audio_active = false;
-    if (use_file_stream || config.audio.capture.enabled) {
+    if (use_file_stream || use_shared_memory || config.audio.capture.enabled) {
         audio_active = audio.start();
         if (!audio_active) {
             std::cerr << "[audio] failed to start audio backend";
@@ -115,36 +178,96 @@ int main(int argc, char** argv) {
                 std::cerr << ": " << audio.last_error();
             }
             std::cerr << std::endl;
+        } else if (audio.using_shared_memory()) {
+            if (audio.shared_memory_attached()) {
+                std::clog << "[audio] attached to when-capture on '" << shm_name << "'" << std::endl;
+            } else {
+                std::clog << "[audio] waiting for when-capture on '" << shm_name << "': " << audio.last_error()
+                          << std::endl;
+            }
+        } else if (!audio.using_file_stream()) {
+            std::clog << "[audio] capture profile '" << config.audio.capture.latency_profile << "': period "
+                      << audio.period_frames() << " frames x " << audio.periods();
+            if (period_frames != 0 || config.audio.capture.periods != 0) {
+                std::clog << " (requested " << period_frames << " x "
+                          << config.audio.capture.periods << ")";
+            }
+            std::clog << ", hop " << dsp_config.hop_size << " frames" << std::endl;
         }
     }
 
     when::events::EventBus event_bus;
 
-    when::FeatureExtractor::Config feature_config{};
-    feature_config.smoothing_attack = config.dsp.smoothing_attack;
-    feature_config.smoothing_release = config.dsp.smoothing_release;
-    feature_config.apply_a_weighting = config.dsp.apply_a_weighting;
-    feature_config.enable_spectral_flatness = config.dsp.enable_spectral_flatness;
-    feature_config.enable_chroma = config.dsp.enable_chroma;
-    feature_config.bass_onset_sensitivity = config.dsp.bass_onset_sensitivity;
-    feature_config.mid_onset_sensitivity = config.dsp.mid_onset_sensitivity;
-    feature_config.treble_onset_sensitivity = config.dsp.treble_onset_sensitivity;
-
+    const when::FeatureExtractor::Config feature_config = when::make_feature_extractor_config(dsp_config);
     when::DspEngine dsp(event_bus,
                        sample_rate,
                        channels,
-                       config.dsp.fft_size,
-                       config.dsp.hop_size,
-                       config.dsp.bands,
+                       dsp_config.fft_size,
+                       dsp_config.hop_size,
+                       dsp_config.bands,
                        feature_config);
+    std::vector<std::string> dsp_warnings;
+    when::configure_dsp_engine(dsp, dsp_config, dsp_warnings);
+    for (const std::string& warning : dsp_warnings) {
+        std::cerr << "[dsp] " << warning << std::endl;
+    }
+    // Live-only pacing; the batch analyser leaves these off.
+    dsp.set_max_backlog_ms(config.dsp.max_backlog_ms);
+    when::DspEngine::RateGovernorConfig governor_config{};
+    governor_config.enabled = config.dsp.adaptive_hop;
+    governor_config.min_hop_size = config.dsp.min_hop_size;
+    governor_config.max_hop_size = config.dsp.max_hop_size;
+    governor_config.cpu_budget = config.dsp.analysis_cpu_budget;
+    dsp.configure_rate_governor(governor_config);
 
     when::PluginManager plugin_manager;
     when::register_builtin_plugins(plugin_manager);
     plugin_manager.load_from_config(config, feature_config);
+    dsp.set_analysis_stage_budget_ms(config.dsp.analysis_stage_budget_ms);
+    for (std::unique_ptr<when::AnalysisStage>& stage : plugin_manager.take_analysis_stages()) {
+        dsp.add_analysis_stage(std::move(stage));
+    }
     for (const std::string& warning : plugin_manager.warnings()) {
         std::cerr << "[plugin] " << warning << std::endl;
     }
 
+    // Stages are bypassed and restored while notcurses owns the terminal, so
+    // the messages are held until it has been released.
+    constexpr std::size_t kMaxStageStatusMessages = 64;
+    std::vector<std::string> stage_status_messages;
+    std::size_t dropped_stage_status_messages = 0;
+    auto stage_status_handle = event_bus.subscribe<when::events::AnalysisStageStatusEvent>(
+        [&](const when::events::AnalysisStageStatusEvent& event) {
+            if (stage_status_messages.size() >= kMaxStageStatusMessages) {
+                ++dropped_stage_status_messages;
+                return;
+            }
+            std::ostringstream message;
+            message << "[analysis] stage '" << event.stage_id << "' ";
+            if (event.bypassed) {
+                message << "exceeded its " << event.budget_ms << " ms budget; bypassed";
+            } else {
+                message << "is back within its " << event.budget_ms << " ms budget; restored";
+            }
+            stage_status_messages.push_back(message.str());
+        });
+
+    when::RuntimeMetrics runtime_metrics;
+    std::unique_ptr<when::MetricsExporter> metrics_exporter;
+    if (config.metrics.enabled) {
+        when::MetricsExporter::Config exporter_config;
+        exporter_config.path = config.metrics.path;
+        exporter_config.interval_s = config.metrics.interval_s;
+        if (!when::MetricsExporter::parse_mode(config.metrics.mode, exporter_config.mode)) {
+            std::cerr << "[metrics] unknown mode '" << config.metrics.mode << "', using textfile" << std::endl;
+        }
+        metrics_exporter = std::make_unique<when::MetricsExporter>(runtime_metrics, exporter_config);
+        if (!metrics_exporter->start()) {
+            std::cerr << "[metrics] failed to start exporter: " << metrics_exporter->last_error() << std::endl;
+            metrics_exporter.reset();
+        }
+    }
+
     notcurses_options opts{};
     opts.flags = NCOPTION_SUPPRESS_BANNERS;
     notcurses* nc = notcurses_init(&opts, nullptr);
@@ -154,7 +277,15 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-
+    const std::string& output_name = output_override.empty() ? config.runtime.output_backend : output_override;
+    when::output::OutputBackend output_backend = when::output::OutputBackend::Notcurses;
+    if (!when::output::parse_output_backend(output_name, output_backend)) {
+        std::cerr << "[output] unknown backend '" << output_name << "', using notcurses" << std::endl;
+    }
+    std::unique_ptr<when::output::AnsiOutput> ansi_output;
+    if (output_backend == when::output::OutputBackend::Ansi) {
+        ansi_output = std::make_unique<when::output::AnsiOutput>(nc, STDOUT_FILENO);
+    }
 
     const std::chrono::duration<double> frame_time(1.0 / config.visual.target_fps);
 
@@ -167,6 +298,8 @@ int main(int argc, char** argv) {
     when::load_animations_from_config(nc, config);
 
     bool running = true;
+    when::FrameMarker frame_marker{};
+    frame_marker.features_ns = when::steady_now_ns();
     const auto start_time = std::chrono::steady_clock::now();
 
     while (running) {
@@ -174,10 +307,16 @@ int main(int argc, char** argv) {
         const auto elapsed = now - start_time;
         const float time_s = std::chrono::duration_cast<std::chrono::duration<float>>(elapsed).count();
 
+        float ring_occupancy = 0.0f; // Sampled before the read below drains the ring
         if (audio_active) {
+            ring_occupancy = audio.ring_occupancy();
             const std::size_t samples_read = audio.read_samples(audio_scratch.data(), audio_scratch.size());
             if (samples_read > 0) {
+                const std::uint64_t hops_before = dsp.hops_processed();
                 dsp.push_samples(audio_scratch.data(), samples_read);
+                if (dsp.hops_processed() != hops_before) {
+                    frame_marker.features_ns = when::steady_now_ns();
+                }
                 double sum_squares = 0.0;
                 float peak_value = 0.0f;
                 for (std::size_t i = 0; i < samples_read; ++i) {
@@ -193,6 +332,10 @@ int main(int argc, char** argv) {
                 audio_metrics.peak *= 0.98f;
             }
             audio_metrics.dropped = audio.dropped_samples();
+            audio_metrics.stale_skips = dsp.stale_skips();
+            audio_metrics.analysis_rate_hz = dsp.analysis_rate_hz();
+            audio_metrics.analysis_load = dsp.analysis_load();
+            audio_metrics.bypassed_stages = dsp.bypassed_analysis_stages();
         }
 
         plugin_manager.notify_frame(audio_metrics, dsp.audio_features(), time_s);
@@ -204,11 +347,26 @@ int main(int argc, char** argv) {
                        audio.using_file_stream(),
                        config.runtime.show_metrics,
                        config.runtime.show_overlay_metrics);
+        dsp.mark_features_consumed();
 
-        if (notcurses_render(nc) != 0) {
+        if (ansi_output) {
+            if (!ansi_output->present()) {
+                std::cerr << "Failed to render frame: " << ansi_output->last_error() << std::endl;
+                break;
+            }
+        } else if (notcurses_render(nc) != 0) {
             std::cerr << "Failed to render frame" << std::endl;
             break;
         }
+        if (emit_frame_marker) {
+            // The frame has been flushed; the marker follows it on the same fd.
+            char marker[96];
+            const std::size_t length = when::format_frame_marker(frame_marker, marker, sizeof(marker));
+            if (length > 0 && ::write(STDOUT_FILENO, marker, length) < 0) {
+                emit_frame_marker = false;
+            }
+            ++frame_marker.sequence;
+        }
 
         ncinput input{};
         const timespec ts{0, 0};
@@ -226,22 +384,53 @@ int main(int argc, char** argv) {
 
 
             if (key == NCKEY_RESIZE) {
+                if (ansi_output) {
+                    ansi_output->handle_resize();
+                }
                 break;
             }
         }
 
         const auto frame_end = std::chrono::steady_clock::now();
+        if (metrics_exporter) {
+            constexpr float kIdleRms = 1e-4f; // Below this the input is treated as silence
+            const when::AudioFeatures& features = dsp.audio_features();
+            runtime_metrics.dropped_samples.store(audio_metrics.dropped, std::memory_order_relaxed);
+            runtime_metrics.stale_skips.store(audio_metrics.stale_skips, std::memory_order_relaxed);
+            runtime_metrics.dsp_hops.store(dsp.hops_processed(), std::memory_order_relaxed);
+            runtime_metrics.ring_occupancy.store(ring_occupancy, std::memory_order_relaxed);
+            runtime_metrics.dsp_hop_seconds.store(static_cast<float>(dsp.last_hop_seconds()),
+                                                  std::memory_order_relaxed);
+            runtime_metrics.dsp_load.store(audio_metrics.analysis_load, std::memory_order_relaxed);
+            runtime_metrics.analysis_rate_hz.store(audio_metrics.analysis_rate_hz, std::memory_order_relaxed);
+            runtime_metrics.analysis_stages_bypassed.store(audio_metrics.bypassed_stages, std::memory_order_relaxed);
+            runtime_metrics.bpm.store(features.bpm, std::memory_order_relaxed);
+            runtime_metrics.tempo_confidence.store(features.tempo_confidence, std::memory_order_relaxed);
+            runtime_metrics.audio_active.store(audio_active, std::memory_order_relaxed);
+            runtime_metrics.idle.store(!audio_active || audio_metrics.rms < kIdleRms, std::memory_order_relaxed);
+            runtime_metrics.record_frame(std::chrono::duration<double>(frame_end - now).count());
+        }
         if (frame_end - now < frame_time) {
             std::this_thread::sleep_for(frame_time - (frame_end - now));
         }
     }
 
+    if (metrics_exporter) {
+        metrics_exporter->stop();
+    }
     audio.stop();
 
     if (notcurses_stop(nc) != 0) {
         std::cerr << "Failed to stop notcurses cleanly" << std::endl;
         return 1;
     }
+    for (const std::string& message : stage_status_messages) {
+        std::clog << message << std::endl;
+    }
+    if (dropped_stage_status_messages > 0) {
+        std::clog << "[analysis] " << dropped_stage_status_messages << " further stage status changes not shown"
+                  << std::endl;
+    }
 
     return 0;
 }
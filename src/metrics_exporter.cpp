@@ -0,0 +1,308 @@
+#include "metrics_exporter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace when {
+namespace {
+constexpr int kSocketPollMs = 100;
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL; // A scraper hanging up must not raise SIGPIPE
+#else
+constexpr int kSendFlags = 0;
+#endif
+constexpr std::array<double, 3> kFrameTimeQuantiles{0.5, 0.9, 0.99};
+
+void append_metric(std::ostringstream& out,
+                   const char* name,
+                   const char* type,
+                   const char* help,
+                   double value) {
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+    out << name << ' ' << value << '\n';
+}
+} // namespace
+
+void RuntimeMetrics::record_frame(double seconds) {
+    const auto bucket = static_cast<std::size_t>(
+        std::lower_bound(kFrameTimeBounds.begin(), kFrameTimeBounds.end(), seconds) - kFrameTimeBounds.begin());
+    frame_time_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    frames.fetch_add(1, std::memory_order_relaxed);
+    // Single writer, so a load/store pair is enough.
+    frame_time_sum_s.store(frame_time_sum_s.load(std::memory_order_relaxed) + seconds, std::memory_order_relaxed);
+}
+
+RuntimeMetrics::Snapshot RuntimeMetrics::snapshot() const {
+    Snapshot snapshot;
+    for (std::size_t i = 0; i < kFrameTimeBuckets; ++i) {
+        snapshot.frame_time_buckets[i] = frame_time_buckets[i].load(std::memory_order_relaxed);
+    }
+    snapshot.frames = frames.load(std::memory_order_relaxed);
+    snapshot.frame_time_sum_s = frame_time_sum_s.load(std::memory_order_relaxed);
+    snapshot.dropped_samples = dropped_samples.load(std::memory_order_relaxed);
+    snapshot.stale_skips = stale_skips.load(std::memory_order_relaxed);
+    snapshot.dsp_hops = dsp_hops.load(std::memory_order_relaxed);
+    snapshot.ring_occupancy = ring_occupancy.load(std::memory_order_relaxed);
+    snapshot.dsp_hop_seconds = dsp_hop_seconds.load(std::memory_order_relaxed);
+    snapshot.dsp_load = dsp_load.load(std::memory_order_relaxed);
+    snapshot.analysis_rate_hz = analysis_rate_hz.load(std::memory_order_relaxed);
+    snapshot.analysis_stages_bypassed = analysis_stages_bypassed.load(std::memory_order_relaxed);
+    snapshot.bpm = bpm.load(std::memory_order_relaxed);
+    snapshot.tempo_confidence = tempo_confidence.load(std::memory_order_relaxed);
+    snapshot.audio_active = audio_active.load(std::memory_order_relaxed);
+    snapshot.idle = idle.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+MetricsExporter::MetricsExporter(const RuntimeMetrics& metrics, Config config)
+    : metrics_(metrics), config_(std::move(config)) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::parse_mode(const std::string& text, Mode& mode) {
+    if (text == "textfile") {
+        mode = Mode::TextFile;
+        return true;
+    }
+    if (text == "socket") {
+        mode = Mode::UnixSocket;
+        return true;
+    }
+    return false;
+}
+
+bool MetricsExporter::start() {
+    if (thread_.joinable()) {
+        return true;
+    }
+    if (config_.path.empty()) {
+        last_error_ = "no metrics path configured";
+        return false;
+    }
+
+    stop_requested_ = false;
+    if (config_.mode == Mode::UnixSocket) {
+        sockaddr_un address{};
+        if (config_.path.size() >= sizeof(address.sun_path)) {
+            last_error_ = "socket path too long: " + config_.path;
+            return false;
+        }
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            last_error_ = std::string("socket: ") + std::strerror(errno);
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, config_.path.c_str(), config_.path.size() + 1);
+        ::unlink(config_.path.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd_, 4) != 0) {
+            last_error_ = "cannot listen on " + config_.path + ": " + std::strerror(errno);
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+        thread_ = std::thread([this]() { socket_loop(); });
+        return true;
+    }
+
+    // Fail early on an unwritable path rather than silently in the thread.
+    if (!write_text_file(next_payload())) {
+        return false;
+    }
+    thread_ = std::thread([this]() { text_file_loop(); });
+    return true;
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        ::unlink(config_.path.c_str());
+    }
+}
+
+std::string MetricsExporter::next_payload() {
+    const RuntimeMetrics::Snapshot current = metrics_.snapshot();
+    std::string payload = format(current, have_previous_ ? &previous_ : nullptr);
+    previous_ = current;
+    have_previous_ = true;
+    return payload;
+}
+
+bool MetricsExporter::write_text_file(const std::string& payload) {
+    // Write-then-rename so collectors never read a partial file.
+    const std::string temp_path = config_.path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        if (!out) {
+            last_error_ = "cannot write " + temp_path;
+            return false;
+        }
+        out << payload;
+        if (!out) {
+            last_error_ = "short write to " + temp_path;
+            return false;
+        }
+    }
+    if (std::rename(temp_path.c_str(), config_.path.c_str()) != 0) {
+        last_error_ = "cannot rename " + temp_path + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::text_file_loop() {
+    const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(config_.interval_s, 0.05)));
+    bool reported_failure = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_for(lock, interval, [this]() { return stop_requested_; })) {
+        lock.unlock();
+        const bool written = write_text_file(next_payload());
+        if (!written && !reported_failure) {
+            std::clog << "[metrics] " << last_error_ << std::endl;
+        }
+        reported_failure = !written;
+        lock.lock();
+    }
+}
+
+void MetricsExporter::socket_loop() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_requested_) {
+                return;
+            }
+        }
+
+        pollfd descriptor{listen_fd_, POLLIN, 0};
+        const int ready = ::poll(&descriptor, 1, kSocketPollMs);
+        if (ready <= 0 || (descriptor.revents & POLLIN) == 0) {
+            continue;
+        }
+
+        const int client = ::accept(listen_fd_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        const std::string payload = next_payload();
+        std::size_t sent = 0;
+        while (sent < payload.size()) {
+            const ssize_t written = ::send(client, payload.data() + sent, payload.size() - sent, kSendFlags);
+            if (written <= 0) {
+                break;
+            }
+            sent += static_cast<std::size_t>(written);
+        }
+        ::close(client);
+    }
+}
+
+double MetricsExporter::estimate_quantile(const RuntimeMetrics::Snapshot& current,
+                                          const RuntimeMetrics::Snapshot* previous,
+                                          double quantile) {
+    std::array<std::uint64_t, RuntimeMetrics::kFrameTimeBuckets> counts{};
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        const std::uint64_t before = previous ? previous->frame_time_buckets[i] : 0u;
+        counts[i] = current.frame_time_buckets[i] >= before ? current.frame_time_buckets[i] - before : 0u;
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    // Linear interpolation inside the bucket holding the rank, as Prometheus'
+    // histogram_quantile does; the +Inf bucket reports its lower bound.
+    const double rank = std::clamp(quantile, 0.0, 1.0) * static_cast<double>(total);
+    double cumulative = 0.0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        const double next = cumulative + static_cast<double>(counts[i]);
+        if (next >= rank && counts[i] > 0) {
+            const double lower = (i == 0) ? 0.0 : RuntimeMetrics::kFrameTimeBounds[i - 1];
+            if (i >= RuntimeMetrics::kFrameTimeBounds.size()) {
+                return lower;
+            }
+            const double upper = RuntimeMetrics::kFrameTimeBounds[i];
+            return lower + (upper - lower) * (rank - cumulative) / static_cast<double>(counts[i]);
+        }
+        cumulative = next;
+    }
+    return RuntimeMetrics::kFrameTimeBounds.back();
+}
+
+std::string MetricsExporter::format(const RuntimeMetrics::Snapshot& current, const RuntimeMetrics::Snapshot* previous) {
+    std::ostringstream out;
+    out.precision(9);
+
+    out << "# HELP when_frame_time_seconds Main loop work per frame, excluding the pacing sleep.\n";
+    out << "# TYPE when_frame_time_seconds histogram\n";
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < RuntimeMetrics::kFrameTimeBuckets; ++i) {
+        cumulative += current.frame_time_buckets[i];
+        out << "when_frame_time_seconds_bucket{le=\"";
+        if (i < RuntimeMetrics::kFrameTimeBounds.size()) {
+            out << RuntimeMetrics::kFrameTimeBounds[i];
+        } else {
+            out << "+Inf";
+        }
+        out << "\"} " << cumulative << '\n';
+    }
+    out << "when_frame_time_seconds_sum " << current.frame_time_sum_s << '\n';
+    out << "when_frame_time_seconds_count " << current.frames << '\n';
+
+    out << "# HELP when_frame_time_window_seconds Frame time quantiles since the previous export.\n";
+    out << "# TYPE when_frame_time_window_seconds gauge\n";
+    for (const double quantile : kFrameTimeQuantiles) {
+        out << "when_frame_time_window_seconds{quantile=\"" << quantile << "\"} "
+            << estimate_quantile(current, previous, quantile) << '\n';
+    }
+
+    append_metric(out, "when_dropped_samples_total", "counter", "Capture samples lost to a full ring.",
+                  static_cast<double>(current.dropped_samples));
+    append_metric(out, "when_stale_backlog_skips_total", "counter", "Times the DSP skipped a stale backlog.",
+                  static_cast<double>(current.stale_skips));
+    append_metric(out, "when_dsp_hops_total", "counter", "Analysis hops processed.",
+                  static_cast<double>(current.dsp_hops));
+    append_metric(out, "when_ring_occupancy_ratio", "gauge", "Fraction of the capture ring in use.",
+                  current.ring_occupancy);
+    append_metric(out, "when_dsp_hop_seconds", "gauge", "Cost of the most recent analysis hop.",
+                  current.dsp_hop_seconds);
+    append_metric(out, "when_dsp_load_ratio", "gauge", "Smoothed analysis cost as a fraction of real time.",
+                  current.dsp_load);
+    append_metric(out, "when_analysis_rate_hz", "gauge", "Current analysis hop rate.", current.analysis_rate_hz);
+    append_metric(out, "when_analysis_stages_bypassed", "gauge", "Custom analysis stages bypassed for overrunning.",
+                  static_cast<double>(current.analysis_stages_bypassed));
+    append_metric(out, "when_tempo_bpm", "gauge", "Estimated tempo.", current.bpm);
+    append_metric(out, "when_tempo_confidence", "gauge", "Tempo tracker confidence score.", current.tempo_confidence);
+    append_metric(out, "when_audio_active", "gauge", "1 when an audio backend is running.",
+                  current.audio_active ? 1.0 : 0.0);
+    append_metric(out, "when_idle", "gauge", "1 when no audio signal is arriving.", current.idle ? 1.0 : 0.0);
+    return out.str();
+}
+
+} // namespace when
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace when {
+
+// Lock-free counters and gauges written by the main loop with relaxed stores.
+// The exporter thread only loads them, so scraping never blocks a frame.
+struct RuntimeMetrics {
+    // Upper bounds (seconds) of the frame time histogram; the last bucket is +Inf.
+    static constexpr std::array<double, 11> kFrameTimeBounds{
+        0.002, 0.004, 0.008, 0.012, 0.016, 0.020, 0.025, 0.033, 0.050, 0.100, 0.250};
+    static constexpr std::size_t kFrameTimeBuckets = kFrameTimeBounds.size() + 1;
+
+    struct Snapshot {
+        std::array<std::uint64_t, kFrameTimeBuckets> frame_time_buckets{};
+        std::uint64_t frames = 0;
+        double frame_time_sum_s = 0.0;
+        std::uint64_t dropped_samples = 0;
+        std::uint64_t stale_skips = 0;
+        std::uint64_t dsp_hops = 0;
+        double ring_occupancy = 0.0;
+        double dsp_hop_seconds = 0.0;
+        double dsp_load = 0.0;
+        double analysis_rate_hz = 0.0;
+        std::uint64_t analysis_stages_bypassed = 0;
+        double bpm = 0.0;
+        double tempo_confidence = 0.0;
+        bool audio_active = false;
+        bool idle = true;
+    };
+
+    // Single writer (the main loop); readers may run on any thread.
+    void record_frame(double seconds);
+    Snapshot snapshot() const;
+
+    std::array<std::atomic<std::uint64_t>, kFrameTimeBuckets> frame_time_buckets{};
+    std::atomic<std::uint64_t> frames{0};
+    std::atomic<double> frame_time_sum_s{0.0};
+    std::atomic<std::uint64_t> dropped_samples{0};
+    std::atomic<std::uint64_t> stale_skips{0};
+    std::atomic<std::uint64_t> dsp_hops{0};
+    std::atomic<float> ring_occupancy{0.0f};  // Fraction of the capture ring in use
+    std::atomic<float> dsp_hop_seconds{0.0f}; // Cost of the most recent analysis hop
+    std::atomic<float> dsp_load{0.0f};
+    std::atomic<float> analysis_rate_hz{0.0f};
+    std::atomic<std::uint64_t> analysis_stages_bypassed{0};
+    std::atomic<float> bpm{0.0f};
+    std::atomic<float> tempo_confidence{0.0f};
+    std::atomic<bool> audio_active{false};
+    std::atomic<bool> idle{true};
+};
+
+// Publishes RuntimeMetrics in the Prometheus text format, either by rewriting a
+// file for node_exporter's textfile collector or by answering each connection
+// on a Unix socket. Frame time quantiles cover the interval since the previous
+// export.
+class MetricsExporter {
+public:
+    enum class Mode { TextFile, UnixSocket };
+
+    struct Config {
+        Mode mode = Mode::TextFile;
+        std::string path = "when.prom";
+        double interval_s = 5.0; // Text file rewrite period
+    };
+
+    MetricsExporter(const RuntimeMetrics& metrics, Config config);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    bool start();
+    void stop();
+    const std::string& last_error() const { return last_error_; }
+
+    static bool parse_mode(const std::string& text, Mode& mode);
+    // previous may be null, in which case quantiles use every recorded frame.
+    static std::string format(const RuntimeMetrics::Snapshot& current, const RuntimeMetrics::Snapshot* previous);
+    static double estimate_quantile(const RuntimeMetrics::Snapshot& current,
+                                    const RuntimeMetrics::Snapshot* previous,
+                                    double quantile);
+
+private:
+    void text_file_loop();
+    void socket_loop();
+    std::string next_payload();
+    bool write_text_file(const std::string& payload);
+
+    const RuntimeMetrics& metrics_;
+    Config config_;
+    std::string last_error_;
+    RuntimeMetrics::Snapshot previous_{};
+    bool have_previous_ = false;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_requested_ = false;
+    int listen_fd_ = -1;
+};
+
+} // namespace when
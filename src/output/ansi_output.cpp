@@ -0,0 +1,190 @@
+#include "output/ansi_output.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace when {
+namespace output {
+
+namespace {
+constexpr std::uint8_t kGlyphPending = 1u << 0;
+constexpr std::uint8_t kBackgroundPending = 1u << 1;
+
+std::uint32_t fg_color(std::uint64_t channels) {
+    if (ncchannels_fg_default_p(channels)) {
+        return kDefaultColor;
+    }
+    if (ncchannels_fg_palindex_p(channels)) {
+        return kPaletteColor | ncchannels_fg_palindex(channels);
+    }
+    return ncchannels_fg_rgb(channels);
+}
+
+std::uint32_t bg_color(std::uint64_t channels) {
+    if (ncchannels_bg_default_p(channels)) {
+        return kDefaultColor;
+    }
+    if (ncchannels_bg_palindex_p(channels)) {
+        return kPaletteColor | ncchannels_bg_palindex(channels);
+    }
+    return ncchannels_bg_rgb(channels);
+}
+
+std::uint8_t map_style(std::uint16_t stylemask) {
+    std::uint8_t style = 0;
+    if (stylemask & NCSTYLE_BOLD) {
+        style |= kStyleBold;
+    }
+    if (stylemask & NCSTYLE_ITALIC) {
+        style |= kStyleItalic;
+    }
+    if (stylemask & (NCSTYLE_UNDERLINE | NCSTYLE_UNDERCURL)) {
+        style |= kStyleUnderline;
+    }
+    if (stylemask & NCSTYLE_STRUCK) {
+        style |= kStyleStruck;
+    }
+    return style;
+}
+} // namespace
+
+bool parse_output_backend(const std::string& text, OutputBackend& backend) {
+    if (text == "notcurses") {
+        backend = OutputBackend::Notcurses;
+        return true;
+    }
+    if (text == "ansi") {
+        backend = OutputBackend::Ansi;
+        return true;
+    }
+    return false;
+}
+
+AnsiOutput::AnsiOutput(notcurses* nc, int fd) : nc_(nc), fd_(fd) {}
+
+bool AnsiOutput::present() {
+    ncplane* stdplane = notcurses_stdplane(nc_);
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    ncplane_dim_yx(stdplane, &rows, &cols);
+    if (grid_.rows() != rows || grid_.cols() != cols) {
+        grid_.resize(rows, cols);
+    }
+    compose(stdplane);
+    writer_.encode(grid_);
+    if (!writer_.flush(fd_)) {
+        last_error_ = std::string("write failed: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void AnsiOutput::handle_resize() {
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    notcurses_refresh(nc_, &rows, &cols);
+    writer_.invalidate();
+}
+
+void AnsiOutput::compose(ncplane* stdplane) {
+    const unsigned int rows = grid_.rows();
+    const unsigned int cols = grid_.cols();
+    unresolved_.assign(static_cast<std::size_t>(rows) * cols, kGlyphPending | kBackgroundPending);
+    std::size_t remaining = unresolved_.size();
+    auto resolve = [&](std::size_t index, std::uint8_t what) {
+        const std::uint8_t before = unresolved_[index];
+        unresolved_[index] = static_cast<std::uint8_t>(before & ~what);
+        if (before != 0 && unresolved_[index] == 0) {
+            --remaining;
+        }
+    };
+
+    for (ncplane* plane = ncpile_top(stdplane); plane != nullptr && remaining > 0; plane = ncplane_below(plane)) {
+        int origin_y = 0;
+        int origin_x = 0;
+        unsigned int plane_rows = 0;
+        unsigned int plane_cols = 0;
+        ncplane_abs_yx(plane, &origin_y, &origin_x);
+        ncplane_dim_yx(plane, &plane_rows, &plane_cols);
+        const int y_begin = std::max(0, origin_y);
+        const int y_end = std::min(static_cast<int>(rows), origin_y + static_cast<int>(plane_rows));
+        const int x_begin = std::max(0, origin_x);
+        const int x_end = std::min(static_cast<int>(cols), origin_x + static_cast<int>(plane_cols));
+        if (y_begin >= y_end || x_begin >= x_end) {
+            continue;
+        }
+
+        // Empty cells show the plane's base cell, as notcurses does.
+        nccell base = NCCELL_TRIVIAL_INITIALIZER;
+        ncplane_base(plane, &base);
+        const char* base_egc = nccell_extended_gcluster(plane, &base);
+        const std::string base_glyph = base_egc ? base_egc : "";
+
+        for (int y = y_begin; y < y_end; ++y) {
+            for (int x = x_begin; x < x_end; ++x) {
+                const std::size_t index = static_cast<std::size_t>(y) * cols + static_cast<std::size_t>(x);
+                const std::uint8_t pending = unresolved_[index];
+                if (pending == 0) {
+                    continue;
+                }
+                nccell cell = NCCELL_TRIVIAL_INITIALIZER;
+                if (ncplane_at_yx_cell(plane, y - origin_y, x - origin_x, &cell) < 0) {
+                    continue;
+                }
+                const char* egc = nccell_extended_gcluster(plane, &cell);
+                const bool empty = egc == nullptr || *egc == '\0';
+                const bool wide_right = empty && cell.width >= 2; // Drawn by the cell to its left
+                const nccell& visible = (empty && !wide_right) ? base : cell;
+                const char* glyph = (empty && !wide_right) ? base_glyph.c_str() : egc;
+                Cell& out = grid_.at(static_cast<unsigned int>(y), static_cast<unsigned int>(x));
+
+                if ((pending & kGlyphPending) && !wide_right && glyph != nullptr && *glyph != '\0') {
+                    const unsigned int width = std::max(1u, nccell_cols(&visible));
+                    const bool fits = width == 1 ||
+                                      (x + 1 < static_cast<int>(cols) && (unresolved_[index + 1] & kGlyphPending));
+                    out.set_glyph(fits ? std::string_view(glyph) : std::string_view(" "));
+                    out.width = fits ? static_cast<std::uint8_t>(width) : 1;
+                    out.style = map_style(visible.stylemask);
+                    out.fg = (ncchannels_fg_alpha(visible.channels) == NCALPHA_TRANSPARENT) ? kDefaultColor
+                                                                                          : fg_color(visible.channels);
+                    resolve(index, kGlyphPending);
+                    if (fits && width >= 2) {
+                        Cell& right = grid_.at(static_cast<unsigned int>(y), static_cast<unsigned int>(x + 1));
+                        right.length = 0;
+                        right.width = 0;
+                        right.style = out.style;
+                        right.fg = out.fg;
+                        resolve(index + 1, kGlyphPending);
+                    }
+                }
+                if ((pending & kBackgroundPending) && ncchannels_bg_alpha(visible.channels) != NCALPHA_TRANSPARENT) {
+                    out.bg = bg_color(visible.channels);
+                    resolve(index, kBackgroundPending);
+                }
+                nccell_release(plane, &cell);
+            }
+        }
+        nccell_release(plane, &base);
+    }
+
+    // Whatever no plane covered is blank in the default colours.
+    if (remaining > 0) {
+        for (std::size_t index = 0; index < unresolved_.size(); ++index) {
+            const std::uint8_t pending = unresolved_[index];
+            Cell& out = grid_.at(static_cast<unsigned int>(index / cols), static_cast<unsigned int>(index % cols));
+            if (pending & kGlyphPending) {
+                out.set_glyph(" ");
+                out.width = 1;
+                out.style = 0;
+                out.fg = kDefaultColor;
+            }
+            if (pending & kBackgroundPending) {
+                out.bg = kDefaultColor;
+            }
+        }
+    }
+}
+
+} // namespace output
+} // namespace when
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <notcurses/notcurses.h>
+
+#include "output/ansi_writer.h"
+#include "output/cell_grid.h"
+
+namespace when {
+namespace output {
+
+enum class OutputBackend {
+    Notcurses, // notcurses_render: full compositor and rasterizer
+    Ansi,      // AnsiOutput: flatten the pile here, write diffs with AnsiWriter
+};
+
+bool parse_output_backend(const std::string& text, OutputBackend& backend);
+
+// Presents the standard pile without notcurses' rasterizer. Animations keep
+// drawing into their planes; present() flattens the pile top-down into a
+// CellGrid (opaque cells stop the descent, transparent bases let lower planes
+// through, as in notcurses) and hands it to an AnsiWriter. notcurses still
+// owns terminal setup, input and teardown.
+class AnsiOutput {
+public:
+    AnsiOutput(notcurses* nc, int fd);
+
+    bool present();
+    // Call on NCKEY_RESIZE: lets notcurses pick up the new geometry and
+    // repaints everything on the next present().
+    void handle_resize();
+
+    const AnsiWriter::Stats& stats() const { return writer_.stats(); }
+    const std::string& last_error() const { return last_error_; }
+
+private:
+    void compose(ncplane* stdplane);
+
+    notcurses* nc_;
+    int fd_;
+    CellGrid grid_;
+    std::vector<std::uint8_t> unresolved_; // Per cell: glyph/background still to find
+    AnsiWriter writer_;
+    std::string last_error_;
+};
+
+} // namespace output
+} // namespace when
@@ -0,0 +1,227 @@
+#include "output/ansi_writer.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace when {
+namespace output {
+
+namespace {
+// CUP with five-digit coordinates, a full SGR (reset, four styles, two RGB
+// colours) and the longest glyph: nothing a single cell emits is longer.
+constexpr std::size_t kWorstCellBytes = 14 + 46 + Cell::kMaxGlyphBytes;
+// Unchanged cells re-sent to bridge a gap when that beats a CUF.
+constexpr unsigned int kMaxBridgeCells = 3;
+} // namespace
+
+AnsiWriter::AnsiWriter(std::size_t reserve_bytes) : buffer_(reserve_bytes) {}
+
+void AnsiWriter::invalidate() {
+    previous_valid_ = false;
+    cursor_row_ = -1;
+    cursor_col_ = -1;
+    pen_valid_ = false;
+}
+
+std::string_view AnsiWriter::encode(const CellGrid& frame) {
+    const unsigned int rows = frame.rows();
+    const unsigned int cols = frame.cols();
+    const std::size_t worst = static_cast<std::size_t>(rows) * cols * kWorstCellBytes + 16;
+    if (buffer_.size() < worst) {
+        buffer_.resize(worst);
+    }
+    length_ = 0;
+    stats_ = Stats{};
+
+    const bool repaint = !previous_valid_ || previous_.rows() != rows || previous_.cols() != cols;
+    for (unsigned int row = 0; row < rows; ++row) {
+        for (unsigned int col = 0; col < cols; ++col) {
+            const Cell& cell = frame.at(row, col);
+            if (cell.width == 0 || (!repaint && cell == previous_.at(row, col))) {
+                continue;
+            }
+            move_to(frame, row, col);
+            set_pen(cell);
+            put_glyph(cell, cols);
+        }
+    }
+
+    previous_ = frame; // Reuses the existing storage while the geometry is unchanged
+    previous_valid_ = true;
+    stats_.bytes = length_;
+    return std::string_view(buffer_.data(), length_);
+}
+
+bool AnsiWriter::flush(int fd) {
+    std::size_t offset = 0;
+    while (offset < length_) {
+        const ssize_t written = ::write(fd, buffer_.data() + offset, length_ - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // The terminal state is unknown after a partial frame.
+            invalidate();
+            return false;
+        }
+        offset += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+void AnsiWriter::move_to(const CellGrid& frame, unsigned int row, unsigned int col) {
+    const int target_row = static_cast<int>(row);
+    const int target_col = static_cast<int>(col);
+    if (cursor_row_ == target_row && cursor_col_ == target_col) {
+        return;
+    }
+    if (cursor_row_ == target_row && cursor_col_ >= 0 && target_col > cursor_col_) {
+        const auto gap = static_cast<unsigned int>(target_col - cursor_col_);
+        if (gap <= kMaxBridgeCells && pen_valid_) {
+            // Re-sending a few narrow, same-pen glyphs is shorter than a CUF.
+            bool bridge = true;
+            for (unsigned int c = static_cast<unsigned int>(cursor_col_); c < col && bridge; ++c) {
+                const Cell& skipped = frame.at(row, c);
+                bridge = skipped.width == 1 && skipped.length == 1 && skipped.fg == pen_.fg &&
+                         skipped.bg == pen_.bg && skipped.style == pen_.style;
+            }
+            if (bridge) {
+                for (unsigned int c = static_cast<unsigned int>(cursor_col_); c < col; ++c) {
+                    buffer_[length_++] = frame.at(row, c).glyph[0];
+                }
+                cursor_col_ = target_col;
+                return;
+            }
+        }
+        put("\x1b[");
+        if (gap > 1) {
+            put_uint(gap);
+        }
+        buffer_[length_++] = 'C';
+        ++stats_.moves;
+        cursor_col_ = target_col;
+        return;
+    }
+
+    put("\x1b[");
+    if (row != 0 || col != 0) {
+        put_uint(row + 1);
+        if (col != 0) {
+            buffer_[length_++] = ';';
+            put_uint(col + 1);
+        }
+    }
+    buffer_[length_++] = 'H';
+    ++stats_.moves;
+    cursor_row_ = target_row;
+    cursor_col_ = target_col;
+}
+
+void AnsiWriter::set_pen(const Cell& cell) {
+    if (pen_valid_ && pen_.fg == cell.fg && pen_.bg == cell.bg && pen_.style == cell.style) {
+        return;
+    }
+    put("\x1b[");
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) {
+            buffer_[length_++] = ';';
+        }
+        first = false;
+    };
+
+    // SGR can only switch attributes off by resetting everything.
+    if (!pen_valid_ || (pen_.style & ~cell.style) != 0) {
+        pen_ = Pen{};
+        if (cell.style == 0 && cell.fg == kDefaultColor && cell.bg == kDefaultColor) {
+            buffer_[length_++] = 'm';
+            pen_valid_ = true;
+            ++stats_.sgr;
+            return;
+        }
+        buffer_[length_++] = '0';
+        first = false;
+    }
+    const auto added = static_cast<std::uint8_t>(cell.style & ~pen_.style);
+    if (added & kStyleBold) {
+        separator();
+        buffer_[length_++] = '1';
+    }
+    if (added & kStyleItalic) {
+        separator();
+        buffer_[length_++] = '3';
+    }
+    if (added & kStyleUnderline) {
+        separator();
+        buffer_[length_++] = '4';
+    }
+    if (added & kStyleStruck) {
+        separator();
+        buffer_[length_++] = '9';
+    }
+    if (cell.fg != pen_.fg) {
+        separator();
+        put_color(cell.fg, false);
+    }
+    if (cell.bg != pen_.bg) {
+        separator();
+        put_color(cell.bg, true);
+    }
+    buffer_[length_++] = 'm';
+    ++stats_.sgr;
+    pen_ = Pen{cell.fg, cell.bg, cell.style};
+    pen_valid_ = true;
+}
+
+void AnsiWriter::put_glyph(const Cell& cell, unsigned int cols) {
+    std::memcpy(buffer_.data() + length_, cell.glyph.data(), cell.length);
+    length_ += cell.length;
+    ++stats_.cells;
+    cursor_col_ += cell.width;
+    if (cursor_col_ >= static_cast<int>(cols)) {
+        // Pending wrap: terminals disagree on where the cursor is now.
+        cursor_row_ = -1;
+        cursor_col_ = -1;
+    }
+}
+
+void AnsiWriter::put(std::string_view bytes) {
+    std::memcpy(buffer_.data() + length_, bytes.data(), bytes.size());
+    length_ += bytes.size();
+}
+
+void AnsiWriter::put_uint(std::uint32_t value) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0) {
+        buffer_[length_++] = digits[--count];
+    }
+}
+
+void AnsiWriter::put_color(std::uint32_t color, bool background) {
+    if (color == kDefaultColor) {
+        put(background ? "49" : "39");
+        return;
+    }
+    put(background ? "48;" : "38;");
+    if ((color & kPaletteColor) != 0) {
+        put("5;");
+        put_uint(color & 0xffu);
+        return;
+    }
+    put("2;");
+    put_uint((color >> 16) & 0xffu);
+    buffer_[length_++] = ';';
+    put_uint((color >> 8) & 0xffu);
+    buffer_[length_++] = ';';
+    put_uint(color & 0xffu);
+}
+
+} // namespace output
+} // namespace when
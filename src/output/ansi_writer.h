@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "output/cell_grid.h"
+
+namespace when {
+namespace output {
+
+// Turns successive CellGrids into the smallest escape stream it can cheaply
+// find: only changed cells are written, the cursor is moved with CUF/CUP or by
+// re-sending a few unchanged glyphs, and SGR state is cached across cells and
+// frames. Output goes to one buffer that grows only when the geometry does.
+class AnsiWriter {
+public:
+    struct Stats {
+        std::size_t cells = 0; // Cells written
+        std::size_t moves = 0; // Cursor positioning sequences
+        std::size_t sgr = 0;   // SGR sequences
+        std::size_t bytes = 0;
+    };
+
+    explicit AnsiWriter(std::size_t reserve_bytes = 1u << 16);
+
+    // Forgets the previous frame, cursor and pen; the next encode repaints
+    // everything. Call after anything else has written to the terminal.
+    void invalidate();
+
+    // Encodes frame against the previous one. The view stays valid until the
+    // next encode.
+    std::string_view encode(const CellGrid& frame);
+
+    // Writes the last encoded frame to fd with one write() (more only on a
+    // short write). Returns false on error.
+    bool flush(int fd);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Pen {
+        std::uint32_t fg = kDefaultColor;
+        std::uint32_t bg = kDefaultColor;
+        std::uint8_t style = 0;
+    };
+
+    void move_to(const CellGrid& frame, unsigned int row, unsigned int col);
+    void set_pen(const Cell& cell);
+    void put_glyph(const Cell& cell, unsigned int cols);
+    void put(std::string_view bytes);
+    void put_uint(std::uint32_t value);
+    void put_color(std::uint32_t color, bool background);
+
+    std::vector<char> buffer_;
+    std::size_t length_ = 0;
+    CellGrid previous_;
+    bool previous_valid_ = false;
+    int cursor_row_ = -1; // -1: unknown
+    int cursor_col_ = -1;
+    Pen pen_{};
+    bool pen_valid_ = false;
+    Stats stats_{};
+};
+
+} // namespace output
+} // namespace when
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace when {
+namespace output {
+
+// Colours are 0xRRGGBB, or one of the tagged values below.
+inline constexpr std::uint32_t kDefaultColor = 0x01000000u;
+inline constexpr std::uint32_t kPaletteColor = 0x02000000u; // Low byte is the palette index
+
+enum CellStyle : std::uint8_t {
+    kStyleBold = 1u << 0,
+    kStyleItalic = 1u << 1,
+    kStyleUnderline = 1u << 2,
+    kStyleStruck = 1u << 3,
+};
+
+// One composed terminal cell. Glyphs are stored inline as UTF-8 so a frame is
+// a flat array that compares with memcmp-like cost.
+struct Cell {
+    static constexpr std::size_t kMaxGlyphBytes = 12;
+
+    std::array<char, kMaxGlyphBytes> glyph{' '};
+    std::uint8_t length = 1;
+    std::uint8_t width = 1; // Columns; 0 marks the right half of a wide glyph
+    std::uint8_t style = 0;
+    std::uint32_t fg = kDefaultColor;
+    std::uint32_t bg = kDefaultColor;
+
+    // Clusters longer than kMaxGlyphBytes keep their first code point.
+    void set_glyph(std::string_view utf8) {
+        if (utf8.size() > kMaxGlyphBytes) {
+            std::size_t end = 1;
+            while (end < utf8.size() && (static_cast<unsigned char>(utf8[end]) & 0xc0u) == 0x80u) {
+                ++end;
+            }
+            utf8 = utf8.substr(0, end);
+        }
+        std::memcpy(glyph.data(), utf8.data(), utf8.size());
+        length = static_cast<std::uint8_t>(utf8.size());
+    }
+
+    std::string_view text() const { return std::string_view(glyph.data(), length); }
+
+    bool same_pen(const Cell& other) const { return fg == other.fg && bg == other.bg && style == other.style; }
+
+    bool operator==(const Cell& other) const {
+        return length == other.length && width == other.width && same_pen(other) &&
+               std::memcmp(glyph.data(), other.glyph.data(), length) == 0;
+    }
+};
+
+class CellGrid {
+public:
+    // Resets every cell to a blank with default colours.
+    void resize(unsigned int rows, unsigned int cols) {
+        rows_ = rows;
+        cols_ = cols;
+        cells_.assign(static_cast<std::size_t>(rows) * cols, Cell{});
+    }
+
+    void clear() { cells_.assign(cells_.size(), Cell{}); }
+
+    unsigned int rows() const { return rows_; }
+    unsigned int cols() const { return cols_; }
+
+    Cell& at(unsigned int row, unsigned int col) { return cells_[static_cast<std::size_t>(row) * cols_ + col]; }
+    const Cell& at(unsigned int row, unsigned int col) const {
+        return cells_[static_cast<std::size_t>(row) * cols_ + col];
+    }
+
+private:
+    unsigned int rows_ = 0;
+    unsigned int cols_ = 0;
+    std::vector<Cell> cells_;
+};
+
+} // namespace output
+} // namespace when
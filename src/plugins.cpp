@@ -260,6 +260,68 @@ private:
         when::animations::band::feature_tap_config_from(when::FeatureExtractor::Config{});
 };
 
+// Adds spectral roll-off and crest channels computed on the analysis thread.
+class SpectralShapeStage final : public AnalysisStage {
+public:
+    std::string id() const override { return "spectral-shape"; }
+
+    std::vector<std::string> channel_names() const override {
+        return {"spectral_rolloff", "spectral_crest"};
+    }
+
+    void process(const FeatureInputFrame& frame, std::span<float> out) override {
+        const std::span<const float> magnitudes = frame.fft_magnitudes;
+        if (magnitudes.size() < 2 || out.size() < 2) {
+            return;
+        }
+
+        double total_energy = 0.0;
+        double magnitude_sum = 0.0;
+        float peak = 0.0f;
+        for (float magnitude : magnitudes) {
+            total_energy += static_cast<double>(magnitude) * magnitude;
+            magnitude_sum += magnitude;
+            peak = std::max(peak, magnitude);
+        }
+        if (total_energy <= kSilenceEnergy) {
+            out[0] = 0.0f;
+            out[1] = 0.0f;
+            return;
+        }
+
+        // Fraction of the spectrum below which kRolloffFraction of the energy sits.
+        const double target = total_energy * kRolloffFraction;
+        double cumulative = 0.0;
+        std::size_t rolloff_bin = magnitudes.size() - 1;
+        for (std::size_t bin = 0; bin < magnitudes.size(); ++bin) {
+            cumulative += static_cast<double>(magnitudes[bin]) * magnitudes[bin];
+            if (cumulative >= target) {
+                rolloff_bin = bin;
+                break;
+            }
+        }
+        out[0] = static_cast<float>(rolloff_bin) / static_cast<float>(magnitudes.size() - 1);
+
+        // Crest factor peak/mean mapped to 0-1 (0 = flat, towards 1 = a single peak).
+        const double mean = magnitude_sum / static_cast<double>(magnitudes.size());
+        out[1] = (peak > 0.0f) ? static_cast<float>(1.0 - mean / peak) : 0.0f;
+    }
+
+private:
+    static constexpr double kRolloffFraction = 0.85;
+    static constexpr double kSilenceEnergy = 1e-12;
+};
+
+class SpectralShapePlugin final : public Plugin {
+public:
+    std::string id() const override { return "spectral-shape"; }
+    void on_load(const AppConfig&) override {}
+    void on_frame(const AudioMetrics&, const AudioFeatures&, double) override {}
+    std::unique_ptr<AnalysisStage> create_analysis_stage() override {
+        return std::make_unique<SpectralShapeStage>();
+    }
+};
+
 } // namespace
 
 void PluginManager::register_factory(const std::string& id, PluginFactory factory) {
@@ -270,6 +332,7 @@ void PluginManager::load_from_config(const AppConfig& config,
                                      const when::FeatureExtractor::Config& feature_config) {
     warnings_.clear();
     active_.clear();
+    analysis_stages_.clear();
     if (config.plugins.safe_mode) {
         warnings_.push_back("Plug-ins disabled by plugins.safe_mode");
         return;
@@ -294,6 +357,9 @@ void PluginManager::load_from_config(const AppConfig& config,
         }
         plugin->configure_feature_extractor(feature_config);
         plugin->on_load(config);
+        if (std::unique_ptr<AnalysisStage> stage = plugin->create_analysis_stage()) {
+            analysis_stages_.push_back(std::move(stage));
+        }
         active_.push_back(std::move(plugin));
     }
 }
@@ -309,6 +375,7 @@ void PluginManager::notify_frame(const AudioMetrics& metrics,
 void register_builtin_plugins(PluginManager& manager) {
     manager.register_factory("beat-flash-debug", []() { return std::make_unique<BeatFlashDebugPlugin>(); });
     manager.register_factory("band-feature-tap-logger", []() { return std::make_unique<BandFeatureTapLogger>(); });
+    manager.register_factory("spectral-shape", []() { return std::make_unique<SpectralShapePlugin>(); });
 }
 
 } // namespace when
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "audio_engine.h"
+#include "audio/analysis_stage.h"
 #include "audio/audio_features.h"
 #include "audio/feature_extractor.h"
 #include "config.h"
@@ -22,6 +23,8 @@ public:
     virtual void on_frame(const AudioMetrics& metrics,
                           const AudioFeatures& features,
                           double time_s) = 0;
+    // Optional analysis-thread counterpart; its channels appear in AudioFeatures::custom_channels.
+    virtual std::unique_ptr<AnalysisStage> create_analysis_stage() { return nullptr; }
 };
 
 using PluginFactory = std::function<std::unique_ptr<Plugin>()>;
@@ -35,10 +38,12 @@ public:
                       double time_s);
 
     const std::vector<std::string>& warnings() const { return warnings_; }
+    std::vector<std::unique_ptr<AnalysisStage>> take_analysis_stages() { return std::move(analysis_stages_); }
 
 private:
     std::unordered_map<std::string, PluginFactory> factories_;
     std::vector<std::unique_ptr<Plugin>> active_;
+    std::vector<std::unique_ptr<AnalysisStage>> analysis_stages_;
     std::vector<std::string> warnings_;
 };
 
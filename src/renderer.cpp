@@ -56,14 +56,18 @@ void render_frame(notcurses* nc,
         ncplane_set_fg_rgb8(stdplane, 200, 200, 200); // White foreground
         ncplane_set_bg_rgb8(stdplane, 0, 0, 0);     // Black background
         ncplane_printf_yx(stdplane, plane_rows - 3, 0,
-                          "Audio %s",
-                          metrics.active ? (file_stream ? "file" : "capturing") : "inactive");
+                          "Audio %s | Analysis %.0f Hz (load %.0f%%) | Bypassed stages: %zu",
+                          metrics.active ? (file_stream ? "file" : "capturing") : "inactive",
+                          metrics.analysis_rate_hz,
+                          metrics.analysis_load * 100.0f,
+                          metrics.bypassed_stages);
 
         ncplane_printf_yx(stdplane, plane_rows - 2, 0,
-                          "RMS: %.3f | Peak: %.3f | Dropped: %zu | Beat: %.2f",
+                          "RMS: %.3f | Peak: %.3f | Dropped: %zu | Skips: %zu | Beat: %.2f",
                           metrics.rms,
                           metrics.peak,
                           metrics.dropped,
+                          metrics.stale_skips,
                           features.beat_strength);
     }
 }
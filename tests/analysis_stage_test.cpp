@@ -0,0 +1,121 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "audio/analysis_stage.h"
+#include "dsp.h"
+#include "events/event_bus.h"
+#include "events/frame_events.h"
+
+namespace {
+
+class HopCounterStage final : public when::AnalysisStage {
+public:
+    std::string id() const override { return "hop-counter"; }
+    std::vector<std::string> channel_names() const override { return {"hops", "band0"}; }
+    void process(const when::FeatureInputFrame& frame, std::span<float> out) override {
+        out[0] += 1.0f;
+        out[1] = frame.instantaneous_band_energies.empty() ? -1.0f : frame.instantaneous_band_energies[0];
+    }
+};
+
+// Stage cost is charged to a fake clock, so overruns do not depend on how
+// busy the machine running the test is.
+double fake_now_seconds = 0.0;
+double fake_clock() { return fake_now_seconds; }
+
+class SlowStage final : public when::AnalysisStage {
+public:
+    SlowStage(const bool& slow, int& calls) : slow_(slow), calls_(calls) {}
+
+    std::string id() const override { return "slow"; }
+    std::vector<std::string> channel_names() const override { return {"slow"}; }
+    void process(const when::FeatureInputFrame&, std::span<float> out) override {
+        ++calls_;
+        if (slow_) {
+            fake_now_seconds += 0.002; // Four times the 0.5 ms budget
+        }
+        out[0] = 1.0f;
+    }
+
+private:
+    const bool& slow_;
+    int& calls_;
+};
+
+// Pushes `seconds` of audio one hop at a time.
+void push_seconds(when::DspEngine& dsp, const std::vector<float>& hop, float seconds) {
+    const int hops = static_cast<int>(std::ceil(seconds * 48000.0f / static_cast<float>(hop.size())));
+    for (int i = 0; i < hops; ++i) {
+        dsp.push_samples(hop.data(), hop.size());
+    }
+}
+
+} // namespace
+
+int main() {
+    when::events::EventBus bus;
+    std::vector<when::events::AnalysisStageStatusEvent> status_events;
+    auto handle = bus.subscribe<when::events::AnalysisStageStatusEvent>(
+        [&](const when::events::AnalysisStageStatusEvent& event) { status_events.push_back(event); });
+
+    bool slow_enabled = true;
+    int slow_calls = 0;
+    when::DspEngine dsp(bus, 48000, 1, 1024, 256, 16);
+    dsp.set_analysis_stage_budget_ms(0.5f);
+    dsp.set_analysis_stage_time_source(fake_clock);
+    dsp.add_analysis_stage(std::make_unique<HopCounterStage>());
+    dsp.add_analysis_stage(std::make_unique<SlowStage>(slow_enabled, slow_calls));
+
+    std::vector<float> samples(256 * 12);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = 0.5f * std::sin(2.0f * 3.14159265f * 110.0f * static_cast<float>(i) / 48000.0f);
+    }
+    dsp.push_samples(samples.data(), samples.size());
+
+    const when::AudioFeatures& features = dsp.audio_features();
+    assert(features.custom_channels.size() == 3);
+    const int hops = when::find_custom_channel(features, "hops");
+    const int band0 = when::find_custom_channel(features, "band0");
+    const int slow = when::find_custom_channel(features, "slow");
+    assert(hops == 0 && band0 == 1 && slow == 2);
+    assert(when::find_custom_channel(features, "missing") == -1);
+
+    assert(features.custom_channels[hops] == 12.0f);
+    assert(features.custom_channels[band0] >= 0.0f);
+
+    // The slow stage overran its budget on every hop and has been bypassed.
+    assert(dsp.bypassed_analysis_stages() == 1);
+    assert(features.custom_channels[slow] == 0.0f);
+    assert(slow_calls == static_cast<int>(when::AnalysisStageHost::kMaxConsecutiveOverruns));
+    assert(status_events.size() == 1);
+    assert(status_events[0].stage_id == "slow" && status_events[0].bypassed && status_events[0].budget_ms == 0.5f);
+
+    const std::vector<float> hop(samples.begin(), samples.begin() + 256);
+
+    // Once the cool-down has passed a single re-probe within budget restores it.
+    slow_enabled = false;
+    push_seconds(dsp, hop, when::AnalysisStageHost::kBypassCooldownSeconds * 0.5f);
+    assert(dsp.bypassed_analysis_stages() == 1 && status_events.size() == 1);
+    push_seconds(dsp, hop, when::AnalysisStageHost::kBypassCooldownSeconds * 0.5f + 0.05f);
+    assert(dsp.bypassed_analysis_stages() == 0);
+    assert(status_events.size() == 2 && status_events[1].stage_id == "slow" && !status_events[1].bypassed);
+    assert(dsp.audio_features().custom_channels[slow] == 1.0f);
+
+    // A failed re-probe keeps it bypassed and doubles the wait before the next one.
+    slow_enabled = true;
+    push_seconds(dsp, hop, 0.1f);
+    assert(dsp.bypassed_analysis_stages() == 1 && status_events.size() == 3 && status_events[2].bypassed);
+    slow_calls = 0;
+    push_seconds(dsp, hop, when::AnalysisStageHost::kBypassCooldownSeconds + 0.05f);
+    assert(slow_calls == 1);
+    assert(dsp.bypassed_analysis_stages() == 1 && status_events.size() == 3);
+    assert(dsp.audio_features().custom_channels[slow] == 0.0f);
+    push_seconds(dsp, hop, when::AnalysisStageHost::kBypassCooldownSeconds * 1.5f);
+    assert(slow_calls == 1);
+    push_seconds(dsp, hop, when::AnalysisStageHost::kBypassCooldownSeconds * 0.5f + 0.05f);
+    assert(slow_calls == 2);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "animations/animation.h"
+#include "animations/animation_event_utils.h"
+#include "events/event_bus.h"
+#include "events/frame_events.h"
+
+namespace {
+
+class CountingAnimation : public when::animations::Animation {
+public:
+    void init(notcurses*, const when::AppConfig&) override {}
+    void update(float delta_time, const when::AudioMetrics&, const when::AudioFeatures&) override {
+        update_deltas.push_back(delta_time);
+    }
+    void render(notcurses*) override {}
+    void activate() override { active_ = true; }
+    void deactivate() override { active_ = false; }
+    bool is_active() const override { return active_; }
+    int get_z_index() const override { return 0; }
+    ncplane* get_plane() const override { return nullptr; }
+    void bind_events(const when::AnimationConfig& config, when::events::EventBus& bus) override {
+        when::animations::bind_standard_frame_updates(this, config, bus);
+    }
+
+    std::vector<float> update_deltas;
+
+private:
+    bool active_ = true;
+};
+
+} // namespace
+
+int main() {
+    when::events::EventBus bus;
+    when::AnimationConfig config;
+    config.initially_active = true;
+
+    CountingAnimation every_frame;
+    CountingAnimation halved_a;
+    CountingAnimation halved_b;
+    every_frame.bind_events(config, bus);
+    halved_a.bind_events(config, bus);
+    halved_b.bind_events(config, bus);
+    halved_a.set_update_schedule(2, 0);
+    halved_b.set_update_schedule(2, 1);
+
+    const when::AudioMetrics metrics{};
+    const when::AudioFeatures features{};
+    for (std::uint64_t frame = 0; frame < 8; ++frame) {
+        when::events::FrameUpdateEvent event{0.01f, metrics, features, frame};
+        bus.publish(event);
+    }
+
+    assert(every_frame.update_deltas.size() == 8);
+    assert(halved_a.update_deltas.size() == 4);
+    assert(halved_b.update_deltas.size() == 4);
+
+    // Staggered peers never share a frame, and reduced-rate updates receive
+    // the time accumulated since their previous slot.
+    assert(std::abs(halved_b.update_deltas.front() - 0.02f) < 1e-6f);
+    assert(std::abs(halved_a.update_deltas.front() - 0.01f) < 1e-6f);
+    assert(std::abs(halved_a.update_deltas.back() - 0.02f) < 1e-6f);
+    return 0;
+}
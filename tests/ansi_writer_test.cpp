@@ -0,0 +1,247 @@
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "output/ansi_writer.h"
+
+namespace {
+using when::output::Cell;
+using when::output::CellGrid;
+
+// Just enough of a terminal to replay what AnsiWriter emits: CUP, CUF, SGR
+// and UTF-8 glyphs, with deferred wrap at the right margin.
+class MiniTerminal {
+public:
+    MiniTerminal(unsigned int rows, unsigned int cols) : rows_(rows), cols_(cols), screen_(rows * cols) {}
+
+    void feed(std::string_view data) {
+        std::size_t i = 0;
+        while (i < data.size()) {
+            if (data[i] == '\x1b') {
+                assert(data[i + 1] == '[');
+                std::size_t end = i + 2;
+                while (!(data[end] >= 0x40 && data[end] <= 0x7e)) {
+                    ++end;
+                }
+                csi(data.substr(i + 2, end - i - 2), data[end]);
+                i = end + 1;
+                continue;
+            }
+            std::size_t length = 1;
+            const auto lead = static_cast<unsigned char>(data[i]);
+            if (lead >= 0xf0) {
+                length = 4;
+            } else if (lead >= 0xe0) {
+                length = 3;
+            } else if (lead >= 0xc0) {
+                length = 2;
+            }
+            const std::string glyph(data.substr(i, length));
+            const unsigned int width = (glyph == "\xe7\x95\x8c") ? 2 : 1; // U+754C
+            assert(col_ + width <= cols_);
+            Cell& cell = screen_[row_ * cols_ + col_];
+            cell.set_glyph(glyph);
+            cell.width = static_cast<std::uint8_t>(width);
+            cell.fg = pen_.fg;
+            cell.bg = pen_.bg;
+            cell.style = pen_.style;
+            if (width == 2) {
+                Cell& right = screen_[row_ * cols_ + col_ + 1];
+                right.length = 0;
+                right.width = 0;
+            }
+            col_ += width;
+            if (col_ >= cols_) {
+                col_ = cols_ - 1; // Cursor parks on the margin until repositioned
+                wrapped_ = true;
+            }
+            i += length;
+        }
+    }
+
+    // Compares what is visible; the hidden half of a wide glyph only needs its width.
+    bool matches(const CellGrid& grid) const {
+        for (unsigned int r = 0; r < rows_; ++r) {
+            for (unsigned int c = 0; c < cols_; ++c) {
+                const Cell& expected = grid.at(r, c);
+                const Cell& actual = screen_[r * cols_ + c];
+                if (expected.width == 0 ? actual.width != 0 : !(expected == actual)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    std::vector<unsigned int> params(std::string_view text) {
+        std::vector<unsigned int> out;
+        unsigned int value = 0;
+        bool any = false;
+        for (const char c : text) {
+            if (c == ';') {
+                out.push_back(value);
+                value = 0;
+                any = false;
+            } else {
+                value = value * 10 + static_cast<unsigned int>(c - '0');
+                any = true;
+            }
+        }
+        if (any || !out.empty()) {
+            out.push_back(value);
+        }
+        return out;
+    }
+
+    void csi(std::string_view text, char final) {
+        const std::vector<unsigned int> p = params(text);
+        if (final == 'H') {
+            row_ = (p.size() > 0 ? p[0] : 1) - 1;
+            col_ = (p.size() > 1 ? p[1] : 1) - 1;
+            wrapped_ = false;
+        } else if (final == 'C') {
+            assert(!wrapped_); // The writer must not rely on the cursor after a wrap
+            col_ += p.empty() ? 1 : p[0];
+        } else if (final == 'm') {
+            if (p.empty()) {
+                pen_ = Cell{};
+            }
+            for (std::size_t i = 0; i < p.size(); ++i) {
+                switch (p[i]) {
+                case 0: pen_ = Cell{}; break;
+                case 1: pen_.style |= when::output::kStyleBold; break;
+                case 3: pen_.style |= when::output::kStyleItalic; break;
+                case 4: pen_.style |= when::output::kStyleUnderline; break;
+                case 9: pen_.style |= when::output::kStyleStruck; break;
+                case 39: pen_.fg = when::output::kDefaultColor; break;
+                case 49: pen_.bg = when::output::kDefaultColor; break;
+                case 38:
+                case 48: {
+                    const bool foreground = p[i] == 38;
+                    std::uint32_t color = 0;
+                    if (p[i + 1] == 5) {
+                        color = when::output::kPaletteColor | p[i + 2];
+                        i += 2;
+                    } else {
+                        color = (p[i + 2] << 16) | (p[i + 3] << 8) | p[i + 4];
+                        i += 4;
+                    }
+                    (foreground ? pen_.fg : pen_.bg) = color;
+                    break;
+                }
+                default: assert(false);
+                }
+            }
+        } else {
+            assert(false);
+        }
+    }
+
+    unsigned int rows_;
+    unsigned int cols_;
+    std::vector<Cell> screen_;
+    unsigned int row_ = 0;
+    unsigned int col_ = 0;
+    bool wrapped_ = false;
+    Cell pen_{};
+};
+
+void randomise(CellGrid& grid, std::mt19937& rng, float fraction) {
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::uniform_int_distribution<int> pick(0, 7);
+    static const char* glyphs[] = {"a", "#", " ", "\xe2\x96\x88", "\xe2\xa3\xbf", ".", "*", "\xc3\xa9"};
+    static const std::uint32_t colors[] = {when::output::kDefaultColor, 0xff0000u, 0x00ff80u, 0x102030u,
+                                           when::output::kPaletteColor | 196u, 0xffffffu, 0x000000u, 0x808080u};
+    for (unsigned int r = 0; r < grid.rows(); ++r) {
+        for (unsigned int c = 0; c < grid.cols(); ++c) {
+            if (chance(rng) >= fraction) {
+                continue;
+            }
+            Cell& cell = grid.at(r, c);
+            cell.set_glyph(glyphs[pick(rng)]);
+            cell.width = 1;
+            cell.fg = colors[pick(rng)];
+            cell.bg = colors[pick(rng) / 3];
+            cell.style = static_cast<std::uint8_t>(pick(rng) < 6 ? 0 : (pick(rng) & 0x0f));
+        }
+    }
+}
+} // namespace
+
+int main() {
+    constexpr unsigned int kRows = 12;
+    constexpr unsigned int kCols = 40;
+    std::mt19937 rng(7u);
+    when::output::AnsiWriter writer(64);
+    MiniTerminal terminal(kRows, kCols);
+
+    // First frame paints everything.
+    CellGrid grid;
+    grid.resize(kRows, kCols);
+    randomise(grid, rng, 1.0f);
+    terminal.feed(writer.encode(grid));
+    assert(terminal.matches(grid));
+    assert(writer.stats().cells == kRows * kCols);
+
+    // An identical frame costs nothing.
+    assert(writer.encode(grid).empty());
+
+    // Sparse updates write only what changed, and stay correct over many frames.
+    for (int frame = 0; frame < 50; ++frame) {
+        randomise(grid, rng, 0.05f);
+        terminal.feed(writer.encode(grid));
+        assert(terminal.matches(grid));
+        assert(writer.stats().cells < kRows * kCols / 4);
+    }
+
+    // A one-cell gap with the same pen is bridged instead of moved over.
+    CellGrid flat;
+    flat.resize(kRows, kCols);
+    MiniTerminal flat_terminal(kRows, kCols);
+    when::output::AnsiWriter flat_writer;
+    flat_terminal.feed(flat_writer.encode(flat));
+    flat.at(3, 5).set_glyph("x");
+    flat.at(3, 7).set_glyph("y");
+    const std::string_view bridged = flat_writer.encode(flat);
+    flat_terminal.feed(bridged);
+    assert(flat_terminal.matches(flat));
+    assert(flat_writer.stats().moves == 1 && flat_writer.stats().sgr == 0);
+    assert(bridged == "\x1b[4;6Hx y");
+
+    // Dropping an attribute needs a reset; colours are re-sent after it.
+    flat.at(0, 0).style = when::output::kStyleBold | when::output::kStyleUnderline;
+    flat.at(0, 0).fg = 0x123456u;
+    flat.at(0, 1).style = when::output::kStyleUnderline;
+    flat.at(0, 1).fg = 0x123456u;
+    flat_terminal.feed(flat_writer.encode(flat));
+    assert(flat_terminal.matches(flat));
+    assert(flat_writer.stats().sgr == 2);
+
+    // Wide glyphs cover their right neighbour; writing the last column forces a CUP next.
+    flat.at(5, 10).set_glyph("\xe7\x95\x8c");
+    flat.at(5, 10).width = 2;
+    flat.at(5, 11).length = 0;
+    flat.at(5, 11).width = 0;
+    flat.at(5, 12).set_glyph("z");
+    flat.at(6, kCols - 1).set_glyph("e");
+    flat.at(7, 0).set_glyph("f");
+    flat_terminal.feed(flat_writer.encode(flat));
+    assert(flat_terminal.matches(flat));
+
+    // A geometry change repaints, and invalidate() forces the same.
+    CellGrid small;
+    small.resize(4, 10);
+    randomise(small, rng, 1.0f);
+    MiniTerminal small_terminal(4, 10);
+    small_terminal.feed(writer.encode(small));
+    assert(small_terminal.matches(small));
+    assert(writer.stats().cells == 40);
+    writer.invalidate();
+    small_terminal.feed(writer.encode(small));
+    assert(writer.stats().cells == 40);
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "analyze/batch_analyzer.h"
+
+namespace {
+namespace fs = std::filesystem;
+
+void write_u32(std::ofstream& out, std::uint32_t value) {
+    const char bytes[4] = {static_cast<char>(value), static_cast<char>(value >> 8), static_cast<char>(value >> 16),
+                           static_cast<char>(value >> 24)};
+    out.write(bytes, 4);
+}
+
+void write_u16(std::ofstream& out, std::uint16_t value) {
+    const char bytes[2] = {static_cast<char>(value), static_cast<char>(value >> 8)};
+    out.write(bytes, 2);
+}
+
+// 16-bit mono PCM tone.
+void write_wav(const fs::path& path, float frequency, float seconds) {
+    constexpr std::uint32_t kRate = 48000;
+    const auto frames = static_cast<std::uint32_t>(seconds * kRate);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write("RIFF", 4);
+    write_u32(out, 36 + frames * 2);
+    out.write("WAVEfmt ", 8);
+    write_u32(out, 16);
+    write_u16(out, 1);
+    write_u16(out, 1);
+    write_u32(out, kRate);
+    write_u32(out, kRate * 2);
+    write_u16(out, 2);
+    write_u16(out, 16);
+    out.write("data", 4);
+    write_u32(out, frames * 2);
+    for (std::uint32_t i = 0; i < frames; ++i) {
+        const float sample = 0.4f * std::sin(6.28318530718f * frequency * static_cast<float>(i) / kRate);
+        write_u16(out, static_cast<std::uint16_t>(static_cast<std::int16_t>(sample * 32767.0f)));
+    }
+}
+
+std::size_t count_lines(const std::string& path) {
+    std::ifstream in(path);
+    std::size_t lines = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        ++lines;
+    }
+    return lines;
+}
+} // namespace
+
+int main() {
+    using when::analyze::BatchAnalyzer;
+
+    const fs::path dir = fs::temp_directory_path() / "when_batch_analyzer_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "library" / "disc2");
+    write_wav(dir / "library" / "a.wav", 220.0f, 1.0f);
+    write_wav(dir / "library" / "disc2" / "b.wav", 880.0f, 0.5f);
+    write_wav(dir / "library" / "disc2" / "a.wav", 440.0f, 0.25f);
+    { std::ofstream notes(dir / "library" / "notes.md"); notes << "not audio\n"; }
+
+    // Directories are scanned recursively; playlists resolve relative entries.
+    std::string error;
+    const std::vector<std::string> tracks = when::analyze::collect_tracks((dir / "library").string(), error);
+    assert(error.empty());
+    assert(tracks.size() == 3);
+    {
+        std::ofstream playlist(dir / "set.m3u");
+        playlist << "#EXTM3U\n# opener\nlibrary/disc2/b.wav\r\n\n" << (dir / "library" / "a.wav").string() << "\n";
+    }
+    const std::vector<std::string> listed = when::analyze::collect_tracks((dir / "set.m3u").string(), error);
+    assert(listed.size() == 2);
+    assert(listed[0] == (dir / "library" / "a.wav").string());
+    assert(listed[1] == (dir / "library" / "disc2" / "b.wav").string());
+
+    when::DspConfig config;
+    config.fft_size = 1024;
+    config.hop_size = 512;
+    BatchAnalyzer::Options options;
+    options.output_dir = (dir / "out").string();
+    options.jobs = 2;
+
+    std::size_t callbacks = 0;
+    {
+        BatchAnalyzer analyzer(config, options);
+        assert(analyzer.run(tracks, [&](const BatchAnalyzer::Progress&) { ++callbacks; }, 0.01));
+        const BatchAnalyzer::Progress& progress = analyzer.progress();
+        assert(analyzer.errors().empty());
+        assert(progress.analysed == 3 && progress.skipped == 0 && progress.failed == 0);
+        assert(std::abs(progress.audio_seconds - 1.75) < 0.01);
+        assert(progress.realtime_factor() > 0.0);
+    }
+    assert(callbacks > 0);
+
+    // One CSV per track (same-named files stay apart), one row per hop plus the header.
+    std::vector<std::string> outputs;
+    for (const auto& entry : fs::directory_iterator(dir / "out")) {
+        if (entry.path().extension() == ".csv") {
+            outputs.push_back(entry.path().string());
+        }
+    }
+    assert(outputs.size() == 3);
+    std::size_t rows = 0;
+    for (const std::string& output : outputs) {
+        rows += count_lines(output) - 1;
+    }
+    assert(rows == 48000 / 512 + 24000 / 512 + 12000 / 512);
+
+    // Unchanged content and config: everything is skipped, even after a touch.
+    fs::last_write_time(tracks[0], fs::last_write_time(tracks[0]) + std::chrono::seconds(5));
+    {
+        BatchAnalyzer analyzer(config, options);
+        assert(analyzer.run(tracks));
+        assert(analyzer.progress().skipped == 3 && analyzer.progress().analysed == 0);
+        assert(analyzer.progress().audio_seconds == 0.0);
+    }
+
+    // Changed content re-analyses just that track.
+    write_wav(dir / "library" / "disc2" / "b.wav", 660.0f, 0.5f);
+    {
+        BatchAnalyzer analyzer(config, options);
+        assert(analyzer.run(tracks));
+        assert(analyzer.progress().analysed == 1 && analyzer.progress().skipped == 2);
+    }
+
+    // A config change re-analyses everything, as does --force.
+    config.hop_size = 256;
+    {
+        BatchAnalyzer analyzer(config, options);
+        assert(analyzer.run(tracks));
+        assert(analyzer.progress().analysed == 3);
+    }
+    options.force = true;
+    {
+        BatchAnalyzer analyzer(config, options);
+        assert(analyzer.run(tracks));
+        assert(analyzer.progress().analysed == 3);
+    }
+
+    // Undecodable input is reported per track without stopping the batch.
+    {
+        std::vector<std::string> with_bad = tracks;
+        with_bad.push_back((dir / "library" / "notes.md").string());
+        BatchAnalyzer analyzer(config, options);
+        assert(analyzer.run(with_bad));
+        assert(analyzer.progress().failed == 1 && analyzer.errors().size() == 1);
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "animations/breathe_outline.h"
+
+int main() {
+    using when::animations::BreatheOutline;
+
+    BreatheOutline outline;
+    outline.configure(96, 11u);
+    assert(outline.vertex_count() == 96);
+
+    // Without jitter the vertices lie on the ellipse, evenly spaced, and the
+    // rotation is applied to the table rather than per vertex.
+    std::vector<std::array<float, 2>> points;
+    outline.build(50.0f, 20.0f, 30.0f, 12.0f, 0.0f, 0.0f, 0.0f, points);
+    assert(points.size() == 96);
+    for (const auto& p : points) {
+        const float ex = (p[0] - 50.0f) / 30.0f;
+        const float ey = (p[1] - 20.0f) / 12.0f;
+        assert(std::abs(ex * ex + ey * ey - 1.0f) < 1e-4f);
+    }
+    assert(std::abs(points[0][0] - 80.0f) < 1e-4f && std::abs(points[0][1] - 20.0f) < 1e-4f);
+
+    const float quarter = 1.57079632679f;
+    std::vector<std::array<float, 2>> rotated;
+    outline.build(0.0f, 0.0f, 10.0f, 10.0f, quarter, 0.0f, 0.0f, rotated);
+    assert(std::abs(rotated[0][0]) < 1e-4f && std::abs(rotated[0][1] - 10.0f) < 1e-4f);
+
+    // The noise table is bounded, periodic and continuous across its seam.
+    float peak = 0.0f;
+    for (int i = 0; i < 1000; ++i) {
+        const float t = static_cast<float>(i) / 1000.0f;
+        const float value = outline.noise(t);
+        assert(value >= -1.0f - 1e-5f && value <= 1.0f + 1e-5f);
+        assert(std::abs(value - outline.noise(t + 3.0f)) < 1e-4f);
+        peak = std::max(peak, std::abs(value));
+    }
+    assert(peak > 0.9f);
+    assert(std::abs(outline.noise(0.9999f) - outline.noise(0.0f)) < 0.05f);
+
+    // Jitter stays within noise_amount of the radius and the closing edge is
+    // no longer than a typical edge, so the ring has no seam.
+    std::vector<std::array<float, 2>> jittered;
+    outline.build(0.0f, 0.0f, 20.0f, 20.0f, 0.3f, 0.25f, 0.42f, jittered);
+    float longest_edge = 0.0f;
+    for (std::size_t i = 0; i < jittered.size(); ++i) {
+        const float r = std::hypot(jittered[i][0], jittered[i][1]);
+        assert(r >= 20.0f * 0.75f - 1e-3f && r <= 20.0f * 1.25f + 1e-3f);
+        const auto& next = jittered[(i + 1) % jittered.size()];
+        longest_edge = std::max(longest_edge, std::hypot(next[0] - jittered[i][0], next[1] - jittered[i][1]));
+    }
+    const auto& first = jittered.front();
+    const auto& last = jittered.back();
+    assert(std::hypot(first[0] - last[0], first[1] - last[1]) <= longest_edge);
+    assert(longest_edge < 2.0f * 20.0f * 1.25f * 3.14159265f / 96.0f * 1.5f);
+
+    outline.configure(1, 3u);
+    assert(outline.vertex_count() == 3);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "animations/cell_shader.h"
+
+using when::animations::CellShader;
+using when::animations::ShaderResolution;
+using when::animations::ShaderSpan;
+using when::animations::ShaderThreadPool;
+using when::animations::ShaderUniforms;
+
+int main() {
+    ShaderThreadPool pool(3);
+    CellShader shader(pool);
+
+    // 30 x 100 cells at Braille resolution is 120 x 200 samples: 15 x 4 tiles,
+    // including partial tiles on the right edge.
+    shader.resize(30, 100, ShaderResolution::Braille);
+    assert(shader.sample_rows() == 120);
+    assert(shader.sample_cols() == 200);
+    assert(shader.tile_count() == 15 * 4);
+
+    // Every sample is visited exactly once.
+    std::vector<int> visits(static_cast<std::size_t>(shader.sample_rows()) * shader.sample_cols(), 0);
+    const unsigned int sample_cols = shader.sample_cols();
+    shader.dispatch(
+        [&](const ShaderSpan& span, const ShaderUniforms&, float* out) {
+            for (std::size_t i = 0; i < span.count; ++i) {
+                ++visits[static_cast<std::size_t>(span.row) * sample_cols + span.col + i];
+                out[i] = 1.0f;
+            }
+        },
+        ShaderUniforms{});
+    for (int count : visits) {
+        assert(count == 1);
+    }
+    for (const auto& cell : shader.cells()) {
+        assert(cell.codepoint == 0x28FFu);
+    }
+
+    // Only the left dot column lights up when x < 0.5 within each cell.
+    shader.resize(1, 1, ShaderResolution::Braille);
+    shader.dispatch(
+        [](const ShaderSpan& span, const ShaderUniforms&, float* out) {
+            for (std::size_t i = 0; i < span.count; ++i) {
+                out[i] = span.x[i] < 0.5f ? 1.0f : 0.0f;
+            }
+        },
+        ShaderUniforms{});
+    assert(shader.cells()[0].codepoint == 0x2800u + 0x47u);
+
+    // Cell resolution leaves values under the threshold empty.
+    shader.resize(2, 2, ShaderResolution::Cell);
+    shader.dispatch(
+        [](const ShaderSpan& span, const ShaderUniforms& uniforms, float* out) {
+            for (std::size_t i = 0; i < span.count; ++i) {
+                out[i] = span.row == 0 ? uniforms.params[0] : 0.0f;
+            }
+        },
+        [] {
+            ShaderUniforms uniforms;
+            uniforms.params[0] = 1.0f;
+            return uniforms;
+        }());
+    assert(shader.cells()[0].codepoint == '@');
+    assert(shader.cells()[3].codepoint == 0u);
+
+    return 0;
+}
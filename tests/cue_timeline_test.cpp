@@ -0,0 +1,135 @@
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "animations/cue_timeline.h"
+
+namespace {
+
+using when::animations::Cue;
+using when::animations::CueFramePool;
+using when::animations::CueScheduler;
+
+when::AudioFeatures frame(bool beat, bool downbeat) {
+    when::AudioFeatures features;
+    features.beat_detected = beat;
+    features.downbeat = downbeat;
+    return features;
+}
+
+// "On the downbeat flash for two bars, then ramp over four beats."
+Cue sequence(CueScheduler& cues, std::vector<int>& log) {
+    co_await cues.next_downbeat();
+    log.push_back(1);
+    co_await cues.bars(2);
+    log.push_back(2);
+    for (int beat = 0; beat < 4; ++beat) {
+        co_await cues.next_beat();
+        log.push_back(10 + beat);
+    }
+    co_await cues.seconds(0.5);
+    log.push_back(3);
+}
+
+Cue wait_forever(CueScheduler& cues, int& resumed) {
+    co_await cues.bars(1000000);
+    ++resumed;
+}
+
+Cue immediate(CueScheduler& cues, int& finished) {
+    co_await cues.beats(0);
+    co_await cues.seconds(0.0);
+    ++finished;
+}
+
+// Torn down after main()'s thread_locals, like the renderer's AnimationManager.
+CueScheduler static_cues;
+int static_resumed = 0;
+
+} // namespace
+
+int main() {
+    CueScheduler cues;
+    std::vector<int> log;
+    cues.spawn(sequence(cues, log));
+    assert(log.empty());
+    assert(cues.parked_cues() == 1);
+
+    // Beats before the first downbeat do not count towards it.
+    cues.advance(0.1f, frame(true, false));
+    assert(log.empty());
+    cues.advance(0.1f, frame(true, true));
+    assert(log == std::vector<int>{1});
+
+    // Two more bars, with beats in between.
+    for (int bar = 0; bar < 2; ++bar) {
+        for (int beat = 0; beat < 3; ++beat) {
+            cues.advance(0.1f, frame(true, false));
+        }
+        cues.advance(0.1f, frame(true, true));
+    }
+    assert((log == std::vector<int>{1, 2}));
+
+    for (int beat = 0; beat < 4; ++beat) {
+        cues.advance(0.1f, frame(false, false));
+        cues.advance(0.1f, frame(true, false));
+    }
+    assert((log == std::vector<int>{1, 2, 10, 11, 12, 13}));
+
+    cues.advance(0.3f, frame(false, false));
+    assert(log.size() == 6);
+    cues.advance(0.3f, frame(false, false));
+    assert(log.back() == 3);
+    assert(cues.parked_cues() == 0);
+
+    // Zero-length waits complete without parking.
+    int finished = 0;
+    cues.spawn(immediate(cues, finished));
+    assert(finished == 1);
+    assert(cues.parked_cues() == 0);
+
+    // Thousands of idle cues stay parked, and their frames come from the pool.
+    int resumed = 0;
+    CueFramePool& pool = CueFramePool::local();
+    const std::size_t blocks_before = pool.blocks_in_use();
+    for (int i = 0; i < 5000; ++i) {
+        cues.spawn(wait_forever(cues, resumed));
+    }
+    assert(cues.parked_cues() == 5000);
+    assert(pool.blocks_in_use() == blocks_before + 5000);
+    for (int i = 0; i < 100; ++i) {
+        cues.advance(0.016f, frame(i % 8 == 0, i % 32 == 0));
+    }
+    assert(resumed == 0);
+
+    // Clearing destroys parked frames and returns them for reuse.
+    const std::size_t chunks = pool.chunk_count();
+    cues.clear();
+    assert(cues.parked_cues() == 0);
+    assert(pool.blocks_in_use() == blocks_before);
+    for (int i = 0; i < 5000; ++i) {
+        cues.spawn(wait_forever(cues, resumed));
+    }
+    assert(pool.chunk_count() == chunks);
+    cues.clear();
+
+    // Frames must outlive the thread whose pool they came from.
+    auto late = std::make_unique<CueScheduler>();
+    int late_resumed = 0;
+    std::thread spawner([&] {
+        for (int i = 0; i < 100; ++i) {
+            late->spawn(wait_forever(*late, late_resumed));
+        }
+    });
+    spawner.join();
+    assert(late->parked_cues() == 100);
+    late.reset();
+
+    // ...and a static scheduler with pending cues is destroyed after this thread's pool would be.
+    static_cues.spawn(wait_forever(static_cues, static_resumed));
+    assert(static_cues.parked_cues() == 1);
+
+    return 0;
+}
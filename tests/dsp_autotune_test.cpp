@@ -0,0 +1,90 @@
+#include <cassert>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "dsp_autotune.h"
+
+int main() {
+    namespace fs = std::filesystem;
+
+    when::DspConfig config;
+    config.fft_size = 1024;
+    config.hop_size = 256;
+
+    // With CPU to spare the configured resolution stays and the hop shrinks as
+    // far as the latency bound allows (it already rules out hop 512). Budgets
+    // here are extreme so the outcome does not depend on the machine.
+    when::AutotuneOptions options;
+    options.sample_rate = 48000;
+    options.cpu_budget = 1000.0f;
+    when::AutotuneResult result = when::autotune_dsp(config, options);
+    assert(result.feasible);
+    assert(result.fft_size == 1024 && result.hop_size == 128);
+    assert(result.hop_cost_s > 0.0 && result.load > 0.0);
+    for (const when::AutotuneCandidate& candidate : result.candidates) {
+        assert(candidate.latency_ms <= 1000.0 * (1024 + 256) / 48000.0 + 1e-3 || candidate.hop_cost_s == 0.0);
+    }
+
+    // An impossible budget falls back to the cheapest pair that was timed.
+    options.cpu_budget = 1e-9f;
+    result = when::autotune_dsp(config, options);
+    assert(!result.feasible);
+    for (const when::AutotuneCandidate& candidate : result.candidates) {
+        assert(candidate.hop_cost_s == 0.0 || candidate.load >= result.load);
+    }
+
+    // Keys follow everything the timing depends on.
+    when::AutotuneOptions defaults;
+    const std::string key = when::autotune_key(config, defaults);
+    when::DspConfig more_bands = config;
+    more_bands.bands = 64;
+    assert(when::autotune_key(more_bands, defaults) != key);
+    assert(key.find('\t') == std::string::npos);
+    assert(!when::host_cpu_model().empty());
+
+    const fs::path dir = fs::temp_directory_path() / "when_dsp_autotune_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    // Wisdom round-trips and keeps one entry per CPU and key.
+    {
+        when::DspWisdom wisdom;
+        assert(!wisdom.load((dir / "missing.wisdom").string()));
+        wisdom.update({"cpu A", key, 1024, 128, 2e-5});
+        wisdom.update({"cpu B", key, 512, 64, 1e-5});
+        wisdom.update({"cpu A", key, 2048, 256, 3e-5});
+        assert(wisdom.size() == 2);
+        assert(wisdom.save((dir / "round.wisdom").string()));
+        when::DspWisdom loaded;
+        assert(loaded.load((dir / "round.wisdom").string()));
+        assert(loaded.size() == 2);
+        const when::DspWisdom::Entry* entry = loaded.find("cpu A", key);
+        assert(entry && entry->fft_size == 2048 && entry->hop_size == 256);
+        assert(!loaded.find("cpu C", key));
+    }
+
+    // First run tunes and records; the next reuses the record; force re-tunes.
+    config.wisdom_file = (dir / "when.wisdom").string();
+    config.analysis_cpu_budget = 1000.0f;
+    std::vector<std::string> messages;
+    when::DspConfig tuned = config;
+    when::apply_dsp_autotune(tuned, 48000, false, messages);
+    assert(fs::exists(config.wisdom_file));
+    assert(messages.size() == 1 && messages[0].find("after timing") != std::string::npos);
+    assert(tuned.fft_size == 1024 && tuned.hop_size == 128);
+
+    messages.clear();
+    when::DspConfig reused = config;
+    when::apply_dsp_autotune(reused, 48000, false, messages);
+    assert(messages.size() == 1 && messages[0].find("wisdom") != std::string::npos);
+    assert(reused.fft_size == tuned.fft_size && reused.hop_size == tuned.hop_size);
+
+    messages.clear();
+    when::DspConfig forced = config;
+    when::apply_dsp_autotune(forced, 48000, true, messages);
+    assert(messages[0].find("after timing") != std::string::npos);
+
+    fs::remove_all(dir);
+    return 0;
+}
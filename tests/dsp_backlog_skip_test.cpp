@@ -0,0 +1,55 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "dsp.h"
+#include "events/event_bus.h"
+#include "events/frame_events.h"
+
+namespace {
+
+std::vector<float> make_tone(std::size_t frames, float sample_rate) {
+    std::vector<float> samples(frames);
+    for (std::size_t i = 0; i < frames; ++i) {
+        samples[i] = 0.5f * std::sin(2.0f * 3.14159265f * 440.0f * static_cast<float>(i) / sample_rate);
+    }
+    return samples;
+}
+
+std::size_t count_frames(float max_backlog_ms, const std::vector<float>& samples, std::size_t& skips) {
+    when::events::EventBus bus;
+    std::size_t published = 0;
+    auto handle = bus.subscribe<when::events::AudioFeaturesUpdatedEvent>(
+        [&published](const when::events::AudioFeaturesUpdatedEvent&) { ++published; });
+
+    when::DspEngine dsp(bus, 48000, 1, 1024, 256, 16);
+    dsp.set_max_backlog_ms(max_backlog_ms);
+    dsp.push_samples(samples.data(), samples.size());
+    skips = dsp.stale_skips();
+    return published;
+}
+
+} // namespace
+
+int main() {
+    // One second of audio queued at once, as after a terminal stall.
+    const std::vector<float> backlog = make_tone(48000, 48000.0f);
+
+    std::size_t skips = 0;
+    const std::size_t unbounded = count_frames(0.0f, backlog, skips);
+    assert(unbounded == 48000 / 256);
+    assert(skips == 0);
+
+    const std::size_t bounded = count_frames(100.0f, backlog, skips);
+    assert(bounded == 1);
+    assert(skips == 1);
+
+    // Small pushes under the bound are analysed hop by hop as before.
+    const std::vector<float> small = make_tone(1024, 48000.0f);
+    const std::size_t regular = count_frames(100.0f, small, skips);
+    assert(regular == 4);
+    assert(skips == 0);
+
+    return 0;
+}
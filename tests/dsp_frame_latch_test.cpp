@@ -0,0 +1,91 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "dsp.h"
+#include "events/event_bus.h"
+#include "events/frame_events.h"
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr std::size_t kHop = 256;
+constexpr std::size_t kHopsPerFrame = 8; // A render frame drains several hops from the ring
+
+std::vector<float> make_chord(std::size_t frames, float root_hz, std::size_t start_index) {
+    std::vector<float> samples(frames);
+    for (std::size_t i = 0; i < frames; ++i) {
+        const float t = static_cast<float>(start_index + i) / kSampleRate;
+        samples[i] = 0.3f * std::sin(2.0f * 3.14159265f * root_hz * t) +
+                     0.2f * std::sin(2.0f * 3.14159265f * root_hz * 1.5f * t);
+    }
+    return samples;
+}
+
+} // namespace
+
+int main() {
+    when::events::EventBus bus;
+    std::vector<when::events::SectionChangeEvent> dsp_events;
+    auto handle = bus.subscribe<when::events::SectionChangeEvent>(
+        [&](const when::events::SectionChangeEvent& event) { dsp_events.push_back(event); });
+
+    when::DspEngine dsp(bus, static_cast<std::uint32_t>(kSampleRate), 1, 1024, kHop, 16);
+    when::NoveltyDetector::Config novelty;
+    novelty.kernel_seconds = 4.0f;
+    novelty.block_seconds = 0.25f;
+    novelty.threshold = 0.3f;
+    novelty.min_interval_seconds = 2.0f;
+    dsp.configure_section_detection(true, novelty);
+
+    // Two 12 s passages in unrelated keys, fed to the DSP a render frame at a time.
+    std::vector<float> audio = make_chord(12 * 48000, 220.0f, 0);
+    const std::vector<float> second = make_chord(12 * 48000, 311.13f, audio.size());
+    audio.insert(audio.end(), second.begin(), second.end());
+
+    std::vector<when::AudioFeatures> seen;
+    const std::size_t frame_samples = kHop * kHopsPerFrame;
+    for (std::size_t offset = 0; offset + frame_samples <= audio.size(); offset += frame_samples) {
+        dsp.push_samples(audio.data() + offset, frame_samples);
+        const when::AudioFeatures& features = dsp.audio_features();
+        if (features.section_change) {
+            seen.push_back(features);
+        }
+        dsp.mark_features_consumed();
+        assert(!dsp.audio_features().section_change);
+    }
+
+    // Every change the detector confirmed reaches exactly one frame, whichever
+    // hop of the frame it landed on, carrying the confirming peak.
+    assert(!dsp_events.empty());
+    assert(seen.size() == dsp_events.size());
+    for (std::size_t i = 0; i < seen.size(); ++i) {
+        assert(seen[i].section_index == dsp_events[i].section_index);
+        assert(seen[i].section_peak == dsp_events[i].novelty);
+        assert(seen[i].section_peak >= novelty.threshold);
+    }
+
+    // A tone burst in the first hops of a frame still shows in that frame's
+    // peaks after it has decayed by the last hop.
+    when::DspEngine tones(bus, static_cast<std::uint32_t>(kSampleRate), 1, 1024, kHop, 16);
+    when::ToneTracker::Config tone_config;
+    tone_config.frequencies = {440.0f};
+    tone_config.bandwidth_hz = 40.0f;
+    tones.configure_tone_tracker(tone_config);
+
+    std::vector<float> frame(frame_samples, 0.0f);
+    for (std::size_t i = 0; i < 3 * kHop; ++i) {
+        frame[i] = 0.5f * std::sin(2.0f * 3.14159265f * 440.0f * static_cast<float>(i) / kSampleRate);
+    }
+    tones.push_samples(frame.data(), frame.size());
+    assert(tones.audio_features().tone_envelopes[0] < 0.1f);
+    assert(tones.audio_features().tone_peaks[0] > 0.3f);
+    tones.mark_features_consumed();
+
+    // Once consumed, the next frame reports only its own (silent) hops.
+    const std::vector<float> silence(frame_samples, 0.0f);
+    tones.push_samples(silence.data(), silence.size());
+    assert(tones.audio_features().tone_peaks[0] < 0.1f);
+    return 0;
+}
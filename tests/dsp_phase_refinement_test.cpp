@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "dsp.h"
+#include "events/event_bus.h"
+#include "events/frame_events.h"
+
+namespace {
+
+// Returns the dominant pitch class of a 440 Hz tone after a few hops.
+std::size_t dominant_pitch_class(bool phase_refinement) {
+    when::events::EventBus bus;
+    std::array<float, 12> chroma{};
+    bool chroma_available = false;
+    auto handle = bus.subscribe<when::events::AudioFeaturesUpdatedEvent>(
+        [&](const when::events::AudioFeaturesUpdatedEvent& event) {
+            chroma = event.features.chroma;
+            chroma_available = event.features.chroma_available;
+        });
+
+    when::DspEngine dsp(bus, 48000, 1, 1024, 256, 16);
+    dsp.set_phase_refinement(phase_refinement);
+
+    // 440 Hz falls between bins 9 (G#) and 10 (A#) at a 46.875 Hz bin width.
+    std::vector<float> samples(4096);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = 0.5f * std::sin(2.0f * 3.14159265f * 440.0f * static_cast<float>(i) / 48000.0f);
+    }
+    for (std::size_t offset = 0; offset < samples.size(); offset += 256) {
+        dsp.push_samples(samples.data() + offset, 256);
+    }
+
+    assert(chroma_available);
+    return static_cast<std::size_t>(std::distance(chroma.begin(), std::max_element(chroma.begin(), chroma.end())));
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t kPitchClassA = 9;
+    assert(dominant_pitch_class(true) == kPitchClassA);
+    assert(dominant_pitch_class(false) != kPitchClassA);
+    return 0;
+}
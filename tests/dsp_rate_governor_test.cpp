@@ -0,0 +1,121 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audio/analysis_stage.h"
+#include "dsp.h"
+#include "events/event_bus.h"
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr float kBpm = 120.0f;
+
+// Makes every hop cost at least a millisecond while enabled. Sleeping only
+// ever adds time, so the governor is guaranteed to see the load.
+class LoadStage final : public when::AnalysisStage {
+public:
+    explicit LoadStage(const bool& enabled) : enabled_(enabled) {}
+
+    std::string id() const override { return "load"; }
+    std::vector<std::string> channel_names() const override { return {"load"}; }
+    void process(const when::FeatureInputFrame&, std::span<float>) override {
+        if (enabled_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+private:
+    const bool& enabled_;
+};
+
+// Short 1 kHz clicks at kBpm over a quiet noise floor.
+std::vector<float> make_click_track(float seconds) {
+    const std::size_t frames = static_cast<std::size_t>(seconds * kSampleRate);
+    const std::size_t beat_frames = static_cast<std::size_t>(60.0f / kBpm * kSampleRate);
+    const std::size_t click_frames = static_cast<std::size_t>(0.02f * kSampleRate);
+    std::vector<float> samples(frames);
+    std::uint32_t noise = 12345u;
+    for (std::size_t i = 0; i < frames; ++i) {
+        noise = noise * 1664525u + 1013904223u;
+        float sample = 0.01f * (static_cast<float>(noise >> 8) / 16777216.0f - 0.5f);
+        const std::size_t into_beat = i % beat_frames;
+        if (into_beat < click_frames) {
+            const float decay = 1.0f - static_cast<float>(into_beat) / static_cast<float>(click_frames);
+            sample += 0.8f * decay * std::sin(2.0f * 3.14159265f * 1000.0f * static_cast<float>(i) / kSampleRate);
+        }
+        samples[i] = sample;
+    }
+    return samples;
+}
+
+} // namespace
+
+int main() {
+    when::events::EventBus bus;
+    when::FeatureExtractor::Config features;
+    features.tempo_confidence_threshold = 1e-9f; // Clean clicks give tiny flux autocorrelation scores
+    when::DspEngine dsp(bus, static_cast<std::uint32_t>(kSampleRate), 1, 1024, 256, 16, features);
+    bool loaded = false;
+    dsp.add_analysis_stage(std::make_unique<LoadStage>(loaded));
+    // 1 ms is below the floor, so the bound is one window plus the current hop.
+    dsp.set_max_backlog_ms(1.0f);
+
+    const std::vector<float> track = make_click_track(16.0f);
+    std::size_t offset = 0;
+    // Pushing exactly one hop at a time leaves nothing queued between pushes.
+    const auto push_hop = [&] {
+        const std::size_t hop = dsp.hop_size();
+        assert(offset + hop <= track.size());
+        dsp.push_samples(track.data() + offset, hop);
+        offset += hop;
+    };
+
+    // Lock on to the tempo at the startup hop.
+    while (offset < static_cast<std::size_t>(8.0f * kSampleRate)) {
+        push_hop();
+    }
+    const float locked_bpm = dsp.audio_features().bpm;
+    assert(std::abs(locked_bpm - kBpm) < 4.0f);
+
+    // Overload the analysis: the governor grows the hop step by step up to its maximum.
+    when::DspEngine::RateGovernorConfig governor;
+    governor.enabled = true;
+    governor.min_hop_size = 256;
+    governor.max_hop_size = 512;
+    governor.cpu_budget = 0.02f;
+    dsp.configure_rate_governor(governor);
+    loaded = true;
+
+    std::size_t previous_hop = dsp.hop_size();
+    std::size_t hop_changes = 0;
+    while (offset + 512 <= static_cast<std::size_t>(12.0f * kSampleRate)) {
+        push_hop();
+        if (dsp.hop_size() != previous_hop) {
+            assert(dsp.hop_size() > previous_hop);
+            previous_hop = dsp.hop_size();
+            ++hop_changes;
+        }
+        // The onset history is resampled to each new frame period, so the
+        // tempo holds through every step instead of restarting.
+        const when::AudioFeatures& features = dsp.audio_features();
+        assert(std::abs(features.bpm - kBpm) < 3.0f);
+        assert(features.beat_phase >= 0.0f && features.beat_phase <= 1.0f);
+    }
+    assert(hop_changes >= 3);
+    assert(dsp.hop_size() == 512);
+    assert(dsp.analysis_rate_hz() == kSampleRate / 512.0f);
+    assert(dsp.stale_skips() == 0);
+
+    // The backlog floor follows the hop: at the startup hop it was
+    // 1024 + 256 frames, now 1024 + 512, so this push is analysed hop by hop.
+    const std::size_t hops_before = dsp.hops_processed();
+    dsp.push_samples(track.data() + offset, 1400);
+    assert(dsp.stale_skips() == 0);
+    assert(dsp.hops_processed() == hops_before + 2);
+    return 0;
+}
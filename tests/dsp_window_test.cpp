@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio/analysis_stage.h"
+#include "audio/fft_plan_cache.h"
+#include "dsp.h"
+#include "events/event_bus.h"
+#include "events/frame_events.h"
+
+namespace {
+
+constexpr std::size_t kBands = 16;
+
+// Republishes the per-band energies the DSP hands to analysis stages.
+class BandTapStage final : public when::AnalysisStage {
+public:
+    std::string id() const override { return "band-tap"; }
+    std::vector<std::string> channel_names() const override {
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < kBands; ++i) {
+            names.push_back("band" + std::to_string(i));
+        }
+        return names;
+    }
+    void process(const when::FeatureInputFrame& frame, std::span<float> out) override {
+        for (std::size_t i = 0; i < out.size() && i < frame.instantaneous_band_energies.size(); ++i) {
+            out[i] = frame.instantaneous_band_energies[i];
+        }
+    }
+};
+
+struct Levels {
+    float peak_band = 0.0f;
+    float leakage = 0.0f; // Strongest band at least three bands from the peak, relative to the peak
+};
+
+// Feeds a steady tone and reports the band energies of the last hop.
+Levels tone_levels(when::FftWindowType window, float frequency) {
+    when::events::EventBus bus;
+    std::vector<float> bands;
+    auto handle = bus.subscribe<when::events::AudioFeaturesUpdatedEvent>(
+        [&](const when::events::AudioFeaturesUpdatedEvent& event) {
+            bands.assign(event.features.custom_channels.begin(), event.features.custom_channels.end());
+        });
+
+    when::DspEngine dsp(bus, 48000, 1, 1024, 256, kBands);
+    dsp.set_analysis_stage_budget_ms(0.0f);
+    dsp.add_analysis_stage(std::make_unique<BandTapStage>());
+    dsp.set_window(window);
+    dsp.set_phase_refinement(false);
+    assert(dsp.window_type() == window);
+
+    std::vector<float> samples(8192);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = 0.5f * std::sin(2.0f * 3.14159265f * frequency * static_cast<float>(i) / 48000.0f);
+    }
+    for (std::size_t offset = 0; offset < samples.size(); offset += 256) {
+        dsp.push_samples(samples.data() + offset, 256);
+    }
+
+    assert(!bands.empty());
+    const auto peak = std::max_element(bands.begin(), bands.end());
+    Levels levels;
+    levels.peak_band = *peak;
+    const auto peak_index = static_cast<std::ptrdiff_t>(peak - bands.begin());
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(bands.size()); ++i) {
+        if (std::abs(i - peak_index) >= 3) {
+            levels.leakage = std::max(levels.leakage, bands[static_cast<std::size_t>(i)] / *peak);
+        }
+    }
+    return levels;
+}
+
+} // namespace
+
+int main() {
+    using when::FftWindowType;
+
+    when::FftWindowType parsed = FftWindowType::Hann;
+    assert(when::parse_fft_window("Blackman-Harris", parsed) && parsed == FftWindowType::BlackmanHarris);
+    assert(when::parse_fft_window("flat_top", parsed) && parsed == FftWindowType::FlatTop);
+    assert(when::parse_fft_window("kaiser", parsed) && parsed == FftWindowType::Kaiser);
+    assert(when::parse_fft_window("hann", parsed) && parsed == FftWindowType::Hann);
+    assert(!when::parse_fft_window("triangle", parsed));
+
+    // Textbook gains for the symmetric windows.
+    auto& cache = when::FftPlanCache::instance();
+    const auto hann = cache.acquire(4096);
+    const auto harris = cache.acquire(4096, when::FftDirection::Forward, FftWindowType::BlackmanHarris);
+    const auto flat = cache.acquire(4096, when::FftDirection::Forward, FftWindowType::FlatTop);
+    const auto kaiser = cache.acquire(4096, when::FftDirection::Forward, FftWindowType::Kaiser, 8.6f);
+    assert(std::abs(hann->coherent_gain() - 0.5f) < 1e-3f);
+    assert(std::abs(hann->noise_bandwidth_bins() - 1.5f) < 1e-2f);
+    assert(std::abs(harris->coherent_gain() - 0.35875f) < 1e-3f);
+    assert(std::abs(harris->noise_bandwidth_bins() - 2.004f) < 1e-2f);
+    assert(std::abs(flat->noise_bandwidth_bins() - 3.77f) < 2e-2f);
+    assert(std::abs(kaiser->window()[2048] - 1.0f) < 1e-3f);
+    assert(kaiser != cache.acquire(4096, when::FftDirection::Forward, FftWindowType::Kaiser, 6.0f));
+
+    // With gain correction the tone reads about the same through every window,
+    // while the low-leakage windows keep distant bands quieter than Hann.
+    constexpr float kTone = 1000.0f;
+    const Levels reference = tone_levels(FftWindowType::Hann, kTone);
+    for (const FftWindowType window :
+         {FftWindowType::BlackmanHarris, FftWindowType::Kaiser, FftWindowType::FlatTop}) {
+        const Levels levels = tone_levels(window, kTone);
+        assert(std::abs(levels.peak_band / reference.peak_band - 1.0f) < 0.35f);
+    }
+    assert(tone_levels(FftWindowType::BlackmanHarris, kTone).leakage <= reference.leakage);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "audio/fft_plan_cache.h"
+
+int main() {
+    using when::FftDirection;
+    using when::FftPlan;
+    using when::FftPlanCache;
+    using when::FftWindowType;
+
+    FftPlanCache& cache = FftPlanCache::instance();
+    const FftPlanCache::Stats before = cache.stats();
+
+    // Identical keys share one plan; a different direction is a separate plan.
+    auto a = cache.acquire(512);
+    auto b = cache.acquire(512, FftDirection::Forward, FftWindowType::Hann);
+    auto inverse = cache.acquire(512, FftDirection::Inverse);
+    assert(a == b);
+    assert(a != inverse);
+    FftPlanCache::Stats stats = cache.stats();
+    assert(stats.misses == before.misses + 2);
+    assert(stats.hits == before.hits + 1);
+    assert(stats.cached_plans == before.cached_plans + 2);
+    assert(stats.shared_plans == before.shared_plans + 2);
+    assert(stats.bytes > before.bytes + 2 * 512 * sizeof(float));
+
+    // Tables are cache-line aligned, and the window is the symmetric Hann.
+    assert(reinterpret_cast<std::uintptr_t>(a->config()) % FftPlan::kAlignment == 0);
+    assert(reinterpret_cast<std::uintptr_t>(a->window()) % FftPlan::kAlignment == 0);
+    assert(std::abs(a->window()[0]) < 1e-6f);
+    assert(std::abs(a->window()[511]) < 1e-6f);
+    assert(std::abs(a->window()[255] - a->window()[256]) < 1e-6f);
+    assert(a->window()[256] > 0.99f);
+
+    // The shared config transforms correctly: a cosine at bin 8 lands in bins 8 and 504.
+    std::vector<kiss_fft_cpx> in(512);
+    std::vector<kiss_fft_cpx> out(512);
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        in[i].r = std::cos(2.0f * 3.14159265f * 8.0f * static_cast<float>(i) / 512.0f);
+        in[i].i = 0.0f;
+    }
+    kiss_fft(a->config(), in.data(), out.data());
+    assert(std::abs(out[8].r - 256.0f) < 0.05f);
+    assert(std::abs(out[504].r - 256.0f) < 0.05f);
+    assert(std::abs(out[9].r) < 0.05f);
+
+    // Concurrent acquisition from several threads still yields one plan.
+    std::vector<std::shared_ptr<const FftPlan>> acquired(8);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < acquired.size(); ++t) {
+        threads.emplace_back([&acquired, &cache, t]() { acquired[t] = cache.acquire(2048); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& plan : acquired) {
+        assert(plan == acquired.front());
+    }
+
+    // Plans outlive their users until trimmed, so re-acquiring allocates nothing.
+    const FftPlan* raw = acquired.front().get();
+    acquired.clear();
+    assert(cache.acquire(2048).get() == raw);
+    inverse.reset();
+    const std::size_t cached = cache.stats().cached_plans;
+    assert(cache.trim() == 2);
+    stats = cache.stats();
+    assert(stats.cached_plans == cached - 2);
+    assert(stats.evictions == before.evictions + 2);
+    assert(cache.acquire(512) == a);
+
+    bool threw = false;
+    try {
+        cache.acquire(1);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    return 0;
+}
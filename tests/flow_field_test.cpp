@@ -0,0 +1,60 @@
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include "animations/flow_field.h"
+
+int main() {
+    using when::animations::FlowField;
+
+    FlowField field;
+    field.configure(48, 7u);
+    assert(field.resolution() == 48);
+
+    // Pure curl noise: the finite-difference divergence is small next to the
+    // individual gradient terms that cancel to produce it.
+    field.rebuild(1.5f, 1.0f, {}, 0.0f);
+    const std::size_t n = field.resolution();
+    const float spacing = 1.0f / static_cast<float>(n - 1);
+    float max_divergence = 0.0f;
+    float max_gradient = 0.0f;
+    float max_magnitude = 0.0f;
+    for (std::size_t row = 1; row + 1 < n; ++row) {
+        for (std::size_t col = 1; col + 1 < n; ++col) {
+            const float dfx = (field.field_x()[row * n + col + 1] - field.field_x()[row * n + col - 1]) / (2.0f * spacing);
+            const float dfy = (field.field_y()[(row + 1) * n + col] - field.field_y()[(row - 1) * n + col]) / (2.0f * spacing);
+            max_divergence = std::max(max_divergence, std::abs(dfx + dfy));
+            max_gradient = std::max(max_gradient, std::abs(dfx));
+            max_magnitude = std::max(max_magnitude, std::hypot(field.field_x()[row * n + col], field.field_y()[row * n + col]));
+        }
+    }
+    assert(max_magnitude > 0.05f && max_magnitude < 2.0f);
+    assert(max_divergence < 0.05f * max_gradient);
+
+    // Bilinear sampling reproduces node values and interpolates between them.
+    const std::size_t node = 10 * n + 20;
+    const auto at_node = field.sample(20.0f * spacing, 10.0f * spacing);
+    assert(std::abs(at_node[0] - field.field_x()[node]) < 1.0e-4f);
+    assert(std::abs(at_node[1] - field.field_y()[node]) < 1.0e-4f);
+    const auto midway = field.sample(20.5f * spacing, 10.0f * spacing);
+    assert(std::abs(midway[0] - 0.5f * (field.field_x()[node] + field.field_x()[node + 1])) < 1.0e-4f);
+
+    // With the noise off, the field pulls toward the nearest attractor.
+    const std::array<FlowField::Attractor, 2> attractors{
+        FlowField::Attractor{0.2f, 0.2f, 1.0f},
+        FlowField::Attractor{0.8f, 0.8f, 0.5f},
+    };
+    field.rebuild(0.0f, 0.0f, attractors, 1.0f);
+    const auto near_first = field.sample(0.4f, 0.3f);
+    assert(near_first[0] < 0.0f && near_first[1] < 0.0f);
+    const auto near_second = field.sample(0.7f, 0.6f);
+    assert(near_second[0] > 0.0f && near_second[1] > 0.0f);
+
+    // Out-of-range lookups clamp to the border.
+    const auto outside = field.sample(-1.0f, 2.0f);
+    const auto corner = field.sample(0.0f, 1.0f);
+    assert(outside[0] == corner[0] && outside[1] == corner[1]);
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "frame_marker.h"
+
+int main() {
+    using when::FrameMarker;
+    using when::TerminalStreamScanner;
+
+    // Round trip through the wire format.
+    char buffer[96];
+    const std::size_t length = when::format_frame_marker(FrameMarker{42, 123456789012345}, buffer, sizeof(buffer));
+    assert(length > 0);
+    const std::string marker(buffer, length);
+    assert(marker.front() == '\x1b' && marker.back() == '\x07');
+    FrameMarker parsed;
+    assert(when::parse_frame_marker(marker.substr(2, marker.size() - 3), parsed));
+    assert(parsed.sequence == 42 && parsed.features_ns == 123456789012345);
+    assert(!when::parse_frame_marker("7770;when-frame;1", parsed));
+    assert(!when::parse_frame_marker("7770;when-frame;1;x", parsed));
+    assert(!when::parse_frame_marker("0;title", parsed));
+    assert(when::format_frame_marker(FrameMarker{}, buffer, 8) == 0);
+
+    std::vector<FrameMarker> markers;
+    std::vector<TerminalStreamScanner::Counts> counts;
+    std::vector<TerminalStreamScanner::Query> queries;
+    TerminalStreamScanner::Handler handler;
+    handler.on_marker = [&](const FrameMarker& m, const TerminalStreamScanner::Counts& c) {
+        markers.push_back(m);
+        counts.push_back(c);
+    };
+    handler.on_query = [&](TerminalStreamScanner::Query q) { queries.push_back(q); };
+
+    // A frame with CSI, a title OSC (ST-terminated), a charset select and text.
+    const std::string frame = std::string("\x1b[?25l\x1b[1;1H") + "ab" + "\x1b]0;t\x1b\\" + "\x1b(B" + "c";
+    const std::size_t frame_bytes = frame.size();
+    const std::string stream = "\x1b[c" + frame + marker + "\x1b[6n" + "xyz" + marker;
+
+    // Feed one byte at a time so every sequence is split across calls.
+    TerminalStreamScanner scanner;
+    for (const char c : stream) {
+        scanner.feed(std::string_view(&c, 1), handler);
+    }
+    assert(markers.size() == 2);
+    assert(markers[0].sequence == 42);
+    assert(counts[0].escapes == 5);       // DA1 query + 2 CSI + OSC + charset
+    assert(counts[0].bytes == 3 + frame_bytes);
+    assert(counts[0].text == 3);
+    assert(counts[1].escapes == 1 && counts[1].text == 3 && counts[1].bytes == 7);
+    assert(queries.size() == 2);
+    assert(queries[0] == TerminalStreamScanner::Query::PrimaryDeviceAttributes);
+    assert(queries[1] == TerminalStreamScanner::Query::CursorPosition);
+    assert(scanner.total().bytes == counts[0].bytes + counts[1].bytes);
+    assert(scanner.pending().bytes == 0);
+
+    // An OSC cut short by another escape is still counted, and the escape after it parsed.
+    TerminalStreamScanner cut;
+    cut.feed("\x1b]2;unterminated\x1b[0m", handler);
+    assert(cut.total().escapes == 2);
+    assert(cut.total().bytes == 20);
+
+    // Long DCS payloads are counted in full.
+    TerminalStreamScanner dcs;
+    dcs.feed("\x1bPq" + std::string(500, '#') + "\x1b\\", handler);
+    assert(dcs.total().escapes == 1 && dcs.total().bytes == 505);
+    return 0;
+}
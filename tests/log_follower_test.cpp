@@ -0,0 +1,117 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "animations/log_follower.h"
+
+namespace {
+void append(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out << text;
+}
+} // namespace
+
+int main() {
+    using when::animations::LogFollower;
+    namespace fs = std::filesystem;
+
+    const fs::path dir = fs::temp_directory_path() / "when_log_follower_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const fs::path path = dir / "app.log";
+
+    // Step mode hands out one line per call, strips control bytes and loops.
+    append(path, "first\r\n\tsecond\nthird");
+    {
+        LogFollower step;
+        LogFollower::Options options;
+        options.max_lines = 4;
+        assert(step.open_step(path.string(), options));
+        assert(step.advance_line(false) && step.line_from_end(0) == "first");
+        assert(step.advance_line(false) && step.line_from_end(0) == " second");
+        assert(step.advance_line(false) && step.line_from_end(0) == "third");
+        assert(!step.advance_line(false));
+        assert(step.advance_line(true) && step.line_from_end(0) == "first");
+        assert(step.size() == 4 && step.line_from_end(3) == "first");
+        assert(step.advance_line(true));
+        assert(step.size() == 4 && step.total_lines() == 5 && step.line_from_end(3) == " second");
+    }
+
+    // Follow mode starts from the tail and then reads only appended bytes.
+    fs::remove(path);
+    std::string history;
+    for (int i = 0; i < 100; ++i) {
+        history += "old line " + std::to_string(i) + "\n";
+    }
+    append(path, history);
+    {
+        LogFollower follow;
+        LogFollower::Options options;
+        options.max_lines = 8;
+        options.initial_tail_bytes = 64;
+        assert(follow.open_follow(path.string(), options));
+        assert(follow.line_from_end(0) == "old line 99");
+        // The partial line at the seek point is dropped.
+        const std::size_t first_lines = follow.size();
+        assert(first_lines > 0 && first_lines < 8);
+        assert(follow.line_from_end(first_lines - 1).substr(0, 9) == "old line ");
+        const std::uint64_t read_before = follow.bytes_read();
+        assert(read_before <= 64);
+
+        assert(follow.poll() == 0);
+        append(path, "new one\nnew tw");
+        assert(follow.poll() == 1);
+        assert(follow.line_from_end(0) == "new one");
+        append(path, "o\n");
+        assert(follow.poll() == 1);
+        assert(follow.line_from_end(0) == "new two");
+        assert(follow.bytes_read() == read_before + 16);
+
+        // Truncated in place: start over from the beginning.
+        { std::ofstream truncate(path, std::ios::binary | std::ios::trunc); }
+        append(path, "after truncate\n");
+        assert(follow.poll() == 1);
+        assert(follow.line_from_end(0) == "after truncate");
+
+        // Rotated: the old file is renamed and a new one appears at the path.
+        fs::rename(path, dir / "app.log.1");
+        append(dir / "app.log.1", "late write\n");
+        append(path, "rotated\n");
+        assert(follow.poll() == 2);
+        assert(follow.line_from_end(1) == "late write");
+        assert(follow.line_from_end(0) == "rotated");
+
+        // Long lines are truncated to the slot size without splitting a code point.
+        std::string wide;
+        for (int i = 0; i < 20; ++i) {
+            wide += "\xC3\xA9"; // é
+        }
+        LogFollower::Options narrow;
+        narrow.max_line_bytes = 17;
+        LogFollower truncating;
+        assert(truncating.open_step(path.string(), narrow));
+        append(path, wide + "\n");
+        assert(truncating.advance_line(false) && truncating.line_from_end(0) == "rotated");
+        assert(truncating.advance_line(false));
+        assert(truncating.line_from_end(0).size() == 16);
+    }
+
+    // A missing file is not an error when following; it is picked up later.
+    {
+        const fs::path later = dir / "later.log";
+        LogFollower follow;
+        assert(follow.open_follow(later.string(), LogFollower::Options{}));
+        assert(!follow.is_open());
+        append(later, "hello\n");
+        assert(follow.poll() == 1 && follow.line_from_end(0) == "hello");
+
+        LogFollower step;
+        assert(!step.open_step((dir / "missing.log").string(), LogFollower::Options{}));
+        assert(!step.last_error().empty());
+    }
+
+    fs::remove_all(dir);
+    return 0;
+}
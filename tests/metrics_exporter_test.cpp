@@ -0,0 +1,128 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "metrics_exporter.h"
+
+namespace {
+
+bool contains(const std::string& text, const std::string& needle) {
+    return text.find(needle) != std::string::npos;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+std::string read_socket(const std::string& path) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+    const int connected = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    assert(connected == 0);
+    (void)connected;
+
+    std::string payload;
+    char buffer[512];
+    ssize_t received = 0;
+    while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        payload.append(buffer, static_cast<std::size_t>(received));
+    }
+    ::close(fd);
+    return payload;
+}
+
+} // namespace
+
+int main() {
+    when::RuntimeMetrics metrics;
+    for (int i = 0; i < 90; ++i) {
+        metrics.record_frame(0.010); // (0.008, 0.012] bucket
+    }
+    for (int i = 0; i < 10; ++i) {
+        metrics.record_frame(0.040); // (0.033, 0.050] bucket
+    }
+    metrics.dropped_samples.store(128);
+    metrics.bpm.store(120.0f);
+    metrics.idle.store(false);
+
+    const when::RuntimeMetrics::Snapshot first = metrics.snapshot();
+    assert(first.frames == 100);
+    assert(std::abs(first.frame_time_sum_s - 1.3) < 1e-9);
+
+    // Median lands halfway through the 8-12 ms bucket; p99 in the 33-50 ms bucket.
+    const double p50 = when::MetricsExporter::estimate_quantile(first, nullptr, 0.5);
+    assert(p50 > 0.008 && p50 < 0.012);
+    const double p99 = when::MetricsExporter::estimate_quantile(first, nullptr, 0.99);
+    assert(p99 > 0.033 && p99 <= 0.050);
+
+    // Window quantiles only see frames recorded after the previous snapshot.
+    for (int i = 0; i < 50; ++i) {
+        metrics.record_frame(0.200);
+    }
+    const when::RuntimeMetrics::Snapshot second = metrics.snapshot();
+    const double window_p50 = when::MetricsExporter::estimate_quantile(second, &first, 0.5);
+    assert(window_p50 > 0.100 && window_p50 <= 0.250);
+    assert(when::MetricsExporter::estimate_quantile(second, &second, 0.5) == 0.0);
+
+    const std::string text = when::MetricsExporter::format(second, &first);
+    assert(contains(text, "# TYPE when_frame_time_seconds histogram\n"));
+    assert(contains(text, "when_frame_time_seconds_bucket{le=\"+Inf\"} 150\n"));
+    assert(contains(text, "when_frame_time_seconds_count 150\n"));
+    assert(contains(text, "when_dropped_samples_total 128\n"));
+    assert(contains(text, "when_tempo_bpm 120\n"));
+    assert(contains(text, "when_idle 0\n"));
+    assert(contains(text, "when_frame_time_window_seconds{quantile=\"0.99\"}"));
+
+    when::MetricsExporter::Mode mode = when::MetricsExporter::Mode::TextFile;
+    assert(when::MetricsExporter::parse_mode("socket", mode));
+    assert(mode == when::MetricsExporter::Mode::UnixSocket);
+    assert(!when::MetricsExporter::parse_mode("http", mode));
+
+    const std::string base = "/tmp/when_metrics_test_" + std::to_string(::getpid());
+
+    {
+        when::MetricsExporter::Config config;
+        config.path = base + ".prom";
+        config.interval_s = 0.05;
+        when::MetricsExporter exporter(metrics, config);
+        assert(exporter.start());
+        assert(contains(read_file(config.path), "when_frame_time_seconds_count 150\n"));
+        exporter.stop();
+        std::remove(config.path.c_str());
+    }
+
+    {
+        when::MetricsExporter::Config config;
+        config.path = "/nonexistent-dir/when.prom";
+        when::MetricsExporter exporter(metrics, config);
+        assert(!exporter.start());
+        assert(!exporter.last_error().empty());
+    }
+
+    {
+        when::MetricsExporter::Config config;
+        config.mode = when::MetricsExporter::Mode::UnixSocket;
+        config.path = base + ".sock";
+        when::MetricsExporter exporter(metrics, config);
+        assert(exporter.start());
+        const std::string payload = read_socket(config.path);
+        assert(contains(payload, "when_dropped_samples_total 128\n"));
+        exporter.stop();
+        assert(::access(config.path.c_str(), F_OK) != 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "animations/monotone_spline.h"
+
+int main() {
+    using when::animations::MonotoneSpline;
+
+    MonotoneSpline spline;
+
+    // Interpolates the control points exactly.
+    const std::vector<float> ramp{0.0f, 0.25f, 0.5f, 0.75f, 1.0f};
+    spline.fit(ramp);
+    assert(spline.size() == ramp.size());
+    for (std::size_t i = 0; i < ramp.size(); ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(ramp.size() - 1);
+        assert(std::abs(spline.evaluate(t) - ramp[i]) < 1e-6f);
+    }
+    assert(std::abs(spline.evaluate(0.375f) - 0.375f) < 1e-5f);
+
+    // A step with flat shoulders must not ring above or below its plateaus.
+    const std::vector<float> step{0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    spline.fit(step);
+    std::vector<float> dense(301);
+    spline.resample(dense);
+    assert(std::abs(dense.front()) < 1e-6f);
+    assert(std::abs(dense.back() - 1.0f) < 1e-6f);
+    for (std::size_t i = 1; i < dense.size(); ++i) {
+        assert(dense[i] >= -1e-6f && dense[i] <= 1.0f + 1e-6f);
+        assert(dense[i] >= dense[i - 1] - 1e-6f);
+    }
+
+    // A coarse Gaussian at three points per sigma reconstructs within a Braille
+    // dot of the directly evaluated curve when the unit range spans 60 dots.
+    const float sigma = 0.035f;
+    const std::size_t points = static_cast<std::size_t>(std::ceil(3.0f / sigma)) + 1;
+    const auto gaussian = [sigma](float x) {
+        const float dx = x - 0.47f;
+        return std::exp(-(dx * dx) / (2.0f * sigma * sigma));
+    };
+    std::vector<float> coarse(points);
+    for (std::size_t i = 0; i < points; ++i) {
+        coarse[i] = gaussian(static_cast<float>(i) / static_cast<float>(points - 1));
+    }
+    spline.fit(coarse);
+    std::vector<float> raster(800);
+    spline.resample(raster);
+    float max_error = 0.0f;
+    for (std::size_t i = 0; i < raster.size(); ++i) {
+        const float x = static_cast<float>(i) / static_cast<float>(raster.size() - 1);
+        max_error = std::max(max_error, std::abs(raster[i] - gaussian(x)));
+    }
+    assert(max_error * 60.0f < 1.0f);
+
+    // Degenerate inputs stay well defined.
+    spline.fit(std::vector<float>{0.4f});
+    assert(spline.evaluate(0.7f) == 0.4f);
+    spline.resample(raster);
+    assert(raster[123] == 0.4f);
+    spline.fit(std::vector<float>{});
+    assert(spline.evaluate(0.5f) == 0.0f);
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "audio/shm_pcm_ring.h"
+#include "audio_engine.h"
+
+namespace {
+constexpr std::uint32_t kRate = 48000;
+constexpr std::uint32_t kChannels = 2;
+constexpr std::size_t kCapacity = 4096;
+
+// Interleaved ramp: sample i of the stream holds i, so gaps and reordering show.
+void write_ramp(when::ShmPcmRing& ring, std::uint64_t& next, std::size_t frames) {
+    std::vector<float> block(frames * kChannels);
+    for (float& sample : block) {
+        sample = static_cast<float>(next++);
+    }
+    ring.write(block.data(), frames);
+}
+
+// Another process that creates the ring, writes a block and keeps running
+// until stopped.
+struct ChildWriter {
+    pid_t pid = -1;
+    int release_fd = -1;
+};
+
+ChildWriter start_child_writer(const std::string& name) {
+    int ready[2];
+    int release[2];
+    assert(::pipe(ready) == 0 && ::pipe(release) == 0);
+    const pid_t pid = ::fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        ::close(ready[0]);
+        ::close(release[1]);
+        when::ShmPcmRing daemon;
+        std::uint64_t next = 0;
+        char byte = daemon.create(name, kRate, kChannels, kCapacity) ? 1 : 0;
+        write_ramp(daemon, next, 64);
+        (void)!::write(ready[1], &byte, 1);
+        (void)!::read(release[0], &byte, 1);
+        ::_exit(0);
+    }
+    ::close(ready[1]);
+    ::close(release[0]);
+    char byte = 0;
+    assert(::read(ready[0], &byte, 1) == 1 && byte == 1);
+    ::close(ready[0]);
+    return {pid, release[1]};
+}
+
+void stop_child_writer(const ChildWriter& child) {
+    ::close(child.release_fd); // The child's read returns at EOF
+    int status = 0;
+    assert(::waitpid(child.pid, &status, 0) == child.pid && WIFEXITED(status));
+}
+
+bool contiguous(const std::vector<float>& samples, std::size_t count) {
+    for (std::size_t i = 1; i < count; ++i) {
+        if (samples[i] != samples[i - 1] + 1.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+int main() {
+    const std::string name = "/when-pcm-test-" + std::to_string(::getpid());
+    when::ShmPcmRing::unlink(name);
+
+    when::ShmPcmRing writer;
+    when::ShmPcmRing reader;
+    assert(!reader.attach(name)); // Nothing to attach to yet
+    assert(writer.create(name, kRate, kChannels, kCapacity));
+    assert(reader.attach(name));
+    assert(reader.sample_rate() == kRate && reader.channels() == kChannels);
+
+    // In-order delivery across the wrap point, in whole frames.
+    std::uint64_t next = 0;
+    std::vector<float> out(kCapacity * kChannels);
+    std::uint64_t expected = 0;
+    for (int block = 0; block < 20; ++block) {
+        write_ramp(writer, next, 700);
+        const std::size_t got = reader.read(out.data(), out.size());
+        assert(got == 700 * kChannels);
+        assert(out[0] == static_cast<float>(expected) && contiguous(out, got));
+        expected += got;
+    }
+    write_ramp(writer, next, 1);
+    assert(reader.read(out.data(), 3) == 2); // Whole frames only
+    assert(reader.dropped_frames() == 0);
+    assert(reader.occupancy() == 0.0f);
+
+    // A reader that falls behind resumes half a ring back and counts the rest.
+    write_ramp(writer, next, kCapacity + 500);
+    std::size_t got = reader.read(out.data(), out.size());
+    assert(got == kCapacity / 2 * kChannels);
+    assert(out[0] == static_cast<float>(next - kCapacity / 2 * kChannels) && contiguous(out, got));
+    assert(reader.dropped_frames() == kCapacity + 500 - kCapacity / 2);
+
+    // A restarted writer with the same geometry keeps the mapping and the clock.
+    const std::uint64_t clock = writer.write_frames();
+    const std::uint64_t generation = writer.generation();
+    {
+        when::ShmPcmRing restarted;
+        assert(restarted.create(name, kRate, kChannels, kCapacity));
+        assert(restarted.generation() == generation + 1 && restarted.write_frames() == clock);
+        write_ramp(restarted, next, 64);
+        assert(reader.read(out.data(), out.size()) == 0); // Pending audio from the old stream is discarded
+        write_ramp(restarted, next, 64);
+        got = reader.read(out.data(), out.size());
+        assert(got == 64 * kChannels && out[0] == static_cast<float>(next - 64 * kChannels));
+    }
+
+    // A new geometry retires the old segment; readers notice and re-attach.
+    writer.close();
+    when::ShmPcmRing resized;
+    assert(resized.create(name, kRate, kChannels, kCapacity * 2));
+    assert(!reader.is_current());
+    assert(reader.read(out.data(), out.size()) == 0);
+    assert(reader.attach(name) && reader.capacity_frames() == kCapacity * 2);
+
+    // Concurrent writer: every read is a contiguous run, anything missed is counted.
+    {
+        std::atomic<bool> done{false};
+        std::uint64_t written = next;
+        std::thread producer([&] {
+            for (int block = 0; block < 2000; ++block) {
+                write_ramp(resized, written, 256);
+                if (block % 8 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+            done.store(true);
+        });
+        std::uint64_t received = 0;
+        while (!done.load() || reader.occupancy() > 0.0f) {
+            const std::size_t n = reader.read(out.data(), 1024);
+            assert(contiguous(out, n));
+            received += n / kChannels;
+        }
+        producer.join();
+        assert(received + reader.dropped_frames() == 2000 * 256);
+        next = written;
+    }
+
+    // AudioEngine reads the ring as an input, converting to its channel count.
+    {
+        when::AudioEngine engine(kRate, 1, 1024);
+        engine.set_shared_memory_source(name);
+        assert(engine.start());
+        assert(engine.using_shared_memory() && engine.shared_memory_attached());
+        std::vector<float> stereo(128 * kChannels);
+        for (std::size_t frame = 0; frame < 128; ++frame) {
+            stereo[frame * 2] = 0.5f;
+            stereo[frame * 2 + 1] = -0.25f;
+        }
+        resized.write(stereo.data(), 128);
+        std::vector<float> mono(512);
+        assert(engine.read_samples(mono.data(), mono.size()) == 128);
+        assert(std::abs(mono[0] - 0.125f) < 1e-6f && std::abs(mono[127] - 0.125f) < 1e-6f);
+        engine.stop();
+        assert(!engine.shared_memory_attached());
+
+        // A daemon at another rate is refused rather than analysed at the wrong speed.
+        when::AudioEngine mismatched(44100, 2, 1024);
+        mismatched.set_shared_memory_source(name);
+        assert(mismatched.start());
+        assert(!mismatched.shared_memory_attached() && !mismatched.last_error().empty());
+    }
+
+    resized.close();
+    assert(when::ShmPcmRing::unlink(name));
+
+    // So does a new geometry that happens to need the same number of bytes.
+    {
+        when::ShmPcmRing stereo;
+        assert(stereo.create(name, kRate, kChannels, kCapacity));
+        when::ShmPcmRing listener;
+        assert(listener.attach(name));
+        stereo.close();
+        when::ShmPcmRing mono;
+        assert(mono.create(name, kRate * 2, 1, kCapacity * kChannels));
+        assert(!listener.is_current());
+        assert(listener.read(out.data(), out.size()) == 0);
+        assert(listener.attach(name));
+        assert(listener.sample_rate() == kRate * 2 && listener.channels() == 1);
+        mono.close();
+        assert(when::ShmPcmRing::unlink(name));
+    }
+
+    // A second daemon may not take over a ring another live process is
+    // still writing, unless forced; once that writer has exited it may.
+    {
+        ChildWriter live = start_child_writer(name);
+        when::ShmPcmRing second;
+        assert(!second.create(name, kRate, kChannels, kCapacity));
+        assert(second.last_error().find("still being written") != std::string::npos);
+        assert(!second.create(name, kRate, 1, kCapacity)); // Nor retire it for a new geometry
+        assert(second.create(name, kRate, kChannels, kCapacity, true));
+        second.close();
+        stop_child_writer(live);
+
+        stop_child_writer(start_child_writer(name));
+        assert(second.create(name, kRate, kChannels, kCapacity));
+        second.close();
+    }
+    assert(when::ShmPcmRing::unlink(name));
+    return 0;
+}
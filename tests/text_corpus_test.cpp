@@ -0,0 +1,97 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include <unistd.h>
+
+#include "animations/text_corpus.h"
+
+int main() {
+    using when::animations::TextCorpus;
+
+    const std::string path = "/tmp/when_text_corpus_test_" + std::to_string(::getpid()) + ".txt";
+    const std::string index_path = path + TextCorpus::kIndexSuffix;
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "  first   line here\r\n"
+            << "\n"
+            << "   \t \n"
+            << "solo\n"
+            << "caf\xC3\xA9 au lait\tnoir"; // No trailing newline
+    }
+    std::remove(index_path.c_str());
+
+    TextCorpus corpus;
+    assert(corpus.open(path));
+    assert(!corpus.loaded_from_cache());
+
+    // Blank and whitespace-only lines are skipped; line text is trimmed.
+    assert(corpus.line_count() == 3);
+    assert(corpus.total_words() == 8);
+    assert(corpus.line(0) == "first   line here");
+    assert(corpus.words_in_line(0) == 3);
+    assert(corpus.word(0, 1) == "line");
+    assert(corpus.line_prefix(0, 2) == "first   line");
+    assert(corpus.line_prefix(0, 99) == "first   line here");
+    assert(corpus.line_prefix(0, 0).empty());
+    assert(corpus.line(1) == "solo");
+    assert(corpus.line(2) == "caf\xC3\xA9 au lait\tnoir");
+    assert(corpus.word(2, 3) == "noir");
+    assert(corpus.word(2, 4).empty());
+    assert(corpus.line(3).empty());
+
+    // The second open reuses the cached index and sees identical tables.
+    TextCorpus cached;
+    assert(cached.open(path));
+    assert(cached.loaded_from_cache());
+    assert(cached.line_count() == corpus.line_count());
+    assert(cached.line_prefix(2, 2) == "caf\xC3\xA9 au");
+
+    // A corrupt cache is rejected and rebuilt rather than trusted.
+    {
+        std::fstream index(index_path, std::ios::binary | std::ios::in | std::ios::out);
+        index.seekp(-4, std::ios::end);
+        const char junk[4] = {'\xFF', '\xFF', '\xFF', '\x7F'};
+        index.write(junk, sizeof(junk));
+    }
+    TextCorpus rebuilt;
+    assert(rebuilt.open(path));
+    assert(!rebuilt.loaded_from_cache());
+    assert(rebuilt.word(2, 3) == "noir");
+
+    // Offsets that run backwards stay in bounds but would invert a line span.
+    {
+        std::fstream index(index_path, std::ios::binary | std::ios::in | std::ios::out);
+        // 40-byte header, then three 8-byte line entries before the words.
+        const auto first_word_offset = static_cast<std::streamoff>(40 + 3 * 8);
+        index.seekp(first_word_offset);
+        const std::uint32_t past_line_end = 40;
+        index.write(reinterpret_cast<const char*>(&past_line_end), sizeof(past_line_end));
+    }
+    TextCorpus reordered;
+    assert(reordered.open(path));
+    assert(!reordered.loaded_from_cache());
+    assert(reordered.line(0) == "first   line here");
+
+    TextCorpus uncached;
+    assert(uncached.open(path, false));
+    assert(!uncached.loaded_from_cache());
+
+    TextCorpus missing;
+    assert(!missing.open(path + ".missing"));
+    assert(!missing.last_error().empty());
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << " \n\t\n";
+    }
+    TextCorpus blank;
+    assert(!blank.open(path, false));
+
+    std::remove(path.c_str());
+    std::remove(index_path.c_str());
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include "audio/tone_tracker.h"
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+
+float sine(float frequency, std::size_t index) {
+    return 0.5f * std::sin(2.0f * 3.14159265f * frequency * static_cast<float>(index) / kSampleRate);
+}
+
+} // namespace
+
+int main() {
+    when::ToneTracker tracker;
+    when::ToneTracker::Config config;
+    config.frequencies = {55.0f, 440.0f, 30000.0f}; // The last one is above Nyquist and dropped
+    config.bandwidth_hz = 10.0f;
+    tracker.configure(config, kSampleRate);
+    assert(tracker.size() == 2);
+
+    // Silence leaves every envelope at zero.
+    for (std::size_t i = 0; i < 4800; ++i) {
+        tracker.push(0.0f);
+    }
+    tracker.snapshot();
+    assert(tracker.envelopes()[0] == 0.0f);
+
+    // A steady 55 Hz tone settles near its amplitude while 440 Hz stays quiet.
+    for (std::size_t i = 0; i < 48000; ++i) {
+        tracker.push(sine(55.0f, i));
+    }
+    tracker.snapshot();
+    assert(std::abs(tracker.envelopes()[0] - 0.5f) < 0.05f);
+    assert(tracker.envelopes()[1] < 0.05f);
+
+    // After the tone stops the envelope decays, but the peak still reports
+    // the level reached earlier in the interval.
+    for (std::size_t i = 0; i < 4800; ++i) {
+        tracker.push(0.0f);
+    }
+    tracker.snapshot();
+    assert(tracker.envelopes()[0] < 0.1f);
+    assert(tracker.peaks()[0] > 0.45f);
+
+    tracker.snapshot();
+    assert(tracker.peaks()[0] < 0.1f);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <cassert>
+#include <cmath>
+
+#include "animations/trail_occupancy.h"
+
+int main() {
+    using when::animations::TrailOccupancyGrid;
+
+    TrailOccupancyGrid grid;
+    grid.resize(100, 100);
+    assert(grid.occupied_cells() == 0);
+
+    // A horizontal wall across the middle blocks a cycle heading down at it.
+    grid.add_segment(0.1f, 0.5f, 0.9f, 0.5f);
+    assert(grid.occupied(0.3f, 0.505f));
+    assert(!grid.occupied(0.3f, 0.6f));
+    assert(grid.occupied_cells() >= 80);
+
+    const float hit = grid.clearance(0.3f, 0.4f, 0.0f, 1.0f, 0.0f, 0.2f);
+    assert(std::abs(hit - 0.1f) < 0.01f);
+    assert(grid.clearance(0.3f, 0.4f, 0.0f, -1.0f, 0.0f, 0.2f) == 0.2f);
+    // Parallel to the wall and beside it stays clear.
+    assert(grid.clearance(0.3f, 0.45f, 1.0f, 0.0f, 0.0f, 0.3f) == 0.3f);
+
+    // Overlapping segments are counted, so expiring one keeps the other.
+    grid.add_segment(0.5f, 0.1f, 0.5f, 0.9f);
+    assert(grid.occupied(0.505f, 0.505f));
+    grid.remove_segment(0.1f, 0.5f, 0.9f, 0.5f);
+    assert(grid.occupied(0.505f, 0.505f));
+    assert(!grid.occupied(0.3f, 0.505f));
+    grid.remove_segment(0.5f, 0.1f, 0.5f, 0.9f);
+    assert(grid.occupied_cells() == 0);
+
+    // Off-screen segments (cycles entering from the margin) are ignored.
+    grid.add_segment(-0.2f, 0.3f, -0.1f, 0.3f);
+    assert(grid.occupied_cells() == 0);
+    grid.add_segment(-0.1f, 0.3f, 0.05f, 0.3f);
+    assert(grid.occupied(0.02f, 0.305f));
+    grid.clear();
+    assert(grid.occupied_cells() == 0);
+    assert(!grid.occupied(0.02f, 0.305f));
+
+    return 0;
+}
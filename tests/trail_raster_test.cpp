@@ -0,0 +1,105 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "animations/trail_raster.h"
+
+namespace {
+
+// Moves a head along a quarter circle at the given frame rate and counts the
+// samples the gate lays down.
+std::size_t count_samples(float fps) {
+    when::animations::TrailSampleGate gate;
+    gate.configure(0.01f, 0.35f);
+
+    const float duration_s = 2.0f;
+    const auto frames = static_cast<std::size_t>(duration_s * fps);
+    float anchor_x = 0.0f;
+    float anchor_y = 0.0f;
+    float previous_x = 0.0f;
+    float previous_y = 0.0f;
+    std::size_t samples = 0;
+    for (std::size_t frame = 0; frame <= frames; ++frame) {
+        const float angle = 1.5707963f * static_cast<float>(frame) / static_cast<float>(frames);
+        const float x = 0.5f + 0.4f * std::cos(angle);
+        const float y = 0.5f + 0.4f * std::sin(angle);
+        const float step = frame == 0 ? 0.0f : std::hypot(x - previous_x, y - previous_y);
+        if (gate.advance(step, anchor_x, anchor_y, x, y)) {
+            anchor_x = x;
+            anchor_y = y;
+            ++samples;
+        }
+        previous_x = x;
+        previous_y = y;
+    }
+    return samples;
+}
+
+} // namespace
+
+int main() {
+    using when::animations::TrailRasterizer;
+    using when::animations::TrailSampleGate;
+    using when::animations::TrailVertex;
+
+    // Sample count follows arc length (~0.63 / 0.01), not the frame rate.
+    const std::size_t at_60 = count_samples(60.0f);
+    const std::size_t at_600 = count_samples(600.0f);
+    assert(at_60 >= 50 && at_60 <= 70);
+    assert(at_600 >= 55 && at_600 <= 70);
+
+    // A stationary head adds nothing after its first sample.
+    TrailSampleGate still;
+    still.configure(0.01f, 0.35f);
+    assert(still.advance(0.0f, 0.2f, 0.2f, 0.2f, 0.2f));
+    for (int i = 0; i < 100; ++i) {
+        assert(!still.advance(0.0f, 0.2f, 0.2f, 0.2f, 0.2f));
+    }
+
+    // A sharp turn forces an early sample.
+    TrailSampleGate turning;
+    turning.configure(0.1f, 0.35f);
+    assert(turning.advance(0.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+    assert(turning.advance(0.1f, 0.0f, 0.0f, 0.1f, 0.0f));
+    assert(!turning.advance(0.03f, 0.1f, 0.0f, 0.13f, 0.0f));
+    assert(turning.advance(0.03f, 0.1f, 0.0f, 0.1f, 0.03f));
+
+    // A long segment covers every dot column along it with no gaps.
+    TrailRasterizer rasterizer;
+    rasterizer.resize(40, 8);
+    TrailVertex a;
+    a.x = 2.0f;
+    a.y = 3.0f;
+    a.brightness = 1.0f;
+    a.radius = 1.0f;
+    TrailVertex b = a;
+    b.x = 37.0f;
+    rasterizer.draw_segment(a, b);
+    for (int col = 2; col <= 37; ++col) {
+        assert(rasterizer.intensity_at(col, 3) > 0.99f);
+    }
+    assert(rasterizer.intensity_at(20, 6) == 0.0f);
+
+    // Overlapping segments keep the brightest coverage instead of summing.
+    TrailVertex c = b;
+    c.y = 6.0f;
+    rasterizer.draw_segment(b, c);
+    assert(rasterizer.intensity_at(37, 3) <= 1.0f);
+
+    std::vector<std::uint8_t> masks(20 * 2, 0u);
+    float total = 0.0f;
+    const bool wrote = rasterizer.flush(masks, 20, [&](std::size_t index, float intensity, const std::array<float, 3>&) {
+        assert(index < masks.size());
+        total += intensity;
+    });
+    assert(wrote);
+    assert(total > 36.0f);
+    // Dot (2, 3) is the bottom-left dot of cell (0, 1).
+    assert((masks[1] & 0x40u) != 0u);
+    assert(rasterizer.covered_dots() == 0);
+    assert(rasterizer.intensity_at(20, 3) == 0.0f);
+
+    return 0;
+}